@@ -25,7 +25,12 @@
 
 #include <assert.h>
 
+#if defined(QCC_OS_GROUP_POSIX)
+#include <unistd.h>
+#endif
+
 #include "Bus.h"
+#include "DaemonConfig.h"
 #include "DaemonRouter.h"
 #include "TransportList.h"
 
@@ -41,10 +46,46 @@ using namespace std;
  */
 const uint32_t EP_CONCURRENCY = 4;
 
+/*
+ * Default number of iodispatch shards, 0 means one per processor.
+ */
+const uint32_t IO_DISPATCH_SHARDS_DEFAULT = 0;
+
+/*
+ * Number of processors available to the daemon, used as the default number of
+ * iodispatch shards.
+ */
+static uint32_t NumProcessors()
+{
+#if defined(QCC_OS_GROUP_POSIX)
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return (n > 0) ? static_cast<uint32_t>(n) : 1;
+#elif defined(QCC_OS_GROUP_WINDOWS)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors ? info.dwNumberOfProcessors : 1;
+#else
+    return 1;
+#endif
+}
+
 Bus::Bus(const char* applicationName, TransportFactoryContainer& factories, const char* listenSpecs) :
     BusAttachment(new Internal(applicationName, *this, factories, new DaemonRouter, true, listenSpecs, EP_CONCURRENCY), EP_CONCURRENCY)
 {
     GetInternal().GetRouter().SetGlobalGUID(GetInternal().GetGlobalGUID());
+
+    /*
+     * Spread the remote endpoints over several iodispatch event loops so message
+     * throughput is not limited to what a single loop can sustain.
+     */
+    uint32_t shards = DaemonConfig::Access()->Get("limit@io_dispatch_shards", IO_DISPATCH_SHARDS_DEFAULT);
+    if (shards == 0) {
+        shards = NumProcessors();
+    }
+    QStatus status = GetInternal().SetIODispatchShards(shards);
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Failed to set %u iodispatch shards", shards));
+    }
 }
 
 Bus::~Bus()
@@ -125,11 +125,12 @@ class BusController {
     /**
      * Send a sessionless message to the SessionlessObj.
      *
-     * @param msg  Sessionless message to be pushed.
+     * @param msg      Sessionless message to be pushed.
+     * @param msgSize  Memory used by the message buffer.
      * @return     ER_OK if successful
      */
-    QStatus PushSessionlessMessage(Message& msg) {
-        return sessionlessObj.PushMessage(msg);
+    QStatus PushSessionlessMessage(Message& msg, size_t msgSize) {
+        return sessionlessObj.PushMessage(msg, msgSize);
     }
 
     /**
@@ -116,7 +116,7 @@ QStatus DaemonRouter::PushMessage(Message& msg, BusEndpoint& origSender)
 
     bool destinationEmpty = destination[0] == '\0';
     if (!destinationEmpty) {
-        nameTable.Lock();
+        /* Name table lookups are served from a snapshot and do not need the name table lock */
         BusEndpoint destEndpoint = nameTable.FindEndpoint(destination);
         if (destEndpoint->IsValid()) {
             /* If this message is coming from a bus-to-bus ep, make sure the receiver is willing to receive it */
@@ -135,9 +135,7 @@ QStatus DaemonRouter::PushMessage(Message& msg, BusEndpoint& origSender)
                     BusEndpoint busEndpoint = BusEndpoint::cast(localEndpoint);
                     PushMessage(msg, busEndpoint);
                 } else {
-                    nameTable.Unlock();
                     status = SendThroughEndpoint(msg, destEndpoint, sessionId);
-                    nameTable.Lock();
                 }
             } else {
                 QCC_DbgPrintf(("Blocking message from %s to %s (serial=%d) because receiver does not allow remote messages",
@@ -157,9 +155,7 @@ QStatus DaemonRouter::PushMessage(Message& msg, BusEndpoint& origSender)
             if ((ER_OK != status) && (ER_BUS_ENDPOINT_CLOSING != status) && (status != ER_BUS_STOPPING)) {
                 QCC_LogError(status, ("BusEndpoint::PushMessage failed"));
             }
-            nameTable.Unlock();
         } else {
-            nameTable.Unlock();
             if ((msg->GetFlags() & ALLJOYN_FLAG_AUTO_START) &&
                 (sender->GetEndpointType() != ENDPOINT_TYPE_BUS2BUS) &&
                 (sender->GetEndpointType() != ENDPOINT_TYPE_NULL)) {
@@ -198,37 +194,28 @@ QStatus DaemonRouter::PushMessage(Message& msg, BusEndpoint& origSender)
          * The message has an empty destination field and no session is specified so this is a
          * regular broadcast message.
          */
-        nameTable.Lock();
+        vector<BusEndpoint> dests;
         ruleTable.Lock();
-        RuleIterator it = ruleTable.Begin();
-        while (it != ruleTable.End()) {
-            if (it->second.IsMatch(msg)) {
-                BusEndpoint dest = it->first;
-                QCC_DbgPrintf(("Routing %s (%d) to %s", msg->Description().c_str(), msg->GetCallSerial(), dest->GetUniqueName().c_str()));
-                /*
-                 * If the message originated locally or the destination allows remote messages
-                 * forward the message, otherwise silently ignore it.
-                 */
-                if (!((sender->GetEndpointType() == ENDPOINT_TYPE_BUS2BUS) && !dest->AllowRemoteMessages())) {
-                    ruleTable.Unlock();
-                    nameTable.Unlock();
-                    QStatus tStatus = SendThroughEndpoint(msg, dest, sessionId);
-                    status = (status == ER_OK) ? tStatus : status;
-                    nameTable.Lock();
-                    ruleTable.Lock();
-                }
-                it = ruleTable.AdvanceToNextEndpoint(dest);
-            } else {
-                ++it;
+        ruleTable.FindMatchingEndpoints(msg, dests);
+        ruleTable.Unlock();
+
+        for (vector<BusEndpoint>::iterator dit = dests.begin(); dit != dests.end(); ++dit) {
+            BusEndpoint& dest = *dit;
+            QCC_DbgPrintf(("Routing %s (%d) to %s", msg->Description().c_str(), msg->GetCallSerial(), dest->GetUniqueName().c_str()));
+            /*
+             * If the message originated locally or the destination allows remote messages
+             * forward the message, otherwise silently ignore it.
+             */
+            if (!((sender->GetEndpointType() == ENDPOINT_TYPE_BUS2BUS) && !dest->AllowRemoteMessages())) {
+                QStatus tStatus = SendThroughEndpoint(msg, dest, sessionId);
+                status = (status == ER_OK) ? tStatus : status;
             }
         }
-        ruleTable.Unlock();
-        nameTable.Unlock();
 
         if (msg->IsSessionless()) {
             /* Give "locally generated" sessionless message to SessionlessObj */
             if (sender->GetEndpointType() != ENDPOINT_TYPE_BUS2BUS) {
-                status = busController->PushSessionlessMessage(msg);
+                status = busController->PushSessionlessMessage(msg, msg->bufSize);
             }
         } else if (msg->IsGlobalBroadcast()) {
             /*
@@ -283,10 +270,12 @@ QStatus DaemonRouter::PushMessage(Message& msg, BusEndpoint& origSender)
     } else {
         /*
          * The message has an empty destination field and a session id was specified so this is a
-         * session multicast message.
+         * session multicast message. Session members that are reached through the same bus-to-bus
+         * endpoint get a single copy of the message sent over that endpoint and the daemon at the
+         * other end delivers it to each of its members.
          */
+        vector<SessionCastEntry> dests;
         sessionCastSetLock.Lock(MUTEX_CONTEXT);
-        RemoteEndpoint lastB2b;
         /* We need to obtain the first entry in the sessionCastSet that has the id equal to 'sessionId'
          * and the src equal to 'msg->GetSender()'.
          * Note: sce.id has been set to sessionId - 1. Since the src is compared first, and session Ids
@@ -295,7 +284,6 @@ QStatus DaemonRouter::PushMessage(Message& msg, BusEndpoint& origSender)
          */
         SessionCastEntry sce(sessionId - 1, msg->GetSender());
         set<SessionCastEntry>::iterator sit = sessionCastSet.upper_bound(sce);
-        bool foundDest = false;
 
         /* In other cases, it may return the iterator to an element that has the desired src and
          * (sessionId - 1). In that case iterate, until the id is less than the desired one.
@@ -304,26 +292,32 @@ QStatus DaemonRouter::PushMessage(Message& msg, BusEndpoint& origSender)
             sit++;
         }
 
+        /*
+         * Entries are ordered by b2bEp so the members behind one bus-to-bus endpoint are adjacent
+         * and only the first of them is kept. Local members all have distinct (invalid) b2bEps.
+         */
         while ((sit != sessionCastSet.end()) && (sit->id == sessionId) && (sit->src == sce.src)) {
-            if (sit->b2bEp != lastB2b) {
-                foundDest = true;
-                lastB2b = sit->b2bEp;
-                SessionCastEntry entry = *sit;
-                BusEndpoint ep = sit->destEp;
-                sessionCastSetLock.Unlock(MUTEX_CONTEXT);
-                QStatus tStatus = SendThroughEndpoint(msg, ep, sessionId);
-                status = (status == ER_OK) ? tStatus : status;
-                sessionCastSetLock.Lock(MUTEX_CONTEXT);
-                sit = sessionCastSet.lower_bound(entry);
+            if (dests.empty() || (sit->b2bEp != dests.back().b2bEp)) {
+                dests.push_back(*sit);
+            }
+            ++sit;
+        }
+        sessionCastSetLock.Unlock(MUTEX_CONTEXT);
+
+        for (vector<SessionCastEntry>::iterator dit = dests.begin(); dit != dests.end(); ++dit) {
+            QStatus tStatus = ER_BUS_NO_ROUTE;
+            if (dit->b2bEp->IsValid()) {
+                tStatus = dit->b2bEp->PushMessage(msg);
             }
-            if (sit != sessionCastSet.end()) {
-                ++sit;
+            /* Local members, or a bus-to-bus endpoint that has gone away since the session was joined */
+            if (tStatus != ER_OK) {
+                tStatus = SendThroughEndpoint(msg, dit->destEp, sessionId);
             }
+            status = (status == ER_OK) ? tStatus : status;
         }
-        if (!foundDest) {
+        if (dests.empty()) {
             status = ER_BUS_NO_ROUTE;
         }
-        sessionCastSetLock.Unlock(MUTEX_CONTEXT);
     }
 
     return status;
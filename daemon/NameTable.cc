@@ -64,6 +64,8 @@ void NameTable::AddUniqueName(BusEndpoint& endpoint)
     QCC_DbgPrintf(("Add unique name %s", uniqueName.c_str()));
     lock.Lock(MUTEX_CONTEXT);
     uniqueNames[uniqueName] = endpoint;
+    staleNames.insert(uniqueName);
+    PublishSnapshot();
     lock.Unlock(MUTEX_CONTEXT);
 
     /* Notify listeners */
@@ -123,6 +125,8 @@ void NameTable::RemoveUniqueName(const qcc::String& uniqueName)
 
         if (it != uniqueNames.end()) {
             uniqueNames.erase(it);
+            staleNames.insert(uniqueName);
+            PublishSnapshot();
             QCC_DbgPrintf(("Removed ep=%s from name table", uniqueName.c_str()));
         }
 
@@ -187,6 +191,10 @@ QStatus NameTable::AddAlias(const qcc::String& aliasName,
                 origOwner = &vit->second->GetUniqueName();
             }
         }
+        if (newOwner) {
+            staleNames.insert(aliasName);
+            PublishSnapshot();
+        }
         lock.Unlock(MUTEX_CONTEXT);
 
         if (listener) {
@@ -227,7 +235,7 @@ void NameTable::RemoveAlias(const qcc::String& aliasName,
             /* Remove primary */
             if (queue.size() > 1) {
                 queue.pop_front();
-                BusEndpoint ep = FindEndpoint(queue[0].endpointName);
+                BusEndpoint ep = LookupEndpoint(queue[0].endpointName);
                 if (ep->IsValid()) {
                     newOwner = queue[0].endpointName;
                 }
@@ -242,6 +250,8 @@ void NameTable::RemoveAlias(const qcc::String& aliasName,
             }
             oldOwner = ownerName;
             disposition = DBUS_RELEASE_NAME_REPLY_RELEASED;
+            staleNames.insert(aliasNameCopy);
+            PublishSnapshot();
         } else {
             /* Alias is not owned by ownerName */
             disposition = DBUS_RELEASE_NAME_REPLY_NOT_OWNER;
@@ -264,7 +274,25 @@ BusEndpoint NameTable::FindEndpoint(const qcc::String& busName) const
 {
     BusEndpoint ep;
 
-    lock.Lock(MUTEX_CONTEXT);
+    /*
+     * The snapshot lock is only held while taking a reference. The snapshot itself is never
+     * modified so the lookup is made without holding any lock.
+     */
+    snapshotLock.Lock(MUTEX_CONTEXT);
+    EndpointSnapshot snap = snapshot;
+    snapshotLock.Unlock(MUTEX_CONTEXT);
+
+    EndpointMap::const_iterator it = snap->find(busName);
+    if (it != snap->end()) {
+        ep = it->second;
+    }
+    return ep;
+}
+
+BusEndpoint NameTable::LookupEndpoint(const qcc::String& busName) const
+{
+    BusEndpoint ep;
+
     if (busName[0] == ':') {
         unordered_map<qcc::String, BusEndpoint, Hash, Equal>::const_iterator it = uniqueNames.find(busName);
         if (it != uniqueNames.end()) {
@@ -274,7 +302,7 @@ BusEndpoint NameTable::FindEndpoint(const qcc::String& busName) const
         unordered_map<qcc::String, deque<NameQueueEntry>, Hash, Equal>::const_iterator it = aliasNames.find(busName);
         if (it != aliasNames.end()) {
             assert(!it->second.empty());
-            ep = FindEndpoint(it->second[0].endpointName);
+            ep = LookupEndpoint(it->second[0].endpointName);
         }
         /* Fallback to virtual (remote) aliases if a suitable local one cannot be found */
         if (!ep->IsValid()) {
@@ -285,10 +313,39 @@ BusEndpoint NameTable::FindEndpoint(const qcc::String& busName) const
             }
         }
     }
-    lock.Unlock(MUTEX_CONTEXT);
     return ep;
 }
 
+void NameTable::PublishSnapshot()
+{
+    if (staleNames.empty()) {
+        return;
+    }
+
+    /*
+     * Copy the current snapshot and resolve again only the names that have changed. The copy
+     * is O(N) in the number of names so callers publish once per batch of changes.
+     */
+    EndpointSnapshot snap;
+    *snap = *snapshot;
+    set<qcc::String>::const_iterator sit = staleNames.begin();
+    while (sit != staleNames.end()) {
+        BusEndpoint ep = LookupEndpoint(*sit);
+        if (ep->IsValid()) {
+            (*snap)[*sit] = ep;
+        } else {
+            snap->erase(*sit);
+        }
+        ++sit;
+    }
+    staleNames.clear();
+
+    /* The replaced snapshot is freed when the last reader using it releases its reference */
+    snapshotLock.Lock(MUTEX_CONTEXT);
+    snapshot = snap;
+    snapshotLock.Unlock(MUTEX_CONTEXT);
+}
+
 void NameTable::GetBusNames(vector<qcc::String>& names) const
 {
     lock.Lock(MUTEX_CONTEXT);
@@ -320,7 +377,7 @@ void NameTable::GetUniqueNamesAndAliases(vector<pair<qcc::String, vector<qcc::St
     unordered_map<qcc::String, deque<NameQueueEntry>, Hash, Equal>::const_iterator ait = aliasNames.begin();
     while (ait != aliasNames.end()) {
         if (!ait->second.empty()) {
-            BusEndpoint ep = FindEndpoint(ait->second.front().endpointName);
+            BusEndpoint ep = LookupEndpoint(ait->second.front().endpointName);
             if (ep->IsValid()) {
                 epMap.insert(pair<BusEndpoint, qcc::String>(ep, ait->first));
             }
@@ -379,8 +436,10 @@ void NameTable::GetQueuedNames(const qcc::String& busName, std::vector<qcc::Stri
 
 void NameTable::RemoveVirtualAliases(const qcc::String& epName)
 {
+    vector<qcc::String> removed;
+
     lock.Lock(MUTEX_CONTEXT);
-    BusEndpoint tempEp = FindEndpoint(epName);
+    BusEndpoint tempEp = LookupEndpoint(epName);
     VirtualEndpoint ep = VirtualEndpoint::cast(tempEp);
 
     QCC_DbgTrace(("NameTable::RemoveVirtualAliases(%s)", ep->IsValid() ? ep->GetUniqueName().c_str() : "<none>"));
@@ -391,18 +450,23 @@ void NameTable::RemoveVirtualAliases(const qcc::String& epName)
             if (vit->second == ep) {
                 String alias = vit->first.c_str();
                 virtualAliasNames.erase(vit++);
+                staleNames.insert(alias);
+                /* Virtual aliases that were masked by a local alias were never visible to listeners */
                 if (aliasNames.find(alias) == aliasNames.end()) {
-                    lock.Unlock(MUTEX_CONTEXT);
-                    CallListeners(alias, &epName, NULL);
-                    lock.Lock(MUTEX_CONTEXT);
-                    vit = virtualAliasNames.upper_bound(alias);
+                    removed.push_back(alias);
                 }
             } else {
                 ++vit;
             }
         }
+        /* Publish once for all of the removed aliases */
+        PublishSnapshot();
     }
     lock.Unlock(MUTEX_CONTEXT);
+
+    for (vector<qcc::String>::const_iterator it = removed.begin(); it != removed.end(); ++it) {
+        CallListeners(*it, &epName, NULL);
+    }
 }
 
 bool NameTable::SetVirtualAlias(const qcc::String& alias,
@@ -447,6 +511,8 @@ bool NameTable::SetVirtualAlias(const qcc::String& alias,
         madeChange = true;
         virtualAliasNames.erase(StringMapKey(alias));
     }
+    staleNames.insert(alias);
+    PublishSnapshot();
 
     String oldName = oldOwner->IsValid() ? oldOwner->GetUniqueName() : "";
     String newName = newOwner ? (*newOwner)->GetUniqueName() : "";
@@ -29,6 +29,7 @@
 #include <set>
 
 #include <qcc/Mutex.h>
+#include <qcc/ManagedObj.h>
 #include <qcc/Environ.h>
 #include <qcc/String.h>
 #include <qcc/StringMapKey.h>
@@ -173,6 +174,10 @@ class NameTable {
     /**
      * Find an endpoint for a given unique or alias bus name.
      *
+     * Lookups are made against an immutable snapshot of the name table so they never
+     * contend with each other or wait for name ownership changes to complete. The
+     * table lock does not need to be held.
+     *
      * @param busName   Name of bus.
      * @return  Returns the endpoint if it was found or an invalid endpoint if not found
      */
@@ -231,6 +236,16 @@ class NameTable {
         }
     };
 
+    /**
+     * Resolved bus name to endpoint mapping. Once published a snapshot is never modified.
+     */
+    typedef std::unordered_map<qcc::String, BusEndpoint, Hash, Equal> EndpointMap;
+
+    /**
+     * Reference counted snapshot so readers can keep using a snapshot that has been replaced.
+     */
+    typedef qcc::ManagedObj<EndpointMap> EndpointSnapshot;
+
     mutable qcc::Mutex lock;                                             /**< Lock protecting name tables */
     std::unordered_map<qcc::String, BusEndpoint, Hash, Equal> uniqueNames;   /**< Unique name table */
     std::unordered_map<qcc::String, std::deque<NameQueueEntry>, Hash, Equal> aliasNames;  /**< Alias name table */
@@ -241,6 +256,26 @@ class NameTable {
     std::set<ProtectedNameListener> listeners;                         /**< Listeners regsitered with name table */
     std::map<qcc::StringMapKey, VirtualEndpoint> virtualAliasNames;    /**< map of virtual aliases to virtual endpts */
 
+    mutable qcc::Mutex snapshotLock;                                   /**< Only held while taking or replacing a snapshot reference */
+    EndpointSnapshot snapshot;                                         /**< Snapshot used by FindEndpoint */
+    std::set<qcc::String> staleNames;                                  /**< Names changed since the snapshot was published */
+
+    /**
+     * Find an endpoint from the live name tables. Must be called with the lock held.
+     *
+     * @param busName   Name of bus.
+     * @return  Returns the endpoint if it was found or an invalid endpoint if not found
+     */
+    BusEndpoint LookupEndpoint(const qcc::String& busName) const;
+
+    /**
+     * Publish a new snapshot for FindEndpoint with the names in staleNames resolved again.
+     * Must be called with the lock held once a batch of changes to uniqueNames, aliasNames
+     * or virtualAliasNames is complete. A replaced snapshot is freed when the last reader
+     * releases its reference.
+     */
+    void PublishSnapshot();
+
     /**
      * Helper used to call the listners
      *
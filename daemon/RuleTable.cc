@@ -22,11 +22,14 @@
 #include <qcc/platform.h>
 
 #include <cstring>
+#include <ctype.h>
+#include <algorithm>
 
 #include "RuleTable.h"
 
 #include <qcc/Debug.h>
 #include <qcc/String.h>
+#include <qcc/StringUtil.h>
 #include <alljoyn/Message.h>
 
 #define QCC_MODULE "ALLJOYN"
@@ -36,7 +39,9 @@ using namespace qcc;
 
 namespace ajn {
 
-Rule::Rule(const char* ruleSpec, QStatus* outStatus) : type(MESSAGE_INVALID), sessionless(SESSIONLESS_NOT_SPECIFIED)
+Rule::Rule(const char* ruleSpec, QStatus* outStatus) : type(MESSAGE_INVALID), sessionless(SESSIONLESS_NOT_SPECIFIED),
+    senderAtom(NameAtomTable::NIL_ATOM), ifaceAtom(NameAtomTable::NIL_ATOM), memberAtom(NameAtomTable::NIL_ATOM),
+    destinationAtom(NameAtomTable::NIL_ATOM)
 {
     QStatus status = ER_OK;
     const char* pos = ruleSpec;
@@ -91,9 +96,35 @@ Rule::Rule(const char* ruleSpec, QStatus* outStatus) : type(MESSAGE_INVALID), se
         } else if (0 == strncmp("sessionless", pos, 11)) {
             sessionless = ((begQuotePos[0] == 't') || (begQuotePos[0] == 'T')) ? SESSIONLESS_TRUE : SESSIONLESS_FALSE;
         } else if (0 == strncmp("arg", pos, 3)) {
-            status = ER_NOT_IMPLEMENTED;
-            QCC_LogError(status, ("arg keys are not supported in ruleSpec \"%s\"", ruleSpec));
-            break;
+            /* Key is arg<N>, arg<N>path or arg0namespace */
+            const char* keyEnd = eqPos - 1;
+            const char* p = pos + 3;
+            uint32_t argN = 0;
+            size_t digits = 0;
+            while ((p < keyEnd) && isdigit(*p) && (digits < 3)) {
+                argN = argN * 10 + (*p++ - '0');
+                ++digits;
+            }
+            qcc::String suffix(p, keyEnd - p);
+            ArgMatch argMatch;
+            argMatch.argN = static_cast<uint8_t>(argN);
+            argMatch.value = qcc::String(begQuotePos, endQuotePos - begQuotePos);
+            if ((digits == 0) || (argN >= MatchArgs::MAX_ARGS)) {
+                status = ER_FAIL;
+            } else if (suffix.empty()) {
+                argMatch.kind = ArgMatch::ARG_STRING;
+            } else if (suffix == "path") {
+                argMatch.kind = ArgMatch::ARG_PATH;
+            } else if ((suffix == "namespace") && (argN == 0)) {
+                argMatch.kind = ArgMatch::ARG_NAMESPACE;
+            } else {
+                status = ER_FAIL;
+            }
+            if (status != ER_OK) {
+                QCC_LogError(status, ("Invalid arg key in ruleSpec \"%s\"", ruleSpec));
+                break;
+            }
+            args.push_back(argMatch);
         } else {
             status = ER_FAIL;
             QCC_LogError(status, ("Invalid key in ruleSpec \"%s\"", ruleSpec));
@@ -131,21 +162,116 @@ bool Rule::IsMatch(const Message& msg)
         ((sessionless == SESSIONLESS_FALSE) && msg->IsSessionless())) {
         return false;
     }
+    if (!args.empty()) {
+        MatchArgs msgArgs(msg);
+        for (std::vector<ArgMatch>::const_iterator it = args.begin(); it != args.end(); ++it) {
+            if (!it->IsMatch(msgArgs.GetArg(it->argN))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
 
-    // @@ TODO Arg matches are not handled
+bool Rule::IsMatch(const Message& msg, const MessageNameAtoms& atoms, MatchArgs& msgArgs) const
+{
+    /* The fields of a rule (if specified) are logically anded together */
+    if ((type != MESSAGE_INVALID) && (type != msg->GetType())) {
+        return false;
+    }
+    if ((ifaceAtom != NameAtomTable::NIL_ATOM) && (ifaceAtom != atoms.iface)) {
+        return false;
+    }
+    if ((memberAtom != NameAtomTable::NIL_ATOM) && (memberAtom != atoms.member)) {
+        return false;
+    }
+    if ((senderAtom != NameAtomTable::NIL_ATOM) && (senderAtom != atoms.sender)) {
+        return false;
+    }
+    if (!path.empty() && (0 != strcmp(path.c_str(), msg->GetObjectPath()))) {
+        return false;
+    }
+    if ((destinationAtom != NameAtomTable::NIL_ATOM) && (destinationAtom != atoms.destination)) {
+        return false;
+    }
+    if (((sessionless == SESSIONLESS_TRUE) && !msg->IsSessionless()) ||
+        ((sessionless == SESSIONLESS_FALSE) && msg->IsSessionless())) {
+        return false;
+    }
+    /* Argument matches are checked last because they need the message body */
+    for (std::vector<ArgMatch>::const_iterator it = args.begin(); it != args.end(); ++it) {
+        if (!it->IsMatch(msgArgs.GetArg(it->argN))) {
+            return false;
+        }
+    }
     return true;
 }
 
+bool Rule::ArgMatch::IsMatch(const MsgArg* arg) const
+{
+    if (!arg) {
+        return false;
+    }
+    const char* str = arg->v_string.str;
+    size_t len = arg->v_string.len;
+    switch (kind) {
+    case ARG_STRING:
+        return (arg->typeId == ALLJOYN_STRING) && (value == str);
+
+    case ARG_PATH:
+        /*
+         * Matches if the argument and value are equal or if either one ends in '/' and is
+         * a prefix of the other.
+         */
+        if (value == str) {
+            return true;
+        }
+        if (!value.empty() && (value[value.size() - 1] == '/') && (0 == strncmp(value.c_str(), str, value.size()))) {
+            return true;
+        }
+        return (len > 0) && (str[len - 1] == '/') && (0 == strncmp(value.c_str(), str, len));
+
+    case ARG_NAMESPACE:
+        /* Matches if the argument is the value or is a bus name or interface within that namespace */
+        return (arg->typeId == ALLJOYN_STRING) && (0 == strncmp(value.c_str(), str, value.size())) &&
+               ((str[value.size()] == '\0') || (str[value.size()] == '.'));
+    }
+    return false;
+}
+
+const MsgArg* MatchArgs::GetArg(size_t argN)
+{
+    if (!args) {
+        args = new MsgArg[MAX_ARGS];
+        QStatus status = msg->PeekStringArgs(args, MAX_ARGS);
+        if (status != ER_OK) {
+            QCC_DbgPrintf(("Unable to examine args of %s: %s", msg->Description().c_str(), QCC_StatusText(status)));
+        }
+    }
+    return ((argN < MAX_ARGS) && (args[argN].typeId != ALLJOYN_INVALID)) ? &args[argN] : NULL;
+}
+
 qcc::String Rule::ToString() const
 {
-    return "s:" + sender + " i:" + iface + " m:" + member + " p:" + path + " d:" + destination;
+    qcc::String str = "s:" + sender + " i:" + iface + " m:" + member + " p:" + path + " d:" + destination;
+    for (std::vector<ArgMatch>::const_iterator it = args.begin(); it != args.end(); ++it) {
+        str += " arg" + U32ToString(it->argN);
+        if (it->kind == ArgMatch::ARG_PATH) {
+            str += "path";
+        } else if (it->kind == ArgMatch::ARG_NAMESPACE) {
+            str += "namespace";
+        }
+        str += ":" + it->value;
+    }
+    return str;
 }
 
 QStatus RuleTable::AddRule(BusEndpoint& endpoint, const Rule& rule)
 {
     QCC_DbgPrintf(("AddRule for endpoint %s\n  %s", endpoint->GetUniqueName().c_str(), rule.ToString().c_str()));
     Lock();
-    rules.insert(std::pair<BusEndpoint, Rule>(endpoint, rule));
+    RuleIterator it = rules.insert(std::pair<BusEndpoint, Rule>(endpoint, rule));
+    IndexRule(it);
     Unlock();
     return ER_OK;
 }
@@ -153,11 +279,10 @@ QStatus RuleTable::AddRule(BusEndpoint& endpoint, const Rule& rule)
 QStatus RuleTable::RemoveRule(BusEndpoint& endpoint, Rule& rule)
 {
     Lock();
-
-    //std::pair<std::multimap<BusEndpoint, Rule>::const_iterator, RuleIterator> range = rules.equal_range(endpoint);
     std::pair<RuleIterator, RuleIterator> range = rules.equal_range(endpoint);
     while (range.first != range.second) {
         if (range.first->second == rule) {
+            UnindexRule(range.first);
             rules.erase(range.first);
             break;
         }
@@ -171,6 +296,9 @@ QStatus RuleTable::RemoveAllRules(BusEndpoint& endpoint)
 {
     Lock();
     std::pair<RuleIterator, RuleIterator> range = rules.equal_range(endpoint);
+    for (RuleIterator it = range.first; it != range.second; ++it) {
+        UnindexRule(it);
+    }
     if (range.first != rules.end()) {
         rules.erase(range.first, range.second);
     }
@@ -178,4 +306,87 @@ QStatus RuleTable::RemoveAllRules(BusEndpoint& endpoint)
     return ER_OK;
 }
 
+RuleTable::~RuleTable()
+{
+    for (RuleIterator it = rules.begin(); it != rules.end(); ++it) {
+        UnindexRule(it);
+    }
+}
+
+void RuleTable::IndexRule(RuleIterator it)
+{
+    /* The rule holds a reference to each of its names for as long as it is in the table */
+    Rule& rule = it->second;
+    rule.senderAtom = NameAtomTable::Intern(rule.sender);
+    rule.ifaceAtom = NameAtomTable::Intern(rule.iface);
+    rule.memberAtom = NameAtomTable::Intern(rule.member);
+    rule.destinationAtom = NameAtomTable::Intern(rule.destination);
+    index[IndexKey(rule.ifaceAtom, rule.memberAtom)].push_back(it);
+}
+
+void RuleTable::UnindexRule(RuleIterator it)
+{
+    Rule& rule = it->second;
+    RuleIndex::iterator bit = index.find(IndexKey(rule.ifaceAtom, rule.memberAtom));
+    if (bit != index.end()) {
+        std::vector<RuleIterator>& bucket = bit->second;
+        std::vector<RuleIterator>::iterator rit = std::find(bucket.begin(), bucket.end(), it);
+        if (rit != bucket.end()) {
+            bucket.erase(rit);
+        }
+        if (bucket.empty()) {
+            index.erase(bit);
+        }
+    }
+    NameAtomTable::Release(rule.sender);
+    NameAtomTable::Release(rule.iface);
+    NameAtomTable::Release(rule.member);
+    NameAtomTable::Release(rule.destination);
+    rule.senderAtom = rule.ifaceAtom = rule.memberAtom = rule.destinationAtom = NameAtomTable::NIL_ATOM;
+}
+
+void RuleTable::MatchBucket(const IndexKey& key, const Message& msg, const MessageNameAtoms& atoms, MatchArgs& msgArgs, std::vector<BusEndpoint>& endpoints)
+{
+    RuleIndex::iterator bit = index.find(key);
+    if (bit != index.end()) {
+        std::vector<RuleIterator>::iterator rit = bit->second.begin();
+        while (rit != bit->second.end()) {
+            if ((*rit)->second.IsMatch(msg, atoms, msgArgs)) {
+                endpoints.push_back((*rit)->first);
+            }
+            ++rit;
+        }
+    }
+}
+
+void RuleTable::FindMatchingEndpoints(const Message& msg, std::vector<BusEndpoint>& endpoints)
+{
+    /* The message's names were resolved when it was unmarshaled so rules are compared on atoms */
+    MessageNameAtoms atoms(msg);
+    MatchArgs msgArgs(msg);
+    const NameAtom nil = NameAtomTable::NIL_ATOM;
+    size_t first = endpoints.size();
+
+    /*
+     * Every rule lives in exactly one bucket so only the four buckets that can possibly
+     * match this message need to be examined: exact interface and member, interface only,
+     * member only and the rules that wildcard both. A name that has never been interned
+     * cannot be named by any rule so the buckets keyed on it will simply be empty.
+     */
+    if ((atoms.iface != nil) && (atoms.member != nil)) {
+        MatchBucket(IndexKey(atoms.iface, atoms.member), msg, atoms, msgArgs, endpoints);
+    }
+    if (atoms.iface != nil) {
+        MatchBucket(IndexKey(atoms.iface, nil), msg, atoms, msgArgs, endpoints);
+    }
+    if (atoms.member != nil) {
+        MatchBucket(IndexKey(nil, atoms.member), msg, atoms, msgArgs, endpoints);
+    }
+    MatchBucket(IndexKey(nil, nil), msg, atoms, msgArgs, endpoints);
+
+    /* An endpoint with several matching rules only gets one copy of the message */
+    std::sort(endpoints.begin() + first, endpoints.end());
+    endpoints.erase(std::unique(endpoints.begin() + first, endpoints.end()), endpoints.end());
+}
+
 }
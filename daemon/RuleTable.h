@@ -27,6 +27,7 @@
 #include <qcc/platform.h>
 
 #include <map>
+#include <vector>
 
 #include <qcc/String.h>
 #include <qcc/Mutex.h>
@@ -34,11 +35,56 @@
 #include <alljoyn/Message.h>
 
 #include "BusEndpoint.h"
+#include "NameAtoms.h"
 
 #include <alljoyn/Status.h>
 
 namespace ajn {
 
+/**
+ * MatchArgs provides the string arguments of a message for argument matching. The message
+ * body is examined (but never unmarshaled) the first time a rule with argument matches needs
+ * an argument. The arguments are only allocated then, so matching a message on header fields
+ * alone does not construct any MsgArgs.
+ */
+class MatchArgs {
+  public:
+
+    /** Maximum number of arguments that can be matched (arg0 through arg63) */
+    static const size_t MAX_ARGS = 64;
+
+    /**
+     * Constructor
+     *
+     * @param msg   Message whose arguments are to be matched.
+     */
+    MatchArgs(const Message& msg) : msg(msg), args(NULL) { }
+
+    /**
+     * Destructor
+     */
+    ~MatchArgs() { delete [] args; }
+
+    /**
+     * Get a string or object path argument.
+     *
+     * @param argN   Index of the argument.
+     * @return  The argument or NULL if argN is not a string or object path argument.
+     */
+    const MsgArg* GetArg(size_t argN);
+
+  private:
+
+    /** Copy constructor is disallowed */
+    MatchArgs(const MatchArgs& other);
+
+    /** Assignment operator is disallowed */
+    MatchArgs& operator=(const MatchArgs& other);
+
+    const Message& msg;         /**< The message */
+    MsgArg* args;               /**< MAX_ARGS arguments that reference the message body or NULL until examined */
+};
+
 /**
  * Rule defines a message bus routing rule.
  */
@@ -65,17 +111,57 @@ struct Rule {
     /** true iff Rule specifies a filter for sessionless signals */
     enum {SESSIONLESS_NOT_SPECIFIED, SESSIONLESS_FALSE, SESSIONLESS_TRUE} sessionless;
 
-    /** Map of argument matches */
-    // @@ TODO
+    /**
+     * Atoms for sender, iface, member and destination (NIL_ATOM if not specified). These are only
+     * set while the rule is in a RuleTable which holds a reference to each name. Object paths are
+     * matched as strings.
+     */
+    NameAtom senderAtom;
+    NameAtom ifaceAtom;
+    NameAtom memberAtom;
+    NameAtom destinationAtom;
+
+    /**
+     * An argument match compiled from an argN, argNpath or arg0namespace key.
+     */
+    struct ArgMatch {
+        /** Kind of argument match */
+        enum {ARG_STRING, ARG_PATH, ARG_NAMESPACE} kind;
+
+        /** Index of the argument to match */
+        uint8_t argN;
+
+        /** Value to match */
+        qcc::String value;
+
+        /** Equality comparison */
+        bool operator==(const ArgMatch& o) const {
+            return (kind == o.kind) && (argN == o.argN) && (value == o.value);
+        }
+
+        /**
+         * Return true if an argument satisfies this match.
+         *
+         * @param arg   The argument or NULL if the message has no string argument at argN.
+         * @return  true if the argument matches.
+         */
+        bool IsMatch(const MsgArg* arg) const;
+    };
+
+    /** Argument matches */
+    std::vector<ArgMatch> args;
 
     /** Equality comparison */
     bool operator==(const Rule& o) const {
         return (type == o.type) && (sender == o.sender) && (iface == o.iface) &&
-               (member == o.member) && (path == o.path) && (destination == o.destination);
+               (member == o.member) && (path == o.path) && (destination == o.destination) &&
+               (args == o.args);
     }
 
     /** Constructor */
-    Rule() : type(MESSAGE_INVALID) { }
+    Rule() : type(MESSAGE_INVALID), sessionless(SESSIONLESS_NOT_SPECIFIED),
+        senderAtom(NameAtomTable::NIL_ATOM), ifaceAtom(NameAtomTable::NIL_ATOM), memberAtom(NameAtomTable::NIL_ATOM),
+        destinationAtom(NameAtomTable::NIL_ATOM) { }
 
     /**
      * Construct a rule from a rule string.
@@ -84,6 +170,7 @@ struct Rule {
      *                  This format of this string is specified in the DBUS spec.
      *                  AllJoyn has added the following additional parameters:
      *                     sessionless  - Valid values are "true" and "false"
+     *                  The argN, argNpath and arg0namespace keys are supported for N in [0, 63].
      *
      * @param status    ER_OK if ruleStr was successfully parsed.
      */
@@ -97,6 +184,16 @@ struct Rule {
      */
     bool IsMatch(const Message& msg);
 
+    /**
+     * Return true if messages matches rule. Only valid for a rule held by a RuleTable.
+     *
+     * @param msg      Message to compare with rule.
+     * @param atoms    Atoms for the header fields of msg.
+     * @param msgArgs  Arguments of msg for argument matching.
+     * @return  true if this rule matches the message.
+     */
+    bool IsMatch(const Message& msg, const MessageNameAtoms& atoms, MatchArgs& msgArgs) const;
+
     /**
      * String representation of a rule
      */
@@ -115,6 +212,9 @@ typedef std::multimap<BusEndpoint, Rule>::iterator RuleIterator;
 class RuleTable {
   public:
 
+    /** Destructor */
+    ~RuleTable();
+
     /**
      * Add a rule for an endpoint.
      *
@@ -202,9 +302,47 @@ class RuleTable {
         return ret;
     }
 
+    /**
+     * Find the set of endpoints that have at least one rule matching a message.
+     * Only the rules indexed under the message's interface/member (and the
+     * wildcard buckets) are evaluated rather than the entire rule table.
+     * Caller should obtain lock before calling this method.
+     *
+     * @param msg        Message to match against the rules.
+     * @param endpoints  [OUT] Each matching endpoint is appended exactly once.
+     */
+    void FindMatchingEndpoints(const Message& msg, std::vector<BusEndpoint>& endpoints);
+
   private:
+
+    /**
+     * Index key for a rule made up of the interface and member atoms. NIL_ATOM is a wildcard.
+     */
+    typedef std::pair<NameAtom, NameAtom> IndexKey;
+
+    /**
+     * Rules bucketed by (interface, member).
+     */
+    typedef std::map<IndexKey, std::vector<RuleIterator> > RuleIndex;
+
+    /**
+     * Evaluate the rules in one index bucket against a message.
+     */
+    void MatchBucket(const IndexKey& key, const Message& msg, const MessageNameAtoms& atoms, MatchArgs& msgArgs, std::vector<BusEndpoint>& endpoints);
+
+    /**
+     * Intern the names of a rule that was added to the table and add it to the interface/member index.
+     */
+    void IndexRule(RuleIterator it);
+
+    /**
+     * Remove a rule from the interface/member index and release its names.
+     */
+    void UnindexRule(RuleIterator it);
+
     qcc::Mutex lock;                            /**< Lock protecting rule table */
     std::multimap<BusEndpoint, Rule> rules;    /**< Rule table */
+    RuleIndex index;                            /**< Secondary index on rules by interface and member */
 };
 
 }
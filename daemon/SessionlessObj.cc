@@ -26,6 +26,7 @@
 
 #include "SessionlessObj.h"
 #include "BusController.h"
+#include "DaemonConfig.h"
 
 #define QCC_MODULE "SESSIONLESS"
 
@@ -35,6 +36,9 @@ using namespace qcc;
 /** Constants */
 #define MAX_JOINSESSION_RETRIES 50
 
+/** Default memory limit for stored sessionless messages */
+#define SLS_MAX_STORED_BYTES_DEFAULT (4 * 1024 * 1024)
+
 /**
  * Inside window calculation.
  * Returns true if p is in range [beg, beg+sz)
@@ -84,6 +88,11 @@ SessionlessObj::SessionlessObj(Bus& bus, BusController* busController) :
     requestRangeSignal(NULL),
     timer("sessionless"),
     messageMap(),
+    storedBytes(0),
+    maxStoredBytes(DaemonConfig::Access()->Get("limit@sls_max_stored_bytes", SLS_MAX_STORED_BYTES_DEFAULT)),
+    expiredCount(0),
+    evictedCount(0),
+    expireAlarmTime(0),
     ruleCountMap(),
     changeIdMap(),
     lock(),
@@ -317,7 +326,7 @@ void SessionlessObj::RemoveRule(const qcc::String& epName, Rule& rule)
     }
 }
 
-QStatus SessionlessObj::PushMessage(Message& msg)
+QStatus SessionlessObj::PushMessage(Message& msg, size_t msgSize)
 {
     QCC_DbgTrace(("SessionlessObj::PushMessage(%s)", msg->ToString().c_str()));
 
@@ -330,13 +339,7 @@ QStatus SessionlessObj::PushMessage(Message& msg)
     MessageMapKey key(msg->GetSender(), msg->GetInterface(), msg->GetMemberName(), msg->GetObjectPath());
     lock.Lock();
     advanceChangeId = true;
-    pair<uint32_t, Message> val(curChangeId, msg);
-    map<MessageMapKey, pair<uint32_t, Message> >::iterator it = messageMap.find(key);
-    if (it == messageMap.end()) {
-        messageMap.insert(pair<MessageMapKey, pair<uint32_t, Message> >(key, val));
-    } else {
-        it->second = val;
-    }
+    StoreMessage(key, msg, msgSize);
     lock.Unlock();
     uint32_t zero = 0;
     SessionlessObj* slObj = this;
@@ -391,14 +394,14 @@ QStatus SessionlessObj::CancelMessage(const qcc::String& sender, uint32_t serial
     QCC_DbgTrace(("SessionlessObj::CancelMessage(%s, 0x%x)", sender.c_str(), serialNum));
 
     lock.Lock();
-    MessageMapKey key(sender.c_str(), "", "", "");
-    map<MessageMapKey, pair<uint32_t, Message> >::iterator it = messageMap.lower_bound(key);
-    while ((it != messageMap.end()) && (sender == it->second.second->GetSender())) {
-        if (it->second.second->GetCallSerial() == serialNum) {
-            if (!it->second.second->IsExpired()) {
+    MessageMapKey key(sender);
+    MessageMap::iterator it = messageMap.lower_bound(key);
+    while ((it != messageMap.end()) && (sender == it->first.sender)) {
+        if (it->second.msg->GetCallSerial() == serialNum) {
+            if (!it->second.msg->IsExpired()) {
                 status = ER_OK;
             }
-            messageMap.erase(it);
+            EraseMessage(it);
             messageErased = true;
             break;
         }
@@ -483,6 +486,61 @@ QStatus SessionlessObj::RereceiveMessages(const qcc::String& sender, const qcc::
     return status;
 }
 
+void SessionlessObj::StoreMessage(const MessageMapKey& key, Message& msg, size_t msgSize)
+{
+    uint32_t tilExpire;
+    uint64_t expires = 0;
+    if (!msg->IsExpired(&tilExpire) && (tilExpire != ::numeric_limits<uint32_t>::max())) {
+        expires = GetTimestamp64() + tilExpire;
+    }
+    MessageMap::iterator it = messageMap.find(key);
+    if (it != messageMap.end()) {
+        EraseMessage(it);
+    }
+    it = messageMap.insert(pair<MessageMapKey, StoredMessage>(key, StoredMessage(curChangeId, msg, expires, msgSize))).first;
+    changeIdIndex.insert(pair<uint32_t, MessageMapKey>(curChangeId, key));
+    if (expires) {
+        expireIndex.insert(pair<uint64_t, MessageMapKey>(expires, key));
+    }
+    storedBytes += it->second.size;
+
+    /*
+     * Evict the messages with the oldest change ids until we are under the memory limit. All
+     * stored change ids are at or behind curChangeId so ids numerically greater than curChangeId
+     * were stored before the change id wrapped around and are the oldest.
+     */
+    while ((storedBytes > maxStoredBytes) && (messageMap.size() > 1)) {
+        set<pair<uint32_t, MessageMapKey> >::iterator oldest = changeIdIndex.lower_bound(pair<uint32_t, MessageMapKey>(curChangeId + 1, MessageMapKey(String::Empty)));
+        if (oldest == changeIdIndex.end()) {
+            oldest = changeIdIndex.begin();
+        }
+        QCC_DbgPrintf(("Evicting sessionless signal from %s with change id %u", oldest->second.sender.c_str(), oldest->first));
+        EraseMessage(messageMap.find(oldest->second));
+        ++evictedCount;
+    }
+}
+
+void SessionlessObj::EraseMessage(MessageMap::iterator it)
+{
+    changeIdIndex.erase(pair<uint32_t, MessageMapKey>(it->second.changeId, it->first));
+    if (it->second.expires) {
+        expireIndex.erase(pair<uint64_t, MessageMapKey>(it->second.expires, it->first));
+    }
+    storedBytes -= it->second.size;
+    messageMap.erase(it);
+}
+
+void SessionlessObj::GetStats(Stats& stats)
+{
+    lock.Lock();
+    stats.messages = messageMap.size();
+    stats.bytes = storedBytes;
+    stats.maxBytes = maxStoredBytes;
+    stats.expired = expiredCount;
+    stats.evicted = evictedCount;
+    lock.Unlock();
+}
+
 void SessionlessObj::NameOwnerChanged(const String& name,
                                       const String* oldOwner,
                                       const String* newOwner)
@@ -498,10 +556,10 @@ void SessionlessObj::NameOwnerChanged(const String& name,
         }
 
         /* Remove stored sessionless messages sent by toldOwner */
-        MessageMapKey key(oldOwner->c_str(), "", "", "");
-        map<MessageMapKey, pair<uint32_t, Message> >::iterator mit = messageMap.lower_bound(key);
-        while ((mit != messageMap.end()) && (::strcmp(oldOwner->c_str(), mit->second.second->GetSender()) == 0)) {
-            messageMap.erase(mit++);
+        MessageMapKey key(*oldOwner);
+        MessageMap::iterator mit = messageMap.lower_bound(key);
+        while ((mit != messageMap.end()) && (*oldOwner == mit->first.sender)) {
+            EraseMessage(mit++);
         }
         /* Alert the advertiser worker if messageMap is empty */
         if (messageMap.empty()) {
@@ -702,39 +760,54 @@ void SessionlessObj::HandleRangeRequest(const char* sender, SessionId sessionId,
         advanceChangeId = false;
     }
 
-    /* Send all messages in messageMap in range [fromChangeId, toChangeId) */
-    map<MessageMapKey, pair<uint32_t, Message> >::iterator it = messageMap.begin();
+    /*
+     * Send all messages in messageMap in range [fromChangeId, toChangeId). The change id index is
+     * ordered numerically so a range that wraps around continues from the start of the index.
+     */
     uint32_t rangeLen = toChangeId - fromChangeId;
-    while (it != messageMap.end()) {
-        if (IN_WINDOW(uint32_t, fromChangeId, rangeLen, it->second.first)) {
-            MessageMapKey key = it->first;
-            if (it->second.second->IsExpired()) {
-                /* Remove expired message without sending */
-                messageMap.erase(it++);
-                messageErased = true;
-            } else {
-                /* Send message */
-                lock.Unlock();
-                router.LockNameTable();
-                BusEndpoint ep = router.FindEndpoint(sender);
-                if (ep->IsValid()) {
-                    router.UnlockNameTable();
-                    if (ep->GetEndpointType() == ENDPOINT_TYPE_VIRTUAL) {
-                        status = VirtualEndpoint::cast(ep)->PushMessage(it->second.second, sessionId);
-                    } else {
-                        status = ep->PushMessage(it->second.second);
-                    }
+    bool wrapped = false;
+    set<pair<uint32_t, MessageMapKey> >::iterator it = changeIdIndex.lower_bound(pair<uint32_t, MessageMapKey>(fromChangeId, MessageMapKey(String::Empty)));
+    while (true) {
+        if (it == changeIdIndex.end()) {
+            if (wrapped) {
+                break;
+            }
+            wrapped = true;
+            it = changeIdIndex.begin();
+            continue;
+        }
+        if ((wrapped && (it->first >= fromChangeId)) || !IN_WINDOW(uint32_t, fromChangeId, rangeLen, it->first)) {
+            break;
+        }
+        pair<uint32_t, MessageMapKey> indexKey = *it;
+        MessageMap::iterator mit = messageMap.find(indexKey.second);
+        if (mit->second.msg->IsExpired()) {
+            /* Remove expired message without sending */
+            ++it;
+            EraseMessage(mit);
+            ++expiredCount;
+            messageErased = true;
+        } else {
+            /* Send message */
+            Message msg = mit->second.msg;
+            lock.Unlock();
+            router.LockNameTable();
+            BusEndpoint ep = router.FindEndpoint(sender);
+            if (ep->IsValid()) {
+                router.UnlockNameTable();
+                if (ep->GetEndpointType() == ENDPOINT_TYPE_VIRTUAL) {
+                    status = VirtualEndpoint::cast(ep)->PushMessage(msg, sessionId);
                 } else {
-                    router.UnlockNameTable();
+                    status = ep->PushMessage(msg);
                 }
-                lock.Lock();
-                it = messageMap.upper_bound(key);
-            }
-            if (status != ER_OK) {
-                QCC_LogError(status, ("Failed to push sessionless signal to %s", sender));
+            } else {
+                router.UnlockNameTable();
             }
-        } else {
-            ++it;
+            lock.Lock();
+            it = changeIdIndex.upper_bound(indexKey);
+        }
+        if (status != ER_OK) {
+            QCC_LogError(status, ("Failed to push sessionless signal to %s", sender));
         }
     }
     lock.Unlock();
@@ -764,22 +837,31 @@ void SessionlessObj::AlarmTriggered(const Alarm& alarm, QStatus reason)
 
     if (reason == ER_OK) {
         uint32_t tilExpire = ::numeric_limits<uint32_t>::max();
-        uint32_t expire;
         uint32_t maxChangeId = 0;
         bool mapIsEmpty = true;
 
         /* Purge the messageMap of expired messages */
         lock.Lock();
-        map<MessageMapKey, pair<uint32_t, Message> >::iterator it = messageMap.begin();
-        while (it != messageMap.end()) {
-            if (it->second.second->IsExpired(&expire)) {
-                messageMap.erase(it++);
-            } else {
-                maxChangeId = max(maxChangeId, it->second.first);
-                mapIsEmpty = false;
-                ++it;
+        uint64_t now = GetTimestamp64();
+        while (!expireIndex.empty() && (expireIndex.begin()->first <= now)) {
+            EraseMessage(messageMap.find(expireIndex.begin()->second));
+            ++expiredCount;
+        }
+        if (!expireIndex.empty()) {
+            /* Come back when the next message expires unless an earlier alarm is already pending */
+            uint64_t nextExpire = expireIndex.begin()->first;
+            if ((expireAlarmTime <= now) || (nextExpire < expireAlarmTime)) {
+                uint32_t delay = static_cast<uint32_t>(min(nextExpire - now, static_cast<uint64_t>(::numeric_limits<uint32_t>::max() - 1)));
+                SessionlessObj* slObj = this;
+                if (timer.AddAlarm(Alarm(delay, slObj)) == ER_OK) {
+                    expireAlarmTime = nextExpire;
+                }
             }
         }
+        if (!changeIdIndex.empty()) {
+            maxChangeId = changeIdIndex.rbegin()->first;
+            mapIsEmpty = false;
+        }
         lock.Unlock();
 
         /* Change advertisment if map is empty or if maxChangeId > lastAdvChangeId */
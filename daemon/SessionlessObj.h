@@ -112,9 +112,10 @@ class SessionlessObj : public BusObject, public NameListener, public SessionList
     /**
      * Push a sessionless signal.
      *
-     * @param msg    Message to be pushed.
+     * @param msg      Message to be pushed.
+     * @param msgSize  Memory used by the message buffer, counted against the store limit.
      */
-    QStatus PushMessage(Message& msg);
+    QStatus PushMessage(Message& msg, size_t msgSize);
 
     /**
      * Route an incoming sessionless signal if possible.
@@ -211,6 +212,24 @@ class SessionlessObj : public BusObject, public NameListener, public SessionList
      */
     QStatus RereceiveMessages(const qcc::String& sender, const qcc::String& guid);
 
+    /**
+     * Statistics for the sessionless message store
+     */
+    struct Stats {
+        size_t messages;      /**< Number of stored messages */
+        size_t bytes;         /**< Memory used by the stored messages */
+        size_t maxBytes;      /**< Memory limit for the stored messages */
+        uint32_t expired;     /**< Number of messages removed because their TTL expired */
+        uint32_t evicted;     /**< Number of messages removed to stay under the memory limit */
+    };
+
+    /**
+     * Get statistics for the sessionless message store.
+     *
+     * @param stats  Returns the statistics.
+     */
+    void GetStats(Stats& stats);
+
   private:
     /**
      * SessionlessObj worker.
@@ -261,23 +280,78 @@ class SessionlessObj : public BusObject, public NameListener, public SessionList
 
     qcc::Timer timer;                     /**< Timer object for reaping expired names */
 
-    /* Class used as key for messageMap */
-    class MessageMapKey : public qcc::String {
+    /*
+     * Class used as key for messageMap. Keys are ordered by sender first so all of the messages
+     * from a sender are adjacent. The names come from remote peers without bound so they are
+     * kept as strings rather than interned. Fields are compared one at a time instead of being
+     * concatenated into a single string.
+     */
+    class MessageMapKey {
       public:
-        MessageMapKey(const char* sender, const char* iface, const char* member, const char* objPath) :
-            qcc::String(sender, 0, ::strlen(sender) + ::strlen(iface) + ::strlen(member) + ::strlen(objPath) + 4)
-        {
-            append(':');
-            append(iface);
-            append(':');
-            append(member);
-            append(':');
-            append(objPath);
+        MessageMapKey(const qcc::String& sender, const qcc::String& iface, const qcc::String& member, const qcc::String& objPath) :
+            sender(sender), iface(iface), member(member), objPath(objPath) { }
+
+        /** Key that sorts before every other key from the same sender */
+        MessageMapKey(const qcc::String& sender) :
+            sender(sender), iface(), member(), objPath() { }
+
+        bool operator<(const MessageMapKey& other) const {
+            int cmp = sender.compare(other.sender);
+            if (cmp == 0) {
+                cmp = iface.compare(other.iface);
+            }
+            if (cmp == 0) {
+                cmp = member.compare(other.member);
+            }
+            if (cmp == 0) {
+                cmp = objPath.compare(other.objPath);
+            }
+            return cmp < 0;
         }
+
+        qcc::String sender;
+        qcc::String iface;
+        qcc::String member;
+        qcc::String objPath;
     };
 
+    /** A stored sessionless message */
+    struct StoredMessage {
+        StoredMessage(uint32_t changeId, const Message& msg, uint64_t expires, size_t size) :
+            changeId(changeId), msg(msg), expires(expires), size(size) { }
+        uint32_t changeId;    /**< Change id the message was stored with */
+        Message msg;          /**< The message */
+        uint64_t expires;     /**< Time when the message expires or 0 if it doesn't expire */
+        size_t size;          /**< Memory used by the message */
+    };
+
+    typedef std::map<MessageMapKey, StoredMessage> MessageMap;
+
+    /**
+     * Store a message, replacing any message with the same key, and evict the oldest messages
+     * if the store is over its memory limit. Must be called with lock held.
+     */
+    void StoreMessage(const MessageMapKey& key, Message& msg, size_t msgSize);
+
+    /**
+     * Remove a message from the store and its indexes. Must be called with lock held.
+     */
+    void EraseMessage(MessageMap::iterator it);
+
     /** Storage for sessionless messages waiting to be delivered */
-    std::map<MessageMapKey, std::pair<uint32_t, Message> > messageMap;
+    MessageMap messageMap;
+
+    /** Index of messageMap ordered by change id for range requests and eviction */
+    std::set<std::pair<uint32_t, MessageMapKey> > changeIdIndex;
+
+    /** Index of messageMap ordered by expiry time for messages that have a TTL */
+    std::set<std::pair<uint64_t, MessageMapKey> > expireIndex;
+
+    size_t storedBytes;         /**< Memory used by the messages in messageMap */
+    size_t maxStoredBytes;      /**< Memory limit for the messages in messageMap */
+    uint32_t expiredCount;      /**< Number of messages that expired */
+    uint32_t evictedCount;      /**< Number of messages evicted to stay under maxStoredBytes */
+    uint64_t expireAlarmTime;   /**< Time of the pending alarm for expiring messages */
 
     /** Count the number of rules (per endpoint) that specify sesionless=TRUE */
     std::map<qcc::String, uint32_t> ruleCountMap;
@@ -20,6 +20,9 @@
  ******************************************************************************/
 
 #include <qcc/platform.h>
+
+#include <algorithm>
+
 #include <qcc/IPAddress.h>
 #include <qcc/Socket.h>
 #include <qcc/SocketStream.h>
@@ -40,6 +43,10 @@
 #include "ns/IpNameService.h"
 #include "TCPTransport.h"
 
+#if defined(QCC_OS_GROUP_POSIX)
+#include "ScatterGatherList.h"
+#endif
+
 /*
  * How the transport fits into the system
  * ======================================
@@ -282,26 +289,27 @@
  * that an endpoint is not brought up immediately, but an authentication step
  * must be performed.  The server accept loop starts this process by placing the
  * new TCPEndpoint on an authList, or list of authenticating endpoints.
- * It then calls the endpoint Authenticate() method which spins up an
- * authentication thread and returns immediately.  This process transfers the
- * responsibility for the connection and its resources to the authentication
- * thread.  Authentication can succeed, fail, or take to long and be aborted.
- *
- * If authentication succeeds, the authentication thread calls back into the
+ * It then calls the endpoint Authenticate() method which hands the endpoint
+ * to one of a fixed number of auth pumps and returns immediately.  This process
+ * transfers the responsibility for the connection and its resources to the auth
+ * pump.  An auth pump is a thread that waits for data on the sockets of all of
+ * the connections it has been given and advances the authentication handshake
+ * of each one as far as the data received allows, so a burst of incoming
+ * connections does not need a thread per connection.  Authentication can
+ * succeed, fail, or take to long and be aborted.
+ *
+ * If authentication succeeds, the auth pump calls back into the
  * TCPTransport's Authenticated() method.  Along with indicating that
  * authentication has completed successfully, this transfers ownership of the
- * TCPEndpoint back to the TCPTransport from the authentication
- * thread.  At this time, the TCPEndpoint is Start()ed which spins up
- * the transmit and receive threads and enables Message routing across the
- * transport.
+ * TCPEndpoint back to the TCPTransport from the auth pump.  At this time, the
+ * TCPEndpoint is Start()ed which enables Message routing across the transport.
  *
- * If the authentication fails, the authentication thread simply sets a the
- * TCPEndpoint state to FAILED and exits.  The server accept loop looks at
- * authenticating endpoints (those on the authList)each time through its loop.
- * If an endpoint has failed authentication, and its thread has actually gone
- * away (or more precisely is at least going away in such a way that it will
- * never touch the endpoint data structure again).  This means that the endpoint
- * can be deleted.
+ * If the authentication fails, the auth pump simply sets the TCPEndpoint
+ * state to FAILED and lets go of the endpoint.  The server accept loop looks
+ * at authenticating endpoints (those on the authList) each time through its
+ * loop.  If an endpoint has failed authentication the auth pump will never
+ * touch the endpoint data structure again.  This means that the endpoint can
+ * be deleted.
  *
  * If the authentication takes "too long" we assume that a denial of service
  * attack in in progress.  We call AuthStop() on such an endpoint which will most
@@ -408,22 +416,21 @@ const char* const TCPTransport::ALLJOYN_DEFAULT_ROUTER_ADVERTISEMENT_PREFIX = "o
 class _TCPEndpoint : public _RemoteEndpoint {
   public:
     /**
-     * There are three threads that can be running around in this data
-     * structure.  An auth thread is run before the endpoint is started in order
-     * to handle the security stuff that must be taken care of before messages
-     * can start passing.  This enum reflects the states of the authentication
-     * process and the state can be found in m_authState.  Once authentication
-     * is complete, the auth thread must go away, but it must also be joined,
-     * which is indicated by the AUTH_DONE state.  The other threads are the
-     * endpoint RX and TX threads, which are dealt with by the EndpointState.
+     * Before the endpoint is started, one of the transport auth pumps drives
+     * the handshake that handles the security stuff that must be taken care
+     * of before messages can start passing.  This enum reflects the states of
+     * the authentication process and the state can be found in m_authState.
+     * Once authentication is complete, the auth pump lets go of the endpoint,
+     * and the server accept loop acknowledges this with the AUTH_DONE state.
+     * The endpoint RX and TX processing is dealt with by the EndpointState.
      */
     enum AuthState {
         AUTH_ILLEGAL = 0,
-        AUTH_INITIALIZED,    /**< This endpoint structure has been allocated but no auth thread has been run */
-        AUTH_AUTHENTICATING, /**< We have spun up an authentication thread and it has begun running our user function */
-        AUTH_FAILED,         /**< The authentication has failed and the authentication thread is exiting immidiately */
+        AUTH_INITIALIZED,    /**< This endpoint structure has been allocated but authentication has not started */
+        AUTH_AUTHENTICATING, /**< The endpoint has been handed to an auth pump which is driving the handshake */
+        AUTH_FAILED,         /**< The authentication has failed and the auth pump has let go of the endpoint */
         AUTH_SUCCEEDED,      /**< The auth process (Establish) has succeeded and the connection is ready to be started */
-        AUTH_DONE,           /**< The auth thread has been successfully shut down and joined */
+        AUTH_DONE,           /**< The server accept loop has seen the authentication succeed */
     };
 
     /**
@@ -472,7 +479,10 @@ class _TCPEndpoint : public _RemoteEndpoint {
         m_authState(AUTH_INITIALIZED),
         m_epState(EP_INITIALIZED),
         m_tStart(qcc::Timespec(0)),
-        m_authThread(this),
+        m_authPump(NULL),
+        m_authAbort(false),
+        m_authUsesListener(false),
+        m_gotNul(false),
         m_stream(sock),
         m_ipAddr(ipAddr),
         m_port(port),
@@ -487,9 +497,14 @@ class _TCPEndpoint : public _RemoteEndpoint {
 
     void SetStartTime(qcc::Timespec tStart) { m_tStart = tStart; }
     qcc::Timespec GetStartTime(void) { return m_tStart; }
-    QStatus Authenticate(void);
+    QStatus Authenticate(TCPTransport::AuthPump* pump);
+    QStatus AuthAdvance(void);
+    void AuthComplete(QStatus status);
     void AuthStop(void);
-    void AuthJoin(void);
+    void AuthResume(void);
+    bool IsAuthStopping(void) { return m_authAbort; }
+    bool AuthUsesListener(void) { return m_authUsesListener; }
+    qcc::Event& GetAuthEvent(void) { return m_stream.GetSourceEvent(); }
     const qcc::IPAddress& GetIPAddress() { return m_ipAddr; }
     uint16_t GetPort() { return m_port; }
 
@@ -570,231 +585,330 @@ class _TCPEndpoint : public _RemoteEndpoint {
         return status;
     }
 
+  protected:
+#if defined(QCC_OS_GROUP_POSIX)
     /*
-     * Return true if the auth thread is STARTED, RUNNING or STOPPING.  A true
-     * response means the authentication thread is in a state that indicates
-     * a possibility it might touch the endpoint data structure.  This means
-     * don't delete the endpoint if this method returns true.  This method
-     * indicates nothing about endpoint rx and tx thread state.
+     * Send all the buffers with a single sendmsg call.
      */
-    bool IsAuthThreadRunning(void)
+    QStatus PushBytesVectored(const TxBuffer* bufs, size_t numBufs, size_t& pushed)
     {
-        return m_authThread.IsRunning();
+        qcc::ScatterGatherList sg;
+        for (size_t i = 0; i < numBufs; ++i) {
+            sg.AddBuffer(bufs[i].buf, bufs[i].len);
+        }
+        sg.SetDataSize(sg.MaxDataSize());
+        QStatus status = qcc::SendSG(m_stream.GetSocketFd(), sg, pushed);
+        return (status == ER_WOULDBLOCK) ? ER_TIMEOUT : status;
     }
+#endif
 
   private:
-    class AuthThread : public qcc::Thread {
-      public:
-        AuthThread(_TCPEndpoint* ep) : Thread("auth"), m_endpoint(ep)  { }
-      private:
-        virtual qcc::ThreadReturn STDCALL Run(void* arg);
-
-        _TCPEndpoint* m_endpoint;
-    };
-
     TCPTransport* m_transport;        /**< The server holding the connection */
     volatile SideState m_sideState;   /**< Is this an active or passive connection */
     volatile AuthState m_authState;   /**< The state of the endpoint authentication process */
     volatile EndpointState m_epState; /**< The state of the endpoint authentication process */
     qcc::Timespec m_tStart;           /**< Timestamp indicating when the authentication process started */
-    AuthThread m_authThread;          /**< Thread used to do blocking calls during startup */
+    TCPTransport::AuthPump* m_authPump; /**< Auth pump driving the authentication of an incoming connection */
+    volatile bool m_authAbort;        /**< Set by AuthStop() to make the auth pump fail the authentication */
+    bool m_authUsesListener;          /**< True if the handshake may call the auth listener */
+    bool m_gotNul;                    /**< True once the initial NUL byte has been read */
     qcc::SocketStream m_stream;       /**< Stream used by authentication code */
     qcc::IPAddress m_ipAddr;          /**< Remote IP address. */
     uint16_t m_port;                  /**< Remote port. */
     bool m_wasSuddenDisconnect;       /**< If true, assumption is that any disconnect is unexpected due to lower level error */
 };
 
-QStatus _TCPEndpoint::Authenticate(void)
-{
-    QCC_DbgTrace(("TCPEndpoint::Authenticate()"));
+/*
+ * An auth pump drives the authentication handshakes of incoming connections.
+ * Each handshake is a state machine that is advanced whenever data arrives on
+ * its socket, so a pump can have any number of handshakes in flight and a
+ * connection storm costs sockets rather than threads.
+ */
+class TCPTransport::AuthPump : public qcc::Thread {
+  public:
+    AuthPump(TCPTransport* transport, uint32_t index) :
+        Thread(qcc::String("auth-") + U32ToString(index)), m_transport(transport), m_exited(false) { }
+
     /*
-     * Start the authentication thread.
+     * Give the pump a connection to authenticate.  If the pump has already
+     * exited the authentication is failed here since no one else will.
      */
-    QStatus status = m_authThread.Start(this);
-    if (status != ER_OK) {
-        m_authState = AUTH_FAILED;
+    void Add(TCPEndpoint& conn)
+    {
+        m_lock.Lock(MUTEX_CONTEXT);
+        if (m_exited) {
+            m_lock.Unlock(MUTEX_CONTEXT);
+            conn->AuthComplete(ER_BUS_STOPPING);
+            return;
+        }
+        m_added.push_back(conn);
+        m_lock.Unlock(MUTEX_CONTEXT);
+        m_wakeEvent.SetEvent();
     }
-    return status;
-}
-
-void _TCPEndpoint::AuthStop(void)
-{
-    QCC_DbgTrace(("TCPEndpoint::AuthStop()"));
 
     /*
-     * Ask the auth thread to stop executing.  The only ways out of the thread
-     * run function will set the state to either AUTH_SUCCEEDED or AUTH_FAILED.
-     * There is a very small chance that we will send a stop to the thread after
-     * it has successfully authenticated, but we expect that this will result in
-     * an AUTH_FAILED state for the vast majority of cases.  In this case, we
-     * notice that the thread failed the next time through the main server run
-     * loop, join the thread via AuthJoin below and delete the endpoint.  Note
-     * that this is a lazy cleanup of the endpoint.
+     * Make the pump look at its connections again, for example because one of
+     * them has been asked to stop authenticating.
      */
-    m_authThread.Stop();
-}
+    void Wake(void) { m_wakeEvent.SetEvent(); }
 
-void _TCPEndpoint::AuthJoin(void)
-{
-    QCC_DbgTrace(("TCPEndpoint::AuthJoin()"));
+  private:
+    virtual qcc::ThreadReturn STDCALL Run(void* arg);
 
-    /*
-     * Join the auth thread to stop executing.  All threads must be joined in
-     * order to communicate their return status.  The auth thread is no exception.
-     * This is done in a lazy fashion from the main server accept loop, where we
-     * cleanup every time through the loop.
-     */
-    m_authThread.Join();
-}
+    TCPTransport* m_transport;        /**< The transport that owns the pump */
+    qcc::Mutex m_lock;                /**< Mutex that protects m_added and m_exited */
+    std::list<TCPEndpoint> m_added;   /**< Connections given to the pump but not yet picked up by Run() */
+    bool m_exited;                    /**< True once Run() has stopped taking connections */
+    qcc::Event m_wakeEvent;           /**< Set when m_added changes or a connection is stopped */
+};
 
-void* _TCPEndpoint::AuthThread::Run(void* arg)
+void* TCPTransport::AuthPump::Run(void* arg)
 {
-    QCC_DbgTrace(("TCPEndpoint::AuthThread::Run()"));
-
-    m_endpoint->m_authState = AUTH_AUTHENTICATING;
+    QCC_DbgTrace(("TCPTransport::AuthPump::Run()"));
 
     /*
-     * We're running an authentication process here and we are cooperating with
-     * the main server thread.  This thread is running in an object that is
-     * allocated on the heap, and the server is managing these objects so we
-     * need to coordinate getting all of this cleaned up.
-     *
-     * There is a state variable that only we write.  The server thread only
-     * reads this variable, so there are no data sharing issues.  If there is an
-     * authentication failure, this thread sets that state variable to
-     * AUTH_FAILED and then exits.  The server holds a list of currently
-     * authenticating connections and will look for AUTH_FAILED connections when
-     * it runs its Accept loop.  If it finds one, it will AuthJoin() this
-     * thread.  Since we set AUTH_FAILED immediately before exiting, there will
-     * be no problem having the server block waiting for the Join() to complete.
-     * We fail authentication here and let the server clean up after us, lazily.
-     *
-     * If we succeed in the authentication process, we set the state variable
-     * to AUTH_SUCEEDED and then call back into the server telling it that we are
-     * up and running.  It needs to take us off of the list of authenticating
-     * connections and put us on the list of running connections.  This thread
-     * will quickly go away and will be replaced by the RX and TX threads of
-     * the running RemoteEndpoint.
-     *
-     * If we are running an authentication process, we are probably ultimately
-     * blocked on a socket.  We expect that if the server is asked to shut
-     * down, it will run through its list of authenticating connections and
-     * AuthStop() each one.  That will cause a thread Stop() which should unblock
-     * all of the reads and return an error which will eventually pop out here
-     * with an authentication failure.
-     *
-     * Finally, if the server decides we've spent too much time here and we are
-     * actually a denial of service attack, it can close us down by doing an
-     * AuthStop() on the authenticating endpoint.  This will do a thread Stop()
-     * on the auth thread of the endpoint which will pop out of here as an
-     * authentication failure as well.  The only ways out of this method must be
-     * with state = AUTH_FAILED or state = AUTH_SUCCEEDED.
+     * The connections on this list are only touched by this thread until
+     * their authentication completes.  A connection is taken off the list
+     * before AuthComplete() hands it back to the server accept loop.
      */
-    uint8_t byte;
-    size_t nbytes;
+    std::list<TCPEndpoint> conns;
 
-    /*
-     * Eat the first byte of the stream.  This is required to be zero by the
-     * DBus protocol.  It is used in the Unix socket implementation to carry
-     * out-of-band capabilities, but is discarded here.  We do this here since
-     * it involves a read that can block.
-     */
-    QStatus status = m_endpoint->m_stream.PullBytes(&byte, 1, nbytes);
-    if ((status != ER_OK) || (nbytes != 1) || (byte != 0)) {
-        QCC_LogError(status, ("Failed to read first byte from stream"));
+    while (!IsStopping()) {
+        m_lock.Lock(MUTEX_CONTEXT);
+        m_wakeEvent.ResetEvent();
+        conns.splice(conns.end(), m_added);
+        m_lock.Unlock(MUTEX_CONTEXT);
+
+        vector<Event*> checkEvents, signaledEvents;
+        checkEvents.push_back(&stopEvent);
+        checkEvents.push_back(&m_wakeEvent);
+        for (std::list<TCPEndpoint>::iterator i = conns.begin(); i != conns.end(); ++i) {
+            checkEvents.push_back(&(*i)->GetAuthEvent());
+        }
+
+        QStatus status = Event::Wait(checkEvents, signaledEvents);
+        if (ER_OK != status) {
+            QCC_LogError(status, ("TCPTransport::AuthPump::Run(): Event::Wait failed"));
+            break;
+        }
+        sort(signaledEvents.begin(), signaledEvents.end());
+        if (binary_search(signaledEvents.begin(), signaledEvents.end(), &stopEvent)) {
+            stopEvent.ResetEvent();
+        }
 
         /*
-         * Management of the resources used by the authentication thread is done
-         * in one place, by the server Accept loop.  The authentication thread
-         * writes its state into the connection and the server Accept loop reads
-         * this state.  As soon as we set this state to AUTH_FAILED, we are
-         * telling the Accept loop that we are done with the conn data
-         * structure.  That thread is then free to do anything it wants with the
-         * connection, including deleting it, so we are not allowed to touch
-         * conn after setting this state.
-         *
-         * In addition to releasing responsibility for the conn data structure,
-         * when we set the state to AUTH_SUCCEEDED we are telling the server
-         * accept loop that we are exiting now and so it can Join() on us (the
-         * authentication thread) without being worried about blocking since the
-         * next thing we do is exit.
+         * Advance every handshake that has data to read or has been asked to
+         * stop.  A handshake stays on the list for as long as it is waiting
+         * for the other side.
          */
-        m_endpoint->m_authState = AUTH_FAILED;
-        return (void*)ER_FAIL;
+        std::list<TCPEndpoint>::iterator i = conns.begin();
+        while (i != conns.end()) {
+            TCPEndpoint conn = *i;
+            if (!conn->IsAuthStopping() && !binary_search(signaledEvents.begin(), signaledEvents.end(), &conn->GetAuthEvent())) {
+                ++i;
+                continue;
+            }
+            /*
+             * A handshake that may call the auth listener is advanced on the
+             * auth listener dispatcher, which gives the connection back to
+             * us when it needs more data.
+             */
+            if (conn->AuthUsesListener() && !conn->IsAuthStopping()) {
+                i = conns.erase(i);
+                status = m_transport->DispatchAuthStep(conn);
+                if (status != ER_OK) {
+                    conn->AuthComplete(status);
+                }
+                continue;
+            }
+            status = conn->AuthAdvance();
+            if (status == ER_WOULDBLOCK) {
+                ++i;
+                continue;
+            }
+            i = conns.erase(i);
+            conn->AuthComplete(status);
+        }
+    }
+
+    /*
+     * The transport is stopping so fail any authentications that are still
+     * in progress.  The server accept loop cleans up the connections.
+     */
+    m_lock.Lock(MUTEX_CONTEXT);
+    m_exited = true;
+    conns.splice(conns.end(), m_added);
+    m_lock.Unlock(MUTEX_CONTEXT);
+    while (!conns.empty()) {
+        TCPEndpoint conn = conns.front();
+        conns.pop_front();
+        conn->AuthComplete(ER_BUS_STOPPING);
     }
 
+    QCC_DbgTrace(("TCPTransport::AuthPump::Run(): Exiting"));
+    return 0;
+}
+
+QStatus _TCPEndpoint::Authenticate(TCPTransport::AuthPump* pump)
+{
+    QCC_DbgTrace(("TCPEndpoint::Authenticate()"));
+
+    m_authState = AUTH_AUTHENTICATING;
+
     /* Initialized the features for this endpoint */
-    m_endpoint->GetFeatures().isBusToBus = false;
-    m_endpoint->GetFeatures().isBusToBus = false;
-    m_endpoint->GetFeatures().handlePassing = false;
+    GetFeatures().isBusToBus = false;
+    GetFeatures().handlePassing = false;
 
-    /* Run the actual connection authentication code. */
-    qcc::String authName;
-    qcc::String redirection;
-    DaemonRouter& router = reinterpret_cast<DaemonRouter&>(m_endpoint->m_transport->m_bus.GetInternal().GetRouter());
+    DaemonRouter& router = reinterpret_cast<DaemonRouter&>(m_transport->m_bus.GetInternal().GetRouter());
     AuthListener* authListener = router.GetBusController()->GetAuthListener();
     /* Since the TCPTransport allows untrusted clients, it must implement UntrustedClientStart and
      * UntrustedClientExit.
      * As a part of Establish, the endpoint can call the Transport's UntrustedClientStart method if
-     * it is an untrusted client, so the transport MUST call m_endpoint->SetListener before calling Establish
+     * it is an untrusted client, so the transport MUST call SetListener before starting Establish
      * Note: This is only required on the accepting end i.e. for incoming endpoints.
      */
-    m_endpoint->SetListener(m_endpoint->m_transport);
+    SetListener(m_transport);
+    QStatus status;
     if (authListener) {
-        status = m_endpoint->Establish("ALLJOYN_PIN_KEYX ANONYMOUS", authName, redirection, authListener);
+        m_authUsesListener = true;
+        status = StartEstablish("ALLJOYN_PIN_KEYX ANONYMOUS", authListener);
     } else {
-        status = m_endpoint->Establish("ANONYMOUS", authName, redirection, authListener);
+        status = StartEstablish("ANONYMOUS", authListener);
     }
     if (status != ER_OK) {
-        QCC_LogError(status, ("Failed to establish TCP endpoint"));
+        m_authState = AUTH_FAILED;
+        return status;
+    }
 
-        /*
-         * Management of the resources used by the authentication thread is done
-         * in one place, by the server Accept loop.  The authentication thread
-         * writes its state into the connection and the server Accept loop reads
-         * this state.  As soon as we set this state to AUTH_FAILED, we are
-         * telling the Accept loop that we are done with the conn data
-         * structure.  That thread is then free to do anything it wants with the
-         * connection, including deleting it, so we are not allowed to touch
-         * conn after setting this state.
-         *
-         * In addition to releasing responsibility for the conn data structure,
-         * when we set the state to AUTH_SUCCEEDED we are telling the server
-         * accept loop that we are exiting now and so it can Join() on us (the
-         * authentication thread) without being worried about blocking since the
-         * next thing we do is exit.
-         */
-        m_endpoint->m_authState = AUTH_FAILED;
-        return (void*)status;
+    /*
+     * From here on the auth pump is responsible for the handshake.  It will
+     * set the state to AUTH_SUCCEEDED or AUTH_FAILED when it is done.
+     */
+    m_authPump = pump;
+    TCPEndpoint tcpEp = TCPEndpoint::wrap(this);
+    pump->Add(tcpEp);
+    return ER_OK;
+}
+
+QStatus _TCPEndpoint::AuthAdvance(void)
+{
+    if (m_authAbort) {
+        return ER_BUS_STOPPING;
+    }
+
+    /*
+     * Eat the first byte of the stream.  This is required to be zero by the
+     * DBus protocol.  It is used in the Unix socket implementation to carry
+     * out-of-band capabilities, but is discarded here.
+     */
+    if (!m_gotNul) {
+        uint8_t byte;
+        size_t nbytes;
+        QStatus status = m_stream.PullBytes(&byte, 1, nbytes, 0);
+        if (status == ER_TIMEOUT) {
+            return ER_WOULDBLOCK;
+        }
+        if ((status != ER_OK) || (nbytes != 1) || (byte != 0)) {
+            QCC_LogError(status, ("Failed to read first byte from stream"));
+            return (status == ER_OK) ? ER_FAIL : status;
+        }
+        m_gotNul = true;
+    }
+
+    /* Run as much of the actual connection authentication code as the data received allows. */
+    qcc::String authName;
+    qcc::String redirection;
+    return ContinueEstablish(authName, redirection);
+}
+
+void _TCPEndpoint::AuthComplete(QStatus status)
+{
+    QCC_DbgTrace(("TCPEndpoint::AuthComplete(%s)", QCC_StatusText(status)));
+
+    /*
+     * Management of the resources used by the authentication is done in one
+     * place, by the server Accept loop.  The auth pump writes the final state
+     * into the connection and the server Accept loop reads this state.  As
+     * soon as we set this state to AUTH_FAILED or AUTH_SUCCEEDED, we are
+     * telling the Accept loop that we are done with the conn data structure.
+     * That thread is then free to do anything it wants with the connection,
+     * including deleting it, so we are not allowed to touch conn after
+     * setting this state.
+     */
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Failed to establish TCP endpoint"));
+        AbortEstablish();
+        m_authState = AUTH_FAILED;
+        return;
     }
 
     /*
      * Tell the transport that the authentication has succeeded and that it can
      * now bring the connection up.
      */
-    TCPEndpoint tcpEp = TCPEndpoint::wrap(m_endpoint);
-    m_endpoint->m_transport->Authenticated(tcpEp);
+    TCPEndpoint tcpEp = TCPEndpoint::wrap(this);
+    m_transport->Authenticated(tcpEp);
+
+    m_authState = AUTH_SUCCEEDED;
+}
 
-    QCC_DbgTrace(("TCPEndpoint::AuthThread::Run(): Returning"));
+void _TCPEndpoint::AuthStop(void)
+{
+    QCC_DbgTrace(("TCPEndpoint::AuthStop()"));
 
     /*
-     * We are now done with the authentication process.  We have succeeded doing
-     * the authentication and we may or may not have succeeded in starting the
-     * endpoint TX and RX threads depending on what happened down in
-     * Authenticated().  What concerns us here is that we are done with this
-     * thread (the authentication thread) and we are about to exit.  Before
-     * exiting, we must tell server accept loop that we are done with this data
-     * structure.  As soon as we set this state to AUTH_SUCCEEDED that thread is
-     * then free to do anything it wants with the connection, including deleting
-     * it, so we are not allowed to touch conn after setting this state.
-     *
-     * In addition to releasing responsibility for the conn data structure, when
-     * we set the state to AUTH_SUCCEEDED we are telling the server accept loop
-     * that we are exiting now and so it can Join() the authentication thread
-     * without being worried about blocking since the next thing we do is exit.
+     * Ask the auth pump to stop the handshake.  The pump will fail the
+     * authentication the next time it looks at the connection, unless it
+     * happens to complete the handshake first, which is highly unlikely but
+     * okay.  We notice that the authentication failed the next time through
+     * the main server run loop and delete the endpoint.  Note that this is a
+     * lazy cleanup of the endpoint.
+     */
+    m_authAbort = true;
+    if (m_authPump) {
+        m_authPump->Wake();
+    }
+}
+
+void _TCPEndpoint::AuthResume(void)
+{
+    /*
+     * Hand a handshake that is waiting for more data back to its auth pump.
      */
-    m_endpoint->m_authState = AUTH_SUCCEEDED;
-    return (void*)status;
+    TCPEndpoint tcpEp = TCPEndpoint::wrap(this);
+    m_authPump->Add(tcpEp);
+}
+
+QStatus TCPTransport::DispatchAuthStep(TCPEndpoint& conn)
+{
+    if (!m_authListenerDispatcher.IsRunning()) {
+        return ER_BUS_STOPPING;
+    }
+    TCPEndpoint* ctx = new TCPEndpoint(conn);
+    qcc::AlarmListener* tcpListener = this;
+    QStatus status = m_authListenerDispatcher.AddAlarm(Alarm(tcpListener, ctx));
+    if (status != ER_OK) {
+        delete ctx;
+    }
+    return status;
+}
+
+void TCPTransport::AlarmTriggered(const Alarm& alarm, QStatus reason)
+{
+    TCPEndpoint* ctx = static_cast<TCPEndpoint*>(alarm->GetContext());
+    TCPEndpoint conn = *ctx;
+    delete ctx;
+
+    /*
+     * The dispatcher runs any alarms still queued when it is stopped, in
+     * which case the transport is going away and the handshake is failed.
+     */
+    QStatus status = (reason == ER_OK) ? conn->AuthAdvance() : ER_BUS_STOPPING;
+    if (status == ER_WOULDBLOCK) {
+        conn->AuthResume();
+    } else {
+        conn->AuthComplete(status);
+    }
 }
 
 TCPTransport::TCPTransport(BusAttachment& bus)
@@ -803,9 +917,14 @@ TCPTransport::TCPTransport(BusAttachment& bus)
     m_isAdvertising(false), m_isDiscovering(false), m_isListening(false),
     m_isNsEnabled(false), m_reload(STATE_RELOADING),
     m_listenPort(0), m_nsReleaseCount(0),
-    m_maxUntrustedClients(0), m_numUntrustedClients(0)
+    m_maxUntrustedClients(0), m_numUntrustedClients(0),
+    m_nextAuthPump(0),
+    m_authListenerDispatcher("TCPAuthListener", true, ALLJOYN_AUTH_LISTENER_THREADS_TCP)
 {
     QCC_DbgTrace(("TCPTransport::TCPTransport()"));
+    for (uint32_t i = 0; i < ALLJOYN_AUTH_PUMPS_TCP; ++i) {
+        m_authPumps.push_back(new AuthPump(this, i));
+    }
     /*
      * We know we are daemon code, so we'd better be running with a daemon
      * router.  This is assumed elsewhere.
@@ -818,6 +937,9 @@ TCPTransport::~TCPTransport()
     QCC_DbgTrace(("TCPTransport::~TCPTransport()"));
     Stop();
     Join();
+    for (vector<AuthPump*>::iterator i = m_authPumps.begin(); i != m_authPumps.end(); ++i) {
+        delete *i;
+    }
 }
 
 void TCPTransport::Authenticated(TCPEndpoint& conn)
@@ -830,8 +952,8 @@ void TCPTransport::Authenticated(TCPEndpoint& conn)
         return;
     }
     /*
-     * If Authenticated() is being called, it is as a result of the
-     * authentication thread telling us that it has succeeded.  What we need to
+     * If Authenticated() is being called, it is as a result of an auth pump
+     * telling us that the authentication has succeeded.  What we need to
      * do here is to try and Start() the endpoint which will spin up its TX and
      * RX threads and register the endpoint with the daemon router.  As soon as
      * we call Start(), we are transferring responsibility for error reporting
@@ -945,6 +1067,23 @@ QStatus TCPTransport::Start()
                                           new CallbackImpl<FoundCallback, void, const qcc::String&, const qcc::String&, std::vector<qcc::String>&, uint8_t>
                                               (&m_foundCallback, &FoundCallback::Found));
 
+    /*
+     * Start the auth pumps that will authenticate the connections the server
+     * accept loop accepts, and the dispatcher they hand auth listener calls to.
+     */
+    QStatus dispatcherStatus = m_authListenerDispatcher.Start();
+    if (dispatcherStatus != ER_OK) {
+        QCC_LogError(dispatcherStatus, ("TCPTransport::Start(): Failed to Start() auth listener dispatcher"));
+        return dispatcherStatus;
+    }
+    for (vector<AuthPump*>::iterator i = m_authPumps.begin(); i != m_authPumps.end(); ++i) {
+        QStatus status = (*i)->Start();
+        if (status != ER_OK) {
+            QCC_LogError(status, ("TCPTransport::Start(): Failed to Start() auth pump"));
+            return status;
+        }
+    }
+
     /*
      * Start the server accept loop through the thread base class.  This will
      * close or open the IsRunning() gate we use to control access to our
@@ -995,16 +1134,20 @@ QStatus TCPTransport::Stop(void)
     }
 
     /*
-     * Ask any authenticating endpoints to shut down and exit their threads.  By its
-     * presence on the m_authList, we know that the endpoint is authenticating and
-     * the authentication thread has responsibility for dealing with the endpoint
-     * data structure.  We call Stop() to stop that thread from running.  The
-     * endpoint Rx and Tx threads will not be running yet.
+     * Ask any authenticating endpoints to shut down.  By its presence on the
+     * m_authList, we know that the endpoint is authenticating and an auth pump
+     * has responsibility for dealing with the endpoint data structure.  The
+     * auth pumps are stopped too and fail any handshakes they still have when
+     * they exit.  The endpoint Rx and Tx threads will not be running yet.
      */
     for (set<TCPEndpoint>::iterator i = m_authList.begin(); i != m_authList.end(); ++i) {
         TCPEndpoint ep = *i;
         ep->AuthStop();
     }
+    m_authListenerDispatcher.Stop();
+    for (vector<AuthPump*>::iterator i = m_authPumps.begin(); i != m_authPumps.end(); ++i) {
+        (*i)->Stop();
+    }
 
     /*
      * Ask any running endpoints to shut down and exit their threads.  By its
@@ -1058,39 +1201,35 @@ QStatus TCPTransport::Join(void)
      * running in those endpoints actually stop running.
      *
      * Since Stop() is a request to stop, and this is what has ultimately been
-     * done to both authentication threads and Rx and Tx threads, it is possible
-     * that a thread is actually running after the call to Stop().  If that
-     * thead happens to be an authenticating endpoint, it is possible that an
-     * authentication actually completes after Stop() is called.  This will move
-     * a connection from the m_authList to the m_endpointList, so we need to
-     * make sure we wait for all of the connections on the m_authList to go away
-     * before we look for the connections on the m_endpointlist.
+     * done to both the auth pumps and Rx and Tx threads, it is possible that a
+     * thread is actually running after the call to Stop().  If that thead
+     * happens to be an auth pump, it is possible that an authentication
+     * actually completes after Stop() is called.  This will move a connection
+     * from the m_authList to the m_endpointList, so we need to make sure we
+     * wait for all of the auth pumps to exit before we look for the
+     * connections on the m_endpointlist.  The auth listener dispatcher is
+     * joined first since it gives connections back to the auth pumps.
      */
+    m_authListenerDispatcher.Join();
+    for (vector<AuthPump*>::iterator i = m_authPumps.begin(); i != m_authPumps.end(); ++i) {
+        (*i)->Join();
+    }
+
     m_endpointListLock.Lock(MUTEX_CONTEXT);
 
     /*
-     * Any authenticating endpoints have been asked to shut down and exit their
-     * authentication threads in a previously required Stop().  We need to
-     * Join() all of these auth threads here.
+     * The auth pumps have let go of all authenticating endpoints so they can
+     * simply be dropped.
      */
-    set<TCPEndpoint>::iterator it = m_authList.begin();
-    while (it != m_authList.end()) {
-        TCPEndpoint ep = *it;
-        m_authList.erase(it);
-        m_endpointListLock.Unlock(MUTEX_CONTEXT);
-        ep->AuthJoin();
-        m_endpointListLock.Lock(MUTEX_CONTEXT);
-        it = m_authList.upper_bound(ep);
-    }
-
+    m_authList.clear();
 
     /*
      * Any running endpoints have been asked it their threads in a previously
      * required Stop().  We need to Join() all of thesse threads here.  This
      * Join() will wait on the endpoint rx and tx threads to exit as opposed to
-     * the joining of the auth thread we did above.
+     * the joining of the auth pumps we did above.
      */
-    it = m_endpointList.begin();
+    set<TCPEndpoint>::iterator it = m_endpointList.begin();
     while (it != m_endpointList.end()) {
         TCPEndpoint ep = *it;
         m_endpointList.erase(it);
@@ -1377,17 +1516,12 @@ void TCPTransport::ManageEndpoints(Timespec tTimeout)
 
         if (authState == _TCPEndpoint::AUTH_FAILED) {
             /*
-             * The endpoint has failed authentication and the auth thread is
-             * gone or is going away.  Since it has failed there is no way this
-             * endpoint is going to be started so we can get rid of it as soon
-             * as we Join() the (failed) authentication thread.
+             * The endpoint has failed authentication and the auth pump has let
+             * go of it.  Since it has failed there is no way this endpoint is
+             * going to be started so we can get rid of it.
              */
             QCC_DbgHLPrintf(("TCPTransport::ManageEndpoints(): Scavenging failed authenticator"));
-            m_authList.erase(i);
-            m_endpointListLock.Unlock(MUTEX_CONTEXT);
-            ep->AuthJoin();
-            m_endpointListLock.Lock(MUTEX_CONTEXT);
-            i = m_authList.upper_bound(ep);
+            m_authList.erase(i++);
             continue;
         }
 
@@ -1397,25 +1531,21 @@ void TCPTransport::ManageEndpoints(Timespec tTimeout)
         if (ep->GetStartTime() + tTimeout < tNow) {
             /*
              * This endpoint is taking too long to authenticate.  Stop the
-             * authentication process.  The auth thread is still running, so we
-             * can't just delete the connection, we need to let it stop in its
-             * own time.  What that thread will do is to set AUTH_FAILED and
-             * exit.  we will then clean it up the next time through this loop.
-             * In the hope that the thread can exit and we can catch its exit
-             * here and now, we take our thread off the OS ready list (Sleep)
-             * and let the other thread run before looping back.
+             * authentication process.  The auth pump still owns the handshake,
+             * so we can't just delete the connection, we need to let the pump
+             * fail it.  What the pump will do is to set AUTH_FAILED and we will
+             * then clean it up the next time through this loop.
              */
             QCC_DbgHLPrintf(("TCPTransport::ManageEndpoints(): Scavenging slow authenticator"));
             ep->AuthStop();
-            qcc::Sleep(1);
         }
         ++i;
     }
 
     /*
      * We've handled the authList, so now run through the list of connections on
-     * the endpointList and cleanup any that are no longer running or Join()
-     * authentication threads that have successfully completed.
+     * the endpointList and cleanup any that are no longer running or that
+     * have just completed authentication.
      */
     i = m_endpointList.begin();
     while (i != m_endpointList.end()) {
@@ -1436,20 +1566,15 @@ void TCPTransport::ManageEndpoints(Timespec tTimeout)
 
         if (authState == _TCPEndpoint::AUTH_SUCCEEDED) {
             /*
-             * The endpoint has succeeded authentication and the auth thread is
-             * gone or is going away.  Take this opportunity to join the auth
-             * thread.  Since the auth thread promised not to touch the state
-             * after setting AUTH_SUCCEEEDED, we can safely change the state
-             * here since we now own the conn.  We do this through a method call
-             * to enable this single special case where we are allowed to set
-             * the state.
+             * The endpoint has succeeded authentication and the auth pump has
+             * let go of it.  Since the auth pump promised not to touch the
+             * state after setting AUTH_SUCCEEEDED, we can safely change the
+             * state here since we now own the conn.  We do this through a
+             * method call to enable this single special case where we are
+             * allowed to set the state.
              */
-            QCC_DbgHLPrintf(("TCPTransport::ManageEndpoints(): Scavenging failed authenticator"));
-            m_endpointListLock.Unlock(MUTEX_CONTEXT);
-            ep->AuthJoin();
             ep->SetAuthDone();
-            m_endpointListLock.Lock(MUTEX_CONTEXT);
-            i = m_endpointList.upper_bound(ep);
+            ++i;
             continue;
         }
         /*
@@ -1492,8 +1617,7 @@ void TCPTransport::ManageEndpoints(Timespec tTimeout)
          * EndpointExit function.  If we find this, we need to Join
          * the endpoint threads, remove the endpoint from the
          * endpoint list and delete it.  Note that we are calling
-         * the endpoint Join() to join the TX and RX threads and not
-         * the endpoint AuthJoin() to join the auth thread.
+         * the endpoint Join() to join the TX and RX processing.
          */
         if (endpointState == _TCPEndpoint::EP_STOPPING) {
             m_endpointList.erase(i);
@@ -1661,15 +1785,15 @@ void* TCPTransport::Run(void* arg)
                     conn->SetStartTime(tNow);
                     /*
                      * By putting the connection on the m_authList, we are
-                     * transferring responsibility for the connection to the
-                     * Authentication thread.  Therefore, we must check that the
-                     * thread actually started running to ensure the handoff
-                     * worked.  If it didn't we need to deal with the connection
-                     * here.  Since there are no threads running we can just
-                     * pitch the connection.
+                     * transferring responsibility for the connection to an
+                     * auth pump.  Therefore, we must check that the handshake
+                     * actually started to ensure the handoff worked.  If it
+                     * didn't we need to deal with the connection here.  Since
+                     * no auth pump has it we can just pitch the connection.
                      */
                     std::pair<std::set<TCPEndpoint>::iterator, bool> ins = m_authList.insert(conn);
-                    status = conn->Authenticate();
+                    AuthPump* pump = m_authPumps[m_nextAuthPump++ % m_authPumps.size()];
+                    status = conn->Authenticate(pump);
                     if (status != ER_OK) {
                         m_authList.erase(ins.first);
                     }
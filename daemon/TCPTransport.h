@@ -29,6 +29,7 @@
 
 #include <list>
 #include <queue>
+#include <vector>
 #include <alljoyn/Status.h>
 
 #include <qcc/platform.h>
@@ -37,6 +38,7 @@
 #include <qcc/Thread.h>
 #include <qcc/Socket.h>
 #include <qcc/SocketStream.h>
+#include <qcc/Timer.h>
 #include <qcc/time.h>
 
 #include <alljoyn/TransportMask.h>
@@ -61,8 +63,10 @@ typedef qcc::ManagedObj<_TCPEndpoint> TCPEndpoint;
  * versions revolves around routing and discovery. This class provides a
  * specialization of class Transport for use by daemons.
  */
-class TCPTransport : public Transport, public _RemoteEndpoint::EndpointListener, public qcc::Thread {
+class TCPTransport : public Transport, public _RemoteEndpoint::EndpointListener, public qcc::Thread, public qcc::AlarmListener {
     friend class _TCPEndpoint;
+    class AuthPump;
+    friend class AuthPump;
 
   public:
     /**
@@ -446,6 +450,23 @@ class TCPTransport : public Transport, public _RemoteEndpoint::EndpointListener,
      */
     void Authenticated(TCPEndpoint& conn);
 
+    /**
+     * @internal
+     * @brief Run the next authentication step of a connection whose
+     * handshake may call the auth listener off the auth pump.
+     *
+     * @param conn Reference to the TCPEndpoint that has data to read.
+     *
+     * @return ER_OK if the step was queued, otherwise an error status.
+     */
+    QStatus DispatchAuthStep(TCPEndpoint& conn);
+
+    /**
+     * @internal
+     * @brief Run an authentication step queued by DispatchAuthStep().
+     */
+    void AlarmTriggered(const qcc::Alarm& alarm, QStatus reason);
+
     /**
      * @internal
      * @brief Normalize a listen specification.
@@ -494,11 +515,33 @@ class TCPTransport : public Transport, public _RemoteEndpoint::EndpointListener,
      * in the DBus configuration, but it applies only to the TCP transport.  To
      * override this value, change the limit, "max_incomplete_connections_tcp".
      * Typically, DBus sets this value to 10,000 which is essentially infinite
-     * from the perspective of a phone.  Since this represents a transient state
-     * in connection establishment, there should be few connections in this
-     * state, so we default to a quite low number.
+     * from the perspective of a phone.  Authenticating connections are driven
+     * by a fixed number of auth pump threads so an authenticating connection
+     * costs no more than a socket and its handshake state, and SASL lines are
+     * capped so that state is bounded.  The limit is high enough that a burst
+     * of reconnects after a network outage is not turned away; the number of
+     * connections is still bounded by "max_completed_connections".
      */
-    static const uint32_t ALLJOYN_MAX_INCOMPLETE_CONNECTIONS_TCP_DEFAULT = 10;
+    static const uint32_t ALLJOYN_MAX_INCOMPLETE_CONNECTIONS_TCP_DEFAULT = 1024;
+
+    /**
+     * @brief The number of auth pump threads.
+     *
+     * Each auth pump waits for data on the sockets of the incoming connections
+     * it has been given and advances their authentication handshakes without
+     * blocking.
+     */
+    static const uint32_t ALLJOYN_AUTH_PUMPS_TCP = 4;
+
+    /**
+     * @brief The number of threads that run authentication steps which may
+     * call out to the auth listener.
+     *
+     * A PIN_KEYX handshake calls the auth listener, which can take as long as
+     * a user takes to type a PIN, so those steps are run here rather than on
+     * an auth pump where they would hold up every other handshake.
+     */
+    static const uint32_t ALLJOYN_AUTH_LISTENER_THREADS_TCP = 4;
 
     /**
      * @brief The default value for the maximum number of TCP connections
@@ -668,6 +711,12 @@ class TCPTransport : public Transport, public _RemoteEndpoint::EndpointListener,
 
     int32_t m_numUntrustedClients;      /**< Number of untrusted clients currently registered with the daemon */
 
+    uint32_t m_nextAuthPump;                 /**< Auth pump that is given the next incoming connection */
+
+    std::vector<AuthPump*> m_authPumps;      /**< Threads that drive the authentication of incoming connections */
+
+    qcc::Timer m_authListenerDispatcher;     /**< Threads that run authentication steps which may call the auth listener */
+
 };
 
 } // namespace ajn
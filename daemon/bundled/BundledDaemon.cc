@@ -73,6 +73,8 @@ static const char bundledConfig[] =
     "  <limit max_incomplete_connections=\"4\"/>"
     "  <limit max_completed_connections=\"16\"/>"
     "  <limit max_untrusted_clients=\"0\"/>"
+    "  <limit io_dispatch_shards=\"1\"/>"
+    "  <limit sls_max_stored_bytes=\"1048576\"/>"
     "  <property restrict_untrusted_clients=\"true\"/>"
     "  <ip_name_service>"
     "    <property interfaces=\"*\"/>"
@@ -35,6 +35,7 @@
 #include "RemoteEndpoint.h"
 #include "Router.h"
 #include "DaemonTransport.h"
+#include "ScatterGatherList.h"
 
 #define QCC_MODULE "ALLJOYN"
 
@@ -116,6 +117,22 @@ class _DaemonEndpoint : public _RemoteEndpoint {
      */
     bool SupportsUnixIDs() const { return true; }
 
+  protected:
+
+    /**
+     * Send all the buffers with a single sendmsg call.
+     */
+    QStatus PushBytesVectored(const TxBuffer* bufs, size_t numBufs, size_t& pushed)
+    {
+        ScatterGatherList sg;
+        for (size_t i = 0; i < numBufs; ++i) {
+            sg.AddBuffer(bufs[i].buf, bufs[i].len);
+        }
+        sg.SetDataSize(sg.MaxDataSize());
+        QStatus status = SendSG(stream.GetSocketFd(), sg, pushed);
+        return (status == ER_WOULDBLOCK) ? ER_TIMEOUT : status;
+    }
+
   private:
     uint32_t userId;
     uint32_t groupId;
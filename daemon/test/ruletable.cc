@@ -0,0 +1,203 @@
+/**
+ * @file
+ *
+ * Benchmark for broadcast signal routing through the daemon RuleTable.
+ * Compares the cost per signal of a linear scan of every rule against the
+ * interface/member indexed lookup as the number of rules grows.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include <qcc/platform.h>
+#include <qcc/Debug.h>
+#include <qcc/String.h>
+#include <qcc/StringUtil.h>
+#include <qcc/Util.h>
+#include <qcc/time.h>
+
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/Message.h>
+#include <alljoyn/Status.h>
+
+#include <BusEndpoint.h>
+#include <RuleTable.h>
+
+#define QCC_MODULE "ALLJOYN"
+
+using namespace std;
+using namespace qcc;
+using namespace ajn;
+
+static BusAttachment* gBus;
+
+/* Number of distinct interfaces and members used to spread the rules */
+static const uint32_t NUM_IFACES = 64;
+static const uint32_t NUM_MEMBERS = 16;
+
+/* Number of rules registered by each endpoint */
+static const uint32_t RULES_PER_ENDPOINT = 4;
+
+class _BenchMessage : public _Message {
+  public:
+    _BenchMessage() : _Message(*gBus) { }
+
+    QStatus Signal(const qcc::String& iface, const qcc::String& member)
+    {
+        return SignalMsg("", NULL, 0, "/org/alljoyn/bench", iface, member, NULL, 0, 0, 0);
+    }
+};
+
+typedef qcc::ManagedObj<_BenchMessage> BenchMessage;
+
+static qcc::String IfaceName(uint32_t i)
+{
+    return "org.alljoyn.bench.Iface" + U32ToString(i % NUM_IFACES);
+}
+
+static qcc::String MemberName(uint32_t i)
+{
+    return "Signal" + U32ToString(i % NUM_MEMBERS);
+}
+
+/*
+ * Populate the rule table with numRules rules. Most rules name both an interface and
+ * a member, a few only name an interface and one endpoint asks for every signal.
+ */
+static void PopulateRules(RuleTable& ruleTable, vector<BusEndpoint>& endpoints, uint32_t numRules)
+{
+    BusEndpoint ep;
+    for (uint32_t i = 0; i < numRules; ++i) {
+        if ((i % RULES_PER_ENDPOINT) == 0) {
+            ep = BusEndpoint();
+            endpoints.push_back(ep);
+        }
+        qcc::String ruleStr = "type='signal'";
+        if (i == 0) {
+            /* Wildcard rule matches everything */
+        } else if ((i % 10) == 0) {
+            ruleStr += ",interface='" + IfaceName(i) + "'";
+        } else {
+            ruleStr += ",interface='" + IfaceName(i) + "',member='" + MemberName(i / NUM_IFACES) + "'";
+        }
+        Rule rule(ruleStr.c_str());
+        ruleTable.AddRule(ep, rule);
+    }
+}
+
+/* The routing algorithm used before rules were indexed */
+static size_t LinearScan(RuleTable& ruleTable, const Message& msg)
+{
+    size_t matches = 0;
+    RuleIterator it = ruleTable.Begin();
+    while (it != ruleTable.End()) {
+        if (it->second.IsMatch(msg)) {
+            ++matches;
+            it = ruleTable.AdvanceToNextEndpoint(it->first);
+        } else {
+            ++it;
+        }
+    }
+    return matches;
+}
+
+static void usage(void)
+{
+    printf("Usage: ruletable [-n <signals>]\n");
+    printf("Options:\n");
+    printf("   -n <signals>  = Number of signals routed for each rule count (default 10000)\n");
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t numSignals = 10000;
+    static const uint32_t ruleCounts[] = { 10, 100, 1000, 2500, 5000, 10000 };
+
+    for (int i = 1; i < argc; ++i) {
+        if (0 == strcmp("-n", argv[i])) {
+            ++i;
+            if (i == argc) {
+                usage();
+                exit(1);
+            }
+            numSignals = StringToU32(argv[i], 10, 10000);
+        } else {
+            usage();
+            exit(1);
+        }
+    }
+
+    gBus = new BusAttachment("ruletable");
+
+    /* Pre-build a set of signals that cycle through the interfaces and members */
+    vector<Message> signals;
+    for (uint32_t i = 0; i < NUM_IFACES * NUM_MEMBERS; ++i) {
+        BenchMessage bm;
+        QStatus status = bm->Signal(IfaceName(i), MemberName(i / NUM_IFACES));
+        if (status != ER_OK) {
+            QCC_LogError(status, ("Failed to compose signal"));
+            exit(1);
+        }
+        signals.push_back(Message::cast(bm));
+    }
+
+    printf("%8s %12s %12s %10s\n", "rules", "scan(us)", "index(us)", "matches");
+    for (size_t r = 0; r < ArraySize(ruleCounts); ++r) {
+        RuleTable ruleTable;
+        vector<BusEndpoint> endpoints;
+        PopulateRules(ruleTable, endpoints, ruleCounts[r]);
+
+        size_t scanMatches = 0;
+        uint64_t start = GetTimestamp64();
+        ruleTable.Lock();
+        for (uint32_t i = 0; i < numSignals; ++i) {
+            scanMatches += LinearScan(ruleTable, signals[i % signals.size()]);
+        }
+        ruleTable.Unlock();
+        uint64_t scanTime = GetTimestamp64() - start;
+
+        size_t indexMatches = 0;
+        vector<BusEndpoint> dests;
+        start = GetTimestamp64();
+        ruleTable.Lock();
+        for (uint32_t i = 0; i < numSignals; ++i) {
+            dests.clear();
+            ruleTable.FindMatchingEndpoints(signals[i % signals.size()], dests);
+            indexMatches += dests.size();
+        }
+        ruleTable.Unlock();
+        uint64_t indexTime = GetTimestamp64() - start;
+
+        if (scanMatches != indexMatches) {
+            printf("FAILED: linear scan routed %u signals but indexed lookup routed %u\n",
+                   static_cast<uint32_t>(scanMatches), static_cast<uint32_t>(indexMatches));
+            return 1;
+        }
+        printf("%8u %12.3f %12.3f %10.2f\n", ruleCounts[r],
+               (scanTime * 1000.0) / numSignals,
+               (indexTime * 1000.0) / numSignals,
+               static_cast<double>(indexMatches) / numSignals);
+    }
+
+    signals.clear();
+    delete gBus;
+    return 0;
+}
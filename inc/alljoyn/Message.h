@@ -156,7 +156,9 @@ class HeaderFields {
  */
 class _Message;
 class _RemoteEndpoint;
+class _SignatureProgram;
 class BusAttachment;
+struct MessageNameAtoms;
 
 /**
  * @cond ALLJOYN_DEV
@@ -625,6 +627,35 @@ class _Message {
      */
     _Message(const _Message& other);
 
+    /// @cond ALLJOYN_DEV
+    /**
+     * @internal
+     * Get the interned atoms for the sender, interface, member and destination header fields.
+     * These are resolved when a routing node unmarshals the message and are only looked up
+     * again if names have been interned since then.
+     *
+     * @param atoms   [OUT] The header field atoms.
+     */
+    void GetNameAtoms(MessageNameAtoms& atoms) const;
+
+    /**
+     * @internal
+     * Get the leading string and object path arguments from the message body without
+     * unmarshaling the body. This is used by the daemon to evaluate match rules.
+     *
+     * @param args     Array of numArgs args. On return each string or object path argument
+     *                 references the message buffer. Arguments of any other type, arguments
+     *                 beyond the end of the body and all the arguments of an encrypted message
+     *                 are left as ALLJOYN_INVALID.
+     * @param numArgs  Number of leading arguments to examine.
+     *
+     * @return
+     *      - #ER_OK if the arguments were examined.
+     *      - An error status if the message body is malformed.
+     */
+    QStatus PeekStringArgs(MsgArg* args, size_t numArgs) const;
+    /// @endcond
+
   protected:
 
     /*
@@ -837,6 +868,17 @@ class _Message {
      */
     QStatus ReMarshal(const char* senderName = NULL);
 
+    /**
+     * @internal
+     * Marshal a message with a compressed header again with all of its header fields. The
+     * compression token is kept so the receiver learns the expansion from this message.
+     *
+     * @return
+     *      - #ER_OK if successful
+     *      - An error status otherwise
+     */
+    QStatus UncompressHeader();
+
     /**
      * @internal
      * Sets the serial number to the next available value for the bus attachment for this message.
@@ -925,7 +967,7 @@ class _Message {
     bool endianSwap;             ///< true if endianness will be swapped.
 
     MessageHeader msgHeader;     ///< Current message header.
-    uint8_t* _msgBuf;            ///< Pointer to the current msg buffer.
+    uint8_t* _msgBuf;            ///< Pointer to the current msg buffer (allocated from the BufferPool).
     uint64_t* msgBuf;            ///< Pointer to the current msg buffer (8 byte aligned pointer into _msgBuf).
     MsgArg* msgArgs;             ///< Pointer to the unmarshaled arguments.
     uint8_t numMsgArgs;          ///< Number of message args (signature cannot be longer than 255 chars).
@@ -963,8 +1005,21 @@ class _Message {
      */
     HeaderFields hdrFields;
 
+    /**
+     * Atoms for the sender, interface, member and destination header fields and the
+     * NameAtomTable generation they were resolved in. A generation of 0 means the atoms
+     * have not been resolved.
+     */
+    uint32_t hdrAtoms[4];
+    uint32_t hdrAtomsGeneration;
+
     /* Internal methods unmarshal side */
 
+    /**
+     * Resolve the header field atoms returned by GetNameAtoms.
+     */
+    void ResolveNameAtoms();
+
     void ClearHeader();
     QStatus ParseValue(MsgArg* arg, const char*& sigPtr, bool arrayElem = false);
     QStatus ParseStruct(MsgArg* arg, const char*& sigPtr);
@@ -972,6 +1027,21 @@ class _Message {
     QStatus ParseArray(MsgArg* arg, const char*& sigPtr);
     QStatus ParseSignature(MsgArg* arg);
     QStatus ParseVariant(MsgArg* arg);
+    QStatus ParseArrayLength(uint32_t& len);
+    QStatus ParseArrayElements(MsgArg* arg, const char* elemSig, uint32_t len, const _SignatureProgram* program, size_t elemOp);
+
+    /**
+     * Parse a complete type described by an operation of a compiled signature program.
+     *
+     * @param arg      The arg to unmarshal into.
+     * @param program  The compiled signature.
+     * @param index    Index of the operation for the complete type.
+     *
+     * @return
+     *      - #ER_OK if the value was unmarshaled.
+     *      - An error status otherwise.
+     */
+    QStatus ParseCompiled(MsgArg* arg, const _SignatureProgram& program, size_t index);
 
     /**
      * Check that the header fields are valid. This check is automatically performed when a header
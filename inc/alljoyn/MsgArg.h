@@ -745,6 +745,12 @@ class MsgArg {
 
   private:
 
+    /**
+     * The flag value that indicates that the data owned by this MsgArg was allocated from the
+     * internal buffer pool rather than with new[]. Only set by the message parser.
+     */
+    static const uint8_t PooledData = 0x80;
+
     uint8_t flags;
 
     void SetOwnershipDeep();
@@ -59,6 +59,45 @@ class ProxyBusObject : public MessageReceiver {
      */
     static const uint32_t DefaultCallTimeout = 25000;
 
+    /**
+     * Counters for the property cache enabled by EnablePropertyCaching()
+     */
+    struct PropertyCacheStats {
+        uint32_t hits;      /**< Number of property reads served from the cache */
+        uint32_t misses;    /**< Number of cacheable property reads that went to the remote object */
+    };
+
+    /**
+     * A method call made as part of a batch with MethodCallBatchAsync()
+     */
+    struct BatchedCall {
+        const InterfaceDescription::Member* method;  /**< Method being invoked */
+        const MsgArg* args;                           /**< The arguments for the method call (can be NULL) */
+        size_t numArgs;                               /**< The number of arguments */
+    };
+
+    /**
+     * Pure virtual base class implemented by classes that wish to call MethodCallBatchAsync().
+     */
+    class MethodCallBatchAsyncCB {
+      public:
+        /** Destructor */
+        virtual ~MethodCallBatchAsyncCB() { }
+
+        /**
+         * Called when the replies to all method calls in a batch have been received.
+         *
+         * @param status      ER_OK if every reply is a method return or #ER_BUS_REPLY_IS_ERROR_MESSAGE
+         *                    if any reply is an error message.
+         * @param obj         The remote object the batch was sent to.
+         * @param replies     The replies in the same order as the method calls. Method calls that
+         *                    timed out or could not be sent have an error reply.
+         * @param numReplies  The number of replies.
+         * @param context     User defined context which will be passed as-is to callback.
+         */
+        virtual void MethodCallBatchCB(QStatus status, ProxyBusObject* obj, const Message* replies, size_t numReplies, void* context) = 0;
+    };
+
     /**
      * Pure virtual base class implemented by classes that wish to receive
      * ProxyBusObject related messages.
@@ -428,6 +467,30 @@ class ProxyBusObject : public MessageReceiver {
         MsgArg arg("s", s.c_str()); return SetProperty(iface, property, arg, timeout);
     }
 
+    /**
+     * Enable caching of property values on this proxy object. Once enabled GetProperty() and
+     * GetAllProperties() serve reads locally for properties annotated with
+     * org.freedesktop.DBus.Property.EmitsChangedSignal set to "true" or "invalidates". The cache
+     * is filled by reads from the remote object and kept coherent by the PropertiesChanged
+     * signals emitted by the remote object. Properties without the annotation are never cached.
+     * Only PropertiesChanged signals sent by the current owner of the service name are applied,
+     * and the cache is dropped when the owner changes or the session is lost.
+     *
+     * Caching is not inherited by copies of this proxy object.
+     *
+     * @return
+     *      - #ER_OK if caching is enabled.
+     *      - An error status otherwise
+     */
+    QStatus EnablePropertyCaching();
+
+    /**
+     * Get the property cache counters for this proxy object.
+     *
+     * @param[out] stats  Returns the counters.
+     */
+    void GetPropertyCacheStats(PropertyCacheStats& stats) const;
+
     /**
      * Returns the interfaces implemented by this object. Note that all proxy bus objects
      * automatically inherit the "org.freedesktop.DBus.Peer" which provides the built-in "ping"
@@ -833,6 +896,32 @@ class ProxyBusObject : public MessageReceiver {
                             uint32_t timeout = DefaultCallTimeout,
                             uint8_t flags = 0) const;
 
+    /**
+     * Make a batch of asynchronous method calls from this object. All the method calls are
+     * marshaled before any of them is sent and are then sent back to back without waiting for
+     * replies. The callback is called once, when the replies to all the method calls have been
+     * received, and may be called before this function returns.
+     *
+     * @param calls        The method calls to make.
+     * @param numCalls     The number of method calls.
+     * @param callback     The object to be called when the batch completes.
+     * @param context      User-defined context that will be passed to the callback.
+     * @param timeout      Timeout specified in milliseconds to wait for each reply
+     * @param flags        Logical OR of the message flags for the method calls. The following flags apply to method calls:
+     *                     - If #ALLJOYN_FLAG_ENCRYPTED is set the message is authenticated and the payload if any is encrypted.
+     *                     - If #ALLJOYN_FLAG_COMPRESSED is set the header is compressed for destinations that can handle header compression.
+     *                     - If #ALLJOYN_FLAG_AUTO_START is set the bus will attempt to start a service if it is not running.
+     * @return
+     *      - ER_OK if successful, the callback will be called.
+     *      - An error status otherwise, the callback will not be called.
+     */
+    QStatus MethodCallBatchAsync(const BatchedCall* calls,
+                                 size_t numCalls,
+                                 MethodCallBatchAsyncCB* callback,
+                                 void* context = NULL,
+                                 uint32_t timeout = DefaultCallTimeout,
+                                 uint8_t flags = 0);
+
     /**
      * Initialize this proxy object from an XML string. Calling this method does several things:
      *
@@ -964,6 +1053,30 @@ class ProxyBusObject : public MessageReceiver {
      */
     void SetPropMethodCB(Message& message, void* context);
 
+    /**
+     * @internal
+     * PropertiesChanged signal handler used to keep the property cache coherent. (Internal use only)
+     */
+    void PropertiesChangedHandler(const InterfaceDescription::Member* member, const char* srcPath, Message& message);
+
+    /**
+     * @internal
+     * NameOwnerChanged signal handler that tracks the owner of the remote object for the property cache. (Internal use only)
+     */
+    void CacheOwnerChangedHandler(const InterfaceDescription::Member* member, const char* srcPath, Message& message);
+
+    /**
+     * @internal
+     * SessionLostWithReason signal handler that drops the property cache. (Internal use only)
+     */
+    void CacheSessionLostHandler(const InterfaceDescription::Member* member, const char* srcPath, Message& message);
+
+    /**
+     * @internal
+     * Method reply handler for method calls made with MethodCallBatchAsync(). (Internal use only)
+     */
+    void BatchReplyHandler(Message& message, void* context);
+
     /**
      * @internal
      * Set the B2B endpoint to use for all communication with remote object.
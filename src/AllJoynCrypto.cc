@@ -31,6 +31,7 @@
 #include <alljoyn/Status.h>
 
 #include "AllJoynCrypto.h"
+#include "CryptoAESNI.h"
 
 #define QCC_MODULE "ALLJOYN_AUTH"
 
@@ -102,16 +103,24 @@ QStatus Crypto::Encrypt(const _Message& message, const KeyBlob& keyBlob, uint8_t
         QCC_DbgHLPrintf(("Encrypt key:   %s", BytesToHexString(keyBlob.GetData(), keyBlob.GetSize()).c_str()));
         QCC_DbgHLPrintf(("        nonce: %s", BytesToHexString(nonce.GetData(), nonce.GetSize()).c_str()));
 
-        Crypto_AES aes(keyBlob, Crypto_AES::CCM);
+        const void* addData = msgBuf;
+        size_t addLen = hdrLen;
+        qcc::String extHdr;
         if (message.GetFlags() & ALLJOYN_FLAG_COMPRESSED) {
             /*
              * To prevent an attack where the attacker sends a bogus expansion rule we
              * authenticate the compressed headers even though we won't be sending them.
              */
-            qcc::String extHdr = ConcatenateCompressedFields(msgBuf, hdrLen, message.GetHeaderFields());
-            status = aes.Encrypt_CCM(body, body, bodyLen, nonce, extHdr.data(), extHdr.size(), MACLength);
+            extHdr = ConcatenateCompressedFields(msgBuf, hdrLen, message.GetHeaderFields());
+            addData = extHdr.data();
+            addLen = extHdr.size();
+        }
+        if (Crypto_AES_NI::IsAvailable(keyBlob)) {
+            Crypto_AES_NI aes(keyBlob);
+            status = aes.Encrypt_CCM(body, body, bodyLen, nonce, addData, addLen, MACLength);
         } else {
-            status = aes.Encrypt_CCM(body, body, bodyLen, nonce, msgBuf, hdrLen, MACLength);
+            Crypto_AES aes(keyBlob, Crypto_AES::CCM);
+            status = aes.Encrypt_CCM(body, body, bodyLen, nonce, addData, addLen, MACLength);
         }
     }
     break;
@@ -144,16 +153,24 @@ QStatus Crypto::Decrypt(const _Message& message, const KeyBlob& keyBlob, uint8_t
         QCC_DbgHLPrintf(("Decrypt key:   %s", BytesToHexString(keyBlob.GetData(), keyBlob.GetSize()).c_str()));
         QCC_DbgHLPrintf(("        nonce: %s", BytesToHexString(nonce.GetData(), nonce.GetSize()).c_str()));
 
-        Crypto_AES aes(keyBlob, Crypto_AES::CCM);
+        const void* addData = msgBuf;
+        size_t addLen = hdrLen;
+        qcc::String extHdr;
         if (message.GetFlags() & ALLJOYN_FLAG_COMPRESSED) {
             /*
              * To prevent an attack where the attacker sends a bogus expansion rule we
              * authenticate the compressed headers even though we won't be sending them.
              */
-            qcc::String extHdr = ConcatenateCompressedFields(msgBuf, hdrLen, message.GetHeaderFields());
-            status = aes.Decrypt_CCM(body, body, bodyLen, nonce, extHdr.data(), extHdr.size(), MACLength);
+            extHdr = ConcatenateCompressedFields(msgBuf, hdrLen, message.GetHeaderFields());
+            addData = extHdr.data();
+            addLen = extHdr.size();
+        }
+        if (Crypto_AES_NI::IsAvailable(keyBlob)) {
+            Crypto_AES_NI aes(keyBlob);
+            status = aes.Decrypt_CCM(body, body, bodyLen, nonce, addData, addLen, MACLength);
         } else {
-            status = aes.Decrypt_CCM(body, body, bodyLen, nonce, msgBuf, hdrLen, MACLength);
+            Crypto_AES aes(keyBlob, Crypto_AES::CCM);
+            status = aes.Decrypt_CCM(body, body, bodyLen, nonce, addData, addLen, MACLength);
         }
     }
     break;
@@ -30,6 +30,7 @@
 #include <qcc/Util.h>
 #include <qcc/StringSink.h>
 #include <qcc/StringSource.h>
+#include <qcc/time.h>
 
 #include <alljoyn/InterfaceDescription.h>
 #include <alljoyn/AllJoynStd.h>
@@ -68,6 +69,37 @@ static const uint32_t MAX_AUTH_VERSION = 0x0001;
 
 static const uint32_t PREFERRED_AUTH_VERSION = (MAX_AUTH_VERSION << 16) | MIN_KEYGEN_VERSION;
 
+/*
+ * Maximum number of remote peer GUIDs remembered for resuming sessions
+ */
+static const size_t MAX_RESUME_GUIDS = 256;
+
+/*
+ * Maximum number of bus names remembered for each of those peers
+ */
+static const size_t MAX_RESUME_NAMES = 8;
+
+/*
+ * Number of threads that run authentication requests
+ */
+static const uint32_t AUTH_CONCURRENCY = 4;
+
+/*
+ * Once this many authentication requests are queued or running new authentication conversations
+ * initiated by remote peers are refused. Requests that continue a conversation or that were
+ * initiated locally are always queued.
+ */
+static const uint32_t MAX_PENDING_AUTH = 64;
+
+static void AddToHistogram(uint32_t* histogram, uint32_t ms)
+{
+    size_t bucket = 0;
+    while (((ms >> bucket) != 0) && (bucket < (AllJoynPeerObj::AUTH_HISTOGRAM_BUCKETS - 1))) {
+        ++bucket;
+    }
+    ++histogram[bucket];
+}
+
 static bool IsCompatibleVersion(uint32_t version)
 {
     uint16_t authV = version >> 16;
@@ -119,8 +151,11 @@ static void SetRights(PeerState& peerState, bool mutual, bool challenger)
 AllJoynPeerObj::AllJoynPeerObj(BusAttachment& bus) :
     BusObject(bus, org::alljoyn::Bus::Peer::ObjectPath, false),
     AlarmListener(),
-    dispatcher("PeerObjDispatcher", true, 3)
+    dispatcher("PeerObjDispatcher", true, 3),
+    authDispatcher("PeerObjAuth", true, AUTH_CONCURRENCY)
 {
+    memset(&authStats, 0, sizeof(authStats));
+
     /* Add org.alljoyn.Bus.Peer.HeaderCompression interface */
     {
         const InterfaceDescription* ifc = bus.GetInterface(org::alljoyn::Bus::Peer::HeaderCompression::InterfaceName);
@@ -160,6 +195,7 @@ QStatus AllJoynPeerObj::Start()
     assert(bus);
     bus->RegisterBusListener(*this);
     dispatcher.Start();
+    authDispatcher.Start();
     return ER_OK;
 }
 
@@ -167,6 +203,7 @@ QStatus AllJoynPeerObj::Stop()
 {
     assert(bus);
     dispatcher.Stop();
+    authDispatcher.Stop();
     bus->UnregisterBusListener(*this);
     return ER_OK;
 }
@@ -183,6 +220,7 @@ QStatus AllJoynPeerObj::Join()
     lock.Unlock(MUTEX_CONTEXT);
 
     dispatcher.Join();
+    authDispatcher.Join();
     return ER_OK;
 }
 
@@ -283,8 +321,11 @@ void AllJoynPeerObj::ExpandHeader(Message& msg, const qcc::String& receivedFrom)
     QStatus status = ER_OK;
     uint32_t token = msg->GetCompressionToken();
 
-    const HeaderFields* expFields = bus->GetInternal().GetCompressionRules()->GetExpansion(token);
-    if (!expFields) {
+    /*
+     * The expansion is copied since the rule can be removed while the messages are expanded.
+     */
+    HeaderFields expFields;
+    if (!bus->GetInternal().GetCompressionRules()->GetExpansion(token, expFields)) {
         Message replyMsg(*bus);
         MsgArg arg("u", token);
         /*
@@ -302,8 +343,7 @@ void AllJoynPeerObj::ExpandHeader(Message& msg, const qcc::String& receivedFrom)
         if (status == ER_OK) {
             status = replyMsg->AddExpansionRule(token, replyMsg->GetArg(0));
             if (status == ER_OK) {
-                expFields = bus->GetInternal().GetCompressionRules()->GetExpansion(token);
-                if (!expFields) {
+                if (!bus->GetInternal().GetCompressionRules()->GetExpansion(token, expFields)) {
                     status = ER_BUS_HDR_EXPANSION_INVALID;
                 }
             }
@@ -332,7 +372,7 @@ void AllJoynPeerObj::ExpandHeader(Message& msg, const qcc::String& receivedFrom)
              */
             for (size_t id = 0; id < ArraySize(msg->hdrFields.field); id++) {
                 if (HeaderFields::Compressible[id] && (msg->hdrFields.field[id].typeId == ALLJOYN_INVALID)) {
-                    msg->hdrFields.field[id] = expFields->field[id];
+                    msg->hdrFields.field[id] = expFields.field[id];
                 }
             }
             /*
@@ -370,6 +410,103 @@ QStatus AllJoynPeerObj::Get(const char* ifcName, const char* propName, MsgArg& v
     return status;
 }
 
+void AllJoynPeerObj::GetGroupKeyArg(uint8_t keyGenVersion, StringSink& snk, MsgArg& arg)
+{
+    assert(bus);
+    KeyBlob key;
+    bus->GetInternal().GetPeerStateTable()->GetGroupKey(key);
+    /*
+     * KeyGen version 0 exchanges key blobs, version 1 just exchanges the key
+     */
+    if (keyGenVersion == 0) {
+        key.Store(snk);
+        arg.Set("ay", snk.GetString().size(), snk.GetString().data());
+    } else {
+        assert(keyGenVersion == 1);
+        arg.Set("ay", key.GetSize(), key.GetData());
+    }
+}
+
+QStatus AllJoynPeerObj::SetGroupKey(PeerState& peerState, uint8_t keyGenVersion, Message& msg)
+{
+    QStatus status;
+    KeyBlob key;
+    if (keyGenVersion == 0) {
+        StringSource src(msg->GetArg(0)->v_scalarArray.v_byte, msg->GetArg(0)->v_scalarArray.numElements);
+        status = key.Load(src);
+    } else {
+        assert(keyGenVersion == 1);
+        status = key.Set(msg->GetArg(0)->v_scalarArray.v_byte, msg->GetArg(0)->v_scalarArray.numElements, KeyBlob::AES);
+    }
+    if (status == ER_OK) {
+        /*
+         * Tag the group key with the auth mechanism used by ExchangeGroupKeys. Group keys
+         * are inherently directional - only initiator encrypts with the group key. We set
+         * the role to NO_ROLE otherwise senders can't decrypt their own broadcast messages.
+         */
+        key.SetTag(msg->GetAuthMechanism(), KeyBlob::NO_ROLE);
+        peerState->SetKey(key, PEER_GROUP_KEY);
+    }
+    return status;
+}
+
+void AllJoynPeerObj::ExchangeGroupKeysReply(Message& msg, void* context)
+{
+    PeerState* peerState = static_cast<PeerState*>(context);
+    QStatus status = ER_AUTH_FAIL;
+    if (msg->GetType() == MESSAGE_METHOD_RET) {
+        status = SetGroupKey(*peerState, (*peerState)->GetAuthVersion() & 0xFF, msg);
+    }
+    if (status != ER_OK) {
+        QCC_LogError(status, ("ExchangeGroupKeys with %s failed", msg->GetSender()));
+    }
+    delete peerState;
+}
+
+void AllJoynPeerObj::AddResumeName(const qcc::String& name, const qcc::GUID128& guid)
+{
+    std::map<qcc::String, qcc::GUID128>::iterator it = resumeNames.find(name);
+    if (it != resumeNames.end()) {
+        if (it->second == guid) {
+            return;
+        }
+        RemoveResumeName(name);
+    }
+    std::map<qcc::GUID128, std::set<qcc::String> >::iterator peer = resumePeers.find(guid);
+    if (peer == resumePeers.end()) {
+        /*
+         * Make room by forgetting the peer with the lowest GUID, which is as good as random.
+         */
+        if (resumePeers.size() >= MAX_RESUME_GUIDS) {
+            std::map<qcc::GUID128, std::set<qcc::String> >::iterator oldest = resumePeers.begin();
+            for (std::set<qcc::String>::iterator n = oldest->second.begin(); n != oldest->second.end(); ++n) {
+                resumeNames.erase(*n);
+            }
+            resumePeers.erase(oldest);
+        }
+        peer = resumePeers.insert(std::pair<qcc::GUID128, std::set<qcc::String> >(guid, std::set<qcc::String>())).first;
+    } else if (peer->second.size() >= MAX_RESUME_NAMES) {
+        return;
+    }
+    peer->second.insert(name);
+    resumeNames[name] = guid;
+}
+
+void AllJoynPeerObj::RemoveResumeName(const qcc::String& name)
+{
+    std::map<qcc::String, qcc::GUID128>::iterator it = resumeNames.find(name);
+    if (it != resumeNames.end()) {
+        std::map<qcc::GUID128, std::set<qcc::String> >::iterator peer = resumePeers.find(it->second);
+        if (peer != resumePeers.end()) {
+            peer->second.erase(name);
+            if (peer->second.empty()) {
+                resumePeers.erase(peer);
+            }
+        }
+        resumeNames.erase(it);
+    }
+}
+
 void AllJoynPeerObj::ExchangeGroupKeys(const InterfaceDescription::Member* member, Message& msg)
 {
     assert(bus);
@@ -384,37 +521,21 @@ void AllJoynPeerObj::ExchangeGroupKeys(const InterfaceDescription::Member* membe
         PeerState peerState = peerStateTable->GetPeerState(msg->GetSender());
         uint8_t keyGenVersion = peerState->GetAuthVersion() & 0xFF;
         QCC_DbgHLPrintf(("ExchangeGroupKeys using key gen version %d", keyGenVersion));
-        /*
-         * KeyGen version 0 exchanges key blobs, version 1 just exchanges the key
-         */
-        KeyBlob key;
-        if (keyGenVersion == 0) {
-            StringSource src(msg->GetArg(0)->v_scalarArray.v_byte, msg->GetArg(0)->v_scalarArray.numElements);
-            status = key.Load(src);
-        } else {
-            assert(keyGenVersion == 1);
-            status = key.Set(msg->GetArg(0)->v_scalarArray.v_byte, msg->GetArg(0)->v_scalarArray.numElements, KeyBlob::AES);
-        }
+        status = SetGroupKey(peerState, keyGenVersion, msg);
         if (status == ER_OK) {
             /*
-             * Tag the group key with the auth mechanism used by ExchangeGroupKeys. Group keys
-             * are inherently directional - only initiator encrypts with the group key. We set
-             * the role to NO_ROLE otherwise senders can't decrypt their own broadcast messages.
+             * This call is encrypted so the remote peer has been authenticated. Remember its
+             * unique name so we can resume the session if we are the one to authenticate next.
              */
-            key.SetTag(msg->GetAuthMechanism(), KeyBlob::NO_ROLE);
-            peerState->SetKey(key, PEER_GROUP_KEY);
+            lock.Lock(MUTEX_CONTEXT);
+            AddResumeName(msg->GetSender(), peerState->GetGuid());
+            lock.Unlock(MUTEX_CONTEXT);
             /*
              * Return the local group key.
              */
-            peerStateTable->GetGroupKey(key);
             StringSink snk;
             MsgArg replyArg;
-            if (keyGenVersion == 0) {
-                key.Store(snk);
-                replyArg.Set("ay", snk.GetString().size(), snk.GetString().data());
-            } else {
-                replyArg.Set("ay", key.GetSize(), key.GetData());
-            }
+            GetGroupKeyArg(keyGenVersion, snk, replyArg);
             MethodReply(msg, &replyArg, 1);
         }
     } else {
@@ -538,6 +659,15 @@ void AllJoynPeerObj::GenSessionKey(const InterfaceDescription::Member* member, M
     if (bus->GetInternal().GetKeyStore().GetGuid() != localPeerGuid.ToString()) {
         MethodReply(msg, ER_BUS_NO_PEER_GUID);
     } else {
+        /*
+         * A peer that is resuming a session calls GenSessionKey without calling ExchangeGuids
+         * first. Its GUID is in the arguments and it will be using its preferred auth version. If
+         * that is not our preferred version the verifiers won't match and the remote peer will
+         * exchange GUIDs and try again.
+         */
+        if (peerState->GetAuthVersion() == 0) {
+            peerState->SetGuidAndAuthVersion(remotePeerGuid, PREFERRED_AUTH_VERSION);
+        }
         qcc::String nonce = RandHexString(NONCE_LEN);
         qcc::String verifier;
         status = KeyGen(peerState, msg->GetArg(2)->v_string.str + nonce, verifier, KeyBlob::RESPONDER);
@@ -676,6 +806,32 @@ void AllJoynPeerObj::ForceAuthentication(const qcc::String& busName)
 #define AUTH_TIMEOUT      120000
 #define DEFAULT_TIMEOUT   10000
 
+QStatus AllJoynPeerObj::ResumeSession(ProxyBusObject& remotePeerObj, const InterfaceDescription* ifc, const qcc::GUID128& remotePeerGuid, PeerState& resumeState, Message& replyMsg)
+{
+    assert(bus);
+    qcc::String localGuidStr = bus->GetInternal().GetKeyStore().GetGuid();
+    qcc::String remoteGuidStr = remotePeerGuid.ToString();
+    resumeState->SetGuidAndAuthVersion(remotePeerGuid, PREFERRED_AUTH_VERSION);
+    /*
+     * Generate a random string - this is the local half of the seed string.
+     */
+    qcc::String nonce = RandHexString(NONCE_LEN);
+    MsgArg args[3];
+    args[0].Set("s", localGuidStr.c_str());
+    args[1].Set("s", remoteGuidStr.c_str());
+    args[2].Set("s", nonce.c_str());
+    QStatus status = remotePeerObj.MethodCall(*(ifc->GetMember("GenSessionKey")), args, ArraySize(args), replyMsg, DEFAULT_TIMEOUT);
+    if (status == ER_OK) {
+        qcc::String verifier;
+        status = KeyGen(resumeState, nonce + replyMsg->GetArg(0)->v_string.str, verifier, KeyBlob::INITIATOR);
+        if ((status == ER_OK) && (verifier != replyMsg->GetArg(1)->v_string.str)) {
+            status = ER_AUTH_FAIL;
+        }
+    }
+    QCC_DbgHLPrintf(("ResumeSession %s %s", remoteGuidStr.c_str(), QCC_StatusText(status)));
+    return status;
+}
+
 QStatus AllJoynPeerObj::AuthenticatePeer(AllJoynMessageType msgType, const qcc::String& busName, bool wait)
 {
     assert(bus);
@@ -722,47 +878,87 @@ QStatus AllJoynPeerObj::AuthenticatePeer(AllJoynMessageType msgType, const qcc::
     ProxyBusObject remotePeerObj(*bus, busName.c_str(), org::alljoyn::Bus::Peer::ObjectPath, 0);
     remotePeerObj.AddInterface(*ifc);
 
+    uint64_t authStart = GetTimestamp64();
+    KeyStore& keyStore = bus->GetInternal().GetKeyStore();
+    qcc::String localGuidStr = keyStore.GetGuid();
+    Message replyMsg(*bus);
+    qcc::String sender;
+    qcc::GUID128 remotePeerGuid;
+    uint32_t authVersion = PREFERRED_AUTH_VERSION;
     /*
-     * Exchange GUIDs with the peer, this will get us the GUID of the remote peer and also the
-     * unique bus name from which we can determine if we have already have a session key, a
-     * master secret or if we have to start an authentication conversation.
+     * If we authenticated this peer before and still have the master secret we can resume the
+     * session: GenSessionKey is called straight away with the GUID we remember so the session key
+     * is established in a single round trip. Peers are remembered by GUID under every name they
+     * were reached by, and a well-known name follows its owner across reconnects. If the GUID is
+     * stale or the remote peer does not support resumption we exchange GUIDs and continue as
+     * normal.
      */
-    qcc::String localGuidStr = bus->GetInternal().GetKeyStore().GetGuid();
-    MsgArg args[2];
-    args[0].Set("s", localGuidStr.c_str());
-    args[1].Set("u", PREFERRED_AUTH_VERSION);
-    Message replyMsg(*bus);
-    status = remotePeerObj.MethodCall(*(ifc->GetMember("ExchangeGuids")), args, ArraySize(args), replyMsg, DEFAULT_TIMEOUT);
-    if (status != ER_OK) {
+    PeerState resumeState;
+    bool resumeTried = false;
+    bool resumed = false;
+    if (msgType == MESSAGE_METHOD_CALL) {
+        lock.Lock(MUTEX_CONTEXT);
+        std::map<qcc::String, qcc::GUID128>::iterator it = resumeNames.find(busName);
+        bool resume = (it != resumeNames.end());
+        if (resume) {
+            remotePeerGuid = it->second;
+        }
+        lock.Unlock(MUTEX_CONTEXT);
+        if (resume && keyStore.HasKey(remotePeerGuid)) {
+            resumeTried = true;
+            status = ResumeSession(remotePeerObj, ifc, remotePeerGuid, resumeState, replyMsg);
+            if (status == ER_OK) {
+                sender = replyMsg->GetSender();
+                resumed = true;
+            }
+        }
+        if (resume && !resumed) {
+            lock.Lock(MUTEX_CONTEXT);
+            RemoveResumeName(busName);
+            lock.Unlock(MUTEX_CONTEXT);
+        }
+    }
+    if (!resumed) {
         /*
-         * ER_BUS_REPLY_IS_ERROR_MESSAGE has a specific meaning in the public API and should not be
-         * propogated to the caller from this context.
+         * Exchange GUIDs with the peer, this will get us the GUID of the remote peer and also the
+         * unique bus name from which we can determine if we have already have a session key, a
+         * master secret or if we have to start an authentication conversation.
          */
-        if (status == ER_BUS_REPLY_IS_ERROR_MESSAGE) {
-            if (replyMsg->GetErrorName() != NULL && strcmp(replyMsg->GetErrorName(), "org.freedesktop.DBus.Error.ServiceUnknown") == 0) {
-                status = ER_BUS_NO_SUCH_OBJECT;
-            } else {
-                status = ER_AUTH_FAIL;
+        MsgArg args[2];
+        args[0].Set("s", localGuidStr.c_str());
+        args[1].Set("u", PREFERRED_AUTH_VERSION);
+        status = remotePeerObj.MethodCall(*(ifc->GetMember("ExchangeGuids")), args, ArraySize(args), replyMsg, DEFAULT_TIMEOUT);
+        if (status != ER_OK) {
+            /*
+             * ER_BUS_REPLY_IS_ERROR_MESSAGE has a specific meaning in the public API and should not be
+             * propogated to the caller from this context.
+             */
+            if (status == ER_BUS_REPLY_IS_ERROR_MESSAGE) {
+                if (replyMsg->GetErrorName() != NULL && strcmp(replyMsg->GetErrorName(), "org.freedesktop.DBus.Error.ServiceUnknown") == 0) {
+                    status = ER_BUS_NO_SUCH_OBJECT;
+                } else {
+                    status = ER_AUTH_FAIL;
+                }
             }
+            QCC_LogError(status, ("ExchangeGuids failed"));
+            return status;
+        }
+        sender = replyMsg->GetSender();
+        /*
+         * Extract the remote guid from the message
+         */
+        remotePeerGuid = qcc::GUID128(replyMsg->GetArg(0)->v_string.str);
+        authVersion = replyMsg->GetArg(1)->v_uint32;
+        /*
+         * Check that we can support the version the remote peer proposed.
+         */
+        if (!IsCompatibleVersion(authVersion)) {
+            status = ER_BUS_PEER_AUTH_VERSION_MISMATCH;
+            QCC_LogError(status, ("ExchangeGuids incompatible authentication version %u", authVersion));
+            return status;
         }
-        QCC_LogError(status, ("ExchangeGuids failed"));
-        return status;
     }
-    const qcc::String sender = replyMsg->GetSender();
-    /*
-     * Extract the remote guid from the message
-     */
-    qcc::GUID128 remotePeerGuid(replyMsg->GetArg(0)->v_string.str);
-    uint32_t authVersion = replyMsg->GetArg(1)->v_uint32;
     qcc::String remoteGuidStr = remotePeerGuid.ToString();
-    /*
-     * Check that we can support the version the remote peer proposed.
-     */
-    if (!IsCompatibleVersion(authVersion)) {
-        status = ER_BUS_PEER_AUTH_VERSION_MISMATCH;
-        QCC_LogError(status, ("ExchangeGuids incompatible authentication version %u", authVersion));
-        return status;
-    }
     QCC_DbgHLPrintf(("ExchangeGuids Local %s", localGuidStr.c_str()));
     QCC_DbgHLPrintf(("ExchangeGuids Remote %s", remoteGuidStr.c_str()));
     QCC_DbgHLPrintf(("ExchangeGuids AuthVersion %d", authVersion));
@@ -834,10 +1030,23 @@ QStatus AllJoynPeerObj::AuthenticatePeer(AllJoynMessageType msgType, const qcc::
     peerState->SetAuthEvent(&authEvent);
     lock.Unlock(MUTEX_CONTEXT);
 
-    KeyStore& keyStore = bus->GetInternal().GetKeyStore();
     bool authTried = false;
     bool firstPass = true;
     do {
+        /*
+         * If the session was resumed we already have the session key.
+         */
+        if (resumed) {
+            KeyBlob sessionKey;
+            status = resumeState->GetKey(sessionKey, PEER_SESSION_KEY);
+            if (status == ER_OK) {
+                memcpy(peerState->authorizations, resumeState->authorizations, sizeof(peerState->authorizations));
+                peerState->SetKey(sessionKey, PEER_SESSION_KEY);
+                break;
+            }
+            status = ER_OK;
+            resumed = false;
+        }
         /*
          * Try to load the master secret for the remote peer. It is possible that the master secret
          * has expired or been deleted either locally or remotely so if we fail to establish a
@@ -932,42 +1141,29 @@ QStatus AllJoynPeerObj::AuthenticatePeer(AllJoynMessageType msgType, const qcc::
     } while (status == ER_OK);
     /*
      * Exchange group keys with the remote peer. This method call is encrypted using the session key
-     * that we just established.
+     * that we just established. A resumed session does not wait for the reply so it is established
+     * in a single round trip. The remote peer gets our group key before any message we send it
+     * under the new session key, we get its group key one round trip later.
      */
     if (status == ER_OK) {
         uint8_t keyGenVersion = authVersion & 0xFF;
-        Message replyMsg(*bus);
-        KeyBlob key;
-        peerStateTable->GetGroupKey(key);
         StringSink snk;
         MsgArg arg;
-        /*
-         * KeyGen version 0 exchanges key blobs, version 1 just exchanges the key
-         */
         QCC_DbgHLPrintf(("ExchangeGroupKeys using key gen version %d", keyGenVersion));
-        if (keyGenVersion == 0) {
-            key.Store(snk);
-            arg.Set("ay", snk.GetString().size(), snk.GetString().data());
-        } else {
-            assert(keyGenVersion == 1);
-            arg.Set("ay", key.GetSize(), key.GetData());
-        }
-        status = remotePeerObj.MethodCall(*(ifc->GetMember("ExchangeGroupKeys")), &arg, 1, replyMsg, DEFAULT_TIMEOUT, ALLJOYN_FLAG_ENCRYPTED);
-        if (status == ER_OK) {
-            if (keyGenVersion == 0) {
-                StringSource src(replyMsg->GetArg(0)->v_scalarArray.v_byte, replyMsg->GetArg(0)->v_scalarArray.numElements);
-                status = key.Load(src);
-            } else {
-                status = key.Set(replyMsg->GetArg(0)->v_scalarArray.v_byte, replyMsg->GetArg(0)->v_scalarArray.numElements, KeyBlob::AES);
+        GetGroupKeyArg(keyGenVersion, snk, arg);
+        if (resumed) {
+            PeerState* context = new PeerState(peerState);
+            status = remotePeerObj.MethodCallAsync(*(ifc->GetMember("ExchangeGroupKeys")), this,
+                                                   static_cast<MessageReceiver::ReplyHandler>(&AllJoynPeerObj::ExchangeGroupKeysReply),
+                                                   &arg, 1, context, DEFAULT_TIMEOUT, ALLJOYN_FLAG_ENCRYPTED);
+            if (status != ER_OK) {
+                delete context;
             }
+        } else {
+            Message replyMsg(*bus);
+            status = remotePeerObj.MethodCall(*(ifc->GetMember("ExchangeGroupKeys")), &arg, 1, replyMsg, DEFAULT_TIMEOUT, ALLJOYN_FLAG_ENCRYPTED);
             if (status == ER_OK) {
-                /*
-                 * Tag the group key with the auth mechanism used by ExchangeGroupKeys. Group keys
-                 * are inherently directional - only initiator encrypts with the group key. We set
-                 * the role to NO_ROLE otherwise senders can't decrypt their own broadcast messages.
-                 */
-                key.SetTag(replyMsg->GetAuthMechanism(), KeyBlob::NO_ROLE);
-                peerState->SetKey(key, PEER_GROUP_KEY);
+                status = SetGroupKey(peerState, keyGenVersion, replyMsg);
             }
         }
     }
@@ -977,6 +1173,35 @@ QStatus AllJoynPeerObj::AuthenticatePeer(AllJoynMessageType msgType, const qcc::
     if (authTried) {
         peerAuthListener.AuthenticationComplete(mech.c_str(), sender.c_str(), status == ER_OK);
     }
+    /*
+     * Remember the remote peer GUID so the session can be resumed the next time and update the
+     * statistics.
+     */
+    uint32_t authTime = static_cast<uint32_t>(GetTimestamp64() - authStart);
+    lock.Lock(MUTEX_CONTEXT);
+    if (resumeTried) {
+        ++authStats.resumeAttempts;
+    }
+    if (resumed) {
+        ++authStats.resumeHits;
+    }
+    if (status == ER_OK) {
+        AddResumeName(busName, remotePeerGuid);
+        AddResumeName(sender, remotePeerGuid);
+        if (resumed) {
+            authStats.resumeTime += authTime;
+        } else if (authTried) {
+            ++authStats.conversations;
+            authStats.conversationTime += authTime;
+        } else {
+            ++authStats.keyGens;
+            authStats.keyGenTime += authTime;
+        }
+        authStats.maxTime = max(authStats.maxTime, authTime);
+    } else {
+        ++authStats.failures;
+    }
+    lock.Unlock(MUTEX_CONTEXT);
     /*
      * ER_BUS_REPLY_IS_ERROR_MESSAGE has a specific meaning in the public API an should not be
      * propogated to the caller from this context.
@@ -997,6 +1222,22 @@ QStatus AllJoynPeerObj::AuthenticatePeer(AllJoynMessageType msgType, const qcc::
     return status;
 }
 
+void AllJoynPeerObj::GetAuthStats(AuthStats& stats)
+{
+    lock.Lock(MUTEX_CONTEXT);
+    stats = authStats;
+    lock.Unlock(MUTEX_CONTEXT);
+}
+
+uint32_t AllJoynPeerObj::GetResumptionHitRate()
+{
+    lock.Lock(MUTEX_CONTEXT);
+    uint64_t hits = authStats.resumeHits;
+    uint64_t attempts = authStats.resumeAttempts;
+    lock.Unlock(MUTEX_CONTEXT);
+    return attempts ? static_cast<uint32_t>((hits * 100) / attempts) : 0;
+}
+
 QStatus AllJoynPeerObj::AuthenticatePeerAsync(const qcc::String& busName)
 {
     assert(bus);
@@ -1008,16 +1249,28 @@ QStatus AllJoynPeerObj::DispatchRequest(Message& msg, RequestType reqType, const
 {
     QStatus status;
     QCC_DbgHLPrintf(("DispatchRequest %s", msg->Description().c_str()));
+    qcc::Timer& timer = (reqType == EXPAND_HEADER) ? dispatcher : authDispatcher;
     lock.Lock(MUTEX_CONTEXT);
-    if (dispatcher.IsRunning()) {
+    if (!timer.IsRunning()) {
+        status = ER_BUS_STOPPING;
+    } else if ((&timer == &authDispatcher) && (authStats.pending >= MAX_PENDING_AUTH) &&
+               (((reqType == AUTH_CHALLENGE) && (conversations.find(msg->GetSender()) == conversations.end())) || (reqType == SECURE_CONNECTION))) {
+        /*
+         * Apply back-pressure by refusing to start any more authentications until the queue drains.
+         */
+        ++authStats.rejected;
+        status = ER_BUS_AUTH_QUEUE_FULL;
+    } else {
         Request* req = new Request(msg, reqType, data);
+        req->queued = GetTimestamp64();
         qcc::AlarmListener* alljoynPeerListener = this;
-        status = dispatcher.AddAlarm(Alarm(alljoynPeerListener, req));
+        status = timer.AddAlarm(Alarm(alljoynPeerListener, req));
         if (status != ER_OK) {
             delete req;
+        } else if (&timer == &authDispatcher) {
+            ++authStats.pending;
+            authStats.maxPending = max(authStats.maxPending, authStats.pending);
         }
-    } else {
-        status = ER_BUS_STOPPING;
     }
     lock.Unlock(MUTEX_CONTEXT);
     return status;
@@ -1030,6 +1283,7 @@ void AllJoynPeerObj::AlarmTriggered(const Alarm& alarm, QStatus reason)
     assert(bus);
     QCC_DbgHLPrintf(("AllJoynPeerObj::AlarmTriggered"));
     Request* req = static_cast<Request*>(alarm->GetContext());
+    uint64_t start = GetTimestamp64();
 
     switch (req->reqType) {
     case AUTHENTICATE_PEER:
@@ -1106,6 +1360,14 @@ void AllJoynPeerObj::AlarmTriggered(const Alarm& alarm, QStatus reason)
         break;
     }
 
+    if (req->reqType != EXPAND_HEADER) {
+        uint64_t now = GetTimestamp64();
+        lock.Lock(MUTEX_CONTEXT);
+        --authStats.pending;
+        AddToHistogram(authStats.queueTime, static_cast<uint32_t>(start - req->queued));
+        AddToHistogram(authStats.runTime, static_cast<uint32_t>(now - start));
+        lock.Unlock(MUTEX_CONTEXT);
+    }
     delete req;
     QCC_DbgHLPrintf(("AllJoynPeerObj::AlarmTriggered - exiting"));
     return;
@@ -1149,6 +1411,21 @@ void AllJoynPeerObj::NameOwnerChanged(const char* busName, const char* previousO
 {
     assert(bus);
 
+    /*
+     * A well-known name of a peer we can resume a session with now also reaches the peer under its
+     * new unique name, which is how a peer that reconnected is found again. Unique names are never
+     * reused so those are forgotten when they go away.
+     */
+    lock.Lock(MUTEX_CONTEXT);
+    if (busName[0] != ':') {
+        std::map<qcc::String, qcc::GUID128>::iterator it = resumeNames.find(busName);
+        if ((it != resumeNames.end()) && newOwner) {
+            AddResumeName(newOwner, it->second);
+        }
+    } else if (newOwner == NULL) {
+        RemoveResumeName(busName);
+    }
+    lock.Unlock(MUTEX_CONTEXT);
     /*
      * We are only interested in names that no longer have an owner.
      */
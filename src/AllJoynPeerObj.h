@@ -25,10 +25,12 @@
 #include <qcc/platform.h>
 
 #include <map>
+#include <set>
 #include <deque>
 
 #include <qcc/GUID.h>
 #include <qcc/String.h>
+#include <qcc/StringSink.h>
 #include <qcc/Timer.h>
 #include <qcc/KeyBlob.h>
 
@@ -46,6 +48,7 @@ namespace ajn {
 /* Forward declaration */
 class SASLEngine;
 class BusAttachment;
+class ProxyBusObject;
 
 /**
  * The AllJoynPeer object @c /org/alljoyn/Bus/Peer implements interfaces that provide AllJoyn
@@ -56,6 +59,32 @@ class BusAttachment;
 class AllJoynPeerObj : public BusObject, public BusListener, public qcc::AlarmListener {
   public:
 
+    /**
+     * Number of buckets in the authentication latency histograms. Bucket i counts times of less
+     * than 2^i milliseconds, the last bucket counts all longer times.
+     */
+    static const size_t AUTH_HISTOGRAM_BUCKETS = 16;
+
+    /**
+     * Peer authentication statistics.
+     */
+    struct AuthStats {
+        uint32_t resumeAttempts;    /**< Number of authentications that tried to resume a session without exchanging GUIDs */
+        uint32_t resumeHits;        /**< Number of resumptions that established a session key in a single round trip */
+        uint32_t keyGens;           /**< Number of authentications that generated a session key from a stored master secret after exchanging GUIDs */
+        uint32_t conversations;     /**< Number of authentications that needed an authentication conversation */
+        uint32_t failures;          /**< Number of authentications that failed */
+        uint64_t resumeTime;        /**< Total time in milliseconds of the successful authentications that resumed a session */
+        uint64_t keyGenTime;        /**< Total time in milliseconds of the successful authentications counted in keyGens */
+        uint64_t conversationTime;  /**< Total time in milliseconds of the successful authentications counted in conversations */
+        uint32_t maxTime;           /**< Longest successful authentication in milliseconds */
+        uint32_t pending;           /**< Number of requests currently queued or running on the authentication threads */
+        uint32_t maxPending;        /**< Largest number of requests that were queued or running at once */
+        uint32_t rejected;          /**< Number of new authentication conversations refused because the queue was full */
+        uint32_t queueTime[AUTH_HISTOGRAM_BUCKETS]; /**< Histogram of the time requests waited for an authentication thread */
+        uint32_t runTime[AUTH_HISTOGRAM_BUCKETS];   /**< Histogram of the time taken to process each request */
+    };
+
     /**
      * Constructor
      *
@@ -200,6 +229,20 @@ class AllJoynPeerObj : public BusObject, public BusListener, public qcc::AlarmLi
      */
     void AlarmTriggered(const qcc::Alarm& alarm, QStatus reason);
 
+    /**
+     * Get the peer authentication statistics.
+     *
+     * @param stats  [OUT] Returns the statistics.
+     */
+    void GetAuthStats(AuthStats& stats);
+
+    /**
+     * Get the percentage of session resumptions that established a session key.
+     *
+     * @return  The resumption hit rate in percent.
+     */
+    uint32_t GetResumptionHitRate();
+
     /**
      * Destructor
      */
@@ -222,7 +265,8 @@ class AllJoynPeerObj : public BusObject, public BusListener, public qcc::AlarmLi
         Message msg;
         RequestType reqType;
         const qcc::String data;
-        Request(const Message& msg, RequestType type, const qcc::String& data) : msg(msg), reqType(type), data(data) { }
+        uint64_t queued;   /* Time the request was queued */
+        Request(const Message& msg, RequestType type, const qcc::String& data) : msg(msg), reqType(type), data(data), queued(0) { }
     };
 
     /**
@@ -288,6 +332,64 @@ class AllJoynPeerObj : public BusObject, public BusListener, public qcc::AlarmLi
      */
     QStatus KeyGen(PeerState& peerState, qcc::String seed, qcc::String& verifier, qcc::KeyBlob::Role role);
 
+    /**
+     * Resume a session with a peer that was authenticated before by generating a new session key
+     * from the stored master secret without exchanging GUIDs first.
+     *
+     * @param remotePeerObj   Proxy for the remote peer object.
+     * @param ifc             The peer authentication interface.
+     * @param remotePeerGuid  The GUID the remote peer had when it was last authenticated.
+     * @param resumeState     Peer state that returns the session key if the session was resumed.
+     * @param replyMsg        Returns the GenSessionKey reply.
+     *
+     * @return
+     *      - ER_OK if a session key was established.
+     *      - An error status if the GUIDs must be exchanged instead.
+     */
+    QStatus ResumeSession(ProxyBusObject& remotePeerObj, const InterfaceDescription* ifc, const qcc::GUID128& remotePeerGuid, PeerState& resumeState, Message& replyMsg);
+
+    /**
+     * Build the argument for an ExchangeGroupKeys method call or reply carrying the local group key.
+     *
+     * @param keyGenVersion  The key generation version agreed with the remote peer.
+     * @param snk            Sink that holds the marshaled key blob for key gen version 0.
+     * @param arg            Returns the argument.
+     */
+    void GetGroupKeyArg(uint8_t keyGenVersion, qcc::StringSink& snk, MsgArg& arg);
+
+    /**
+     * Store the group key a remote peer sent in an ExchangeGroupKeys method call or reply.
+     *
+     * @param peerState      The peer state of the remote peer.
+     * @param keyGenVersion  The key generation version agreed with the remote peer.
+     * @param msg            The message carrying the remote group key.
+     */
+    QStatus SetGroupKey(PeerState& peerState, uint8_t keyGenVersion, Message& msg);
+
+    /**
+     * Reply handler for the ExchangeGroupKeys method call made after a session was resumed.
+     *
+     * @param msg      The reply message.
+     * @param context  The PeerState of the remote peer.
+     */
+    void ExchangeGroupKeysReply(Message& msg, void* context);
+
+    /**
+     * Remember a bus name the remote peer with the given GUID can be resumed by. Must be called
+     * with the lock held.
+     *
+     * @param name  A unique or well-known name of the remote peer.
+     * @param guid  The GUID of the remote peer.
+     */
+    void AddResumeName(const qcc::String& name, const qcc::GUID128& guid);
+
+    /**
+     * Forget a bus name of a remote peer. Must be called with the lock held.
+     *
+     * @param name  The name to forget.
+     */
+    void RemoveResumeName(const qcc::String& name);
+
     /**
      * Get a property from this object
      * @param ifcName the name of the interface
@@ -365,11 +467,26 @@ class AllJoynPeerObj : public BusObject, public BusListener, public qcc::AlarmLi
     /** Dispatcher for handling peer object requests */
     qcc::Timer dispatcher;
 
+    /**
+     * Dispatcher for authentication requests. Key exchanges are computationally expensive and may
+     * wait for user input so they run on their own threads and cannot hold up header expansion.
+     */
+    qcc::Timer authDispatcher;
+
     /** Queue of encrypted messages waiting for an authentication to complete */
     std::deque<Message> msgsPendingAuth;
 
     /** Queue of compressed messages waiting for an expansion rule to be supplied */
     std::deque<Message> msgsPendingExpansion;
+
+    /** Remote peers whose sessions can be resumed indexed by GUID with the bus names each peer is known by */
+    std::map<qcc::GUID128, std::set<qcc::String> > resumePeers;
+
+    /** GUIDs of the remote peers in resumePeers indexed by bus name */
+    std::map<qcc::String, qcc::GUID128> resumeNames;
+
+    /** Peer authentication statistics */
+    AuthStats authStats;
 };
 
 }
@@ -0,0 +1,181 @@
+/**
+ * @file
+ *
+ * This file implements the process-wide pool of size-classed buffers.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <qcc/atomic.h>
+#include <qcc/Debug.h>
+#include <qcc/Mutex.h>
+
+#include "BufferPool.h"
+
+#define QCC_MODULE "ALLJOYN"
+
+using namespace qcc;
+
+namespace ajn {
+
+/* Smallest size class is 2^MIN_CLASS_SHIFT bytes */
+static const uint32_t MIN_CLASS_SHIFT = 6;
+
+/* Number of size classes, the largest is 64K */
+static const uint32_t NUM_CLASSES = 11;
+
+/* Approximate number of bytes cached in each size class */
+static const size_t MAX_CACHED_BYTES = 512 * 1024;
+
+/* Limits on the number of buffers cached in each size class */
+static const size_t MIN_CACHED = 8;
+static const size_t MAX_CACHED = 256;
+
+/*
+ * Each buffer is preceded by a 64 bit header that records its size class. The header also keeps
+ * the buffer 8 byte aligned.
+ */
+static const size_t HEADER_SIZE = sizeof(uint64_t);
+
+/*
+ * The free buffers of one size class. Each class has its own lock so allocations of different
+ * sizes never contend and the lock is only held to push or pop a pointer.
+ */
+class SizeClass {
+  public:
+    SizeClass() : size(0), maxFree(0), numFree(0), freeList(NULL) { }
+
+    void Init(size_t sz)
+    {
+        size = sz;
+        maxFree = MAX_CACHED_BYTES / size;
+        if (maxFree < MIN_CACHED) {
+            maxFree = MIN_CACHED;
+        } else if (maxFree > MAX_CACHED) {
+            maxFree = MAX_CACHED;
+        }
+        freeList = new uint64_t*[maxFree];
+    }
+
+    size_t size;           /**< Usable size of the buffers in this class */
+    size_t maxFree;        /**< Maximum number of free buffers kept */
+    size_t numFree;        /**< Number of free buffers */
+    uint64_t** freeList;   /**< Stack of free buffers */
+    qcc::Mutex lock;       /**< Protects numFree and freeList */
+};
+
+/*
+ * The pool is created during static initialization and never destroyed so buffers can safely be
+ * released by objects that are destroyed during process exit. Allocations made before the pool
+ * exists go to the heap.
+ */
+class Pool {
+  public:
+    Pool()
+    {
+        for (uint32_t i = 0; i < NUM_CLASSES; ++i) {
+            classes[i].Init((size_t)1 << (MIN_CLASS_SHIFT + i));
+        }
+    }
+    SizeClass classes[NUM_CLASSES];
+};
+
+static Pool* pool = new Pool();
+
+static volatile int32_t hits = 0;
+static volatile int32_t misses = 0;
+static volatile int32_t discards = 0;
+
+/*
+ * Return the smallest size class that can hold size bytes or NUM_CLASSES if size is larger than
+ * the largest class. NUM_CLASSES is also recorded in the header of buffers allocated from the heap.
+ */
+static inline uint32_t ClassIndex(size_t size)
+{
+    uint32_t index = 0;
+    size_t classSize = (size_t)1 << MIN_CLASS_SHIFT;
+    while ((classSize < size) && (index < NUM_CLASSES)) {
+        classSize <<= 1;
+        ++index;
+    }
+    return index;
+}
+
+uint8_t* BufferPool::Alloc(size_t size)
+{
+    uint32_t index = pool ? ClassIndex(size) : NUM_CLASSES;
+    uint64_t* buf = NULL;
+    if (index < NUM_CLASSES) {
+        SizeClass& sc = pool->classes[index];
+        sc.lock.Lock(MUTEX_CONTEXT);
+        if (sc.numFree) {
+            buf = sc.freeList[--sc.numFree];
+        }
+        sc.lock.Unlock(MUTEX_CONTEXT);
+    }
+    if (buf) {
+        IncrementAndFetch(&hits);
+    } else {
+        size_t sz = (index < NUM_CLASSES) ? pool->classes[index].size : size;
+        buf = new uint64_t[(HEADER_SIZE + sz + sizeof(uint64_t) - 1) / sizeof(uint64_t)];
+        buf[0] = index;
+        if ((IncrementAndFetch(&misses) & 0xFFF) == 0) {
+            QCC_DbgPrintf(("BufferPool hit rate %u%%", GetHitRate()));
+        }
+    }
+    return reinterpret_cast<uint8_t*>(buf + 1);
+}
+
+void BufferPool::Free(void* ptr)
+{
+    if (!ptr) {
+        return;
+    }
+    uint64_t* buf = reinterpret_cast<uint64_t*>(ptr) - 1;
+    uint64_t index = buf[0];
+    if (index < NUM_CLASSES) {
+        SizeClass& sc = pool->classes[index];
+        sc.lock.Lock(MUTEX_CONTEXT);
+        if (sc.numFree < sc.maxFree) {
+            sc.freeList[sc.numFree++] = buf;
+            buf = NULL;
+        }
+        sc.lock.Unlock(MUTEX_CONTEXT);
+        if (buf) {
+            IncrementAndFetch(&discards);
+        }
+    }
+    delete [] buf;
+}
+
+void BufferPool::GetStats(Stats& stats)
+{
+    stats.hits = static_cast<uint32_t>(hits);
+    stats.misses = static_cast<uint32_t>(misses);
+    stats.discards = static_cast<uint32_t>(discards);
+}
+
+uint32_t BufferPool::GetHitRate()
+{
+    uint64_t h = static_cast<uint32_t>(hits);
+    uint64_t total = h + static_cast<uint32_t>(misses);
+    return total ? static_cast<uint32_t>((h * 100) / total) : 0;
+}
+
+}
@@ -0,0 +1,83 @@
+#ifndef _ALLJOYN_BUFFERPOOL_H
+#define _ALLJOYN_BUFFERPOOL_H
+/**
+ * @file
+ *
+ * This file defines a process-wide pool of size-classed buffers used for
+ * message buffers and unmarshaled array data.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#ifndef __cplusplus
+#error Only include BufferPool.h in C++ code.
+#endif
+
+#include <qcc/platform.h>
+
+namespace ajn {
+
+/**
+ * BufferPool recycles buffers in power of two size classes so that a steady stream of messages
+ * of similar sizes is marshaled and unmarshaled without heap allocation. Buffers larger than the
+ * largest size class are allocated from the heap. Buffers are 8 byte aligned.
+ */
+class BufferPool {
+  public:
+
+    /**
+     * Pool statistics.
+     */
+    struct Stats {
+        uint32_t hits;      /**< Number of allocations satisfied from the pool */
+        uint32_t misses;    /**< Number of allocations that went to the heap */
+        uint32_t discards;  /**< Number of released buffers that were freed because their size class was full */
+    };
+
+    /**
+     * Allocate a buffer.
+     *
+     * @param size   Minimum size of the buffer in bytes.
+     * @return  The buffer. The buffer must be released by calling Free().
+     */
+    static uint8_t* Alloc(size_t size);
+
+    /**
+     * Release a buffer that was allocated by Alloc().
+     *
+     * @param buf   The buffer to release (may be NULL).
+     */
+    static void Free(void* buf);
+
+    /**
+     * Get the pool statistics.
+     *
+     * @param stats  [OUT] Returns the statistics.
+     */
+    static void GetStats(Stats& stats);
+
+    /**
+     * Get the percentage of allocations that were satisfied from the pool.
+     *
+     * @return  The hit rate in percent.
+     */
+    static uint32_t GetHitRate();
+};
+
+}
+
+#endif
@@ -23,6 +23,7 @@
 #include <qcc/Util.h>
 #include <qcc/Event.h>
 #include <qcc/String.h>
+#include <qcc/Thread.h>
 #include <qcc/Timer.h>
 #include <qcc/atomic.h>
 #include <qcc/XmlElement.h>
@@ -63,6 +64,8 @@
 
 #define QCC_MODULE "ALLJOYN"
 
+/* Maximum number of concurrent callbacks on each iodispatch shard */
+static const uint32_t IODISPATCH_CONCURRENCY = 128;
 
 using namespace std;
 using namespace qcc;
@@ -109,8 +112,10 @@ BusAttachment::Internal::Internal(const char* appName,
     bus(bus),
     listenersLock(),
     listeners(),
-    m_ioDispatch("iodisp", 128),
-    transportList(bus, factories, &m_ioDispatch, concurrency),
+    m_ioDispatch("iodisp", IODISPATCH_CONCURRENCY),
+    m_ioDispatchers(1, &m_ioDispatch),
+    m_nextIODispatch(0),
+    transportList(bus, factories, m_ioDispatchers, concurrency),
     keyStore(application),
     authManager(keyStore),
     globalGuid(qcc::GUID128()),
@@ -120,7 +125,8 @@ BusAttachment::Internal::Internal(const char* appName,
     allowRemoteMessages(allowRemoteMessages),
     listenAddresses(listenAddresses ? listenAddresses : ""),
     stopLock(),
-    stopCount(0)
+    stopCount(0),
+    numSyncReplyContexts(0)
 {
     /*
      * Bus needs a pointer to this internal object.
@@ -152,6 +158,93 @@ BusAttachment::Internal::~Internal()
     transportList.Join();
     delete router;
     router = NULL;
+
+    for (size_t i = 0; i < NUM_SYNC_REPLY_SLOTS; ++i) {
+        delete syncReplySlots[i].ctx;
+        syncReplySlots[i].ctx = NULL;
+    }
+
+    /* The first shard is m_ioDispatch */
+    for (size_t i = 1; i < m_ioDispatchers.size(); ++i) {
+        delete m_ioDispatchers[i];
+    }
+}
+
+IODispatch& BusAttachment::Internal::AssignIODispatch(void)
+{
+    if (m_ioDispatchers.size() == 1) {
+        return m_ioDispatch;
+    }
+    uint32_t n = static_cast<uint32_t>(IncrementAndFetch(&m_nextIODispatch));
+    return *m_ioDispatchers[n % m_ioDispatchers.size()];
+}
+
+BusAttachment::Internal::SyncReplyContext* BusAttachment::Internal::AcquireSyncReplyContext(Thread* thread)
+{
+    SyncReplyContext* ctx = NULL;
+    size_t start = static_cast<size_t>(reinterpret_cast<uintptr_t>(thread) / sizeof(Thread));
+    for (size_t i = 0; i < NUM_SYNC_REPLY_SLOTS; ++i) {
+        SyncReplySlot& slot = syncReplySlots[(start + i) % NUM_SYNC_REPLY_SLOTS];
+        /*
+         * A claim count of 1 means nobody else owns or is probing the slot.
+         */
+        if (IncrementAndFetch(&slot.claims) == 1) {
+            if (!slot.ctx) {
+                slot.ctx = new SyncReplyContext(bus, &slot.claims);
+                IncrementAndFetch(&numSyncReplyContexts);
+            }
+            ctx = slot.ctx;
+            break;
+        }
+        DecrementAndFetch(&slot.claims);
+    }
+    /*
+     * All the slots are in use so this call gets a context of its own.
+     */
+    if (!ctx) {
+        ctx = new SyncReplyContext(bus, NULL);
+    }
+    ctx->refs = 2;
+    return ctx;
+}
+
+void BusAttachment::Internal::ReleaseSyncReplyContext(SyncReplyContext* ctx)
+{
+    if (DecrementAndFetch(&ctx->refs) == 0) {
+        if (ctx->slot) {
+            /*
+             * Don't hold on to the reply and reset the event for the next method call.
+             */
+            ctx->replyMsg = ctx->emptyMsg;
+            ctx->event.ResetEvent();
+            DecrementAndFetch(ctx->slot);
+        } else {
+            delete ctx;
+        }
+    }
+}
+
+QStatus BusAttachment::Internal::SetIODispatchShards(uint32_t shards)
+{
+    if (bus.IsStarted()) {
+        return ER_BUS_BUS_ALREADY_STARTED;
+    }
+    if (shards == 0) {
+        shards = 1;
+    }
+    while (m_ioDispatchers.size() > shards) {
+        delete m_ioDispatchers.back();
+        m_ioDispatchers.pop_back();
+    }
+    /*
+     * The callback threads of each shard are only created as they are needed so every shard gets
+     * the same concurrency as a single iodispatch would.
+     */
+    while (m_ioDispatchers.size() < shards) {
+        qcc::String name = "iodisp-" + U32ToString(static_cast<uint32_t>(m_ioDispatchers.size()));
+        m_ioDispatchers.push_back(new IODispatch(name.c_str(), IODISPATCH_CONCURRENCY));
+    }
+    return ER_OK;
 }
 
 /*
@@ -32,9 +32,11 @@
 #include <qcc/atomic.h>
 #include <qcc/ManagedObj.h>
 #include <qcc/IODispatch.h>
+#include <qcc/Mutex.h>
 
 #include <alljoyn/BusAttachment.h>
 #include <alljoyn/InterfaceDescription.h>
+#include <alljoyn/Message.h>
 
 #include "AuthManager.h"
 #include "ClientRouter.h"
@@ -130,6 +132,29 @@ class BusAttachment::Internal : public MessageReceiver, public JoinSessionAsyncC
      * @return  The iodispatch
      */
     qcc::IODispatch& GetIODispatch(void) { return m_ioDispatch; }
+
+    /**
+     * Get the iodispatch a new stream should be registered with. Streams are spread round-robin
+     * over the iodispatch shards. A stream must stay on the shard it was given so callbacks for
+     * the stream are still delivered in order.
+     *
+     * @return  The iodispatch for a new stream
+     */
+    qcc::IODispatch& AssignIODispatch(void);
+
+    /**
+     * Set the number of iodispatch shards. Each shard runs its own event loop so the streams of
+     * a bus with many connections are not all serviced by a single thread. Must be called
+     * before the bus is started.
+     *
+     * @param shards   Number of iodispatch shards, 0 is treated as 1.
+     *
+     * @return
+     *      - #ER_OK if the number of shards was set.
+     *      - #ER_BUS_BUS_ALREADY_STARTED if the bus has already been started.
+     */
+    QStatus SetIODispatchShards(uint32_t shards);
+
     /**
      * Get the header compression rules
      *
@@ -142,6 +167,55 @@ class BusAttachment::Internal : public MessageReceiver, public JoinSessionAsyncC
      */
     void OverrideCompressionRules(CompressionRules& newRules) { compressionRules = newRules; }
 
+    /**
+     * Context used between a synchronous method call and its reply handler. Contexts are
+     * recycled so a synchronous method call does not create an event and a reply message
+     * every time.
+     */
+    class SyncReplyContext {
+      public:
+        SyncReplyContext(BusAttachment& bus, volatile int32_t* slot) : replyMsg(bus), emptyMsg(replyMsg), refs(0), slot(slot) { }
+        Message replyMsg;          /**< The method reply */
+        qcc::Event event;          /**< Set when the method reply has been received */
+        Message emptyMsg;          /**< Stands in for replyMsg while the context is not in use */
+        volatile int32_t refs;     /**< References held by the calling thread and the reply handler */
+        volatile int32_t* slot;    /**< Claim count of the pool slot holding the context or NULL */
+    };
+
+    /**
+     * Number of slots in the synchronous method call context pool
+     */
+    static const size_t NUM_SYNC_REPLY_SLOTS = 16;
+
+    /**
+     * Get a context for a synchronous method call. The context starts with two references, one
+     * for the calling thread and one for the reply handler.
+     *
+     * Each calling thread starts looking for a free context at a slot picked from its thread
+     * so concurrent callers normally claim different slots. Slots are claimed with atomic
+     * operations, no lock is taken.
+     *
+     * @param thread  The calling thread.
+     *
+     * @return  A context that must be released by each of its holders.
+     */
+    SyncReplyContext* AcquireSyncReplyContext(qcc::Thread* thread);
+
+    /**
+     * Release a reference to a synchronous method call context. The context is recycled when
+     * the last reference is released.
+     *
+     * @param ctx  The context to release.
+     */
+    void ReleaseSyncReplyContext(SyncReplyContext* ctx);
+
+    /**
+     * Get the number of contexts that have been created for the synchronous method call pool.
+     *
+     * @return  The number of pooled contexts.
+     */
+    uint32_t GetNumSyncReplyContexts() const { return static_cast<uint32_t>(numSyncReplyContexts); }
+
     /**
      * Constructor called by BusAttachment.
      */
@@ -276,7 +350,9 @@ class BusAttachment::Internal : public MessageReceiver, public JoinSessionAsyncC
     typedef qcc::ManagedObj<BusListener*> ProtectedBusListener;
     typedef std::set<ProtectedBusListener> ListenerSet;
     ListenerSet listeners;               /* List of registered BusListeners */
-    qcc::IODispatch m_ioDispatch;         /* iodispatch for this bus */
+    qcc::IODispatch m_ioDispatch;         /* iodispatch for this bus, also the first iodispatch shard */
+    std::vector<qcc::IODispatch*> m_ioDispatchers;  /* iodispatch shards that streams are spread over */
+    int32_t m_nextIODispatch;             /* Round-robin counter for AssignIODispatch() */
     TransportList transportList;          /* List of active transports */
     KeyStore keyStore;                    /* The key store for the bus attachment */
     AuthManager authManager;              /* The authentication manager for the bus attachment */
@@ -311,6 +387,15 @@ class BusAttachment::Internal : public MessageReceiver, public JoinSessionAsyncC
 
     std::map<qcc::Thread*, JoinContext> joinThreads;  /* List of threads waiting to join */
     qcc::Mutex joinLock;                              /* Mutex that protects joinThreads */
+
+    struct SyncReplySlot {
+        SyncReplySlot() : ctx(NULL), claims(0) { }
+        SyncReplyContext* ctx;      /* Context created by the first caller to claim the slot */
+        volatile int32_t claims;    /* The caller that takes this from 0 to 1 owns the slot */
+    };
+
+    SyncReplySlot syncReplySlots[NUM_SYNC_REPLY_SLOTS];  /* Synchronous method call contexts */
+    volatile int32_t numSyncReplyContexts;              /* Number of contexts created for syncReplySlots */
 };
 
 }
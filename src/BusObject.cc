@@ -389,11 +389,17 @@ QStatus BusObject::AddMethodHandlers(const MethodEntry* entries, size_t numEntri
 
 void BusObject::InstallMethods(MethodTable& methodTable)
 {
+    /*
+     * Add all the handlers with a single update of the method table
+     */
+    vector<MethodTable::Entry> entries;
+    entries.reserve(components->methodContexts.size());
     vector<MethodContext>::iterator iter;
     for (iter = components->methodContexts.begin(); iter != components->methodContexts.end(); iter++) {
         const MethodContext methodContext = *iter;
-        methodTable.Add(this, methodContext.handler, methodContext.member, methodContext.context);
+        entries.push_back(MethodTable::Entry(this, methodContext.handler, methodContext.member, methodContext.context));
     }
+    methodTable.Add(entries);
 }
 
 QStatus BusObject::AddInterface(const InterfaceDescription& iface)
@@ -39,31 +39,69 @@ using namespace std;
 
 namespace ajn {
 
-void _CompressionRules::Add(const HeaderFields& hdrFields, uint32_t token)
+const size_t _CompressionRules::MAX_EXPANSIONS;
+
+_CompressionRules::RuleSnapshot _CompressionRules::GetSnapshot()
 {
-    HeaderFields* expFields = new HeaderFields;
+    snapshotLock.Lock(MUTEX_CONTEXT);
+    RuleSnapshot snap = rules;
+    snapshotLock.Unlock(MUTEX_CONTEXT);
+    return snap;
+}
+
+void _CompressionRules::Add(const HeaderFields& hdrFields, uint32_t token, uint32_t evict)
+{
+    RuleRef rule;
+    rule->token = token;
     /*
      * Copy compressible fields.
      */
-    for (size_t i = 0; i < ArraySize(expFields->field); i++) {
+    for (size_t i = 0; i < ArraySize(rule->fields.field); i++) {
         if (HeaderFields::Compressible[i]) {
-            expFields->field[i] = hdrFields.field[i];
+            rule->fields.field[i] = hdrFields.field[i];
         }
     }
     /*
-     * Add forward and reverse mapping.
+     * Add forward and reverse mapping to a copy of the current rules and publish the copy. The
+     * copy is linear in the number of rules but rules are only added for new tokens and the
+     * number of rules learned from peers is bounded. Readers that still hold the old snapshot
+     * keep any evicted rule alive until they are done with it.
      */
-    tokenMap[token] = expFields;
-    fieldMap[expFields] = token;
-    QCC_DbgHLPrintf(("Added compression/expansion rule %u <-->\n%s", token, expFields->ToString().c_str()));
+    RuleSnapshot snap;
+    *snap = *GetSnapshot();
+    if (evict) {
+        RuleMaps::TokenMap::iterator iter = snap->tokenMap.find(evict);
+        if (iter != snap->tokenMap.end()) {
+            QCC_DbgHLPrintf(("Removed expansion rule %u", evict));
+            snap->fieldMap.erase(&iter->second->fields);
+            snap->tokenMap.erase(iter);
+        }
+    }
+    snap->tokenMap[token] = rule;
+    snap->fieldMap[&rule->fields] = rule;
+    snapshotLock.Lock(MUTEX_CONTEXT);
+    rules = snap;
+    snapshotLock.Unlock(MUTEX_CONTEXT);
+    QCC_DbgHLPrintf(("Added compression/expansion rule %u <-->\n%s", token, rule->fields.ToString().c_str()));
 }
 
 void _CompressionRules::AddExpansion(const HeaderFields& hdrFields, uint32_t token)
 {
     if (token) {
         lock.Lock(MUTEX_CONTEXT);
-        if (fieldMap.count(&hdrFields) == 0) {
-            Add(hdrFields, token);
+        RuleSnapshot snap = GetSnapshot();
+        if ((snap->fieldMap.count(&hdrFields) == 0) && (snap->tokenMap.count(token) == 0)) {
+            /*
+             * Make room by removing the oldest rule learned from a peer. If a peer still uses
+             * it the expansion will be learned again.
+             */
+            uint32_t evict = 0;
+            if (maxExpansions && (expansions.size() >= maxExpansions)) {
+                evict = expansions.front();
+                expansions.pop_front();
+            }
+            Add(hdrFields, token, evict);
+            expansions.push_back(token);
         }
         lock.Unlock(MUTEX_CONTEXT);
     }
@@ -72,40 +110,48 @@ void _CompressionRules::AddExpansion(const HeaderFields& hdrFields, uint32_t tok
 uint32_t _CompressionRules::GetToken(const HeaderFields& hdrFields)
 {
     uint32_t token;
-    lock.Lock(MUTEX_CONTEXT);
-    unordered_map<const HeaderFields*, uint32_t, HdrFieldHash, HdrFieldsEq>::iterator iter = fieldMap.find(&hdrFields);
-    if (iter != fieldMap.end()) {
-        token = iter->second;
+    RuleSnapshot snap = GetSnapshot();
+    RuleMaps::FieldMap::const_iterator iter = snap->fieldMap.find(&hdrFields);
+    if (iter != snap->fieldMap.end()) {
+        token = iter->second->token;
     } else {
+        lock.Lock(MUTEX_CONTEXT);
         /*
-         * Allocate a random token (check it isn't zero and not in use)
+         * Another thread may have added the rule while we were waiting for the lock
          */
-        do { token = Rand32(); } while (token && GetExpansion(token));
-        Add(hdrFields, token);
+        snap = GetSnapshot();
+        iter = snap->fieldMap.find(&hdrFields);
+        if (iter != snap->fieldMap.end()) {
+            token = iter->second->token;
+        } else {
+            /*
+             * Allocate a random token (check it isn't zero and not in use)
+             */
+            do { token = Rand32(); } while (!token || snap->tokenMap.count(token));
+            Add(hdrFields, token, 0);
+        }
+        lock.Unlock(MUTEX_CONTEXT);
     }
-    lock.Unlock(MUTEX_CONTEXT);
     return token;
 }
 
-const HeaderFields* _CompressionRules::GetExpansion(uint32_t token)
+bool _CompressionRules::GetExpansion(uint32_t token, HeaderFields& hdrFields)
 {
-    const HeaderFields* expansion = NULL;
-    if (token) {
-        lock.Lock(MUTEX_CONTEXT);
-        map<uint32_t, const HeaderFields*>::iterator iter = tokenMap.find(token);
-        expansion = (iter != tokenMap.end()) ? iter->second : NULL;
-        lock.Unlock(MUTEX_CONTEXT);
+    if (!token) {
+        return false;
     }
-    return expansion;
-}
-
-_CompressionRules::~_CompressionRules()
-{
-    map<uint32_t, const ajn::HeaderFields*>::iterator iter = tokenMap.begin();
-    while (iter != tokenMap.end()) {
-        delete iter->second;
-        iter++;
+    RuleSnapshot snap = GetSnapshot();
+    RuleMaps::TokenMap::const_iterator iter = snap->tokenMap.find(token);
+    if (iter == snap->tokenMap.end()) {
+        return false;
+    }
+    const HeaderFields& expFields = iter->second->fields;
+    for (size_t id = 0; id < ArraySize(hdrFields.field); id++) {
+        if (HeaderFields::Compressible[id] && (hdrFields.field[id].typeId == ALLJOYN_INVALID)) {
+            hdrFields.field[id] = expFields.field[id];
+        }
     }
+    return true;
 }
 
 bool _CompressionRules::HdrFieldsEq::operator()(const HeaderFields* k1, const HeaderFields* k2) const
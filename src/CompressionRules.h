@@ -26,8 +26,10 @@
 #endif
 
 #include <qcc/platform.h>
+#include <deque>
 #include <qcc/String.h>
 #include <qcc/Util.h>
+#include <qcc/ManagedObj.h>
 #include <qcc/Mutex.h>
 
 #include <alljoyn/Message.h>
@@ -35,7 +37,6 @@
 #include <alljoyn/Status.h>
 
 #include <qcc/STLContainer.h>
-#include <map>
 
 namespace ajn {
 
@@ -54,19 +55,37 @@ typedef qcc::ManagedObj<_CompressionRules> CompressionRules;
  * This class maintains a list of header compression rules for header field compression and provides
  * methods that map from a expanded header to a compression token and back. This class is used by
  * the marshaling code to compress a header before sending it.
+ *
+ * Each remote endpoint also keeps a small instance of its own for the rules defined in band by the
+ * messages received on that link, so a remote peer cannot define tokens for any other link.
+ *
+ * The rules are published as immutable snapshots so looking up a token or an expansion does not
+ * block on rules being added.
  */
 class _CompressionRules {
 
   public:
 
+    /**
+     * Default maximum number of expansion rules that can be added with AddExpansion()
+     */
+    static const size_t MAX_EXPANSIONS = 1024;
+
+    /**
+     * Constructor
+     *
+     * @param maxExpansions  Maximum number of expansion rules added with AddExpansion() that are
+     *                       kept. The oldest of these is removed to make room for a new one.
+     */
+    _CompressionRules(size_t maxExpansions = MAX_EXPANSIONS) : maxExpansions(maxExpansions) { }
+
     /**
      * Add a new expansion rule to the expansion table. This is an expansion that was received from
-     * a remote peer. Note that 0 is an invalid token value.
+     * a remote peer. Note that 0 is an invalid token value. Rules for tokens or header fields
+     * that are already known are not replaced.
      *
      * @param hdrFields  The header fields to add.
      * @param token      The compression token for the header fields.
-     *
-     * @return ER_OK if the expansion rule was added.
      */
     void AddExpansion(const HeaderFields& hdrFields, uint32_t token);
 
@@ -81,30 +100,30 @@ class _CompressionRules {
 
     /**
      * Perform the lookup of the expansion given a compression token. Note that token must
-     * be non-zero.
+     * be non-zero. The expansion is copied because an expansion rule can be removed at any time.
      *
-     * @param token  The compression token to lookup.
+     * @param token      The compression token to lookup.
+     * @param hdrFields  Header fields to expand. Compressible fields that are already set are
+     *                   not replaced.
      *
-     * @return  The expansion for the compression token or NULL if there is no such expansion.
+     * @return  true if there is an expansion for the compression token.
      */
-    const HeaderFields* GetExpansion(uint32_t token);
-
-    /**
-     * Destructor
-     */
-    ~_CompressionRules();
+    bool GetExpansion(uint32_t token, HeaderFields& hdrFields);
 
   private:
 
     /**
-     * Add a compression/expansion rule.
+     * A compression rule.
      */
-    void Add(const HeaderFields& hdrFields, uint32_t token);
+    struct Rule {
+        HeaderFields fields;     /**< The compressible header fields */
+        uint32_t token;          /**< The compression token for the header fields */
+    };
 
     /**
-     * Mutex to protect compression rules maps
+     * Rules are shared by every snapshot that contains them
      */
-    qcc::Mutex lock;
+    typedef qcc::ManagedObj<Rule> RuleRef;
 
     /**
      * Hash funcion for header compression. Hash value is computed over member and interface only.
@@ -122,14 +141,69 @@ class _CompressionRules {
     };
 
     /**
-     * The header compression mapping from header fields to compression token
+     * A snapshot of the compression rules
+     */
+    struct RuleMaps {
+        typedef std::unordered_map<const ajn::HeaderFields*, RuleRef, HdrFieldHash, HdrFieldsEq> FieldMap;
+        typedef std::unordered_map<uint32_t, RuleRef> TokenMap;
+
+        /**
+         * The header compression mapping from header fields to compression rule
+         */
+        FieldMap fieldMap;
+
+        /*
+         * The header expansion mapping from compression token to compression rule
+         */
+        TokenMap tokenMap;
+    };
+
+    /**
+     * Snapshots are replaced rather than modified so a reader only needs a reference to the
+     * current one.
+     */
+    typedef qcc::ManagedObj<RuleMaps> RuleSnapshot;
+
+    /**
+     * Get a reference to the current snapshot.
+     */
+    RuleSnapshot GetSnapshot();
+
+    /**
+     * Add a compression/expansion rule to a copy of the current snapshot and publish the copy.
+     * Must be called with the lock held.
+     *
+     * @param hdrFields  The header fields for the rule.
+     * @param token      The compression token for the rule.
+     * @param evict      Token of a rule to leave out of the copy or 0.
+     */
+    void Add(const HeaderFields& hdrFields, uint32_t token, uint32_t evict);
+
+    /**
+     * Mutex that serializes adding rules
+     */
+    qcc::Mutex lock;
+
+    /**
+     * Mutex held while the current snapshot reference is copied or replaced
+     */
+    qcc::Mutex snapshotLock;
+
+    /**
+     * The current snapshot
      */
-    std::unordered_map<const ajn::HeaderFields*, uint32_t, HdrFieldHash, HdrFieldsEq> fieldMap;
+    RuleSnapshot rules;
 
-    /*
-     * The header expansion mapping from compression token to header fields
+    /**
+     * Maximum number of rules added by AddExpansion() that are kept
+     */
+    size_t maxExpansions;
+
+    /**
+     * Tokens of the rules added by AddExpansion(), oldest first. Rules allocated by GetToken() are
+     * never removed because peers may ask for their expansion at any time.
      */
-    std::map<uint32_t, const ajn::HeaderFields*> tokenMap;
+    std::deque<uint32_t> expansions;
 
 };
 
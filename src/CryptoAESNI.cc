@@ -0,0 +1,476 @@
+/**
+ * @file
+ *
+ * AES-CCM using the AES instructions of x86 processors.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <string.h>
+
+#include <qcc/Crypto.h>
+#include <qcc/Debug.h>
+#include <qcc/KeyBlob.h>
+#include <qcc/Util.h>
+
+#include <alljoyn/Status.h>
+
+#include "CryptoAESNI.h"
+
+/*
+ * The AES instructions are used through compiler intrinsics. GCC and Clang compile the functions
+ * that use them for the AES instruction set regardless of the target of the rest of the library so
+ * the processor is checked at runtime before they are called.
+ */
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define AESNI_SUPPORTED
+#define AESNI_TARGET
+#include <intrin.h>
+#include <emmintrin.h>
+#include <wmmintrin.h>
+#elif (defined(__x86_64__) || defined(__i386__)) && (defined(__clang__) || (__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9)))
+#define AESNI_SUPPORTED
+#define AESNI_TARGET __attribute__((target("aes,sse2")))
+#include <cpuid.h>
+#include <emmintrin.h>
+#include <wmmintrin.h>
+#endif
+
+#define QCC_MODULE "ALLJOYN_AUTH"
+
+using namespace qcc;
+
+namespace ajn {
+
+#if defined(AESNI_SUPPORTED)
+
+static bool CpuHasAESNI()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 25)) != 0;
+#else
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+    return (ecx & (1 << 25)) != 0;
+#endif
+}
+
+AESNI_TARGET static inline __m128i ExpandKeyStep(__m128i key, __m128i assist)
+{
+    assist = _mm_shuffle_epi32(assist, 0xFF);
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    return _mm_xor_si128(key, assist);
+}
+
+/*
+ * The round constant of _mm_aeskeygenassist_si128 must be a compile time constant.
+ */
+#define EXPAND_ROUND(n, rcon) rk[n] = ExpandKeyStep(rk[n - 1], _mm_aeskeygenassist_si128(rk[n - 1], rcon))
+
+AESNI_TARGET static void ExpandKey(const uint8_t* key, uint8_t* roundKeys)
+{
+    __m128i rk[11];
+    rk[0] = _mm_loadu_si128((const __m128i*)key);
+    EXPAND_ROUND(1, 0x01);
+    EXPAND_ROUND(2, 0x02);
+    EXPAND_ROUND(3, 0x04);
+    EXPAND_ROUND(4, 0x08);
+    EXPAND_ROUND(5, 0x10);
+    EXPAND_ROUND(6, 0x20);
+    EXPAND_ROUND(7, 0x40);
+    EXPAND_ROUND(8, 0x80);
+    EXPAND_ROUND(9, 0x1B);
+    EXPAND_ROUND(10, 0x36);
+    for (size_t i = 0; i < 11; ++i) {
+        _mm_storeu_si128((__m128i*)(roundKeys + i * 16), rk[i]);
+    }
+}
+
+#undef EXPAND_ROUND
+
+AESNI_TARGET static inline __m128i AesEncrypt(const __m128i* rk, __m128i b)
+{
+    b = _mm_xor_si128(b, rk[0]);
+    for (size_t r = 1; r < 10; ++r) {
+        b = _mm_aesenc_si128(b, rk[r]);
+    }
+    return _mm_aesenclast_si128(b, rk[10]);
+}
+
+/*
+ * Encrypts two independent blocks. CBC-MAC is serial so running a counter mode block alongside it
+ * keeps the AES unit busy while the MAC chain waits on the previous round.
+ */
+AESNI_TARGET static inline void AesEncrypt2(const __m128i* rk, __m128i& a, __m128i& b)
+{
+    a = _mm_xor_si128(a, rk[0]);
+    b = _mm_xor_si128(b, rk[0]);
+    for (size_t r = 1; r < 10; ++r) {
+        a = _mm_aesenc_si128(a, rk[r]);
+        b = _mm_aesenc_si128(b, rk[r]);
+    }
+    a = _mm_aesenclast_si128(a, rk[10]);
+    b = _mm_aesenclast_si128(b, rk[10]);
+}
+
+/*
+ * Returns counter block i. The counter occupies the last L bytes of the block in big endian order
+ * and is zero in a0.
+ */
+AESNI_TARGET static inline __m128i CounterBlock(__m128i a0, uint32_t i)
+{
+    uint32_t be = ((i & 0xFF) << 24) | ((i & 0xFF00) << 8) | ((i >> 8) & 0xFF00) | (i >> 24);
+    return _mm_xor_si128(a0, _mm_set_epi32((int)be, 0, 0, 0));
+}
+
+AESNI_TARGET static inline __m128i LoadPartial(const uint8_t* data, size_t len)
+{
+    uint8_t blk[16];
+    memset(blk, 0, sizeof(blk));
+    memcpy(blk, data, len);
+    return _mm_loadu_si128((const __m128i*)blk);
+}
+
+/*
+ * Computes the B_0 and A_0 blocks of RFC 3610 and the CBC-MAC over B_0 and the additional data.
+ * Returns the MAC state in T and the encrypted A_0 block in S0.
+ */
+AESNI_TARGET static void StartCCM(const __m128i* rk, const uint8_t* nonce, size_t nLen, uint8_t L, size_t len, const uint8_t* addData, size_t addLen, uint8_t authLen,
+                                  __m128i& T, __m128i& A0, __m128i& S0)
+{
+    uint8_t blk[16];
+
+    memset(blk, 0, sizeof(blk));
+    blk[0] = L - 1;
+    memcpy(&blk[1], nonce, nLen);
+    A0 = _mm_loadu_si128((const __m128i*)blk);
+
+    blk[0] = (addLen ? 0x40 : 0) | (((authLen - 2) / 2) << 3) | (L - 1);
+    for (size_t i = 15, l = len; l != 0; --i) {
+        blk[i] = (uint8_t)(l & 0xFF);
+        l >>= 8;
+    }
+    T = _mm_loadu_si128((const __m128i*)blk);
+    S0 = A0;
+    AesEncrypt2(rk, T, S0);
+
+    if (addLen) {
+        /* The first block encodes the length of the additional data and its first few octets */
+        size_t pos;
+        memset(blk, 0, sizeof(blk));
+        if (addLen < ((1 << 16) - (1 << 8))) {
+            blk[0] = (uint8_t)(addLen >> 8);
+            blk[1] = (uint8_t)(addLen >> 0);
+            pos = 2;
+        } else {
+            blk[0] = 0xFF;
+            blk[1] = 0xFE;
+            blk[2] = (uint8_t)(addLen >> 24);
+            blk[3] = (uint8_t)(addLen >> 16);
+            blk[4] = (uint8_t)(addLen >> 8);
+            blk[5] = (uint8_t)(addLen >> 0);
+            pos = 6;
+        }
+        size_t n = (addLen < (sizeof(blk) - pos)) ? addLen : (sizeof(blk) - pos);
+        memcpy(&blk[pos], addData, n);
+        addData += n;
+        addLen -= n;
+        T = AesEncrypt(rk, _mm_xor_si128(T, _mm_loadu_si128((const __m128i*)blk)));
+        while (addLen >= 16) {
+            T = AesEncrypt(rk, _mm_xor_si128(T, _mm_loadu_si128((const __m128i*)addData)));
+            addData += 16;
+            addLen -= 16;
+        }
+        if (addLen) {
+            T = AesEncrypt(rk, _mm_xor_si128(T, LoadPartial(addData, addLen)));
+        }
+    }
+}
+
+AESNI_TARGET static void EncryptCCM(const uint8_t* roundKeys, const uint8_t* in, uint8_t* out, size_t len, const uint8_t* nonce, size_t nLen, uint8_t L,
+                                    const uint8_t* addData, size_t addLen, uint8_t authLen)
+{
+    __m128i rk[11];
+    for (size_t i = 0; i < 11; ++i) {
+        rk[i] = _mm_loadu_si128((const __m128i*)(roundKeys + i * 16));
+    }
+    __m128i T, A0, S0;
+    StartCCM(rk, nonce, nLen, L, len, addData, addLen, authLen, T, A0, S0);
+
+    uint32_t ctr = 1;
+    while (len >= 16) {
+        __m128i p = _mm_loadu_si128((const __m128i*)in);
+        __m128i s = CounterBlock(A0, ctr++);
+        T = _mm_xor_si128(T, p);
+        AesEncrypt2(rk, T, s);
+        _mm_storeu_si128((__m128i*)out, _mm_xor_si128(p, s));
+        in += 16;
+        out += 16;
+        len -= 16;
+    }
+    uint8_t blk[16];
+    if (len) {
+        __m128i p = LoadPartial(in, len);
+        __m128i s = CounterBlock(A0, ctr);
+        T = _mm_xor_si128(T, p);
+        AesEncrypt2(rk, T, s);
+        _mm_storeu_si128((__m128i*)blk, _mm_xor_si128(p, s));
+        memcpy(out, blk, len);
+        out += len;
+    }
+    /* The authentication field follows the encrypted data */
+    _mm_storeu_si128((__m128i*)blk, _mm_xor_si128(T, S0));
+    memcpy(out, blk, authLen);
+}
+
+AESNI_TARGET static bool DecryptCCM(const uint8_t* roundKeys, const uint8_t* in, uint8_t* out, size_t len, const uint8_t* nonce, size_t nLen, uint8_t L,
+                                    const uint8_t* addData, size_t addLen, uint8_t authLen)
+{
+    __m128i rk[11];
+    for (size_t i = 0; i < 11; ++i) {
+        rk[i] = _mm_loadu_si128((const __m128i*)(roundKeys + i * 16));
+    }
+    uint8_t mac[16];
+    memcpy(mac, in + len, authLen);
+
+    __m128i T, A0, S0;
+    StartCCM(rk, nonce, nLen, L, len, addData, addLen, authLen, T, A0, S0);
+
+    /*
+     * The MAC is over the plaintext so it runs one block behind the decryption. Each block of
+     * plaintext is added to the MAC while the next block is being decrypted.
+     */
+    uint8_t* start = out;
+    size_t msgLen = len;
+    uint32_t ctr = 1;
+    bool pending = false;
+    __m128i p = _mm_setzero_si128();
+    while (len >= 16) {
+        __m128i s = CounterBlock(A0, ctr++);
+        if (pending) {
+            T = _mm_xor_si128(T, p);
+            AesEncrypt2(rk, T, s);
+        } else {
+            s = AesEncrypt(rk, s);
+        }
+        p = _mm_xor_si128(_mm_loadu_si128((const __m128i*)in), s);
+        _mm_storeu_si128((__m128i*)out, p);
+        pending = true;
+        in += 16;
+        out += 16;
+        len -= 16;
+    }
+    uint8_t blk[16];
+    if (len) {
+        __m128i s = CounterBlock(A0, ctr);
+        if (pending) {
+            T = _mm_xor_si128(T, p);
+            AesEncrypt2(rk, T, s);
+        } else {
+            s = AesEncrypt(rk, s);
+        }
+        /* Bytes past the end of the data must be zero in the last MAC block */
+        _mm_storeu_si128((__m128i*)blk, _mm_xor_si128(LoadPartial(in, len), s));
+        memset(&blk[len], 0, sizeof(blk) - len);
+        memcpy(out, blk, len);
+        p = _mm_loadu_si128((const __m128i*)blk);
+        pending = true;
+    }
+    if (pending) {
+        T = AesEncrypt(rk, _mm_xor_si128(T, p));
+    }
+    _mm_storeu_si128((__m128i*)blk, _mm_xor_si128(T, S0));
+
+    /* Compare without an early exit so the time taken does not depend on where the MAC differs */
+    uint8_t diff = 0;
+    for (size_t i = 0; i < authLen; ++i) {
+        diff |= blk[i] ^ mac[i];
+    }
+    if (diff) {
+        memset(start, 0, msgLen);
+        return false;
+    }
+    return true;
+}
+
+#endif
+
+/*
+ * 0 until the first call to IsAvailable(), then 1 if AES-NI can be used or -1 if it cannot.
+ */
+static volatile int32_t aesniState = 0;
+
+bool Crypto_AES_NI::IsAvailable(const KeyBlob& key)
+{
+    if ((key.GetType() != KeyBlob::AES) || (key.GetSize() != KEY_SIZE)) {
+        return false;
+    }
+    if (aesniState == 0) {
+#if defined(AESNI_SUPPORTED)
+        bool available = CpuHasAESNI() && SelfTest();
+#else
+        bool available = false;
+#endif
+        QCC_DbgPrintf(("AES-NI CCM is %s", available ? "available" : "not available"));
+        aesniState = available ? 1 : -1;
+    }
+    return aesniState > 0;
+}
+
+Crypto_AES_NI::Crypto_AES_NI(const KeyBlob& key)
+{
+    memset(roundKeys, 0, sizeof(roundKeys));
+#if defined(AESNI_SUPPORTED)
+    if (key.GetSize() == KEY_SIZE) {
+        ExpandKey(key.GetData(), roundKeys);
+    }
+#endif
+}
+
+#if defined(AESNI_SUPPORTED)
+/*
+ * Checks the CCM arguments and computes L, the size of the length field, in the same way as
+ * qcc::Crypto_AES. Short nonces are zero padded to 11 bytes.
+ */
+static QStatus CheckCCM(const void* in, const void* out, size_t len, const KeyBlob& nonce, uint8_t authLen, uint8_t& L)
+{
+    if (!in && len) {
+        return ER_BAD_ARG_1;
+    }
+    if (!out && len) {
+        return ER_BAD_ARG_2;
+    }
+    size_t nLen = nonce.GetSize();
+    if ((nLen < 4) || (nLen > 14)) {
+        return ER_BAD_ARG_4;
+    }
+    if ((authLen < 4) || (authLen > 16) || (authLen & 1)) {
+        return ER_BAD_ARG_8;
+    }
+    L = 15 - static_cast<uint8_t>((nLen > 11) ? nLen : 11);
+    if ((L < sizeof(size_t)) && (len >= (static_cast<size_t>(1) << (8 * L)))) {
+        return ER_BAD_ARG_3;
+    }
+    return ER_OK;
+}
+#endif
+
+QStatus Crypto_AES_NI::Encrypt_CCM(const void* in, void* out, size_t& len, const KeyBlob& nonce, const void* addData, size_t addLen, uint8_t authLen)
+{
+#if defined(AESNI_SUPPORTED)
+    uint8_t L;
+    QStatus status = CheckCCM(in, out, len, nonce, authLen, L);
+    if (status == ER_OK) {
+        EncryptCCM(roundKeys, (const uint8_t*)in, (uint8_t*)out, len, nonce.GetData(), nonce.GetSize(), L, (const uint8_t*)addData, addLen, authLen);
+        len += authLen;
+    }
+    return status;
+#else
+    return ER_NOT_IMPLEMENTED;
+#endif
+}
+
+QStatus Crypto_AES_NI::Decrypt_CCM(const void* in, void* out, size_t& len, const KeyBlob& nonce, const void* addData, size_t addLen, uint8_t authLen)
+{
+#if defined(AESNI_SUPPORTED)
+    if (len < authLen) {
+        return ER_BAD_ARG_3;
+    }
+    uint8_t L;
+    size_t msgLen = len - authLen;
+    QStatus status = CheckCCM(in, out, msgLen, nonce, authLen, L);
+    if (status == ER_OK) {
+        if (DecryptCCM(roundKeys, (const uint8_t*)in, (uint8_t*)out, msgLen, nonce.GetData(), nonce.GetSize(), L, (const uint8_t*)addData, addLen, authLen)) {
+            len = msgLen;
+        } else {
+            status = ER_AUTH_FAIL;
+        }
+    }
+    return status;
+#else
+    return ER_NOT_IMPLEMENTED;
+#endif
+}
+
+bool Crypto_AES_NI::SelfTest()
+{
+    static const size_t bodyLens[] = { 0, 1, 15, 16, 17, 64, 100 };
+    static const size_t addLens[] = { 0, 1, 14, 30, 300 };
+    static const uint8_t authLen = 8;
+
+    uint8_t keyData[KEY_SIZE];
+    uint8_t nonceData[5];
+    uint8_t addData[300];
+    uint8_t plain[100];
+    for (size_t i = 0; i < sizeof(keyData); ++i) {
+        keyData[i] = (uint8_t)(i * 7 + 3);
+    }
+    for (size_t i = 0; i < sizeof(nonceData); ++i) {
+        nonceData[i] = (uint8_t)(0xA0 + i);
+    }
+    for (size_t i = 0; i < sizeof(addData); ++i) {
+        addData[i] = (uint8_t)(i * 13);
+    }
+    for (size_t i = 0; i < sizeof(plain); ++i) {
+        plain[i] = (uint8_t)(255 - i);
+    }
+    KeyBlob key(keyData, sizeof(keyData), KeyBlob::AES);
+    KeyBlob nonce(nonceData, sizeof(nonceData), KeyBlob::GENERIC);
+    Crypto_AES portable(key, Crypto_AES::CCM);
+    Crypto_AES_NI fast(key);
+
+    for (size_t b = 0; b < ArraySize(bodyLens); ++b) {
+        for (size_t a = 0; a < ArraySize(addLens); ++a) {
+            uint8_t expect[sizeof(plain) + 16];
+            uint8_t actual[sizeof(plain) + 16];
+            size_t expectLen = bodyLens[b];
+            size_t actualLen = bodyLens[b];
+            memcpy(expect, plain, expectLen);
+            memcpy(actual, plain, actualLen);
+            if (portable.Encrypt_CCM(expect, expect, expectLen, nonce, addData, addLens[a], authLen) != ER_OK) {
+                return false;
+            }
+            if (fast.Encrypt_CCM(actual, actual, actualLen, nonce, addData, addLens[a], authLen) != ER_OK) {
+                return false;
+            }
+            if ((expectLen != actualLen) || (memcmp(expect, actual, actualLen) != 0)) {
+                QCC_DbgPrintf(("AES-NI CCM does not match the portable implementation"));
+                return false;
+            }
+            if ((fast.Decrypt_CCM(actual, actual, actualLen, nonce, addData, addLens[a], authLen) != ER_OK) ||
+                (actualLen != bodyLens[b]) || (memcmp(actual, plain, actualLen) != 0)) {
+                return false;
+            }
+            /* A modified authentication field must be rejected */
+            expect[expectLen - 1] ^= 1;
+            if (fast.Decrypt_CCM(expect, expect, expectLen, nonce, addData, addLens[a], authLen) == ER_OK) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,112 @@
+/**
+ * @file
+ *
+ * AES-CCM using the AES instructions of x86 processors.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#ifndef _ALLJOYN_CRYPTOAESNI_H
+#define _ALLJOYN_CRYPTOAESNI_H
+
+#ifndef __cplusplus
+#error Only include CryptoAESNI.h in C++ code.
+#endif
+
+#include <qcc/platform.h>
+#include <qcc/KeyBlob.h>
+
+#include <alljoyn/Status.h>
+
+namespace ajn {
+
+/**
+ * AES-CCM with 128 bit keys implemented with the AES-NI instructions. The output is identical to
+ * qcc::Crypto_AES in CCM mode, which remains the portable implementation used on processors
+ * without AES-NI.
+ */
+class Crypto_AES_NI {
+
+  public:
+
+    /**
+     * Size of the keys supported by this class.
+     */
+    static const size_t KEY_SIZE = 16;
+
+    /**
+     * Check if AES-NI CCM can be used with a key. The first call checks that the processor has
+     * the AES instructions and that the results match qcc::Crypto_AES for a set of test inputs.
+     *
+     * @param key   The key that would be used.
+     *
+     * @return true if the key can be used with this class on this processor.
+     */
+    static bool IsAvailable(const qcc::KeyBlob& key);
+
+    /**
+     * Constructor
+     *
+     * @param key   An AES key of KEY_SIZE bytes.
+     */
+    Crypto_AES_NI(const qcc::KeyBlob& key);
+
+    /**
+     * Encrypt some data using CCM mode. Same arguments and behavior as qcc::Crypto_AES::Encrypt_CCM().
+     *
+     * @param in         Pointer to the data to encrypt.
+     * @param out        The encrypted data, may be the same as in. This buffer must be authLen
+     *                   bytes longer than the input data.
+     * @param len        On input the length of the input data, on output the length of the encrypted data.
+     * @param nonce      A nonce of 4 to 14 bytes.
+     * @param addData    Additional data to be authenticated but not encrypted.
+     * @param addLen     Length of the additional data.
+     * @param authLen    Length of the authentication field, an even number from 4 to 16.
+     *
+     * @return  ER_OK if the data was encrypted.
+     */
+    QStatus Encrypt_CCM(const void* in, void* out, size_t& len, const qcc::KeyBlob& nonce, const void* addData, size_t addLen, uint8_t authLen);
+
+    /**
+     * Decrypt and authenticate some data using CCM mode. Same arguments and behavior as
+     * qcc::Crypto_AES::Decrypt_CCM().
+     *
+     * @param in         Pointer to the data to decrypt.
+     * @param out        The decrypted data, may be the same as in.
+     * @param len        On input the length of the encrypted data, on output the length of the decrypted data.
+     * @param nonce      The nonce the data was encrypted with.
+     * @param addData    Additional data to be authenticated.
+     * @param addLen     Length of the additional data.
+     * @param authLen    Length of the authentication field.
+     *
+     * @return  ER_OK if the data was decrypted and authenticated, ER_AUTH_FAIL if the
+     *          authentication failed.
+     */
+    QStatus Decrypt_CCM(const void* in, void* out, size_t& len, const qcc::KeyBlob& nonce, const void* addData, size_t addLen, uint8_t authLen);
+
+  private:
+
+    /**
+     * Checks that the results of this class match qcc::Crypto_AES.
+     */
+    static bool SelfTest();
+
+    uint8_t roundKeys[11 * 16];   /**< Expanded AES-128 key schedule */
+};
+
+}
+
+#endif
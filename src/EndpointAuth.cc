@@ -51,6 +51,11 @@ namespace ajn {
 
 static const uint32_t HELLO_RESPONSE_TIMEOUT = 5000;
 
+/*
+ * Maximum length of a SASL command, the same limit DBus applies.
+ */
+static const uint32_t MAX_SASL_LINE_LEN = 16 * 1024;
+
 static const char* RedirectError = "org.alljoyn.error.redirect";
 static const char* UntrustedError = "org.alljoyn.error.untrusted";
 
@@ -162,107 +167,7 @@ QStatus EndpointAuth::WaitHello(qcc::String& authUsed)
     }
     status = hello->Unmarshal(endpoint, false);
     if (ER_OK == status) {
-        if (hello->GetType() != MESSAGE_METHOD_CALL) {
-            QCC_DbgPrintf(("First message must be Hello/BusHello method call"));
-            return ER_BUS_ESTABLISH_FAILED;
-        }
-
-        if (strcmp(hello->GetInterface(), org::freedesktop::DBus::InterfaceName) == 0) {
-            if (hello->GetCallSerial() == 0) {
-                QCC_DbgPrintf(("Hello expected non-zero serial"));
-                return ER_BUS_ESTABLISH_FAILED;
-            }
-            if (strcmp(hello->GetDestination(), org::freedesktop::DBus::WellKnownName) != 0) {
-                QCC_DbgPrintf(("Hello expected destination \"%s\"", org::freedesktop::DBus::WellKnownName));
-                return ER_BUS_ESTABLISH_FAILED;
-            }
-            if (strcmp(hello->GetObjectPath(), org::freedesktop::DBus::ObjectPath) != 0) {
-                QCC_DbgPrintf(("Hello expected object path \"%s\"", org::freedesktop::DBus::ObjectPath));
-                return ER_BUS_ESTABLISH_FAILED;
-            }
-            if (strcmp(hello->GetMemberName(), "Hello") != 0) {
-                QCC_DbgPrintf(("Hello expected member \"Hello\""));
-                return ER_BUS_ESTABLISH_FAILED;
-            }
-            endpoint->GetFeatures().isBusToBus = false;
-
-            bool trusted = (authUsed != "ANONYMOUS");
-
-            if (isAccepting && !trusted) {
-                /* If this is an incoming connection that is not bus-to-bus and is untrusted,
-                 * We need to make sure that the transport is accepting untrusted clients.
-                 */
-                status = endpoint->UntrustedClientStart();
-                if (status != ER_OK) {
-                    QCC_DbgPrintf(("Untrusted client is being rejected"));
-                    hello->ErrorMsg(hello, UntrustedError, "");
-                    hello->Deliver(endpoint);
-                    return status;
-                }
-            }
-            endpoint->GetFeatures().allowRemote = (0 != (hello->GetFlags() & ALLJOYN_FLAG_ALLOW_REMOTE_MSG));
-            /*
-             * Remote name for the endpoint is the unique name we are allocating.
-             */
-            remoteName = uniqueName;
-        } else if (strcmp(hello->GetInterface(), org::alljoyn::Bus::InterfaceName) == 0) {
-            if (hello->GetCallSerial() == 0) {
-                QCC_DbgPrintf(("Hello expected non-zero serial"));
-                return ER_BUS_ESTABLISH_FAILED;
-            }
-            if (strcmp(hello->GetDestination(), org::alljoyn::Bus::WellKnownName) != 0) {
-                QCC_DbgPrintf(("Hello expected destination \"%s\"", org::alljoyn::Bus::WellKnownName));
-                return ER_BUS_ESTABLISH_FAILED;
-            }
-            if (strcmp(hello->GetObjectPath(), org::alljoyn::Bus::ObjectPath) != 0) {
-                QCC_DbgPrintf(("Hello expected object path \"%s\"", org::alljoyn::Bus::ObjectPath));
-                return ER_BUS_ESTABLISH_FAILED;
-            }
-            if (strcmp(hello->GetMemberName(), "BusHello") != 0) {
-                QCC_DbgPrintf(("Hello expected member \"BusHello\""));
-                return ER_BUS_ESTABLISH_FAILED;
-            }
-            size_t numArgs;
-            const MsgArg* args;
-            status = hello->UnmarshalArgs("su");
-            hello->GetArgs(numArgs, args);
-            if ((ER_OK == status) && (2 == numArgs) && (ALLJOYN_STRING == args[0].typeId) && (ALLJOYN_UINT32 == args[1].typeId)) {
-                remoteGUID = qcc::GUID128(args[0].v_string.str);
-                remoteProtocolVersion = args[1].v_uint32;
-                if (remoteGUID == bus.GetInternal().GetGlobalGUID()) {
-                    QCC_DbgPrintf(("BusHello was sent by self"));
-                    return ER_BUS_SELF_CONNECT;
-                }
-            } else {
-                QCC_DbgPrintf(("BusHello expected 2 args with signature \"su\""));
-                return ER_BUS_ESTABLISH_FAILED;
-            }
-            endpoint->GetFeatures().isBusToBus = true;
-            endpoint->GetFeatures().allowRemote = true;
-
-            /*
-             * Remote name for the endpoint is the sender of the hello.
-             */
-            remoteName = hello->GetSender();
-        } else {
-            QCC_DbgPrintf(("Hello expected interface \"%s\" or \"%s\"", org::freedesktop::DBus::InterfaceName,
-                           org::alljoyn::Bus::InterfaceName));
-            return ER_BUS_ESTABLISH_FAILED;
-        }
-        redirection = endpoint->RedirectionAddress();
-        if (redirection.empty()) {
-            QCC_DbgHLPrintf(("Endpoint remote %sname %s", endpoint->GetFeatures().isBusToBus ? "(bus-to-bus) " : "", remoteName.c_str()));
-            status = hello->HelloReply(endpoint->GetFeatures().isBusToBus, uniqueName);
-        } else {
-            QCC_DbgHLPrintf(("Endpoint redirecting name %s to %d", remoteName.c_str(), redirection.c_str()));
-            status = hello->ErrorMsg(hello, RedirectError, redirection.c_str());
-        }
-    }
-    if (ER_OK == status) {
-        status = hello->Deliver(endpoint);
-        if (ER_OK != status) {
-            QCC_LogError(status, ("%s", __FUNCTION__));
-        }
+        status = ReplyHello(hello, authUsed, redirection);
     }
     if ((ER_OK == status) && !redirection.empty()) {
         /*
@@ -285,6 +190,116 @@ QStatus EndpointAuth::WaitHello(qcc::String& authUsed)
     return status;
 }
 
+/*
+ * Validate an unmarshaled hello message and deliver the reply or the redirection error.
+ */
+QStatus EndpointAuth::ReplyHello(Message& hello, const qcc::String& authUsed, qcc::String& redirection)
+{
+    QStatus status = ER_OK;
+    if (hello->GetType() != MESSAGE_METHOD_CALL) {
+        QCC_DbgPrintf(("First message must be Hello/BusHello method call"));
+        return ER_BUS_ESTABLISH_FAILED;
+    }
+
+    if (strcmp(hello->GetInterface(), org::freedesktop::DBus::InterfaceName) == 0) {
+        if (hello->GetCallSerial() == 0) {
+            QCC_DbgPrintf(("Hello expected non-zero serial"));
+            return ER_BUS_ESTABLISH_FAILED;
+        }
+        if (strcmp(hello->GetDestination(), org::freedesktop::DBus::WellKnownName) != 0) {
+            QCC_DbgPrintf(("Hello expected destination \"%s\"", org::freedesktop::DBus::WellKnownName));
+            return ER_BUS_ESTABLISH_FAILED;
+        }
+        if (strcmp(hello->GetObjectPath(), org::freedesktop::DBus::ObjectPath) != 0) {
+            QCC_DbgPrintf(("Hello expected object path \"%s\"", org::freedesktop::DBus::ObjectPath));
+            return ER_BUS_ESTABLISH_FAILED;
+        }
+        if (strcmp(hello->GetMemberName(), "Hello") != 0) {
+            QCC_DbgPrintf(("Hello expected member \"Hello\""));
+            return ER_BUS_ESTABLISH_FAILED;
+        }
+        endpoint->GetFeatures().isBusToBus = false;
+
+        bool trusted = (authUsed != "ANONYMOUS");
+
+        if (isAccepting && !trusted) {
+            /* If this is an incoming connection that is not bus-to-bus and is untrusted,
+             * We need to make sure that the transport is accepting untrusted clients.
+             */
+            status = endpoint->UntrustedClientStart();
+            if (status != ER_OK) {
+                QCC_DbgPrintf(("Untrusted client is being rejected"));
+                hello->ErrorMsg(hello, UntrustedError, "");
+                hello->Deliver(endpoint);
+                return status;
+            }
+        }
+        endpoint->GetFeatures().allowRemote = (0 != (hello->GetFlags() & ALLJOYN_FLAG_ALLOW_REMOTE_MSG));
+        /*
+         * Remote name for the endpoint is the unique name we are allocating.
+         */
+        remoteName = uniqueName;
+    } else if (strcmp(hello->GetInterface(), org::alljoyn::Bus::InterfaceName) == 0) {
+        if (hello->GetCallSerial() == 0) {
+            QCC_DbgPrintf(("Hello expected non-zero serial"));
+            return ER_BUS_ESTABLISH_FAILED;
+        }
+        if (strcmp(hello->GetDestination(), org::alljoyn::Bus::WellKnownName) != 0) {
+            QCC_DbgPrintf(("Hello expected destination \"%s\"", org::alljoyn::Bus::WellKnownName));
+            return ER_BUS_ESTABLISH_FAILED;
+        }
+        if (strcmp(hello->GetObjectPath(), org::alljoyn::Bus::ObjectPath) != 0) {
+            QCC_DbgPrintf(("Hello expected object path \"%s\"", org::alljoyn::Bus::ObjectPath));
+            return ER_BUS_ESTABLISH_FAILED;
+        }
+        if (strcmp(hello->GetMemberName(), "BusHello") != 0) {
+            QCC_DbgPrintf(("Hello expected member \"BusHello\""));
+            return ER_BUS_ESTABLISH_FAILED;
+        }
+        size_t numArgs;
+        const MsgArg* args;
+        status = hello->UnmarshalArgs("su");
+        hello->GetArgs(numArgs, args);
+        if ((ER_OK == status) && (2 == numArgs) && (ALLJOYN_STRING == args[0].typeId) && (ALLJOYN_UINT32 == args[1].typeId)) {
+            remoteGUID = qcc::GUID128(args[0].v_string.str);
+            remoteProtocolVersion = args[1].v_uint32;
+            if (remoteGUID == bus.GetInternal().GetGlobalGUID()) {
+                QCC_DbgPrintf(("BusHello was sent by self"));
+                return ER_BUS_SELF_CONNECT;
+            }
+        } else {
+            QCC_DbgPrintf(("BusHello expected 2 args with signature \"su\""));
+            return ER_BUS_ESTABLISH_FAILED;
+        }
+        endpoint->GetFeatures().isBusToBus = true;
+        endpoint->GetFeatures().allowRemote = true;
+
+        /*
+         * Remote name for the endpoint is the sender of the hello.
+         */
+        remoteName = hello->GetSender();
+    } else {
+        QCC_DbgPrintf(("Hello expected interface \"%s\" or \"%s\"", org::freedesktop::DBus::InterfaceName,
+                       org::alljoyn::Bus::InterfaceName));
+        return ER_BUS_ESTABLISH_FAILED;
+    }
+    redirection = endpoint->RedirectionAddress();
+    if (redirection.empty()) {
+        QCC_DbgHLPrintf(("Endpoint remote %sname %s", endpoint->GetFeatures().isBusToBus ? "(bus-to-bus) " : "", remoteName.c_str()));
+        status = hello->HelloReply(endpoint->GetFeatures().isBusToBus, uniqueName);
+    } else {
+        QCC_DbgHLPrintf(("Endpoint redirecting name %s to %d", remoteName.c_str(), redirection.c_str()));
+        status = hello->ErrorMsg(hello, RedirectError, redirection.c_str());
+    }
+    if (ER_OK == status) {
+        status = hello->Deliver(endpoint);
+        if (ER_OK != status) {
+            QCC_LogError(status, ("%s", __FUNCTION__));
+        }
+    }
+    return status;
+}
+
 
 static const char NegotiateUnixFd[] = "NEGOTIATE_UNIX_FD";
 static const char AgreeUnixFd[] = "AGREE_UNIX_FD";
@@ -477,4 +492,123 @@ ExitEstablish:
     return status;
 }
 
-}
\ No newline at end of file
+QStatus EndpointAuth::Begin(const qcc::String& authMechanisms, AuthListener* listener)
+{
+    QCC_DbgPrintf(("EndpointAuth::Begin authMechanisms=\"%s\"", authMechanisms.c_str()));
+
+    if (!isAccepting || (handshake != HANDSHAKE_IDLE)) {
+        return ER_BUS_ESTABLISH_FAILED;
+    }
+    if (listener) {
+        authListener.Set(listener);
+    }
+    sasl = new SASLEngine(bus, AuthMechanism::CHALLENGER, authMechanisms, NULL, authListener, this);
+    /*
+     * The server's GUID is sent to the client when the authentication succeeds
+     */
+    sasl->SetLocalId(bus.GetInternal().GetGlobalGUID().ToString());
+    handshake = HANDSHAKE_SASL;
+    return ER_OK;
+}
+
+/*
+ * Accumulate received bytes until a complete SASL command has been read. Returns ER_TIMEOUT if
+ * the command is not complete yet. A peer that has not authenticated must not be able to make
+ * us buffer an unbounded amount of data so the command length is capped.
+ */
+QStatus EndpointAuth::PullLine()
+{
+    QStatus status = endpoint->GetSource().GetLine(inLine, 0);
+    if (inLine.size() > MAX_SASL_LINE_LEN) {
+        status = ER_BUS_ESTABLISH_FAILED;
+        QCC_LogError(status, ("SASL command longer than %u bytes", MAX_SASL_LINE_LEN));
+    }
+    return status;
+}
+
+QStatus EndpointAuth::Continue(qcc::String& authUsed, qcc::String& redirection)
+{
+    QStatus status = ER_OK;
+
+    while ((status == ER_OK) && (handshake != HANDSHAKE_DONE)) {
+        switch (handshake) {
+        case HANDSHAKE_SASL:
+        {
+            SASLEngine::AuthState state;
+            qcc::String outStr;
+            status = PullLine();
+            if (status != ER_OK) {
+                break;
+            }
+            status = sasl->Advance(inLine, outStr, state);
+            inLine.clear();
+            if (status != ER_OK) {
+                QCC_DbgPrintf(("Server authentication failed %s", QCC_StatusText(status)));
+                break;
+            }
+            if (state == SASLEngine::ALLJOYN_AUTH_SUCCESS) {
+                /*
+                 * Remember the authentication mechanism that was used
+                 */
+                authUsed = sasl->GetMechanism();
+                handshake = HANDSHAKE_HELLO;
+                break;
+            }
+            size_t numPushed;
+            status = endpoint->GetSink().PushBytes((void*)(outStr.data()), outStr.length(), numPushed);
+            if (status == ER_OK) {
+                QCC_DbgPrintf(("Sent %s", outStr.c_str()));
+            } else {
+                QCC_LogError(status, ("Failed to write to stream"));
+            }
+        }
+        break;
+
+        case HANDSHAKE_HELLO:
+            /*
+             * The hello message is read incrementally so it may arrive in any number of pieces
+             */
+            status = helloMsg->ReadNonBlocking(endpoint, false);
+            if (status == ER_OK) {
+                status = helloMsg->Unmarshal(endpoint, false);
+            }
+            if (status == ER_OK) {
+                status = ReplyHello(helloMsg, authUsed, redirection);
+            }
+            if (status == ER_OK) {
+                handshake = redirection.empty() ? HANDSHAKE_DONE : HANDSHAKE_REDIRECT;
+            }
+            break;
+
+        case HANDSHAKE_REDIRECT:
+        {
+            /*
+             * As in WaitHello() the other end should close the socket when it receives the
+             * redirection error. The transport bounds how long we wait for that to happen.
+             */
+            uint8_t buf[1];
+            size_t sz;
+            status = endpoint->GetSource().PullBytes(buf, sizeof(buf), sz, 0);
+            if (status != ER_TIMEOUT) {
+                status = (status == ER_OK) ? ER_BUS_ESTABLISH_FAILED : ER_BUS_ENDPOINT_REDIRECTED;
+            }
+        }
+        break;
+
+        default:
+            status = ER_BUS_ESTABLISH_FAILED;
+            break;
+        }
+    }
+    if (status == ER_TIMEOUT) {
+        return ER_WOULDBLOCK;
+    }
+    handshake = HANDSHAKE_DONE;
+    authListener.Set(NULL);
+
+    QCC_DbgPrintf(("Establish complete %s", QCC_StatusText(status)));
+
+    return status;
+}
+
+}
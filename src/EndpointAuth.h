@@ -28,6 +28,8 @@
 #include <qcc/GUID.h>
 #include <qcc/Stream.h>
 
+#include <alljoyn/Message.h>
+
 #include "BusInternal.h"
 #include "SASLEngine.h"
 
@@ -59,13 +61,16 @@ class EndpointAuth : public SASLEngine::ExtensionHandler {
         endpoint(endpoint),
         uniqueName(bus.GetInternal().GetRouter().GenerateUniqueName()),
         isAccepting(isAcceptor),
-        remoteProtocolVersion(0)
+        remoteProtocolVersion(0),
+        sasl(NULL),
+        handshake(HANDSHAKE_IDLE),
+        helloMsg(bus)
     { }
 
     /**
      * Destructor
      */
-    ~EndpointAuth() { };
+    ~EndpointAuth() { delete sasl; }
 
     /**
      * Establish a connection.
@@ -83,6 +88,35 @@ class EndpointAuth : public SASLEngine::ExtensionHandler {
      */
     QStatus Establish(const qcc::String& authMechanisms, qcc::String& authUsed, qcc::String& redirection, AuthListener* listener = NULL);
 
+    /**
+     * Start establishing an accepted connection without blocking. The handshake is driven by
+     * calling Continue() each time the endpoint source has data to read. Only valid for the
+     * accepting side of a connection.
+     *
+     * @param authMechanisms  The authentication mechanisms to accept.
+     * @param listener        Authentication credentials listener
+     *
+     * @return
+     *      - ER_OK if the handshake was started
+     *      - An error status otherwise
+     */
+    QStatus Begin(const qcc::String& authMechanisms, AuthListener* listener = NULL);
+
+    /**
+     * Advance a handshake started by Begin() as far as the data already received allows.
+     *
+     * @param authUsed     Returns the name of the authentication method that was used to establish the connection.
+     * @param redirection  Returns a redirection address for the endpoint. This value is only meaninful if the
+     *                     return status is ER_BUS_ENDPOINT_REDIRECTED.
+     *
+     * @return
+     *      - ER_OK if the connection has been established
+     *      - ER_WOULDBLOCK if the handshake is waiting for data from the remote side
+     *      = ER_BUS_ENDPOINT_REDIRECTED if the endpoint is being redirected.
+     *      - An error status otherwise
+     */
+    QStatus Continue(qcc::String& authUsed, qcc::String& redirection);
+
     /**
      * Get the unique bus name assigned by the bus for this endpoint.
      *
@@ -143,10 +177,28 @@ class EndpointAuth : public SASLEngine::ExtensionHandler {
 
     ProtectedAuthListener authListener;  ///< Authentication listener
 
+    /**
+     * Steps of a handshake driven by Continue()
+     */
+    typedef enum {
+        HANDSHAKE_IDLE,       ///< Begin() has not been called
+        HANDSHAKE_SASL,       ///< Exchanging SASL commands
+        HANDSHAKE_HELLO,      ///< Waiting for the hello message
+        HANDSHAKE_REDIRECT,   ///< Waiting for the remote side to close a redirected connection
+        HANDSHAKE_DONE        ///< The handshake is over
+    } HandshakeState;
+
+    SASLEngine* sasl;                ///< SASL engine for a handshake driven by Continue()
+    HandshakeState handshake;        ///< Current step of a handshake driven by Continue()
+    qcc::String inLine;              ///< Partially received SASL command
+    Message helloMsg;                ///< Partially received hello message
+
     /* Internal methods */
 
     QStatus Hello(qcc::String& redirection);
     QStatus WaitHello(qcc::String& authUsed);
+    QStatus ReplyHello(Message& hello, const qcc::String& authUsed, qcc::String& redirection);
+    QStatus PullLine();
 };
 
 }
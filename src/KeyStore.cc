@@ -21,8 +21,15 @@
  ******************************************************************************/
 
 #include <map>
+#include <stdio.h>
 
 #include <qcc/platform.h>
+
+#if defined(QCC_OS_GROUP_WINDOWS)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 #include <qcc/Debug.h>
 #include <qcc/String.h>
 #include <qcc/Crypto.h>
@@ -49,6 +56,18 @@ using namespace qcc;
 namespace ajn {
 
 
+/*
+ * Flush a file that has been written with stdio to disk.
+ */
+static bool SyncFile(FILE* file)
+{
+#if defined(QCC_OS_GROUP_WINDOWS)
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
 /*
  * Lowest version number we can read
  */
@@ -57,7 +76,50 @@ static const uint16_t LowStoreVersion = 0x0102;
 /*
  * Current key store version we will write
  */
-static const uint16_t KeyStoreVersion = 0x0103;
+static const uint16_t KeyStoreVersion = 0x0104;
+
+/*
+ * Lowest version that can be followed by a journal. Readers of earlier versions would ignore the
+ * journal so a key store with an earlier version is rewritten before anything is appended to it.
+ */
+static const uint16_t JournalStoreVersion = 0x0104;
+
+/*
+ * Sanity check on the length of the encrypted keys in a key store snapshot
+ */
+static const size_t MaxKeysLen = 16 * 1024 * 1024;
+
+/*
+ * Sanity check on the length of a single encrypted journal record
+ */
+static const uint32_t MaxJournalRecordLen = 64000;
+
+/*
+ * The journal is compacted into a new snapshot once it has more records than this or than there
+ * are keys in the key store, whichever is larger, so the cost of compaction is amortized over the
+ * records that were appended.
+ */
+static const uint32_t MinJournalRecords = 64;
+
+/*
+ * Journal record operations
+ */
+static const uint8_t JournalAddKey = 1;
+static const uint8_t JournalDelKey = 2;
+
+/*
+ * Appended to the revision number to form the nonce for a journal record so it can never be the
+ * same as the nonce used for a snapshot.
+ */
+static const uint8_t JournalNonceTag = 'J';
+
+static KeyBlob JournalNonce(uint32_t rev)
+{
+    uint8_t nonce[sizeof(rev) + 1];
+    memcpy(nonce, &rev, sizeof(rev));
+    nonce[sizeof(rev)] = JournalNonceTag;
+    return KeyBlob(nonce, sizeof(nonce), KeyBlob::GENERIC);
+}
 
 
 QStatus KeyStoreListener::PutKeys(KeyStore& keyStore, const qcc::String& source, const qcc::String& password)
@@ -148,6 +210,43 @@ class DefaultKeyStoreListener : public KeyStoreListener {
         return status;
     }
 
+    QStatus AppendRequest(const qcc::String& records) {
+        QStatus status = ER_OK;
+        /*
+         * FileSink always truncates the file it opens so the records are appended through stdio.
+         * The key store file lock is held through a FileSource so the append is serialized with
+         * loads and stores in other processes, and the records are flushed to disk before the
+         * append is reported as done.
+         */
+        FileSource source(fileName);
+        if (!source.IsValid()) {
+            status = ER_BUS_WRITE_ERROR;
+            QCC_LogError(status, ("Cannot append to key store %s", fileName.c_str()));
+            return status;
+        }
+        source.Lock(true);
+        FILE* file = fopen(fileName.c_str(), "ab");
+        if (!file) {
+            status = ER_BUS_WRITE_ERROR;
+            QCC_LogError(status, ("Cannot append to key store %s", fileName.c_str()));
+            source.Unlock();
+            return status;
+        }
+        if ((fwrite(records.data(), 1, records.size(), file) != records.size()) || (fflush(file) != 0) || !SyncFile(file)) {
+            status = ER_BUS_WRITE_ERROR;
+        }
+        if (fclose(file) != 0) {
+            status = ER_BUS_WRITE_ERROR;
+        }
+        source.Unlock();
+        if (status == ER_OK) {
+            QCC_DbgHLPrintf(("Appended %u bytes to key store %s", static_cast<uint32_t>(records.size()), fileName.c_str()));
+        } else {
+            QCC_LogError(status, ("Failed to append to key store %s", fileName.c_str()));
+        }
+        return status;
+    }
+
   private:
 
     qcc::String fileName;
@@ -158,11 +257,14 @@ KeyStore::KeyStore(const qcc::String& application) :
     application(application),
     storeState(UNAVAILABLE),
     keys(new KeyMap),
+    journalRecords(0),
+    compact(true),
     defaultListener(NULL),
     listener(NULL),
     thisGuid(),
     keyStoreKey(NULL),
     shared(false),
+    journaled(false),
     stored(NULL),
     loaded(NULL)
 {
@@ -222,6 +324,7 @@ QStatus KeyStore::Reset()
         delete defaultListener;
         defaultListener = NULL;
         shared = false;
+        journaled = false;
         return status;
     } else {
         return ER_FAIL;
@@ -236,6 +339,7 @@ QStatus KeyStore::Init(const char* fileName, bool isShared)
             listener = new ProtectedKeyStoreListener(defaultListener);
         }
         shared = isShared;
+        journaled = (defaultListener != NULL) && !shared;
         return Load();
     } else {
         return ER_FAIL;
@@ -253,6 +357,11 @@ QStatus KeyStore::Store()
     /* Don't store if not modified */
     if (storeState == MODIFIED) {
 
+        /* Append the changes to the journal unless the whole key store has to be rewritten */
+        if (journaled && (StoreJournal() == ER_OK)) {
+            return ER_OK;
+        }
+
         lock.Lock(MUTEX_CONTEXT);
         EraseExpiredKeys();
 
@@ -280,6 +389,33 @@ QStatus KeyStore::Store()
     return status;
 }
 
+QStatus KeyStore::StoreJournal()
+{
+    QStatus status = ER_OK;
+    lock.Lock(MUTEX_CONTEXT);
+    if (compact) {
+        status = ER_FAIL;
+    } else if (storeState == MODIFIED) {
+        qcc::String records;
+        status = PushJournal(records);
+        if ((status == ER_OK) && !records.empty()) {
+            status = defaultListener->AppendRequest(records);
+        }
+        if (status == ER_OK) {
+            storeState = LOADED;
+            deletions.clear();
+            if (journalRecords > max(MinJournalRecords, static_cast<uint32_t>(keys->size()))) {
+                compact = true;
+            }
+        } else {
+            /* The journal may now end with a partial record so rewrite the whole key store */
+            compact = true;
+        }
+    }
+    lock.Unlock(MUTEX_CONTEXT);
+    return status;
+}
+
 QStatus KeyStore::Load()
 {
     QStatus status;
@@ -325,6 +461,10 @@ QStatus KeyStore::Pull(Source& source, const qcc::String& password)
 
     lock.Lock(MUTEX_CONTEXT);
 
+    journalPending.clear();
+    journalRecords = 0;
+    compact = false;
+
     uint8_t guidBuf[qcc::GUID128::SIZE];
     size_t pulled;
     size_t len = 0;
@@ -370,7 +510,7 @@ QStatus KeyStore::Pull(Source& source, const qcc::String& password)
         goto ExitPull;
     }
     /* Sanity check on the length */
-    if (len > 64000) {
+    if (len > MaxKeysLen) {
         status = ER_BUS_CORRUPT_KEYSTORE;
         goto ExitPull;
     }
@@ -431,8 +571,20 @@ QStatus KeyStore::Pull(Source& source, const qcc::String& password)
     if (status != ER_OK) {
         goto ExitPull;
     }
+    if (version >= JournalStoreVersion) {
+        status = PullJournal(source);
+        if (status != ER_OK) {
+            goto ExitPull;
+        }
+        if (journalRecords > max(MinJournalRecords, static_cast<uint32_t>(keys->size()))) {
+            compact = true;
+        }
+    } else {
+        compact = true;
+    }
     if (EraseExpiredKeys()) {
         storeState = MODIFIED;
+        compact = true;
     } else {
         storeState = LOADED;
     }
@@ -443,6 +595,9 @@ ExitPull:
         keys->clear();
         storeState = MODIFIED;
     }
+    if (storeState == MODIFIED) {
+        compact = true;
+    }
     if (loaded) {
         loaded->SetEvent();
     }
@@ -450,6 +605,121 @@ ExitPull:
     return status;
 }
 
+QStatus KeyStore::PullJournal(Source& source)
+{
+    uint8_t guidBuf[qcc::GUID128::SIZE];
+    size_t pulled;
+    QStatus status = ER_OK;
+
+    while (status == ER_OK) {
+        uint32_t recLen;
+        uint32_t rev;
+        /* The journal, if there is one, ends at the end of the key store */
+        status = source.PullBytes(&recLen, sizeof(recLen), pulled);
+        if (status == ER_NONE) {
+            return ER_OK;
+        }
+        if ((status == ER_OK) && (pulled == sizeof(recLen))) {
+            status = source.PullBytes(&rev, sizeof(rev), pulled);
+        }
+        if ((status != ER_OK) || (pulled != sizeof(rev)) || (recLen > MaxJournalRecordLen)) {
+            break;
+        }
+        uint8_t* data = new uint8_t[recLen];
+        status = source.PullBytes(data, recLen, pulled);
+        if ((status == ER_OK) && (pulled == recLen)) {
+            size_t len = recLen;
+            Crypto_AES aes(*keyStoreKey, Crypto_AES::CCM);
+            status = aes.Decrypt_CCM(data, data, len, JournalNonce(rev), NULL, 0, 16);
+            uint8_t op = 0;
+            StringSource strSource(data, len);
+            if (status == ER_OK) {
+                status = strSource.PullBytes(&op, sizeof(op), pulled);
+            }
+            if (status == ER_OK) {
+                status = strSource.PullBytes(guidBuf, qcc::GUID128::SIZE, pulled);
+            }
+            if (status == ER_OK) {
+                qcc::GUID128 guid;
+                guid.SetBytes(guidBuf);
+                if (op == JournalAddKey) {
+                    KeyRecord keyRec;
+                    keyRec.revision = rev;
+                    status = keyRec.key.Load(strSource);
+                    if (status == ER_OK) {
+                        status = strSource.PullBytes(&keyRec.accessRights, sizeof(keyRec.accessRights), pulled);
+                    }
+                    if (status == ER_OK) {
+                        (*keys)[guid] = keyRec;
+                    }
+                } else if (op == JournalDelKey) {
+                    keys->erase(guid);
+                } else {
+                    status = ER_BUS_CORRUPT_KEYSTORE;
+                }
+                QCC_DbgPrintf(("KeyStore::PullJournal rev:%d op:%d GUID %s %s", rev, op, guid.ToString().c_str(), QCC_StatusText(status)));
+            }
+        } else {
+            status = ER_BUS_CORRUPT_KEYSTORE;
+        }
+        delete [] data;
+        if (status == ER_OK) {
+            revision = max(revision, rev);
+            ++journalRecords;
+        }
+    }
+    /*
+     * A record that is truncated or fails to decrypt was being written when the application
+     * stopped. Keep the records before it and rewrite the key store on the next store so the bad
+     * record is dropped.
+     */
+    QCC_LogError(ER_BUS_CORRUPT_KEYSTORE, ("Discarding incomplete key store journal record after revision %d", revision));
+    compact = true;
+    return ER_OK;
+}
+
+QStatus KeyStore::PushJournal(qcc::String& records)
+{
+    QStatus status = ER_OK;
+    size_t pushed;
+
+    std::set<qcc::GUID128>::iterator itPend;
+    for (itPend = journalPending.begin(); (status == ER_OK) && (itPend != journalPending.end()); ++itPend) {
+        /*
+         * Each record gets its own revision number so no two records are encrypted with the same
+         * nonce.
+         */
+        uint32_t rev = ++revision;
+        StringSink strSink;
+        KeyMap::iterator it = keys->find(*itPend);
+        uint8_t op = (it == keys->end()) ? JournalDelKey : JournalAddKey;
+        strSink.PushBytes(&op, sizeof(op), pushed);
+        strSink.PushBytes(itPend->GetBytes(), qcc::GUID128::SIZE, pushed);
+        if (op == JournalAddKey) {
+            it->second.revision = rev;
+            it->second.key.Store(strSink);
+            strSink.PushBytes(&it->second.accessRights, sizeof(it->second.accessRights), pushed);
+        }
+        size_t len = strSink.GetString().size();
+        uint8_t* data = new uint8_t[len + 16];
+        Crypto_AES aes(*keyStoreKey, Crypto_AES::CCM);
+        status = aes.Encrypt_CCM(strSink.GetString().data(), data, len, JournalNonce(rev), NULL, 0, 16);
+        if (status == ER_OK) {
+            uint32_t recLen = static_cast<uint32_t>(len);
+            records.append(reinterpret_cast<const char*>(&recLen), sizeof(recLen));
+            records.append(reinterpret_cast<const char*>(&rev), sizeof(rev));
+            records.append(reinterpret_cast<const char*>(data), len);
+            ++journalRecords;
+            QCC_DbgPrintf(("KeyStore::PushJournal rev:%d op:%d GUID %s", rev, op, itPend->ToString().c_str()));
+        }
+        delete [] data;
+    }
+    if (status == ER_OK) {
+        journalPending.clear();
+    }
+    return status;
+}
+
 QStatus KeyStore::Clear()
 {
     if (storeState == UNAVAILABLE) {
@@ -460,6 +730,8 @@ QStatus KeyStore::Clear()
     storeState = MODIFIED;
     revision = 0;
     deletions.clear();
+    journalPending.clear();
+    compact = true;
     lock.Unlock(MUTEX_CONTEXT);
     listener->StoreRequest(*this);
     return ER_OK;
@@ -615,6 +887,10 @@ QStatus KeyStore::Push(Sink& sink)
         goto ExitPush;
     }
     storeState = LOADED;
+    /* The snapshot includes every journal record so the journal starts over */
+    journalPending.clear();
+    journalRecords = 0;
+    compact = false;
 
 ExitPush:
 
@@ -672,6 +948,9 @@ QStatus KeyStore::AddKey(const qcc::GUID128& guid, const KeyBlob& key, const uin
     memcpy(&keyRec.accessRights, accessRights, sizeof(uint8_t) * 4);
     storeState = MODIFIED;
     deletions.erase(guid);
+    if (journaled) {
+        journalPending.insert(guid);
+    }
     lock.Unlock(MUTEX_CONTEXT);
     return ER_OK;
 }
@@ -686,8 +965,15 @@ QStatus KeyStore::DelKey(const qcc::GUID128& guid)
     keys->erase(guid);
     storeState = MODIFIED;
     deletions.insert(guid);
+    if (journaled) {
+        journalPending.insert(guid);
+    }
     lock.Unlock(MUTEX_CONTEXT);
-    listener->StoreRequest(*this);
+    if (journaled) {
+        Store();
+    } else {
+        listener->StoreRequest(*this);
+    }
     return ER_OK;
 }
 
@@ -702,12 +988,19 @@ QStatus KeyStore::SetKeyExpiration(const qcc::GUID128& guid, const Timespec& exp
     if (keys->count(guid) != 0) {
         (*keys)[guid].key.SetExpiration(expiration);
         storeState = MODIFIED;
+        if (journaled) {
+            journalPending.insert(guid);
+        }
     } else {
         status = ER_BUS_KEY_UNAVAILABLE;
     }
     lock.Unlock(MUTEX_CONTEXT);
     if (status == ER_OK) {
-        listener->StoreRequest(*this);
+        if (journaled) {
+            Store();
+        } else {
+            listener->StoreRequest(*this);
+        }
     }
     return status;
 }
@@ -46,6 +46,8 @@
 
 namespace ajn {
 
+class DefaultKeyStoreListener;
+
 /**
  * The %KeyStore class manages the storing and loading of key blobs from
  * external storage.
@@ -290,6 +292,29 @@ class KeyStore {
      */
     QStatus Load();
 
+    /**
+     * Read the journal records that follow the key store snapshot and apply them to the keys.
+     *
+     * @param source   The source positioned after the snapshot.
+     */
+    QStatus PullJournal(qcc::Source& source);
+
+    /**
+     * Encode and encrypt a journal record for each key that has been added, changed or deleted
+     * since the key store was last written.
+     *
+     * @param records  Returns the journal records to append to the key store.
+     */
+    QStatus PushJournal(qcc::String& records);
+
+    /**
+     * Append journal records to the key store instead of writing the whole key store.
+     *
+     * @return ER_OK if the changes were appended, an error status if the whole key store must be
+     *         written instead.
+     */
+    QStatus StoreJournal();
+
     /**
      * The application that owns this key store. If the key store is shared this will be the name
      * of a suite of applications.
@@ -331,10 +356,25 @@ class KeyStore {
      */
     std::set<qcc::GUID128> deletions;
 
+    /**
+     * GUIDs of keys that have been added, changed or deleted since the key store was last written
+     */
+    std::set<qcc::GUID128> journalPending;
+
+    /**
+     * Number of journal records that follow the key store snapshot
+     */
+    uint32_t journalRecords;
+
+    /**
+     * Indicates the next store must rewrite the whole key store rather than append to the journal
+     */
+    bool compact;
+
     /**
      * Default listener for handling load/store requests
      */
-    KeyStoreListener* defaultListener;
+    DefaultKeyStoreListener* defaultListener;
 
     /**
      * Listener for handling load/store requests
@@ -366,6 +406,12 @@ class KeyStore {
      */
     bool shared;
 
+    /**
+     * Indicates if changes are appended to a journal. Only the default listener for a key store
+     * that is not shared supports the journal.
+     */
+    bool journaled;
+
     /**
      * Event for synchronizing store requests
      */
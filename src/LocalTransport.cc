@@ -22,7 +22,8 @@
  ******************************************************************************/
 #include <qcc/platform.h>
 
-#include <list>
+#include <deque>
+#include <vector>
 
 #include <qcc/Debug.h>
 #include <qcc/GUID.h>
@@ -30,6 +31,7 @@
 #include <qcc/StringUtil.h>
 #include <qcc/Thread.h>
 #include <qcc/atomic.h>
+#include <qcc/time.h>
 
 #include <alljoyn/DBusStd.h>
 #include <alljoyn/AllJoynStd.h>
@@ -55,23 +57,112 @@ namespace ajn {
 
 static const uint32_t LOCAL_ENDPOINT_CONCURRENCY = 4;
 
+/*
+ * Number of lanes messages are distributed over. Messages in the same lane are dispatched one at
+ * a time in the order they were received.
+ */
+static const uint32_t DISPATCH_LANES = 64;
+
+/* Deferred callbacks have a lane of their own after the message lanes */
+static const uint32_t CALLBACK_LANE = DISPATCH_LANES;
+
+/* Name of the dispatcher threads. Used to recognize a dispatcher thread */
+static const char DISPATCH_THREAD_NAME[] = "lepDisp";
+
+/* Maximum number of messages waiting to be dispatched before the senders are blocked */
+static const int32_t MAX_DISPATCH_PENDING = 10;
 
-class _LocalEndpoint::Dispatcher : public qcc::Timer, public qcc::AlarmListener {
+/* Longest time an idle dispatcher thread waits before looking for work to steal */
+static const uint32_t DISPATCH_IDLE_MS = 500;
+
+/*
+ * The dispatcher calls message handlers on a pool of concurrency threads. Messages are assigned
+ * to a lane by sender and session so all the messages from one sender in one session (and
+ * therefore all the calls it makes on a given BusObject) are handled in order. A lane with
+ * messages is queued on one thread at a time. Each thread runs the lanes on its own queue and
+ * steals lanes from the other threads when it runs out.
+ *
+ * Only one handler runs at a time unless the handler calls EnableReentrancy
+ * (BusAttachment::EnableConcurrentCallbacks). Enabling reentrancy also releases the handler's
+ * lane so the next message from the same sender (such as the reply to a call the handler is
+ * about to make) can be dispatched on another thread.
+ */
+class _LocalEndpoint::Dispatcher {
   public:
-    Dispatcher(_LocalEndpoint* endpoint, uint32_t concurrency = LOCAL_ENDPOINT_CONCURRENCY) : Timer("lepDisp", true, concurrency, true, 10), AlarmListener(), endpoint(endpoint) { }
+    Dispatcher(_LocalEndpoint* endpoint, BusAttachment& bus, uint32_t concurrency = LOCAL_ENDPOINT_CONCURRENCY);
+
+    ~Dispatcher();
+
+    QStatus Start();
+
+    QStatus Stop();
+
+    QStatus Join();
+
     QStatus DispatchMessage(Message& msg);
 
-    void AlarmTriggered(const qcc::Alarm& alarm, QStatus reason);
+    QStatus DispatchCallbacks(DeferredCallbacks* callbacks);
+
+    void EnableReentrancy();
+
+    bool ThreadHoldsLock();
 
   private:
+
+    /* A message, or a request to run the deferred callbacks, waiting to be dispatched */
+    struct Work {
+        Work(const Message& msg, DeferredCallbacks* callbacks) : msg(msg), callbacks(callbacks) { }
+        Message msg;
+        DeferredCallbacks* callbacks;
+    };
+
+    struct Lane {
+        Lane() : scheduled(false) { }
+        std::deque<Work> queue;   /* Work in this lane */
+        bool scheduled;           /* True if the lane is on a worker queue or being run */
+        qcc::Mutex lock;          /* Protects queue and scheduled */
+    };
+
+    class Worker : public qcc::Thread {
+      public:
+        Worker(Dispatcher& dispatcher) : Thread(DISPATCH_THREAD_NAME), dispatcher(dispatcher), holdsLock(false), current(NULL) { }
+
+        Dispatcher& dispatcher;
+        std::deque<Lane*> lanes;  /* Lanes scheduled on this worker */
+        qcc::Mutex lock;          /* Protects lanes */
+        bool holdsLock;           /* True while this worker holds the reentrancy lock */
+        Lane* current;            /* Lane being run or NULL if the lane has been released */
+
+      protected:
+        qcc::ThreadReturn STDCALL Run(void* arg);
+    };
+
+    QStatus Enqueue(uint32_t lane, const Work& work);
+    void Schedule(Lane* lane, Worker* worker);
+    Lane* NextLane(Worker* worker);
+    void RunLane(Worker* worker, Lane* lane);
+    void ReleaseLane(Worker* worker);
+    void SetStopping(bool stop);
+    Worker* CurrentWorker();
+
     _LocalEndpoint* endpoint;
+    Message idleMsg;                   /* Placeholder message for work that is not a message */
+    uint32_t concurrency;
+    Lane lanes[DISPATCH_LANES + 1];    /* Message lanes followed by the callback lane */
+    std::vector<Worker*> workers;
+    qcc::Event workEvent;              /* Set when a lane is scheduled */
+    qcc::Event spaceEvent;             /* Set when the number of pending messages drops */
+    volatile int32_t pending;          /* Number of queued messages */
+    volatile int32_t nextWorker;       /* Round robin worker selection for work queued by other threads */
+    qcc::Mutex reentrancyLock;         /* Held while a handler runs unless it enables reentrancy */
+    volatile bool stopping;            /* Only changed with every lane lock held */
 };
 
-class _LocalEndpoint::DeferredCallbacks : public qcc::AlarmListener {
+class _LocalEndpoint::DeferredCallbacks {
   public:
     DeferredCallbacks(_LocalEndpoint* ep) : endpoint(ep) { }
 
-    void AlarmTriggered(const qcc::Alarm& alarm, QStatus reason);
+    void Run();
 
   private:
     _LocalEndpoint* endpoint;
@@ -109,50 +200,9 @@ bool LocalTransport::IsRunning()
     return !isStoppedEvent.IsSet();
 }
 
-class _LocalEndpoint::ReplyContext {
-  public:
-    ReplyContext(LocalEndpoint ep,
-                 MessageReceiver* receiver,
-                 MessageReceiver::ReplyHandler handler,
-                 const InterfaceDescription::Member* method,
-                 Message& methodCall,
-                 void* context,
-                 uint32_t timeout) :
-        ep(ep),
-        receiver(receiver),
-        handler(handler),
-        method(method),
-        callFlags(methodCall->GetFlags()),
-        serial(methodCall->msgHeader.serialNum),
-        context(context)
-    {
-        uint32_t zero = 0;
-        void* tempContext = (void*)this;
-        AlarmListener* listener = ep.unwrap();
-        alarm = Alarm(timeout, listener, tempContext, zero);
-    }
-
-    ~ReplyContext() {
-        ep->replyTimer.RemoveAlarm(alarm, false /* don't block if alarm in progress */);
-    }
-
-    LocalEndpoint ep;                            /* The endpoint this reply context is associated with */
-    MessageReceiver* receiver;                   /* The object to receive the reply */
-    MessageReceiver::ReplyHandler handler;       /* The receiving object's handler function */
-    const InterfaceDescription::Member* method;  /* The method that was called */
-    uint8_t callFlags;                           /* Flags from the method call */
-    uint32_t serial;                             /* Serial number for the method reply */
-    void* context;                               /* The calling object's context */
-    qcc::Alarm alarm;                            /* Alarm object for handling method call timeouts */
-
-  private:
-    ReplyContext(const ReplyContext& other);
-    ReplyContext operator=(const ReplyContext& other);
-};
-
 _LocalEndpoint::_LocalEndpoint(BusAttachment& bus, uint32_t concurrency) :
     _BusEndpoint(ENDPOINT_TYPE_LOCAL),
-    dispatcher(new Dispatcher(this, concurrency)),
+    dispatcher(new Dispatcher(this, bus, concurrency)),
     deferredCallbacks(new DeferredCallbacks(this)),
     running(false),
     isRegistered(false),
@@ -160,6 +210,8 @@ _LocalEndpoint::_LocalEndpoint(BusAttachment& bus, uint32_t concurrency) :
     objectsLock(),
     replyMapLock(),
     replyTimer("replyTimer", true),
+    replyWheel(REPLY_TICK_MS, REPLY_WHEEL_SLOTS),
+    replyAlarmTime(0),
     dbusObj(NULL),
     alljoynObj(NULL),
     alljoynDebugObj(NULL),
@@ -180,11 +232,8 @@ _LocalEndpoint::~_LocalEndpoint()
          * Delete any stale reply contexts
          */
         replyMapLock.Lock(MUTEX_CONTEXT);
-        for (map<uint32_t, ReplyContext*>::iterator iter = replyMap.begin(); iter != replyMap.end(); ++iter) {
-            QCC_DbgHLPrintf(("LocalEndpoint~LocalEndpoint deleting reply handler for serial %u", iter->second->serial));
-            delete iter->second;
-        }
-        replyMap.clear();
+        QCC_DbgHLPrintf(("LocalEndpoint~LocalEndpoint deleting %u reply handlers", static_cast<uint32_t>(replyMap.Size())));
+        replyMap.Clear();
         replyMapLock.Unlock(MUTEX_CONTEXT);
         /*
          * Unregister all application registered bus objects
@@ -390,22 +439,315 @@ QStatus _LocalEndpoint::PeerInterface(Message& message)
 }
 
 
-QStatus _LocalEndpoint::Dispatcher::DispatchMessage(Message& msg)
+/*
+ * Select the lane for a message from the sender and session.
+ */
+static uint32_t DispatchLane(Message& msg)
 {
-    uint32_t zero = 0;
-    void* context = new Message(msg);
-    qcc::AlarmListener* localEndpointListener = this;
-    Alarm alarm(zero, localEndpointListener, context, zero);
-    QStatus status = AddAlarm(alarm);
-    if (status != ER_OK) {
-        Message* temp = static_cast<Message*>(context);
-        if (temp) {
-            delete temp;
+    uint32_t hash = msg->GetSessionId();
+    for (const char* c = msg->GetSender(); c && *c; ++c) {
+        hash = (hash * 31) + static_cast<uint8_t>(*c);
+    }
+    return hash % DISPATCH_LANES;
+}
+
+_LocalEndpoint::Dispatcher::Dispatcher(_LocalEndpoint* endpoint, BusAttachment& bus, uint32_t concurrency) :
+    endpoint(endpoint),
+    idleMsg(bus),
+    concurrency(concurrency ? concurrency : 1),
+    pending(0),
+    nextWorker(0),
+    stopping(false)
+{
+}
+
+_LocalEndpoint::Dispatcher::~Dispatcher()
+{
+    Stop();
+    Join();
+}
+
+QStatus _LocalEndpoint::Dispatcher::Start()
+{
+    QStatus status = ER_OK;
+    SetStopping(false);
+    if (workers.empty()) {
+        for (uint32_t i = 0; i < concurrency; ++i) {
+            workers.push_back(new Worker(*this));
+        }
+        for (uint32_t i = 0; (status == ER_OK) && (i < concurrency); ++i) {
+            status = workers[i]->Start();
+        }
+        /* Schedule anything that was queued before there were workers to run it */
+        for (uint32_t i = 0; i < ArraySize(lanes); ++i) {
+            lanes[i].lock.Lock(MUTEX_CONTEXT);
+            bool queued = !lanes[i].queue.empty();
+            lanes[i].lock.Unlock(MUTEX_CONTEXT);
+            if (queued) {
+                Schedule(&lanes[i], NULL);
+            }
         }
     }
     return status;
 }
 
+/*
+ * Enqueue checks stopping with the lane lock held so nothing can be queued once Stop returns.
+ */
+void _LocalEndpoint::Dispatcher::SetStopping(bool stop)
+{
+    for (uint32_t i = 0; i < ArraySize(lanes); ++i) {
+        lanes[i].lock.Lock(MUTEX_CONTEXT);
+    }
+    stopping = stop;
+    for (uint32_t i = 0; i < ArraySize(lanes); ++i) {
+        lanes[i].lock.Unlock(MUTEX_CONTEXT);
+    }
+}
+
+QStatus _LocalEndpoint::Dispatcher::Stop()
+{
+    SetStopping(true);
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i]->Stop();
+    }
+    spaceEvent.SetEvent();
+    return ER_OK;
+}
+
+QStatus _LocalEndpoint::Dispatcher::Join()
+{
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i]->Join();
+        delete workers[i];
+    }
+    workers.clear();
+    /*
+     * Messages that were not dispatched before the dispatcher stopped are discarded
+     */
+    for (uint32_t i = 0; i < ArraySize(lanes); ++i) {
+        lanes[i].lock.Lock(MUTEX_CONTEXT);
+        lanes[i].queue.clear();
+        lanes[i].scheduled = false;
+        lanes[i].lock.Unlock(MUTEX_CONTEXT);
+    }
+    pending = 0;
+    return ER_OK;
+}
+
+/*
+ * Dispatcher threads are recognized by name so the current worker is found without searching.
+ */
+_LocalEndpoint::Dispatcher::Worker* _LocalEndpoint::Dispatcher::CurrentWorker()
+{
+    Thread* thread = Thread::GetThread();
+    if (thread && (strcmp(thread->GetName(), DISPATCH_THREAD_NAME) == 0)) {
+        Worker* worker = static_cast<Worker*>(thread);
+        if (&worker->dispatcher == this) {
+            return worker;
+        }
+    }
+    return NULL;
+}
+
+QStatus _LocalEndpoint::Dispatcher::DispatchMessage(Message& msg)
+{
+    return Enqueue(DispatchLane(msg), Work(msg, NULL));
+}
+
+QStatus _LocalEndpoint::Dispatcher::DispatchCallbacks(DeferredCallbacks* callbacks)
+{
+    return Enqueue(CALLBACK_LANE, Work(idleMsg, callbacks));
+}
+
+QStatus _LocalEndpoint::Dispatcher::Enqueue(uint32_t laneIndex, const Work& work)
+{
+    if (stopping) {
+        return ER_TIMER_EXITING;
+    }
+    Worker* worker = CurrentWorker();
+    /*
+     * Block the sender while too many messages are waiting. Handlers that send messages to
+     * this endpoint are never blocked.
+     */
+    if (!worker) {
+        while (pending >= MAX_DISPATCH_PENDING) {
+            spaceEvent.ResetEvent();
+            if (stopping) {
+                return ER_TIMER_EXITING;
+            }
+            if (pending < MAX_DISPATCH_PENDING) {
+                break;
+            }
+            QStatus status = Event::Wait(spaceEvent, DISPATCH_IDLE_MS);
+            if ((status != ER_OK) && (status != ER_TIMEOUT)) {
+                return status;
+            }
+        }
+    }
+    IncrementAndFetch(&pending);
+
+    Lane* lane = &lanes[laneIndex];
+    lane->lock.Lock(MUTEX_CONTEXT);
+    if (stopping) {
+        lane->lock.Unlock(MUTEX_CONTEXT);
+        if (DecrementAndFetch(&pending) < MAX_DISPATCH_PENDING) {
+            spaceEvent.SetEvent();
+        }
+        return ER_TIMER_EXITING;
+    }
+    lane->queue.push_back(work);
+    bool schedule = !lane->scheduled;
+    lane->scheduled = true;
+    lane->lock.Unlock(MUTEX_CONTEXT);
+    if (schedule) {
+        Schedule(lane, worker);
+    }
+    return ER_OK;
+}
+
+/*
+ * Put a lane on a worker queue. Lanes scheduled by a worker stay on that worker, lanes
+ * scheduled by other threads are spread round robin.
+ */
+void _LocalEndpoint::Dispatcher::Schedule(Lane* lane, Worker* worker)
+{
+    if (!worker) {
+        if (workers.empty()) {
+            return;
+        }
+        worker = workers[static_cast<uint32_t>(IncrementAndFetch(&nextWorker)) % workers.size()];
+    }
+    worker->lock.Lock(MUTEX_CONTEXT);
+    worker->lanes.push_back(lane);
+    worker->lock.Unlock(MUTEX_CONTEXT);
+    workEvent.SetEvent();
+}
+
+/*
+ * Take the next lane from the worker's own queue or steal one from the back of another
+ * worker's queue.
+ */
+_LocalEndpoint::Dispatcher::Lane* _LocalEndpoint::Dispatcher::NextLane(Worker* worker)
+{
+    Lane* lane = NULL;
+    worker->lock.Lock(MUTEX_CONTEXT);
+    if (!worker->lanes.empty()) {
+        lane = worker->lanes.front();
+        worker->lanes.pop_front();
+    }
+    worker->lock.Unlock(MUTEX_CONTEXT);
+    for (size_t i = 0; !lane && (i < workers.size()); ++i) {
+        Worker* victim = workers[i];
+        if (victim != worker) {
+            victim->lock.Lock(MUTEX_CONTEXT);
+            if (!victim->lanes.empty()) {
+                lane = victim->lanes.back();
+                victim->lanes.pop_back();
+            }
+            victim->lock.Unlock(MUTEX_CONTEXT);
+        }
+    }
+    return lane;
+}
+
+/*
+ * Dispatch the message at the head of a lane. The lane goes to the back of the worker queue if
+ * it has more messages so a busy sender does not starve the others.
+ */
+void _LocalEndpoint::Dispatcher::RunLane(Worker* worker, Lane* lane)
+{
+    lane->lock.Lock(MUTEX_CONTEXT);
+    Work work = lane->queue.front();
+    lane->queue.pop_front();
+    lane->lock.Unlock(MUTEX_CONTEXT);
+
+    worker->current = lane;
+    reentrancyLock.Lock(MUTEX_CONTEXT);
+    worker->holdsLock = true;
+    if (work.callbacks) {
+        work.callbacks->Run();
+    } else {
+        QStatus status = endpoint->DoPushMessage(work.msg);
+        // ER_BUS_STOPPING is a common shutdown error
+        if (status != ER_OK && status != ER_BUS_STOPPING) {
+            QCC_LogError(status, ("LocalEndpoint::DoPushMessage failed"));
+        }
+    }
+    if (worker->holdsLock) {
+        worker->holdsLock = false;
+        reentrancyLock.Unlock(MUTEX_CONTEXT);
+    }
+
+    if (DecrementAndFetch(&pending) < MAX_DISPATCH_PENDING) {
+        spaceEvent.SetEvent();
+    }
+
+    /* The lane has already been rescheduled if the handler released it */
+    if (worker->current == lane) {
+        worker->current = NULL;
+        lane->lock.Lock(MUTEX_CONTEXT);
+        bool more = !lane->queue.empty();
+        lane->scheduled = more;
+        lane->lock.Unlock(MUTEX_CONTEXT);
+        if (more) {
+            Schedule(lane, worker);
+        }
+    }
+}
+
+/*
+ * Let the rest of the worker's current lane be dispatched while the handler is still running.
+ * The lane is spread round robin because this worker is busy with the handler.
+ */
+void _LocalEndpoint::Dispatcher::ReleaseLane(Worker* worker)
+{
+    Lane* lane = worker->current;
+    if (lane) {
+        worker->current = NULL;
+        lane->lock.Lock(MUTEX_CONTEXT);
+        bool more = !lane->queue.empty();
+        lane->scheduled = more;
+        lane->lock.Unlock(MUTEX_CONTEXT);
+        if (more) {
+            Schedule(lane, NULL);
+        }
+    }
+}
+
+qcc::ThreadReturn STDCALL _LocalEndpoint::Dispatcher::Worker::Run(void* arg)
+{
+    while (!IsStopping()) {
+        /*
+         * Reset before looking for work, a lane scheduled after this sets the event again.
+         */
+        dispatcher.workEvent.ResetEvent();
+        Lane* lane = dispatcher.NextLane(this);
+        if (lane) {
+            dispatcher.RunLane(this, lane);
+        } else {
+            Event::Wait(dispatcher.workEvent, DISPATCH_IDLE_MS);
+        }
+    }
+    return 0;
+}
+
+void _LocalEndpoint::Dispatcher::EnableReentrancy()
+{
+    Worker* worker = CurrentWorker();
+    if (worker && worker->holdsLock) {
+        worker->holdsLock = false;
+        reentrancyLock.Unlock(MUTEX_CONTEXT);
+        ReleaseLane(worker);
+    }
+}
+
+bool _LocalEndpoint::Dispatcher::ThreadHoldsLock()
+{
+    Worker* worker = CurrentWorker();
+    return worker && worker->holdsLock;
+}
+
 void _LocalEndpoint::EnableReentrancy()
 {
     if (dispatcher) {
@@ -422,21 +764,6 @@ bool _LocalEndpoint::IsReentrantCall()
 
 }
 
-void _LocalEndpoint::Dispatcher::AlarmTriggered(const Alarm& alarm, QStatus reason)
-{
-    Message* msg = static_cast<Message*>(alarm->GetContext());
-    if (msg) {
-        if (reason == ER_OK) {
-            QStatus status = endpoint->DoPushMessage(*msg);
-            // ER_BUS_STOPPING is a common shutdown error
-            if (status != ER_OK && status != ER_BUS_STOPPING) {
-                QCC_LogError(status, ("LocalEndpoint::DoPushMessage failed"));
-            }
-        }
-        delete msg;
-    }
-}
-
 QStatus _LocalEndpoint::PushMessage(Message& message)
 {
     QStatus ret;
@@ -649,10 +976,10 @@ void _LocalEndpoint::UpdateSerialNumber(Message& msg)
          */
         if (msg->GetType() == MESSAGE_METHOD_CALL) {
             replyMapLock.Lock(MUTEX_CONTEXT);
-            ReplyContext* rc = RemoveReplyHandler(serial);
-            if (rc) {
-                rc->serial = msg->msgHeader.serialNum;
-                replyMap[rc->serial] = rc;
+            ReplyContext rc;
+            if (RemoveReplyHandler(serial, rc)) {
+                rc.serial = msg->msgHeader.serialNum;
+                AddReplyHandler(rc);
             }
             replyMapLock.Unlock(MUTEX_CONTEXT);
         }
@@ -672,18 +999,23 @@ QStatus _LocalEndpoint::RegisterReplyHandler(MessageReceiver* receiver,
         status = ER_BUS_STOPPING;
         QCC_LogError(status, ("Local transport not running"));
     } else {
-        ReplyContext* rc =  new ReplyContext(LocalEndpoint::wrap(this), receiver, replyHandler, &method, methodCallMsg, context, timeout);
+        ReplyContext rc;
+        rc.receiver = receiver;
+        rc.handler = replyHandler;
+        rc.method = &method;
+        rc.callFlags = methodCallMsg->GetFlags();
+        rc.serial = methodCallMsg->msgHeader.serialNum;
+        rc.context = context;
+        if (timeout != Event::WAIT_FOREVER) {
+            rc.deadline = GetTimestamp64() + timeout;
+        }
         QCC_DbgPrintf(("LocalEndpoint::RegisterReplyHandler"));
         /*
-         * Add reply context.
+         * Add reply context and set timeout
          */
         replyMapLock.Lock(MUTEX_CONTEXT);
-        replyMap[methodCallMsg->msgHeader.serialNum] = rc;
+        status = AddReplyHandler(rc);
         replyMapLock.Unlock(MUTEX_CONTEXT);
-        /*
-         * Set timeout
-         */
-        status = replyTimer.AddAlarm(rc->alarm);
         if (status != ER_OK) {
             UnregisterReplyHandler(methodCallMsg);
         }
@@ -694,30 +1026,79 @@ QStatus _LocalEndpoint::RegisterReplyHandler(MessageReceiver* receiver,
 bool _LocalEndpoint::UnregisterReplyHandler(Message& methodCall)
 {
     replyMapLock.Lock(MUTEX_CONTEXT);
-    ReplyContext* rc = RemoveReplyHandler(methodCall->msgHeader.serialNum);
+    ReplyContext rc;
+    bool removed = RemoveReplyHandler(methodCall->msgHeader.serialNum, rc);
     replyMapLock.Unlock(MUTEX_CONTEXT);
-    if (rc) {
-        delete rc;
-        return true;
-    } else {
-        return false;
+    return removed;
+}
+
+/*
+ * NOTE: Must be called holding replyMapLock
+ */
+QStatus _LocalEndpoint::AddReplyHandler(const ReplyContext& rc)
+{
+    replyMap.Insert(rc.serial, rc);
+    if (rc.deadline && !rc.paused) {
+        replyWheel.Add(rc.serial, rc.deadline);
+        return ScheduleReplyAlarm(rc.deadline);
+    }
+    return ScheduleReplyAlarm(0);
+}
+
+/*
+ * NOTE: Must be called holding replyMapLock
+ */
+QStatus _LocalEndpoint::ScheduleReplyAlarm(uint64_t deadline)
+{
+    /*
+     * The wheel is advanced by a single alarm that is kept pending while there are reply
+     * handlers. The alarm also fails the outstanding method calls when the timer exits.
+     */
+    if (replyMap.Size() == 0) {
+        return ER_OK;
+    }
+    uint64_t now = GetTimestamp64();
+    uint64_t when = now + REPLY_IDLE_MS;
+    if (deadline && (deadline < when)) {
+        when = deadline;
+    }
+    /*
+     * A pending alarm that fires first will schedule the next one when it is triggered.
+     */
+    if (replyAlarmTime && (replyAlarmTime <= when)) {
+        return ER_OK;
     }
+    AlarmListener* listener = this;
+    Alarm alarm((when > now) ? static_cast<uint32_t>(when - now) : 0, listener);
+    QStatus status = ER_FAIL;
+    if (replyAlarmTime) {
+        status = replyTimer.ReplaceAlarm(replyAlarm, alarm, false);
+    }
+    /*
+     * If the pending alarm could not be replaced it has already been triggered.
+     */
+    if (status != ER_OK) {
+        status = replyTimer.AddAlarm(alarm);
+    }
+    if (status == ER_OK) {
+        replyAlarm = alarm;
+        replyAlarmTime = when;
+    }
+    return status;
 }
 
 /*
  * NOTE: Must be called holding replyMapLock
  */
-_LocalEndpoint::ReplyContext* _LocalEndpoint::RemoveReplyHandler(uint32_t serial)
+bool _LocalEndpoint::RemoveReplyHandler(uint32_t serial, ReplyContext& rc)
 {
     QCC_DbgPrintf(("LocalEndpoint::RemoveReplyHandler for serial=%u", serial));
-    ReplyContext* rc = NULL;
-    map<uint32_t, ReplyContext*>::iterator iter = replyMap.find(serial);
-    if (iter != replyMap.end()) {
-        rc = iter->second;
-        replyMap.erase(iter);
-        assert(rc->serial == serial);
-    }
-    return rc;
+    bool removed = replyMap.Remove(serial, &rc);
+    assert(!removed || (rc.serial == serial));
+    if (removed && rc.deadline && !rc.paused) {
+        replyWheel.Remove(serial, rc.deadline);
+    }
+    return removed;
 }
 
 bool _LocalEndpoint::PauseReplyHandlerTimeout(Message& methodCallMsg)
@@ -725,10 +1106,13 @@ bool _LocalEndpoint::PauseReplyHandlerTimeout(Message& methodCallMsg)
     bool paused = false;
     if (methodCallMsg->GetType() == MESSAGE_METHOD_CALL) {
         replyMapLock.Lock();
-        map<uint32_t, ReplyContext*>::iterator iter = replyMap.find(methodCallMsg->GetCallSerial());
-        if (iter != replyMap.end()) {
-            ReplyContext*rc = iter->second;
-            paused = replyTimer.RemoveAlarm(rc->alarm);
+        ReplyContext* rc = replyMap.Find(methodCallMsg->GetCallSerial());
+        if (rc && !rc->paused) {
+            rc->paused = true;
+            if (rc->deadline) {
+                replyWheel.Remove(rc->serial, rc->deadline);
+            }
+            paused = true;
         }
         replyMapLock.Unlock();
     }
@@ -740,15 +1124,14 @@ bool _LocalEndpoint::ResumeReplyHandlerTimeout(Message& methodCallMsg)
     bool resumed = false;
     if (methodCallMsg->GetType() == MESSAGE_METHOD_CALL) {
         replyMapLock.Lock();
-        map<uint32_t, ReplyContext*>::iterator iter = replyMap.find(methodCallMsg->GetCallSerial());
-        if (iter != replyMap.end()) {
-            ReplyContext*rc = iter->second;
-            QStatus status = replyTimer.AddAlarm(rc->alarm);
-            if (status == ER_OK) {
-                resumed = true;
-            } else {
-                QCC_LogError(status, ("Failed to resume reply handler timeout for %s", methodCallMsg->Description().c_str()));
+        ReplyContext* rc = replyMap.Find(methodCallMsg->GetCallSerial());
+        if (rc && rc->paused) {
+            rc->paused = false;
+            if (rc->deadline) {
+                replyWheel.Add(rc->serial, rc->deadline);
+                ScheduleReplyAlarm(rc->deadline);
             }
+            resumed = true;
         }
         replyMapLock.Unlock();
     }
@@ -801,73 +1184,116 @@ QStatus _LocalEndpoint::UnregisterAllHandlers(MessageReceiver* receiver)
      * Remove any reply handlers for this receiver
      */
     replyMapLock.Lock(MUTEX_CONTEXT);
-    for (map<uint32_t, ReplyContext*>::iterator iter = replyMap.begin(); iter != replyMap.end();) {
-        ReplyContext* rc = iter->second;
-        if (rc->receiver == receiver) {
-            replyMap.erase(iter);
-            delete rc;
-            iter = replyMap.begin();
-        } else {
-            ++iter;
+    for (size_t i = 0; i < replyMap.Capacity(); ++i) {
+        uint32_t serial;
+        ReplyContext* rc = replyMap.At(i, serial);
+        if (rc && (rc->receiver == receiver)) {
+            if (rc->deadline && !rc->paused) {
+                replyWheel.Remove(serial, rc->deadline);
+            }
+            replyMap.Remove(serial);
         }
     }
     replyMapLock.Unlock(MUTEX_CONTEXT);
     return ER_OK;
 }
 
+void _LocalEndpoint::UnregisterReplyHandlers(MessageReceiver* receiver, MessageReceiver::ReplyHandler replyHandler, std::vector<void*>& contexts)
+{
+    replyMapLock.Lock(MUTEX_CONTEXT);
+    for (size_t i = 0; i < replyMap.Capacity(); ++i) {
+        uint32_t serial;
+        ReplyContext* rc = replyMap.At(i, serial);
+        if (rc && (rc->receiver == receiver) && (rc->handler == replyHandler)) {
+            if (rc->deadline && !rc->paused) {
+                replyWheel.Remove(serial, rc->deadline);
+            }
+            contexts.push_back(rc->context);
+            replyMap.Remove(serial);
+        }
+    }
+    replyMapLock.Unlock(MUTEX_CONTEXT);
+}
+
 /*
  * Alarm handler for method calls that have not received a response within the timeout period.
  */
 void _LocalEndpoint::AlarmTriggered(const Alarm& alarm, QStatus reason)
 {
-    ReplyContext* rc = reinterpret_cast<ReplyContext*>(alarm->GetContext());
+    vector<TimingWheel::Entry> due;
+    vector<uint32_t> expired;
+
     replyMapLock.Lock(MUTEX_CONTEXT);
-    /* Search for the ReplyContext entry in the replyMap */
-    bool found = false;
-    for (map<uint32_t, ReplyContext*>::iterator iter = replyMap.begin(); iter != replyMap.end(); iter++) {
-        if (rc == iter->second) {
-            found = true;
-            break;
+    if (alarm == replyAlarm) {
+        replyAlarmTime = 0;
+    }
+    if (reason == ER_TIMER_EXITING) {
+        /*
+         * The timer is exiting so all method calls that are not paused fail.
+         */
+        for (size_t i = 0; i < replyMap.Capacity(); ++i) {
+            uint32_t serial;
+            ReplyContext* rc = replyMap.At(i, serial);
+            if (rc && !rc->paused) {
+                expired.push_back(serial);
+            }
+        }
+    } else {
+        replyWheel.Advance(GetTimestamp64(), due);
+        for (vector<TimingWheel::Entry>::const_iterator it = due.begin(); it != due.end(); ++it) {
+            /*
+             * Skip timeouts that no longer match the method call.
+             */
+            ReplyContext* rc = replyMap.Find(it->key);
+            if (rc && !rc->paused && (rc->deadline == it->deadline)) {
+                expired.push_back(it->key);
+            }
         }
     }
-
-    if (found == false) {
-        /* If an entry for the ReplyContext is not found, it might have been deleted due to a MethodReply. */
-        replyMapLock.Unlock(MUTEX_CONTEXT);
-        return;
+    for (vector<uint32_t>::const_iterator it = expired.begin(); it != expired.end(); ++it) {
+        /*
+         * Clear the encrypted flag so the error response doesn't get rejected.
+         */
+        replyMap.Find(*it)->callFlags &= ~ALLJOYN_FLAG_ENCRYPTED;
+    }
+    if (reason != ER_TIMER_EXITING) {
+        /*
+         * Finding the earliest deadline scans the wheel so it is only done here. Adding a
+         * method call only needs to compare its own deadline with the pending alarm.
+         */
+        uint64_t next;
+        ScheduleReplyAlarm(replyWheel.NextDeadline(next) ? next : 0);
     }
-    uint32_t serial = rc->serial;
-    Message msg(*bus);
-    QStatus status = ER_OK;
-
-    /*
-     * Clear the encrypted flag so the error response doesn't get rejected.
-     */
-    rc->callFlags &= ~ALLJOYN_FLAG_ENCRYPTED;
     replyMapLock.Unlock(MUTEX_CONTEXT);
 
-    if (running) {
-        QCC_DbgPrintf(("Timed out waiting for METHOD_REPLY with serial %d", serial));
-        if (reason == ER_TIMER_EXITING) {
-            msg->ErrorMsg("org.alljoyn.Bus.Exiting", serial);
+    for (vector<uint32_t>::const_iterator it = expired.begin(); it != expired.end(); ++it) {
+        uint32_t serial = *it;
+        Message msg(*bus);
+        QStatus status = ER_OK;
+
+        if (running) {
+            QCC_DbgPrintf(("Timed out waiting for METHOD_REPLY with serial %d", serial));
+            if (reason == ER_TIMER_EXITING) {
+                msg->ErrorMsg("org.alljoyn.Bus.Exiting", serial);
+            } else {
+                msg->ErrorMsg("org.alljoyn.Bus.Timeout", serial);
+            }
+            /*
+             * Forward the message via the dispatcher so we conform to our concurrency model.
+             */
+            status = dispatcher->DispatchMessage(msg);
+
         } else {
-            msg->ErrorMsg("org.alljoyn.Bus.Timeout", serial);
+            msg->ErrorMsg("org.alljoyn.Bus.Exiting", serial);
+            HandleMethodReply(msg);
         }
         /*
-         * Forward the message via the dispatcher so we conform to our concurrency model.
+         * If the dispatch failed or we are no longer running handle the reply on this thread.
          */
-        status = dispatcher->DispatchMessage(msg);
-
-    } else {
-        msg->ErrorMsg("org.alljoyn.Bus.Exiting", serial);
-        HandleMethodReply(msg);
-    }
-    /*
-     * If the dispatch failed or we are no longer running handle the reply on this thread.
-     */
-    if (status != ER_OK) {
-        msg->ErrorMsg("org.alljoyn.Bus.Exiting", serial);
-        HandleMethodReply(msg);
+        if (status != ER_OK) {
+            msg->ErrorMsg("org.alljoyn.Bus.Exiting", serial);
+            HandleMethodReply(msg);
+        }
     }
 }
 
@@ -876,10 +1302,9 @@ QStatus _LocalEndpoint::HandleMethodCall(Message& message)
     QStatus status = ER_OK;
 
     /* Look up the member */
-    MethodTable::SafeEntry* safeEntry = methodTable.Find(message->GetObjectPath(),
-                                                         message->GetInterface(),
-                                                         message->GetMemberName());
-    const MethodTable::Entry* entry = safeEntry ? safeEntry->entry : NULL;
+    MethodTable::SafeEntry safeEntry;
+    methodTable.Find(message->GetObjectPath(), message->GetInterface(), message->GetMemberName(), safeEntry);
+    const MethodTable::Entry* entry = safeEntry.entry;
 
     if (entry == NULL) {
         if (strcmp(message->GetInterface(), org::freedesktop::DBus::Peer::InterfaceName) == 0) {
@@ -959,8 +1384,6 @@ QStatus _LocalEndpoint::HandleMethodCall(Message& message)
         status = ER_OK;
     }
 
-    // safeEntry might be null here
-    delete safeEntry;
     return status;
 }
 
@@ -968,31 +1391,22 @@ QStatus _LocalEndpoint::HandleSignal(Message& message)
 {
     QStatus status = ER_OK;
 
-    signalTable.Lock();
+    /*
+     * The snapshot is never modified so the signal handlers can be called directly from it.
+     */
+    SignalTable::Snapshot handlers = signalTable.GetSnapshot();
 
     /* Look up the signal */
     pair<SignalTable::const_iterator, SignalTable::const_iterator> range =
-        signalTable.Find(message->GetObjectPath(), message->GetInterface(), message->GetMemberName());
+        SignalTable::Find(handlers, message->GetObjectPath(), message->GetInterface(), message->GetMemberName());
 
     /*
      * Quick exit if there are no handlers for this signal
      */
     if (range.first == range.second) {
-        signalTable.Unlock();
         return ER_OK;
     }
-    /*
-     * Build a list of all signal handlers for this signal
-     */
-    list<SignalTable::Entry> callList;
     const InterfaceDescription::Member* signal = range.first->second.member;
-    do {
-        callList.push_back(range.first->second);
-    } while (++range.first != range.second);
-    /*
-     * We have our callback list so we can unlock the signal table.
-     */
-    signalTable.Unlock();
     /*
      * Validate and unmarshal the signal
      */
@@ -1008,9 +1422,8 @@ QStatus _LocalEndpoint::HandleSignal(Message& message)
             status = ER_OK;
         }
     } else {
-        list<SignalTable::Entry>::const_iterator callit;
-        for (callit = callList.begin(); callit != callList.end(); ++callit) {
-            (callit->object->*callit->handler)(callit->member, message->GetObjectPath(), message);
+        for (SignalTable::const_iterator callit = range.first; callit != range.second; ++callit) {
+            (callit->second.object->*callit->second.handler)(callit->second.member, message->GetObjectPath(), message);
         }
     }
     return status;
@@ -1021,10 +1434,11 @@ QStatus _LocalEndpoint::HandleMethodReply(Message& message)
     QStatus status = ER_OK;
 
     replyMapLock.Lock();
-    ReplyContext* rc = RemoveReplyHandler(message->GetReplySerial());
+    ReplyContext rc;
+    bool found = RemoveReplyHandler(message->GetReplySerial(), rc);
     replyMapLock.Unlock();
-    if (rc) {
-        if ((rc->callFlags & ALLJOYN_FLAG_ENCRYPTED) && !message->IsEncrypted()) {
+    if (found) {
+        if ((rc.callFlags & ALLJOYN_FLAG_ENCRYPTED) && !message->IsEncrypted()) {
             /*
              * If the response was an internally generated error response just keep that error.
              * Otherwise if reply was not encrypted so return an error to the caller. Internally
@@ -1036,7 +1450,7 @@ QStatus _LocalEndpoint::HandleMethodReply(Message& message)
         } else {
             QCC_DbgPrintf(("Matched reply for serial #%d", message->GetReplySerial()));
             if (message->GetType() == MESSAGE_METHOD_RET) {
-                status = message->UnmarshalArgs(rc->method->returnSignature);
+                status = message->UnmarshalArgs(rc.method->returnSignature);
             } else {
                 status = message->UnmarshalArgs("*");
             }
@@ -1057,8 +1471,7 @@ QStatus _LocalEndpoint::HandleMethodReply(Message& message)
             QCC_LogError(status, ("Reply message replaced with an internally generated error"));
             status = ER_OK;
         }
-        ((rc->receiver)->*(rc->handler))(message, rc->context);
-        delete rc;
+        ((rc.receiver)->*(rc.handler))(message, rc.context);
     } else {
         status = ER_BUS_UNMATCHED_REPLY_SERIAL;
         QCC_DbgHLPrintf(("%s does not match any current method calls: %s", message->Description().c_str(), QCC_StatusText(status)));
@@ -1066,34 +1479,32 @@ QStatus _LocalEndpoint::HandleMethodReply(Message& message)
     return status;
 }
 
-void _LocalEndpoint::DeferredCallbacks::AlarmTriggered(const qcc::Alarm& alarm, QStatus reason)
+void _LocalEndpoint::DeferredCallbacks::Run()
 {
-    if (reason == ER_OK) {
-        /*
-         * Allow synchronous method calls from within the object registration callbacks
-         */
-        endpoint->bus->EnableConcurrentCallbacks();
-        /*
-         * Call ObjectRegistered for any unregistered bus objects
-         */
-        endpoint->objectsLock.Lock(MUTEX_CONTEXT);
-        unordered_map<const char*, BusObject*, Hash, PathEq>::iterator iter = endpoint->localObjects.begin();
-        while (endpoint->running && (iter != endpoint->localObjects.end())) {
-            if (!iter->second->isRegistered) {
-                BusObject* bo = iter->second;
-                bo->isRegistered = true;
-                bo->InUseIncrement();
-                endpoint->objectsLock.Unlock(MUTEX_CONTEXT);
-                bo->ObjectRegistered();
-                endpoint->objectsLock.Lock(MUTEX_CONTEXT);
-                bo->InUseDecrement();
-                iter = endpoint->localObjects.begin();
-            } else {
-                ++iter;
-            }
+    /*
+     * Allow synchronous method calls from within the object registration callbacks
+     */
+    endpoint->bus->EnableConcurrentCallbacks();
+    /*
+     * Call ObjectRegistered for any unregistered bus objects
+     */
+    endpoint->objectsLock.Lock(MUTEX_CONTEXT);
+    unordered_map<const char*, BusObject*, Hash, PathEq>::iterator iter = endpoint->localObjects.begin();
+    while (endpoint->running && (iter != endpoint->localObjects.end())) {
+        if (!iter->second->isRegistered) {
+            BusObject* bo = iter->second;
+            bo->isRegistered = true;
+            bo->InUseIncrement();
+            endpoint->objectsLock.Unlock(MUTEX_CONTEXT);
+            bo->ObjectRegistered();
+            endpoint->objectsLock.Lock(MUTEX_CONTEXT);
+            bo->InUseDecrement();
+            iter = endpoint->localObjects.begin();
+        } else {
+            ++iter;
         }
-        endpoint->objectsLock.Unlock(MUTEX_CONTEXT);
     }
+    endpoint->objectsLock.Unlock(MUTEX_CONTEXT);
 }
 
 void _LocalEndpoint::OnBusConnected()
@@ -1101,9 +1512,8 @@ void _LocalEndpoint::OnBusConnected()
     /*
      * Use the local endpoint's dispatcher to call back to report the object registrations.
      */
-    uint32_t zero = 0;
     if (dispatcher) {
-        dispatcher->AddAlarm(Alarm(zero, deferredCallbacks));
+        dispatcher->DispatchCallbacks(deferredCallbacks);
     }
 }
 
@@ -26,6 +26,7 @@
 #include <qcc/platform.h>
 
 #include <map>
+#include <vector>
 
 #include <qcc/String.h>
 #include <qcc/GUID.h>
@@ -45,7 +46,9 @@
 #include "BusEndpoint.h"
 #include "CompressionRules.h"
 #include "MethodTable.h"
+#include "SerialMap.h"
 #include "SignalTable.h"
+#include "TimingWheel.h"
 #include "Transport.h"
 
 #include <qcc/STLContainer.h>
@@ -75,7 +78,7 @@ class _LocalEndpoint : public _BusEndpoint, public qcc::AlarmListener, public Me
     /**
      * Default constructor initializes an invalid endpoint. This allows for the declaration of uninitialized LocalEndpoint variables.
      */
-    _LocalEndpoint() : dispatcher(NULL), deferredCallbacks(NULL), bus(NULL), replyTimer("replyTimer", true) { }
+    _LocalEndpoint() : dispatcher(NULL), deferredCallbacks(NULL), bus(NULL), replyTimer("replyTimer", true), replyWheel(REPLY_TICK_MS, REPLY_WHEEL_SLOTS), replyAlarmTime(0) { }
 
     /**
      * Constructor
@@ -227,6 +230,17 @@ class _LocalEndpoint : public _BusEndpoint, public qcc::AlarmListener, public Me
      */
     QStatus UnregisterAllHandlers(MessageReceiver* receiver);
 
+    /**
+     * Un-Register the reply handlers registered to the specified MessageReceiver with a specific
+     * handler function. The handlers will not be called so the contexts they were registered with
+     * are returned for the caller to clean up.
+     *
+     * @param receiver       The object waiting for the replies.
+     * @param replyHandler   The handler function.
+     * @param contexts       [OUT] The contexts of the reply handlers that were removed.
+     */
+    void UnregisterReplyHandlers(MessageReceiver* receiver, MessageReceiver::ReplyHandler replyHandler, std::vector<void*>& contexts);
+
     /**
      * Get the endpoint's unique name.
      *
@@ -395,23 +409,71 @@ class _LocalEndpoint : public _BusEndpoint, public qcc::AlarmListener, public Me
     _LocalEndpoint(const _LocalEndpoint& other);
 
     /**
-     * Type definition for a method call reply context
+     * Resolution of method call timeouts in milliseconds
+     */
+    static const uint32_t REPLY_TICK_MS = 10;
+
+    /**
+     * Number of slots in the method call timeout wheel, one turn of the wheel is about 10 seconds
      */
-    class ReplyContext;
+    static const size_t REPLY_WHEEL_SLOTS = 1024;
+
+    /**
+     * Interval for the reply alarm when no method call has a timeout. The alarm is kept pending
+     * so the method calls are failed when the reply timer exits.
+     */
+    static const uint32_t REPLY_IDLE_MS = 60000;
+
+    /**
+     * Context for a method call that is waiting for a reply
+     */
+    struct ReplyContext {
+        ReplyContext() : receiver(NULL), handler(NULL), method(NULL), callFlags(0), serial(0), context(NULL), deadline(0), paused(false) { }
+
+        MessageReceiver* receiver;                   /**< The object to receive the reply */
+        MessageReceiver::ReplyHandler handler;       /**< The receiving object's handler function */
+        const InterfaceDescription::Member* method;  /**< The method that was called */
+        uint8_t callFlags;                           /**< Flags from the method call */
+        uint32_t serial;                             /**< Serial number for the method reply */
+        void* context;                               /**< The calling object's context */
+        uint64_t deadline;                           /**< Timestamp when the method call times out or 0 if it never does */
+        bool paused;                                 /**< true if the timeout is paused */
+    };
 
     /**
      * Equality function for matching object paths
      */
     struct PathEq { bool operator()(const char* p1, const char* p2) const { return (p1 == p2) || (strcmp(p1, p2) == 0); } };
 
+    /**
+     * Add a reply context to the reply handler table and start its timeout. Must be called
+     * with replyMapLock held.
+     *
+     * @param rc   The reply context.
+     *
+     * @return ER_OK if the timeout was started.
+     */
+    QStatus AddReplyHandler(const ReplyContext& rc);
+
     /**
      * Remove a reply handler from the reply handler list.
      *
      * @param serial       The serial number expected in the reply
+     * @param rc           [OUT] Returns the reply context that was removed.
+     *
+     * @return true if the reply context was removed.
+     */
+    bool RemoveReplyHandler(uint32_t serial, ReplyContext& rc);
+
+    /**
+     * Make sure the reply alarm fires no later than a deadline. The pending alarm is only
+     * replaced if the deadline is earlier. Must be called with replyMapLock held.
+     *
+     * @param deadline   Timestamp of a method call timeout or 0 if there is none.
      *
-     * @return A pointer to the reply context if it was removed.
+     * @return ER_OK if the alarm is scheduled.
      */
-    ReplyContext* RemoveReplyHandler(uint32_t serial);
+    QStatus ScheduleReplyAlarm(uint64_t deadline);
 
     /**
      * Hash functor
@@ -428,9 +490,9 @@ class _LocalEndpoint : public _BusEndpoint, public qcc::AlarmListener, public Me
     std::unordered_map<const char*, BusObject*, Hash, PathEq> localObjects;
 
     /**
-     * List of contexts for method call replies.
+     * Contexts for method call replies indexed by serial number.
      */
-    std::map<uint32_t, ReplyContext*> replyMap;
+    SerialMap<ReplyContext> replyMap;
 
     bool running;                      /**< Is the local endpoint up and running */
     bool isRegistered;                 /**< true iff endpoint has been registered with router */
@@ -442,6 +504,9 @@ class _LocalEndpoint : public _BusEndpoint, public qcc::AlarmListener, public Me
     qcc::GUID128 guid;                 /**< GUID to uniquely identify a local endpoint */
     qcc::String uniqueName;            /**< Unique name for endpoint */
     qcc::Timer replyTimer;             /**< Timer used to timeout method calls */
+    TimingWheel replyWheel;            /**< Method call timeouts */
+    qcc::Alarm replyAlarm;             /**< Alarm for advancing replyWheel */
+    uint64_t replyAlarmTime;           /**< Timestamp when replyAlarm fires or 0 if it is not pending */
 
     std::vector<BusObject*> defaultObjects;  /**< Auto-generated, heap allocated parent objects */
 
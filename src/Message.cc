@@ -39,6 +39,8 @@
 
 #include "BusInternal.h"
 #include "BusUtil.h"
+#include "BufferPool.h"
+#include "NameAtoms.h"
 
 #define QCC_MODULE "ALLJOYN"
 
@@ -314,7 +316,8 @@ _Message::_Message(BusAttachment& bus) :
     readState(MESSAGE_NEW),
     countRead(0),
     writeState(MESSAGE_NEW),
-    countWrite(0)
+    countWrite(0),
+    hdrAtomsGeneration(0)
 {
     msgHeader.msgType = MESSAGE_INVALID;
     msgHeader.endian = myEndian;
@@ -322,7 +325,7 @@ _Message::_Message(BusAttachment& bus) :
 
 _Message::~_Message(void)
 {
-    delete [] _msgBuf;
+    BufferPool::Free(_msgBuf);
     delete [] msgArgs;
     while (numHandles) {
         qcc::Close(handles[--numHandles]);
@@ -347,12 +350,14 @@ _Message::_Message(const _Message& other) :
     countRead(other.countRead),
     writeState(other.writeState),
     countWrite(other.countWrite),
-    hdrFields(other.hdrFields)
+    hdrFields(other.hdrFields),
+    hdrAtomsGeneration(other.hdrAtomsGeneration)
 {
+    memcpy(hdrAtoms, other.hdrAtoms, sizeof(hdrAtoms));
     if (bufSize > 0) {
         assert(other.msgBuf != NULL);
-        _msgBuf = new uint8_t[bufSize + 7];
-        msgBuf = (uint64_t*)((uintptr_t)(_msgBuf + 7) & ~7);
+        _msgBuf = BufferPool::Alloc(bufSize);
+        msgBuf = (uint64_t*)_msgBuf;
         bufEOD = ((uint8_t*)msgBuf) + (other.bufEOD - ((uint8_t*)other.msgBuf));
         bufPos = ((uint8_t*)msgBuf) + (other.bufPos - ((uint8_t*)other.msgBuf));
         bodyPtr = ((uint8_t*)msgBuf) + (other.bodyPtr - ((uint8_t*)other.msgBuf));
@@ -392,6 +397,7 @@ QStatus _Message::ReMarshal(const char* senderName)
 {
     if (senderName) {
         hdrFields.field[ALLJOYN_HDR_FIELD_SENDER].Set("s", senderName);
+        hdrAtomsGeneration = 0;
     }
 
     /*
@@ -415,8 +421,8 @@ QStatus _Message::ReMarshal(const char* senderName)
      * message reducing the places where we need to check for bufEOD when unmarshaling the body.
      */
     bufSize = sizeof(msgHeader) + ((((msgHeader.headerLen + 7) & ~7) + msgHeader.bodyLen + 7) & ~7) + 8;
-    _msgBuf = new uint8_t[bufSize + 7];
-    msgBuf = (uint64_t*)((uintptr_t)(_msgBuf + 7) & ~7); /* Align to 8 byte boundary */
+    _msgBuf = BufferPool::Alloc(bufSize);
+    msgBuf = (uint64_t*)_msgBuf; /* Pool buffers are 8 byte aligned */
     bufPos = (uint8_t*)msgBuf;
     memcpy(bufPos, &msgHeader, sizeof(msgHeader));
     bufPos += sizeof(msgHeader);
@@ -448,7 +454,7 @@ QStatus _Message::ReMarshal(const char* senderName)
      */
     assert((size_t)(bufEOD - (uint8_t*)msgBuf) < bufSize);
     memset(bufEOD, 0, (uint8_t*)msgBuf + bufSize - bufEOD);
-    delete [] _savBuf;
+    BufferPool::Free(_savBuf);
     return ER_OK;
 }
 
@@ -501,6 +507,39 @@ void _Message::ClearHeader()
         handles = NULL;
         encrypt = false;
         authMechanism.clear();
+        hdrAtomsGeneration = 0;
+    }
+}
+
+QStatus _Message::UncompressHeader()
+{
+    msgHeader.flags &= ~ALLJOYN_FLAG_COMPRESSED;
+    return ReMarshal(NULL);
+}
+
+void _Message::ResolveNameAtoms()
+{
+    MessageNameAtoms atoms(GetSender(), GetInterface(), GetMemberName(), GetDestination(), hdrAtomsGeneration);
+    hdrAtoms[0] = atoms.sender;
+    hdrAtoms[1] = atoms.iface;
+    hdrAtoms[2] = atoms.member;
+    hdrAtoms[3] = atoms.destination;
+}
+
+void _Message::GetNameAtoms(MessageNameAtoms& atoms) const
+{
+    uint32_t generation = hdrAtomsGeneration;
+    if ((generation != 0) && (generation == NameAtomTable::Generation())) {
+        atoms.sender = hdrAtoms[0];
+        atoms.iface = hdrAtoms[1];
+        atoms.member = hdrAtoms[2];
+        atoms.destination = hdrAtoms[3];
+    } else {
+        /*
+         * Names were interned after the message was unmarshaled or the message was generated
+         * locally. The message may be shared so the atoms are looked up without caching them.
+         */
+        atoms = MessageNameAtoms(GetSender(), GetInterface(), GetMemberName(), GetDestination(), generation);
     }
 }
 
@@ -39,9 +39,11 @@
 #include "KeyStore.h"
 #include "CompressionRules.h"
 #include "BusUtil.h"
+#include "BufferPool.h"
 #include "AllJoynCrypto.h"
 #include "AllJoynPeerObj.h"
 #include "SignatureUtils.h"
+#include "SignatureProgram.h"
 #include "BusInternal.h"
 
 #define QCC_MODULE "ALLJOYN"
@@ -154,13 +156,26 @@ QStatus _Message::MarshalArgs(const MsgArg* arg, size_t numArgs)
                     break;
                 }
                 /*
-                 * Check elements conform to the expected signature type
+                 * Check elements conform to the expected signature type. The compiled element
+                 * signature is checked against the element types without building a signature
+                 * string for every element.
                  */
-                for (size_t i = 0; i < arg->v_array.numElements; i++) {
-                    if (!arg->v_array.elements[i].HasSignature(arg->v_array.GetElemSig())) {
-                        status = ER_BUS_BAD_VALUE;
-                        QCC_LogError(status, ("Array element[%d] does not have expected signature \"%s\"", i, arg->v_array.GetElemSig()));
-                        break;
+                const _SignatureProgram* elemProgram = SignatureProgramCache::IsEnabled() ? SignatureProgramCache::Get(arg->v_array.GetElemSig()) : NULL;
+                if (elemProgram) {
+                    for (size_t i = 0; (status == ER_OK) && (i < arg->v_array.numElements); i++) {
+                        if (!elemProgram->Matches(arg->v_array.elements[i])) {
+                            status = ER_BUS_BAD_VALUE;
+                            QCC_LogError(status, ("Array element[%d] does not have expected signature \"%s\"", i, arg->v_array.GetElemSig()));
+                        }
+                    }
+                    SignatureProgramCache::Release(elemProgram);
+                } else {
+                    for (size_t i = 0; i < arg->v_array.numElements; i++) {
+                        if (!arg->v_array.elements[i].HasSignature(arg->v_array.GetElemSig())) {
+                            status = ER_BUS_BAD_VALUE;
+                            QCC_LogError(status, ("Array element[%d] does not have expected signature \"%s\"", i, arg->v_array.GetElemSig()));
+                            break;
+                        }
                     }
                 }
                 if (status == ER_OK) {
@@ -451,6 +466,17 @@ QStatus _Message::MarshalArgs(const MsgArg* arg, size_t numArgs)
 QStatus _Message::Deliver(RemoteEndpoint& endpoint)
 {
     QStatus status = ER_OK;
+    /*
+     * The first time a compression token is sent on a link the header goes out in full so the
+     * receiver learns the expansion from the message.
+     */
+    if (endpoint->DefineCompressionToken(*this)) {
+        status = UncompressHeader();
+        if (status != ER_OK) {
+            QCC_LogError(status, ("Failed to define compression token %u", GetCompressionToken()));
+            return status;
+        }
+    }
     Sink& sink = endpoint->GetSink();
     uint8_t* buf = reinterpret_cast<uint8_t*>(msgBuf);
     size_t len = bufEOD - buf;
@@ -892,6 +918,10 @@ QStatus _Message::MarshalMessage(const qcc::String& expectedSignature,
      */
     hdrFields.field[ALLJOYN_HDR_FIELD_COMPRESSION_TOKEN].Clear();
     if ((msgHeader.flags & ALLJOYN_FLAG_COMPRESSED)) {
+        /*
+         * The endpoint that sends the message decides if the header must be sent in full
+         * because the token has not been sent on that link before.
+         */
         hdrFields.field[ALLJOYN_HDR_FIELD_COMPRESSION_TOKEN].v_uint32 = bus->GetInternal().GetCompressionRules()->GetToken(hdrFields);
         hdrFields.field[ALLJOYN_HDR_FIELD_COMPRESSION_TOKEN].typeId = ALLJOYN_UINT32;
     }
@@ -911,8 +941,8 @@ QStatus _Message::MarshalMessage(const qcc::String& expectedSignature,
      * Allocate buffer for entire message.
      */
     bufSize = (hdrLen + msgHeader.bodyLen + 7);
-    _msgBuf = new uint8_t[bufSize + 7];
-    msgBuf = (uint64_t*)((uintptr_t)(_msgBuf + 7) & ~7); /* Align to 8 byte boundary */
+    _msgBuf = BufferPool::Alloc(bufSize);
+    msgBuf = (uint64_t*)_msgBuf; /* Pool buffers are 8 byte aligned */
     /*
      * Initialize the buffer and copy in the message header
      */
@@ -982,14 +1012,14 @@ ExitMarshalMessage:
     /*
      * Don't need the old message buffer any more
      */
-    delete [] _oldMsgBuf;
+    BufferPool::Free(_oldMsgBuf);
 
     if (status == ER_OK) {
         QCC_DbgHLPrintf(("MarshalMessage: %d+%d %s %s", hdrLen, msgHeader.bodyLen, Description().c_str(), encrypt ? " (encrypted)" : ""));
     } else {
         QCC_LogError(status, ("MarshalMessage: %s", Description().c_str()));
         msgBuf = NULL;
-        delete [] _msgBuf;
+        BufferPool::Free(_msgBuf);
         _msgBuf = NULL;
         bodyPtr = NULL;
         bufPos = NULL;
@@ -1365,8 +1395,9 @@ void _Message::ErrorMsg(QStatus status,
 QStatus _Message::GetExpansion(uint32_t token, MsgArg& replyArg)
 {
     QStatus status = ER_OK;
-    const HeaderFields* expFields = bus->GetInternal().GetCompressionRules()->GetExpansion(token);
-    if (expFields) {
+    HeaderFields expansion;
+    const HeaderFields* expFields = &expansion;
+    if (bus->GetInternal().GetCompressionRules()->GetExpansion(token, expansion)) {
         MsgArg* hdrArray = new MsgArg[ALLJOYN_HDR_FIELD_UNKNOWN];
         size_t numElements = 0;
         /*
@@ -38,9 +38,11 @@
 #include "PeerState.h"
 #include "CompressionRules.h"
 #include "BusUtil.h"
+#include "BufferPool.h"
 #include "AllJoynCrypto.h"
 #include "AllJoynPeerObj.h"
 #include "SignatureUtils.h"
+#include "SignatureProgram.h"
 #include "BusInternal.h"
 
 #define QCC_MODULE "ALLJOYN"
@@ -64,22 +66,8 @@ namespace ajn {
 
 
 
-QStatus _Message::ParseArray(MsgArg* arg,
-                             const char*& sigPtr)
+QStatus _Message::ParseArrayLength(uint32_t& len)
 {
-    QStatus status;
-    uint32_t len;
-    const char* sigStart = sigPtr;
-
-    /*
-     * First check that the array type signature is valid
-     */
-    arg->typeId = ALLJOYN_ARRAY;
-    status = SignatureUtils::ParseContainerSignature(*arg, sigPtr);
-    if (status != ER_OK) {
-        arg->typeId = ALLJOYN_INVALID;
-        return status;
-    }
     /*
      * Length is aligned on a 4 byte boundary
      */
@@ -94,12 +82,89 @@ QStatus _Message::ParseArray(MsgArg* arg,
      */
     bufPos += 4;
     if ((len > ALLJOYN_MAX_ARRAY_LEN) || ((len + bufPos) > bufEOD)) {
-        status = ER_BUS_BAD_LENGTH;
+        QStatus status = ER_BUS_BAD_LENGTH;
         QCC_LogError(status, ("Array length %ld at pos:%ld is too big", len, bufPos - bodyPtr - 4));
-        arg->typeId = ALLJOYN_INVALID;
         return status;
     }
     QCC_DbgPrintf(("ParseArray len %ld at pos:%ld", len, bufPos - bodyPtr));
+    return ER_OK;
+}
+
+
+QStatus _Message::ParseArrayElements(MsgArg* arg, const char* elemSig, uint32_t len, const _SignatureProgram* program, size_t elemOp)
+{
+    QStatus status = ER_OK;
+    size_t numElements = 0;
+    MsgArg* elements = NULL;
+    if (len > 0) {
+        /*
+         * We know how many bytes there are in the array but not how many elements until we
+         * unmarshal them.
+         */
+        uint8_t* endOfArray = bufPos + len;
+        size_t capacity = 8;
+        numElements = 0;
+        elements = new MsgArg[capacity];
+        /*
+         * Loop until we have consumed all of the data bytes
+         */
+        while (bufPos < endOfArray) {
+            if (numElements == capacity) {
+                capacity *= 2;
+                MsgArg* bigger = new MsgArg[capacity];
+                memcpy(bigger, elements, numElements * sizeof(MsgArg));
+                /*
+                 * Clear the flags to prevent the destructor from freeing anything other
+                 * than the MsgArgs.
+                 */
+                for (size_t i = 0; i < numElements; i++) {
+                    elements[i].flags = 0;
+                }
+                delete [] elements;
+                elements = bigger;
+            }
+            if (program) {
+                status = ParseCompiled(&elements[numElements++], *program, elemOp);
+            } else {
+                const char* esig = elemSig;
+                status = ParseValue(&elements[numElements++], esig, true);
+            }
+            if (status != ER_OK) {
+                break;
+            }
+        }
+    }
+    if (status == ER_OK) {
+        arg->v_array.SetElements(elemSig, numElements, elements);
+        arg->flags |= MsgArg::OwnsArgs;
+    } else {
+        delete [] elements;
+    }
+    return status;
+}
+
+
+QStatus _Message::ParseArray(MsgArg* arg,
+                             const char*& sigPtr)
+{
+    QStatus status;
+    uint32_t len;
+    const char* sigStart = sigPtr;
+
+    /*
+     * First check that the array type signature is valid
+     */
+    arg->typeId = ALLJOYN_ARRAY;
+    status = SignatureUtils::ParseContainerSignature(*arg, sigPtr);
+    if (status != ER_OK) {
+        arg->typeId = ALLJOYN_INVALID;
+        return status;
+    }
+    status = ParseArrayLength(len);
+    if (status != ER_OK) {
+        arg->typeId = ALLJOYN_INVALID;
+        return status;
+    }
     /*
      * Note: at this point alignment is on a 4 bytes boundary so we only need to align values that
      * need 8 byte alignment.
@@ -118,13 +183,13 @@ QStatus _Message::ParseArray(MsgArg* arg,
             arg->typeId = (AllJoynTypeId)((elemTypeId << 8) | ALLJOYN_ARRAY);
             arg->v_scalarArray.numElements = (size_t)(len / 2);
             if (endianSwap) {
-                arg->v_scalarArray.v_uint16 = new uint16_t[arg->v_scalarArray.numElements];
+                arg->v_scalarArray.v_uint16 = (uint16_t*)BufferPool::Alloc(len);
                 uint16_t* p = (uint16_t*)arg->v_scalarArray.v_uint16;
                 uint16_t* n = (uint16_t*)bufPos;
                 for (size_t i = 0; i < arg->v_scalarArray.numElements; i++) {
                     *p++ = EndianSwap16(*n++);
                 }
-                arg->flags = MsgArg::OwnsData;
+                arg->flags = MsgArg::OwnsData | MsgArg::PooledData;
             } else {
                 arg->v_scalarArray.v_uint16 = (uint16_t*)bufPos;
             }
@@ -137,14 +202,14 @@ QStatus _Message::ParseArray(MsgArg* arg,
     case ALLJOYN_BOOLEAN:
         if ((len & 3) == 0) {
             size_t num = (size_t)(len / 4);
-            bool* bools = new bool[num];
+            bool* bools = (bool*)BufferPool::Alloc(num * sizeof(bool));
             for (size_t i = 0; i < num; i++) {
                 uint32_t b = *(uint32_t*)bufPos;
                 if (endianSwap) {
                     b = EndianSwap32(b);
                 }
                 if (b > 1) {
-                    delete [] bools;
+                    BufferPool::Free(bools);
                     status = ER_BUS_BAD_VALUE;
                     break;
                 }
@@ -163,7 +228,7 @@ QStatus _Message::ParseArray(MsgArg* arg,
             arg->typeId = ALLJOYN_BOOLEAN_ARRAY;
             arg->v_scalarArray.numElements = num;
             arg->v_scalarArray.v_bool = bools;
-            arg->flags = MsgArg::OwnsData;
+            arg->flags = MsgArg::OwnsData | MsgArg::PooledData;
         } else {
             status = ER_BUS_BAD_LENGTH;
         }
@@ -175,13 +240,13 @@ QStatus _Message::ParseArray(MsgArg* arg,
             arg->typeId = (AllJoynTypeId)((elemTypeId << 8) | ALLJOYN_ARRAY);
             arg->v_scalarArray.numElements = (size_t)(len / 4);
             if (endianSwap) {
-                arg->v_scalarArray.v_uint32 = new uint32_t[arg->v_scalarArray.numElements];
+                arg->v_scalarArray.v_uint32 = (uint32_t*)BufferPool::Alloc(len);
                 uint32_t* p = (uint32_t*)arg->v_scalarArray.v_uint32;
                 uint32_t* n = (uint32_t*)bufPos;
                 for (size_t i = 0; i < arg->v_scalarArray.numElements; i++) {
                     *p++ = EndianSwap32(*n++);
                 }
-                arg->flags = MsgArg::OwnsData;
+                arg->flags = MsgArg::OwnsData | MsgArg::PooledData;
             } else {
                 arg->v_scalarArray.v_uint32 = (uint32_t*)bufPos;
             }
@@ -200,13 +265,13 @@ QStatus _Message::ParseArray(MsgArg* arg,
             bufPos = AlignPtr(bufPos, 8);
             arg->v_scalarArray.v_uint64 = (uint64_t*)bufPos;
             if (endianSwap) {
-                arg->v_scalarArray.v_uint64 = new uint64_t[arg->v_scalarArray.numElements];
+                arg->v_scalarArray.v_uint64 = (uint64_t*)BufferPool::Alloc(len);
                 uint64_t* p = (uint64_t*)arg->v_scalarArray.v_uint64;
                 uint64_t* n = (uint64_t*)bufPos;
                 for (size_t i = 0; i < arg->v_scalarArray.numElements; i++) {
                     *p++ = EndianSwap64(*n++);
                 }
-                arg->flags = MsgArg::OwnsData;
+                arg->flags = MsgArg::OwnsData | MsgArg::PooledData;
             } else {
                 arg->v_scalarArray.v_uint64 = (uint64_t*)bufPos;
             }
@@ -228,48 +293,7 @@ QStatus _Message::ParseArray(MsgArg* arg,
     default:
     {
         qcc::String elemSig(sigStart, sigPtr - sigStart);
-        size_t numElements = 0;
-        MsgArg* elements = NULL;
-        if (len > 0) {
-            /*
-             * We know how many bytes there are in the array but not how many elements until we
-             * unmarshal them.
-             */
-            uint8_t* endOfArray = bufPos + len;
-            size_t capacity = 8;
-            numElements = 0;
-            elements = new MsgArg[capacity];
-            /*
-             * Loop until we have consumed all of the data bytes
-             */
-            while (bufPos < endOfArray) {
-                if (numElements == capacity) {
-                    capacity *= 2;
-                    MsgArg* bigger = new MsgArg[capacity];
-                    memcpy(bigger, elements, numElements * sizeof(MsgArg));
-                    /*
-                     * Clear the flags to prevent the destructor from freeing anything other
-                     * than the MsgArgs.
-                     */
-                    for (size_t i = 0; i < numElements; i++) {
-                        elements[i].flags = 0;
-                    }
-                    delete [] elements;
-                    elements = bigger;
-                }
-                const char* esig = elemSig.c_str();
-                status = ParseValue(&elements[numElements++], esig, true);
-                if (status != ER_OK) {
-                    break;
-                }
-            }
-        }
-        if (status == ER_OK) {
-            arg->v_array.SetElements(elemSig.c_str(), numElements, elements);
-            arg->flags |= MsgArg::OwnsArgs;
-        } else {
-            delete [] elements;
-        }
+        status = ParseArrayElements(arg, elemSig.c_str(), len, NULL, 0);
     }
     break;
     }
@@ -549,6 +573,286 @@ QStatus _Message::ParseValue(MsgArg* arg, const char*& sigPtr, bool arrayElem)
     return status;
 }
 
+QStatus _Message::ParseCompiled(MsgArg* arg, const _SignatureProgram& program, size_t index)
+{
+    QStatus status = ER_OK;
+    const _SignatureProgram::Op& op = program.GetOp(index);
+    const char* sigPtr = program.GetTypeSig(op);
+
+    switch (op.code) {
+    case _SignatureProgram::OP_VALUE:
+        return ParseValue(arg, sigPtr);
+
+    case _SignatureProgram::OP_SCALAR_ARRAY:
+        arg->Clear();
+        return ParseArray(arg, ++sigPtr);
+
+    case _SignatureProgram::OP_ARRAY:
+    {
+        uint32_t len;
+        arg->Clear();
+        status = ParseArrayLength(len);
+        if (status == ER_OK) {
+            const _SignatureProgram::Op& elemOp = program.GetOp(index + 1);
+            /*
+             * The array length in bytes does not include the pad bytes between the length and the start
+             * of the first element.
+             */
+            if ((elemOp.code == _SignatureProgram::OP_STRUCT) || (elemOp.code == _SignatureProgram::OP_DICT_ENTRY)) {
+                bufPos = AlignPtr(bufPos, 8);
+            }
+            arg->typeId = ALLJOYN_ARRAY;
+            status = ParseArrayElements(arg, program.GetElemSig(op), len, &program, index + 1);
+        }
+        if (status != ER_OK) {
+            arg->typeId = ALLJOYN_INVALID;
+        }
+    }
+    break;
+
+    case _SignatureProgram::OP_STRUCT:
+        arg->Clear();
+        /*
+         * Structs are aligned on an 8 byte boundary
+         */
+        bufPos = AlignPtr(bufPos, 8);
+        arg->typeId = ALLJOYN_STRUCT;
+        arg->v_struct.numMembers = op.numMembers;
+        arg->v_struct.members = new MsgArg[op.numMembers];
+        arg->flags |= MsgArg::OwnsArgs;
+        ++index;
+        for (uint32_t i = 0; i < op.numMembers; ++i) {
+            status = ParseCompiled(&arg->v_struct.members[i], program, index);
+            if (status != ER_OK) {
+                arg->v_struct.numMembers = i;
+                break;
+            }
+            index = program.GetOp(index).next;
+        }
+        break;
+
+    case _SignatureProgram::OP_DICT_ENTRY:
+        arg->Clear();
+        /*
+         * Dict entries are aligned on an 8 byte boundary
+         */
+        bufPos = AlignPtr(bufPos, 8);
+        arg->typeId = ALLJOYN_DICT_ENTRY;
+        arg->v_dictEntry.key = new MsgArg();
+        arg->v_dictEntry.val = new MsgArg();
+        arg->flags |= MsgArg::OwnsArgs;
+        status = ParseCompiled(arg->v_dictEntry.key, program, index + 1);
+        if (status == ER_OK) {
+            status = ParseCompiled(arg->v_dictEntry.val, program, program.GetOp(index + 1).next);
+        }
+        break;
+
+    default:
+        status = ER_BUS_BAD_SIGNATURE;
+        break;
+    }
+    /*
+     * Check we are not running of the end of the buffer
+     */
+    if ((status == ER_OK) && (bufPos > bufEOD)) {
+        status = ER_BUS_BAD_SIGNATURE;
+    }
+    return status;
+}
+
+/*
+ * Maximum container nesting depth allowed by the wire protocol (32 arrays plus 32 structs).
+ */
+static const size_t MAX_SKIP_DEPTH = 64;
+
+/*
+ * Skip over a marshaled value without unmarshaling it. Nothing is allocated and no values are
+ * validated beyond what is needed to stay inside the buffer. Every byte is bounds checked
+ * before it is read.
+ */
+static QStatus SkipValue(uint8_t*& pos, const uint8_t* eod, const char*& sigPtr, bool endianSwap, size_t depth = 0)
+{
+    QStatus status = ER_OK;
+    uint32_t len;
+
+    if (depth > MAX_SKIP_DEPTH) {
+        return ER_BUS_BAD_SIGNATURE;
+    }
+    switch (AllJoynTypeId typeId = (AllJoynTypeId)(*sigPtr++)) {
+    case ALLJOYN_BYTE:
+        pos += 1;
+        break;
+
+    case ALLJOYN_INT16:
+    case ALLJOYN_UINT16:
+        pos = AlignPtr(pos, 2) + 2;
+        break;
+
+    case ALLJOYN_BOOLEAN:
+    case ALLJOYN_INT32:
+    case ALLJOYN_UINT32:
+    case ALLJOYN_HANDLE:
+        pos = AlignPtr(pos, 4) + 4;
+        break;
+
+    case ALLJOYN_DOUBLE:
+    case ALLJOYN_UINT64:
+    case ALLJOYN_INT64:
+        pos = AlignPtr(pos, 8) + 8;
+        break;
+
+    case ALLJOYN_OBJECT_PATH:
+    case ALLJOYN_STRING:
+    case ALLJOYN_ARRAY:
+    {
+        const char* elemSig = sigPtr;
+        if (typeId == ALLJOYN_ARRAY) {
+            status = SignatureUtils::ParseCompleteType(sigPtr);
+            if (status != ER_OK) {
+                break;
+            }
+        }
+        pos = AlignPtr(pos, 4);
+        if ((pos + 4) > eod) {
+            status = ER_BUS_BAD_LENGTH;
+            break;
+        }
+        len = endianSwap ? EndianSwap32(*((uint32_t*)pos)) : *((uint32_t*)pos);
+        if (len > ALLJOYN_MAX_PACKET_LEN) {
+            status = ER_BUS_BAD_LENGTH;
+            break;
+        }
+        pos += 4;
+        if (typeId == ALLJOYN_ARRAY) {
+            /* Array elements are aligned even if the array is empty */
+            pos = AlignPtr(pos, SignatureUtils::AlignmentForType((AllJoynTypeId)(*elemSig))) + len;
+        } else {
+            /* Skip the string and its nul terminator */
+            pos += len + 1;
+        }
+    }
+    break;
+
+    case ALLJOYN_SIGNATURE:
+        if (pos >= eod) {
+            status = ER_BUS_BAD_LENGTH;
+            break;
+        }
+        len = *pos;
+        if ((pos + 1 + len) >= eod) {
+            status = ER_BUS_BAD_LENGTH;
+        } else if (pos[1 + len] != 0) {
+            status = ER_BUS_NOT_NUL_TERMINATED;
+        } else {
+            pos += 1 + len + 1;
+        }
+        break;
+
+    case ALLJOYN_STRUCT_OPEN:
+    case ALLJOYN_DICT_ENTRY_OPEN:
+    {
+        char close = (typeId == ALLJOYN_STRUCT_OPEN) ? ALLJOYN_STRUCT_CLOSE : ALLJOYN_DICT_ENTRY_CLOSE;
+        pos = AlignPtr(pos, 8);
+        while ((status == ER_OK) && (*sigPtr != close)) {
+            if (!*sigPtr) {
+                status = ER_BUS_BAD_SIGNATURE;
+            } else {
+                status = SkipValue(pos, eod, sigPtr, endianSwap, depth + 1);
+            }
+        }
+        if (status == ER_OK) {
+            ++sigPtr;
+        }
+    }
+    break;
+
+    case ALLJOYN_VARIANT:
+    {
+        if (pos >= eod) {
+            status = ER_BUS_BAD_LENGTH;
+            break;
+        }
+        len = *pos;
+        if ((pos + 1 + len) >= eod) {
+            status = ER_BUS_BAD_LENGTH;
+            break;
+        }
+        const char* varSig = (const char*)(pos + 1);
+        /* The variant signature comes off the wire so it must be validated before it is walked */
+        if (varSig[len] != 0) {
+            status = ER_BUS_NOT_NUL_TERMINATED;
+        } else if (!SignatureUtils::IsCompleteType(varSig)) {
+            status = ER_BUS_BAD_SIGNATURE;
+        } else {
+            pos += 1 + len + 1;
+            status = SkipValue(pos, eod, varSig, endianSwap, depth + 1);
+        }
+    }
+    break;
+
+    default:
+        status = ER_BUS_BAD_VALUE_TYPE;
+        break;
+    }
+    if ((status == ER_OK) && (pos > eod)) {
+        status = ER_BUS_BAD_LENGTH;
+    }
+    return status;
+}
+
+QStatus _Message::PeekStringArgs(MsgArg* args, size_t numArgs) const
+{
+    QStatus status = ER_OK;
+
+    /* If the body has already been unmarshaled just reference the args */
+    if (msgArgs) {
+        for (size_t i = 0; (i < numArgs) && (i < numMsgArgs); ++i) {
+            if ((msgArgs[i].typeId == ALLJOYN_STRING) || (msgArgs[i].typeId == ALLJOYN_OBJECT_PATH)) {
+                args[i].typeId = msgArgs[i].typeId;
+                args[i].v_string.str = msgArgs[i].v_string.str;
+                args[i].v_string.len = msgArgs[i].v_string.len;
+            }
+        }
+        return ER_OK;
+    }
+    /* The body of an encrypted message cannot be examined */
+    if ((msgHeader.flags & ALLJOYN_FLAG_ENCRYPTED) || !bodyPtr) {
+        return ER_OK;
+    }
+
+    const char* sig = GetSignature();
+    uint8_t* pos = bodyPtr;
+    const uint8_t* eod = bodyPtr + msgHeader.bodyLen;
+    for (size_t i = 0; (status == ER_OK) && (i < numArgs) && *sig; ++i) {
+        AllJoynTypeId typeId = (AllJoynTypeId)(*sig);
+        if ((typeId == ALLJOYN_STRING) || (typeId == ALLJOYN_OBJECT_PATH)) {
+            pos = AlignPtr(pos, 4);
+            if ((pos + 4) > eod) {
+                status = ER_BUS_BAD_LENGTH;
+                break;
+            }
+            uint32_t len = endianSwap ? EndianSwap32(*((uint32_t*)pos)) : *((uint32_t*)pos);
+            if ((len > ALLJOYN_MAX_PACKET_LEN) || ((pos + 4 + len) >= eod)) {
+                status = ER_BUS_BAD_LENGTH;
+                break;
+            }
+            pos += 4;
+            if (pos[len] != 0) {
+                status = ER_BUS_NOT_NUL_TERMINATED;
+                break;
+            }
+            args[i].typeId = typeId;
+            args[i].v_string.str = (char*)pos;
+            args[i].v_string.len = len;
+            pos += len + 1;
+            ++sig;
+        } else {
+            status = SkipValue(pos, eod, sig, endianSwap);
+        }
+    }
+    return status;
+}
+
 /*
  * The wildcard signature ("*") is used by test programs and for debugging.
  */
@@ -560,6 +864,7 @@ QStatus _Message::UnmarshalArgs(const qcc::String& expectedSignature, const char
     QStatus status = ER_OK;
     int _numMsgArgs = 0;
     MsgArg* _msgArgs = NULL;
+    const _SignatureProgram* program = NULL;
 
     /* Check if message body is already unmarshaled */
     if (msgArgs != NULL) {
@@ -620,20 +925,35 @@ QStatus _Message::UnmarshalArgs(const qcc::String& expectedSignature, const char
         authMechanism = key.GetTag();
     }
     /*
-     * Calculate how many arguments there are
-     */
-    _numMsgArgs = SignatureUtils::CountCompleteTypes(sig);
-    _msgArgs = new MsgArg[_numMsgArgs];
-
-    /*
-     * Unmarshal the body values
+     * Unmarshal the body values. Signatures are normally compiled into a cached program so the
+     * signature is not re-parsed for every message.
      */
     bufPos = bodyPtr;
-    for (uint8_t i = 0; i < _numMsgArgs; i++) {
-        status = ParseValue(&_msgArgs[i], sig);
-        if (status != ER_OK) {
-            _numMsgArgs = i;
-            goto ExitUnmarshalArgs;
+    program = SignatureProgramCache::IsEnabled() ? SignatureProgramCache::Get(sig) : NULL;
+    if (program) {
+        _numMsgArgs = static_cast<int>(program->GetNumArgs());
+        _msgArgs = new MsgArg[_numMsgArgs];
+        size_t op = 0;
+        for (int i = 0; i < _numMsgArgs; i++) {
+            status = ParseCompiled(&_msgArgs[i], *program, op);
+            if (status != ER_OK) {
+                _numMsgArgs = i;
+                goto ExitUnmarshalArgs;
+            }
+            op = program->GetOp(op).next;
+        }
+    } else {
+        /*
+         * Calculate how many arguments there are
+         */
+        _numMsgArgs = SignatureUtils::CountCompleteTypes(sig);
+        _msgArgs = new MsgArg[_numMsgArgs];
+        for (uint8_t i = 0; i < _numMsgArgs; i++) {
+            status = ParseValue(&_msgArgs[i], sig);
+            if (status != ER_OK) {
+                _numMsgArgs = i;
+                goto ExitUnmarshalArgs;
+            }
         }
     }
     if ((bufPos - bodyPtr) != static_cast<ptrdiff_t>(msgHeader.bodyLen)) {
@@ -643,6 +963,8 @@ QStatus _Message::UnmarshalArgs(const qcc::String& expectedSignature, const char
 
 ExitUnmarshalArgs:
 
+    SignatureProgramCache::Release(program);
+
     if (status == ER_OK) {
         QCC_DbgPrintf(("Unmarshaled\n%s", ToString().c_str()));
         /*
@@ -890,8 +1212,8 @@ QStatus _Message::InterpretHeader()
      * message reducing the places where we need to check for bufEOD when unmarshaling the body.
      */
     bufSize = sizeof(msgHeader) + ((pktSize + 7) & ~7) + sizeof(uint64_t);
-    _msgBuf = new uint8_t[bufSize + 7];
-    msgBuf = (uint64_t*)((uintptr_t)(_msgBuf + 7) & ~7); /* Align to 8 byte boundary */
+    _msgBuf = BufferPool::Alloc(bufSize);
+    msgBuf = (uint64_t*)_msgBuf; /* Pool buffers are 8 byte aligned */
     /*
      * Copy header into the buffer
      */
@@ -1016,7 +1338,7 @@ QStatus _Message::Read(RemoteEndpoint& endpoint, bool checkSender, bool pedantic
      * Clear out any stale message state
      */
     msgBuf = NULL;
-    delete [] _msgBuf;
+    BufferPool::Free(_msgBuf);
     _msgBuf = NULL;
     ClearHeader();
     readState = MESSAGE_NEW;
@@ -1113,20 +1435,28 @@ QStatus _Message::Unmarshal(RemoteEndpoint& endpoint, bool checkSender, bool ped
             status = ER_BUS_MISSING_COMPRESSION_TOKEN;
             goto ExitUnmarshal;
         }
-        const HeaderFields* expFields = bus->GetInternal().GetCompressionRules()->GetExpansion(token);
-        if (!expFields) {
-            QCC_DbgPrintf(("No expansion for token %u", token));
-            status = ER_BUS_CANNOT_EXPAND_MESSAGE;
-            goto ExitUnmarshal;
-        }
         /*
          * Expand the compressed fields. Don't overwrite headers we received in the message.
          */
-        for (size_t id = 0; id < ArraySize(hdrFields.field); id++) {
-            if (HeaderFields::Compressible[id] && (hdrFields.field[id].typeId == ALLJOYN_INVALID)) {
-                hdrFields.field[id] = expFields->field[id];
+        bool expanded = bus->GetInternal().GetCompressionRules()->GetExpansion(token, hdrFields);
+        _CompressionRules* linkRules = endpoint->GetLinkCompressionRules();
+        if (!expanded && linkRules) {
+            /*
+             * The link this message came in on may have defined the token in band. Using that
+             * definition is no different from asking the link for it, so the rule is added to the
+             * bus rules where it can be handed to other peers that ask for it.
+             */
+            HeaderFields expFields;
+            if (linkRules->GetExpansion(token, expFields)) {
+                bus->GetInternal().GetCompressionRules()->AddExpansion(expFields, token);
+                expanded = linkRules->GetExpansion(token, hdrFields);
             }
         }
+        if (!expanded) {
+            QCC_DbgPrintf(("No expansion for token %u", token));
+            status = ER_BUS_CANNOT_EXPAND_MESSAGE;
+            goto ExitUnmarshal;
+        }
         hdrFields.field[ALLJOYN_HDR_FIELD_COMPRESSION_TOKEN].typeId = ALLJOYN_INVALID;
     }
     /*
@@ -1167,6 +1497,25 @@ QStatus _Message::Unmarshal(RemoteEndpoint& endpoint, bool checkSender, bool ped
             status = ReMarshal(rcvEndpointName.c_str());
         }
     }
+    /*
+     * A routing node matches every message it routes against the match rules. The routing header
+     * fields are resolved to atoms once here rather than each time the message is matched.
+     */
+    if ((status == ER_OK) && bus->GetInternal().GetRouter().IsDaemon()) {
+        ResolveNameAtoms();
+    }
+    /*
+     * An uncompressed message that carries a compression token defines the expansion for that
+     * token. Learning it here means later compressed messages on the same link can be expanded
+     * without asking the sender for the expansion. The definition is only trusted for this link
+     * and each link can only define a bounded number of rules.
+     */
+    if ((status == ER_OK) && !(msgHeader.flags & ALLJOYN_FLAG_COMPRESSED) && (hdrFields.field[ALLJOYN_HDR_FIELD_COMPRESSION_TOKEN].typeId == ALLJOYN_UINT32)) {
+        _CompressionRules* linkRules = endpoint->GetLinkCompressionRules();
+        if (linkRules) {
+            linkRules->AddExpansion(hdrFields, hdrFields.field[ALLJOYN_HDR_FIELD_COMPRESSION_TOKEN].v_uint32);
+        }
+    }
 
     /*
      * Check serial number and TTL if message is valid and not sessionless.
@@ -1270,7 +1619,7 @@ ExitUnmarshal:
          * There was an unrecoverable failure while unmarshaling the message, cleanup before we return.
          */
         msgBuf = NULL;
-        delete [] _msgBuf;
+        BufferPool::Free(_msgBuf);
         _msgBuf = NULL;
         ClearHeader();
         if ((status != ER_SOCK_OTHER_END_CLOSED) && (status != ER_STOPPING_THREAD)) {
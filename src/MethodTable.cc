@@ -33,16 +33,75 @@ using namespace std;
 
 namespace ajn {
 
-MethodTable::~MethodTable()
+MethodTable::Snapshot MethodTable::GetSnapshot()
 {
-    lock.Lock(MUTEX_CONTEXT);
-    MapType::iterator iter = hashTable.begin();
-    while (iter != hashTable.end()) {
-        delete iter->second;
+    snapshotLock.Lock(MUTEX_CONTEXT);
+    Snapshot snap = hashTable;
+    snapshotLock.Unlock(MUTEX_CONTEXT);
+    return snap;
+}
+
+MethodTable::Snapshot MethodTable::BeginUpdate(bool& inPlace)
+{
+    snapshotLock.Lock(MUTEX_CONTEXT);
+    /*
+     * Readers take a reference while holding snapshotLock so nobody can start using the
+     * current snapshot while it is being changed.
+     */
+    inPlace = (hashTable.GetRefCount() == 1);
+    if (inPlace) {
+        return hashTable;
     }
+    snapshotLock.Unlock(MUTEX_CONTEXT);
+    Snapshot snap;
+    *snap = *hashTable;
+    return snap;
+}
 
-    hashTable.clear();
-    lock.Unlock(MUTEX_CONTEXT);
+void MethodTable::EndUpdate(Snapshot& snap, bool inPlace)
+{
+    if (!inPlace) {
+        snapshotLock.Lock(MUTEX_CONTEXT);
+        hashTable = snap;
+    }
+    snapshotLock.Unlock(MUTEX_CONTEXT);
+}
+
+void MethodTable::WaitForRemoved(vector<EntryRef>& removed)
+{
+    /*
+     * The removed entries are held here so they stay valid until the last method call that
+     * found them has returned.
+     */
+    for (vector<EntryRef>::iterator it = removed.begin(); it != removed.end(); ++it) {
+        Entry& entry = **it;
+        IncrementAndFetch(&entry.removed);
+        while (0 != entry.refCount) {
+            qcc::Sleep(1);
+        }
+    }
+}
+
+void MethodTable::Insert(MapType& map, const EntryRef& entry, vector<EntryRef>& replaced)
+{
+    Key key(entry->pathStr.c_str(), entry->ifaceStr.empty() ? NULL : entry->ifaceStr.c_str(), entry->methodStr.c_str());
+    MapType::iterator iter = map.find(key);
+    if (iter != map.end()) {
+        replaced.push_back(iter->second);
+        map.erase(iter);
+    }
+    map.insert(pair<const Key, EntryRef>(key, entry));
+
+    /* Method calls don't require an interface so we need to add an entry with a NULL interface */
+    if (!entry->ifaceStr.empty()) {
+        Key noIfaceKey(entry->pathStr.c_str(), NULL, entry->methodStr.c_str());
+        iter = map.find(noIfaceKey);
+        if (iter != map.end()) {
+            replaced.push_back(iter->second);
+            map.erase(iter);
+        }
+        map.insert(pair<const Key, EntryRef>(noIfaceKey, entry));
+    }
 }
 
 void MethodTable::Add(BusObject* object,
@@ -50,52 +109,71 @@ void MethodTable::Add(BusObject* object,
                       const InterfaceDescription::Member* member,
                       void* context)
 {
-    Entry* entry = new Entry(object, func, member, context);
-    lock.Lock(MUTEX_CONTEXT);
-    hashTable[Key(object->GetPath(), entry->ifaceStr.empty() ? NULL : entry->ifaceStr.c_str(), member->name.c_str())] = entry;
+    vector<Entry> entries(1, Entry(object, func, member, context));
+    Add(entries);
+}
 
-    /* Method calls don't require an interface so we need to add an entry with a NULL interface */
-    if (!entry->ifaceStr.empty()) {
-        hashTable[Key(object->GetPath(), NULL, member->name.c_str())] = new Entry(*entry);
+void MethodTable::Add(const vector<Entry>& entries)
+{
+    vector<EntryRef> replaced;
+    lock.Lock(MUTEX_CONTEXT);
+    bool inPlace;
+    Snapshot snap = BeginUpdate(inPlace);
+    for (vector<Entry>::const_iterator e = entries.begin(); e != entries.end(); ++e) {
+        EntryRef entry;
+        *entry = *e;
+        Insert(*snap, entry, replaced);
+    }
+    /*
+     * A replaced entry may still be in the table under its other key.
+     */
+    vector<EntryRef>::iterator it = replaced.begin();
+    while (it != replaced.end()) {
+        Key otherKey((*it)->pathStr.c_str(), (*it)->ifaceStr.empty() ? NULL : (*it)->ifaceStr.c_str(), (*it)->methodStr.c_str());
+        MapType::iterator iter = snap->find(otherKey);
+        if ((iter != snap->end()) && (&(*iter->second) == &(**it))) {
+            it = replaced.erase(it);
+        } else {
+            ++it;
+        }
     }
+    EndUpdate(snap, inPlace);
     lock.Unlock(MUTEX_CONTEXT);
+    WaitForRemoved(replaced);
 }
 
-MethodTable::SafeEntry* MethodTable::Find(const char* objectPath,
-                                          const char* iface,
-                                          const char* methodName)
+bool MethodTable::Find(const char* objectPath,
+                       const char* iface,
+                       const char* methodName,
+                       SafeEntry& safeEntry)
 {
-    SafeEntry* entry = NULL;
     Key key(objectPath, iface, methodName);
-    lock.Lock(MUTEX_CONTEXT);
-    MapType::iterator iter = hashTable.find(key);
-    if (iter != hashTable.end()) {
-        entry = new SafeEntry();
-        entry->Set(iter->second);
-    }
-    lock.Unlock(MUTEX_CONTEXT);
-    return entry;
+    Snapshot snap = GetSnapshot();
+    MapType::iterator iter = snap->find(key);
+    return (iter != snap->end()) && safeEntry.Set(&(*iter->second));
 }
 
 void MethodTable::RemoveAll(BusObject* object)
 {
-    MapType::iterator iter;
+    vector<EntryRef> removed;
     /*
-     * Iterate over all entries deleting all entries that reference the object
+     * Remove all entries that reference the object with a single update of the hash table
      */
     lock.Lock(MUTEX_CONTEXT);
-    iter = hashTable.begin();
-    while (iter != hashTable.end()) {
+    bool inPlace;
+    Snapshot snap = BeginUpdate(inPlace);
+    MapType::iterator iter = snap->begin();
+    while (iter != snap->end()) {
         if (iter->second->object == object) {
-            Entry* deleteMe = iter->second;
-            hashTable.erase(iter);
-            delete deleteMe;
-            iter = hashTable.begin();
+            removed.push_back(iter->second);
+            snap->erase(iter++);
         } else {
             ++iter;
         }
     }
+    EndUpdate(snap, inPlace);
     lock.Unlock(MUTEX_CONTEXT);
+    WaitForRemoved(removed);
 }
 
 void MethodTable::AddAll(BusObject* object)
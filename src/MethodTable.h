@@ -29,6 +29,7 @@
 #include <qcc/Mutex.h>
 #include <qcc/Thread.h>
 #include <qcc/atomic.h>
+#include <qcc/ManagedObj.h>
 
 #include <alljoyn/BusObject.h>
 #include <alljoyn/InterfaceDescription.h>
@@ -42,6 +43,10 @@ namespace ajn {
 
 /**
  * %MethodTable is a hash table that maps object paths to BusObject instances.
+ *
+ * A hash table snapshot is never modified while a reader holds it. Changes are made to a copy that
+ * then replaces the current hash table so method dispatch only needs a reference to the current
+ * snapshot. When no reader holds the current snapshot it is changed in place instead.
  */
 class MethodTable {
 
@@ -58,30 +63,30 @@ class MethodTable {
               MessageReceiver::MethodHandler handler,
               const InterfaceDescription::Member* member,
               void* context)
-            : object(object), handler(handler), member(member), context(context), ifaceStr(member->iface->GetName()), methodStr(member->name),
-            refCount(0) { }
-
-        ~Entry()
-        {
-            while (0 != refCount) {
-                qcc::Sleep(1);
-            }
-        }
+            : object(object), handler(handler), member(member), context(context), pathStr(object->GetPath()), ifaceStr(member->iface->GetName()),
+            methodStr(member->name), refCount(0), removed(0) { }
 
         /**
          * Construct an empty Entry.
          */
-        Entry(void) : object(NULL), handler(), ifaceStr(), methodStr() { }
+        Entry(void) : object(NULL), handler(), member(NULL), context(NULL), pathStr(), ifaceStr(), methodStr(), refCount(0), removed(0) { }
 
         BusObject* object;                             /**<  BusObject instance*/
         MessageReceiver::MethodHandler handler;        /**<  Handler for method */
         const InterfaceDescription::Member* member;    /**<  Member that handler implements  */
         void* context;                                 /**<  Optional context provided when handler was registered */
+        qcc::String pathStr;                           /**<  Object path string */
         qcc::String ifaceStr;                          /**<  Interface string */
         qcc::String methodStr;                         /**<  Method string */
-        mutable volatile int32_t refCount;
+        mutable volatile int32_t refCount;             /**<  Number of method calls using this entry */
+        volatile int32_t removed;                      /**<  Non-zero once the entry has been removed from the table */
     };
 
+    /**
+     * Entries are shared between snapshots.
+     */
+    typedef qcc::ManagedObj<Entry> EntryRef;
+
     struct SafeEntry {
         SafeEntry() : entry(NULL) {   }
 
@@ -92,20 +97,24 @@ class MethodTable {
             }
         }
 
-        void Set(Entry* entry)
+        /**
+         * Take a reference to an entry unless it has been removed from the table. Removing an
+         * entry waits until there are no references so the entry's object stays valid.
+         */
+        bool Set(Entry* entry)
         {
             qcc::IncrementAndFetch(&(entry->refCount));
+            if (entry->removed) {
+                qcc::DecrementAndFetch(&(entry->refCount));
+                return false;
+            }
             this->entry = entry;
+            return true;
         }
 
         const Entry* entry;
     };
 
-    /**
-     * Destructor
-     */
-    ~MethodTable();
-
     /**
      * Add an entry to the method hash table.
      *
@@ -118,17 +127,25 @@ class MethodTable {
              const InterfaceDescription::Member* member,
              void* context = NULL);
 
+    /**
+     * Add several entries to the method hash table with a single update of the table.
+     *
+     * @param entries    The entries to add.
+     */
+    void Add(const std::vector<Entry>& entries);
+
     /**
      * Find an Entry based on set of criteria.
      *
      * @param objectPath   The object path.
      * @param iface        The interface.
      * @param methodName   The method name.
+     * @param safeEntry    [OUT] Holds the entry that matches objectPath, interface and method.
      * @return
-     *      - Entry that matches objectPath, interface and method
-     *      - NULL if not found
+     *      - true if an entry was found
+     *      - false if not found
      */
-    SafeEntry* Find(const char* objectPath, const char* iface, const char* methodName);
+    bool Find(const char* objectPath, const char* iface, const char* methodName, SafeEntry& safeEntry);
 
     /**
      * Remove all hash entries related to the specified object.
@@ -146,7 +163,8 @@ class MethodTable {
 
   private:
 
-    qcc::Mutex lock; /**< Lock protecting the method table */
+    qcc::Mutex lock;          /**< Mutex to serialize changes to the method table */
+    qcc::Mutex snapshotLock;  /**< Mutex that is only held while taking or replacing a reference to the current snapshot */
 
     /**
      * Type definition for method hash table key
@@ -198,8 +216,57 @@ class MethodTable {
     };
 
     /** The hash table */
-    typedef std::unordered_map<Key, Entry*, Hash, Equal> MapType;
-    MapType hashTable;
+    typedef std::unordered_map<Key, EntryRef, Hash, Equal> MapType;
+
+    /**
+     * Snapshots are replaced rather than modified so a reader only needs a reference to the
+     * current one.
+     */
+    typedef qcc::ManagedObj<MapType> Snapshot;
+
+    /**
+     * Get a reference to the current snapshot.
+     */
+    Snapshot GetSnapshot();
+
+    /**
+     * Get the snapshot to change. Must be called with the lock held.
+     *
+     * If the table holds the only reference to the current snapshot no reader can be using it,
+     * so it is returned to be changed in place and snapshotLock is held until EndUpdate().
+     * Otherwise a copy is returned.
+     *
+     * @param inPlace  [OUT] true if the current snapshot is returned.
+     *
+     * @return  The snapshot to change.
+     */
+    Snapshot BeginUpdate(bool& inPlace);
+
+    /**
+     * Finish a change started with BeginUpdate(). A copy is published as the current snapshot.
+     * Must be called with the lock held.
+     *
+     * @param snap     The snapshot returned by BeginUpdate().
+     * @param inPlace  The value returned by BeginUpdate().
+     */
+    void EndUpdate(Snapshot& snap, bool inPlace);
+
+    /**
+     * Insert an entry under its keys.
+     *
+     * @param map       The hash table to insert into.
+     * @param entry     The entry.
+     * @param replaced  [OUT] Entries that were replaced are appended.
+     */
+    static void Insert(MapType& map, const EntryRef& entry, std::vector<EntryRef>& replaced);
+
+    /**
+     * Wait until method calls using removed entries have returned.
+     */
+    static void WaitForRemoved(std::vector<EntryRef>& removed);
+
+    /** The current hash table */
+    Snapshot hashTable;
 };
 
 }
@@ -0,0 +1,158 @@
+/**
+ * @file
+ * NameAtomTable is a process-wide table that interns bus, interface and
+ * member names as integer atoms.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <qcc/Debug.h>
+#include <qcc/Mutex.h>
+#include <qcc/String.h>
+#include <qcc/StringMapKey.h>
+
+#include <qcc/STLContainer.h>
+
+#include "NameAtoms.h"
+
+#define QCC_MODULE "ALLJOYN"
+
+using namespace std;
+using namespace qcc;
+
+namespace ajn {
+
+const NameAtom NameAtomTable::NIL_ATOM;
+const NameAtom NameAtomTable::UNKNOWN_ATOM;
+const size_t MessageNameAtoms::NUM_ATOMS;
+
+/**
+ * An interned name and the number of references to it.
+ */
+struct AtomEntry {
+    NameAtom atom;      /**< Atom for the name */
+    uint32_t refs;      /**< Number of Intern calls not yet balanced by Release */
+};
+
+/**
+ * Hash functor
+ */
+struct AtomHash {
+    inline size_t operator()(const qcc::String& s) const {
+        return qcc::hash_string(s.c_str());
+    }
+};
+
+typedef std::unordered_map<qcc::String, AtomEntry, AtomHash> AtomMap;
+
+/*
+ * The table is created on first use so it can be used by static initializers and is never
+ * destroyed so it can be used by static destructors.
+ */
+static qcc::Mutex& TableLock()
+{
+    static qcc::Mutex* lock = new qcc::Mutex();
+    return *lock;
+}
+
+static AtomMap& Table()
+{
+    static AtomMap* table = new AtomMap();
+    return *table;
+}
+
+/* Generation of the table. This is also the last atom that was allocated. */
+static volatile uint32_t generation = 1;
+
+NameAtom NameAtomTable::Intern(const char* name)
+{
+    if (!name || (name[0] == '\0')) {
+        return NIL_ATOM;
+    }
+
+    TableLock().Lock(MUTEX_CONTEXT);
+    AtomMap& table = Table();
+    AtomMap::iterator it = table.find(name);
+    if (it == table.end()) {
+        AtomEntry entry;
+        /* The counter would have to wrap before an atom is reused */
+        entry.atom = generation + 1;
+        if ((entry.atom == UNKNOWN_ATOM) || (entry.atom == NIL_ATOM)) {
+            entry.atom = NIL_ATOM + 2;
+        }
+        entry.refs = 0;
+        it = table.insert(std::make_pair(qcc::String(name), entry)).first;
+        generation = entry.atom;
+        QCC_DbgPrintf(("Interned %s as atom %u", name, entry.atom));
+    }
+    ++it->second.refs;
+    NameAtom atom = it->second.atom;
+    TableLock().Unlock(MUTEX_CONTEXT);
+    return atom;
+}
+
+void NameAtomTable::Release(const char* name)
+{
+    if (!name || (name[0] == '\0')) {
+        return;
+    }
+
+    TableLock().Lock(MUTEX_CONTEXT);
+    AtomMap& table = Table();
+    AtomMap::iterator it = table.find(name);
+    if (it == table.end()) {
+        QCC_LogError(ER_FAIL, ("Release of %s which is not interned", name));
+    } else if (--it->second.refs == 0) {
+        QCC_DbgPrintf(("Released atom %u for %s", it->second.atom, name));
+        table.erase(it);
+    }
+    TableLock().Unlock(MUTEX_CONTEXT);
+}
+
+NameAtom NameAtomTable::Find(const char* name)
+{
+    NameAtom atom;
+    Find(&name, &atom, 1);
+    return atom;
+}
+
+uint32_t NameAtomTable::Find(const char* const* names, NameAtom* atoms, size_t numNames)
+{
+    TableLock().Lock(MUTEX_CONTEXT);
+    AtomMap& table = Table();
+    for (size_t i = 0; i < numNames; ++i) {
+        if (!names[i] || (names[i][0] == '\0')) {
+            atoms[i] = NIL_ATOM;
+        } else if (table.empty()) {
+            atoms[i] = UNKNOWN_ATOM;
+        } else {
+            AtomMap::const_iterator it = table.find(names[i]);
+            atoms[i] = (it == table.end()) ? UNKNOWN_ATOM : it->second.atom;
+        }
+    }
+    uint32_t gen = generation;
+    TableLock().Unlock(MUTEX_CONTEXT);
+    return gen;
+}
+
+uint32_t NameAtomTable::Generation()
+{
+    return generation;
+}
+
+}
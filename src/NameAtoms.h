@@ -0,0 +1,159 @@
+/**
+ * @file
+ * NameAtomTable is a process-wide table that interns bus, interface and
+ * member names as integer atoms so they can be compared and used as map
+ * keys without string comparisons.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#ifndef _ALLJOYN_NAMEATOMS_H
+#define _ALLJOYN_NAMEATOMS_H
+
+#include <qcc/platform.h>
+
+#include <qcc/String.h>
+
+#include <alljoyn/Message.h>
+
+namespace ajn {
+
+/**
+ * Integer handle for an interned name. Two names are equal if and only if their atoms are equal.
+ */
+typedef uint32_t NameAtom;
+
+/**
+ * NameAtomTable maps names to atoms. Every Intern must be balanced by a Release so a name only
+ * stays in the table while something (a match rule for instance) refers to it. Atoms are
+ * allocated from an increasing counter and are not reused so an atom that is held after its
+ * name was released can never match a different name.
+ */
+class NameAtomTable {
+  public:
+
+    /** Atom for the empty (or NULL) name. Used by rules to mean "don't care" */
+    static const NameAtom NIL_ATOM = 0;
+
+    /** Atom returned by Find for a name that is not interned. It is not equal to any interned atom */
+    static const NameAtom UNKNOWN_ATOM = 0xFFFFFFFF;
+
+    /**
+     * Return the atom for a name and take a reference to it, adding the name to the table if it
+     * is not already present.
+     *
+     * @param name   Name to intern.
+     * @return  The atom for name or NIL_ATOM if name is empty.
+     */
+    static NameAtom Intern(const char* name);
+
+    /**
+     * Return the atom for a name and take a reference to it, adding the name to the table if it
+     * is not already present.
+     *
+     * @param name   Name to intern.
+     * @return  The atom for name or NIL_ATOM if name is empty.
+     */
+    static NameAtom Intern(const qcc::String& name) { return Intern(name.c_str()); }
+
+    /**
+     * Drop a reference taken by Intern. The name is removed from the table with its last reference.
+     *
+     * @param name   Name that was interned.
+     */
+    static void Release(const char* name);
+
+    /**
+     * Drop a reference taken by Intern. The name is removed from the table with its last reference.
+     *
+     * @param name   Name that was interned.
+     */
+    static void Release(const qcc::String& name) { Release(name.c_str()); }
+
+    /**
+     * Return the atom for a name without adding it to the table.
+     *
+     * @param name   Name to look up.
+     * @return  The atom for name, NIL_ATOM if name is empty or UNKNOWN_ATOM if name is not interned.
+     */
+    static NameAtom Find(const char* name);
+
+    /**
+     * Look up several names at once while only taking the table lock once.
+     *
+     * @param names     Names to look up.
+     * @param atoms     [OUT] The atom for each name as returned by Find.
+     * @param numNames  Number of entries in names and atoms.
+     * @return  The generation of the table the atoms were looked up in.
+     */
+    static uint32_t Find(const char* const* names, NameAtom* atoms, size_t numNames);
+
+    /**
+     * The generation of the table changes every time a name is added. Atoms looked up in an
+     * earlier generation may be UNKNOWN_ATOM for a name that has since been interned and must be
+     * looked up again. Removing a name does not change the generation because atoms are not reused.
+     *
+     * @return  The current generation. This is never 0.
+     */
+    static uint32_t Generation();
+};
+
+/**
+ * The atoms for the routing related header fields of a message. A message's names are resolved
+ * once when it is unmarshaled by a routing node and the resulting atoms are then compared against
+ * every candidate rule.
+ */
+struct MessageNameAtoms {
+    NameAtom sender;        /**< Atom for the sender header field */
+    NameAtom iface;         /**< Atom for the interface header field */
+    NameAtom member;        /**< Atom for the member header field */
+    NameAtom destination;   /**< Atom for the destination header field */
+
+    /** Number of atoms in a MessageNameAtoms */
+    static const size_t NUM_ATOMS = 4;
+
+    /**
+     * Get the header field atoms of a message. Atoms resolved when the message was unmarshaled
+     * are used unless names have been interned since then.
+     *
+     * @param msg   Message whose header field atoms are needed.
+     */
+    MessageNameAtoms(const Message& msg) { msg->GetNameAtoms(*this); }
+
+    /**
+     * Constructor used by _Message to resolve the header field names.
+     *
+     * @param sender        Sender header field.
+     * @param iface         Interface header field.
+     * @param member        Member header field.
+     * @param destination   Destination header field.
+     * @param generation    [OUT] The table generation the atoms were resolved against.
+     */
+    MessageNameAtoms(const char* sender, const char* iface, const char* member, const char* destination, uint32_t& generation)
+    {
+        const char* names[NUM_ATOMS] = { sender, iface, member, destination };
+        NameAtom atoms[NUM_ATOMS];
+        generation = NameAtomTable::Find(names, atoms, NUM_ATOMS);
+        this->sender = atoms[0];
+        this->iface = atoms[1];
+        this->member = atoms[2];
+        this->destination = atoms[3];
+    }
+};
+
+}
+
+#endif
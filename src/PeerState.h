@@ -82,7 +82,8 @@ class _PeerState {
         lastDriftAdjustTime(0),
         expectedSerial(0),
         isSecure(false),
-        authEvent(NULL)
+        authEvent(NULL),
+        authVersion(0)
     {
         ::memset(window, 0, sizeof(window));
         ::memset(authorizations, 0, sizeof(authorizations));
@@ -33,6 +33,7 @@
 #include <qcc/Util.h>
 #include <qcc/Event.h>
 #include <qcc/Mutex.h>
+#include <qcc/atomic.h>
 #include <qcc/ManagedObj.h>
 
 #include <alljoyn/BusAttachment.h>
@@ -62,6 +63,43 @@ namespace ajn {
 
 struct ProxyBusObject::Components {
 
+    Components() : cacheProperties(false), cacheGeneration(0)
+    {
+        cacheStats.hits = 0;
+        cacheStats.misses = 0;
+    }
+
+    /** Cached property values of one interface */
+    struct CachedInterface {
+        CachedInterface() : complete(false) { }
+        map<qcc::String, MsgArg> values;   /**< Property values (variants) keyed by property name */
+        bool complete;                      /**< True if values holds every readable property of the interface */
+    };
+
+    /**
+     * Discard the property cache and its counters. A copy of a proxy object does not receive
+     * PropertiesChanged signals so it must not use the cache of the original.
+     */
+    void ResetPropertyCache()
+    {
+        cacheProperties = false;
+        propertyCache.clear();
+        cacheOwner.clear();
+        cacheGeneration = 0;
+        cacheStats.hits = 0;
+        cacheStats.misses = 0;
+    }
+
+    /**
+     * Drop all cached values. Bumping the generation keeps replies that are in flight from
+     * filling the cache with values from before the drop.
+     */
+    void ClearPropertyCache()
+    {
+        propertyCache.clear();
+        ++cacheGeneration;
+    }
+
     /** The interfaces this object implements */
     map<qcc::StringMapKey, const InterfaceDescription*> ifaces;
 
@@ -70,6 +108,21 @@ struct ProxyBusObject::Components {
 
     /** List of threads that are waiting in sync method calls */
     vector<Thread*> waitingThreads;
+
+    /** True if property values are cached */
+    bool cacheProperties;
+
+    /** Cached property values keyed by interface name */
+    map<qcc::String, CachedInterface> propertyCache;
+
+    /** Unique name of the current owner of the remote object, the only sender whose PropertiesChanged are applied */
+    qcc::String cacheOwner;
+
+    /** Incremented whenever the remote object reports changed properties */
+    uint32_t cacheGeneration;
+
+    /** Property cache counters */
+    PropertyCacheStats cacheStats;
 };
 
 template <typename _cbType> struct CBContext {
@@ -92,6 +145,224 @@ static inline bool SecurityApplies(const ProxyBusObject* obj, const InterfaceDes
     }
 }
 
+/*
+ * Only properties that the remote object promises to report with PropertiesChanged can be cached.
+ */
+static bool IsCacheable(const InterfaceDescription* ifc, const char* property)
+{
+    qcc::String emitsChanged;
+    if (ifc->GetPropertyAnnotation(property, org::freedesktop::DBus::AnnotateEmitsChanged, emitsChanged)) {
+        return (emitsChanged == "true") || (emitsChanged == "invalidates");
+    }
+    return false;
+}
+
+/*
+ * Check if all the readable properties of an interface can be cached.
+ */
+static bool IsFullyCacheable(const InterfaceDescription* ifc)
+{
+    size_t numProps = ifc->GetProperties();
+    if (numProps == 0) {
+        return false;
+    }
+    vector<const InterfaceDescription::Property*> props(numProps);
+    numProps = ifc->GetProperties(&props[0], numProps);
+    for (size_t i = 0; i < numProps; ++i) {
+        if ((props[i]->access & PROP_ACCESS_READ) && !IsCacheable(ifc, props[i]->name.c_str())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Match rule for the PropertiesChanged signals emitted by an object.
+ */
+static qcc::String PropertiesChangedRule(const qcc::String& path)
+{
+    qcc::String rule("type='signal',interface='");
+    rule += org::freedesktop::DBus::InterfaceName;
+    rule += "',member='PropertiesChanged',path='";
+    rule += path;
+    rule += "'";
+    return rule;
+}
+
+QStatus ProxyBusObject::EnablePropertyCaching()
+{
+    lock->Lock(MUTEX_CONTEXT);
+    bool enabled = components->cacheProperties;
+    lock->Unlock(MUTEX_CONTEXT);
+    if (enabled) {
+        return ER_OK;
+    }
+    const InterfaceDescription* dbusIface = bus->GetInterface(org::freedesktop::DBus::InterfaceName);
+    const InterfaceDescription* ajIface = bus->GetInterface(org::alljoyn::Bus::InterfaceName);
+    const InterfaceDescription::Member* propChanged = (dbusIface ? dbusIface->GetMember("PropertiesChanged") : NULL);
+    const InterfaceDescription::Member* ownerChanged = (dbusIface ? dbusIface->GetMember("NameOwnerChanged") : NULL);
+    const InterfaceDescription::Member* sessionLost = (ajIface ? ajIface->GetMember("SessionLostWithReason") : NULL);
+    if (!propChanged || !ownerChanged || !sessionLost) {
+        return ER_BUS_NO_SUCH_INTERFACE;
+    }
+    /*
+     * The bus attachment already matches the org.freedesktop.DBus and org.alljoyn.Bus signals
+     * so only PropertiesChanged needs a match rule. The owner tracking handlers are registered
+     * before the owner is looked up so a change of owner in between is not missed.
+     */
+    QStatus status = bus->RegisterSignalHandler(this,
+                                                static_cast<MessageReceiver::SignalHandler>(&ProxyBusObject::CacheOwnerChangedHandler),
+                                                ownerChanged,
+                                                NULL);
+    if (status == ER_OK) {
+        status = bus->RegisterSignalHandler(this,
+                                            static_cast<MessageReceiver::SignalHandler>(&ProxyBusObject::CacheSessionLostHandler),
+                                            sessionLost,
+                                            NULL);
+    }
+    if (status == ER_OK) {
+        status = bus->RegisterSignalHandler(this,
+                                            static_cast<MessageReceiver::SignalHandler>(&ProxyBusObject::PropertiesChangedHandler),
+                                            propChanged,
+                                            path.c_str());
+    }
+    if (status == ER_OK) {
+        status = bus->AddMatch(PropertiesChangedRule(path).c_str());
+    }
+    qcc::String owner;
+    lock->Lock(MUTEX_CONTEXT);
+    uint32_t generation = components->cacheGeneration;
+    lock->Unlock(MUTEX_CONTEXT);
+    if ((status == ER_OK) && !serviceName.empty() && (serviceName[0] == ':')) {
+        owner = serviceName;
+    } else if (status == ER_OK) {
+        /*
+         * A well-known name without an owner is not an error, signals are ignored until the
+         * name gets an owner.
+         */
+        Message reply(*bus);
+        MsgArg arg("s", serviceName.c_str());
+        if (bus->GetDBusProxyObj().MethodCall(org::freedesktop::DBus::InterfaceName, "GetNameOwner", &arg, 1, reply) == ER_OK) {
+            owner = reply->GetArg(0)->v_string.str;
+        }
+    }
+    if (status == ER_OK) {
+        lock->Lock(MUTEX_CONTEXT);
+        components->cacheProperties = true;
+        /*
+         * Keep the owner reported by NameOwnerChanged if it changed while GetNameOwner was in progress.
+         */
+        if (generation == components->cacheGeneration) {
+            components->cacheOwner = owner;
+        }
+        lock->Unlock(MUTEX_CONTEXT);
+    } else {
+        bus->UnregisterSignalHandler(this,
+                                     static_cast<MessageReceiver::SignalHandler>(&ProxyBusObject::CacheOwnerChangedHandler),
+                                     ownerChanged,
+                                     NULL);
+        bus->UnregisterSignalHandler(this,
+                                     static_cast<MessageReceiver::SignalHandler>(&ProxyBusObject::CacheSessionLostHandler),
+                                     sessionLost,
+                                     NULL);
+        bus->UnregisterSignalHandler(this,
+                                     static_cast<MessageReceiver::SignalHandler>(&ProxyBusObject::PropertiesChangedHandler),
+                                     propChanged,
+                                     path.c_str());
+    }
+    return status;
+}
+
+void ProxyBusObject::GetPropertyCacheStats(PropertyCacheStats& stats) const
+{
+    lock->Lock(MUTEX_CONTEXT);
+    stats = components->cacheStats;
+    lock->Unlock(MUTEX_CONTEXT);
+}
+
+void ProxyBusObject::PropertiesChangedHandler(const InterfaceDescription::Member* member, const char* srcPath, Message& message)
+{
+    if ((sessionId != 0) && (sessionId != message->GetSessionId())) {
+        return;
+    }
+    size_t numArgs;
+    const MsgArg* args;
+    message->GetArgs(numArgs, args);
+    if ((numArgs < 3) || (args[0].typeId != ALLJOYN_STRING) || (args[1].typeId != ALLJOYN_ARRAY) || (args[2].typeId != ALLJOYN_ARRAY)) {
+        return;
+    }
+    const char* ifaceName = args[0].v_string.str;
+    const InterfaceDescription* ifc = bus->GetInterface(ifaceName);
+    const MsgArg* changed = args[1].v_array.GetElements();
+    size_t numChanged = args[1].v_array.GetNumElements();
+    const MsgArg* invalidated = args[2].v_array.GetElements();
+    size_t numInvalidated = args[2].v_array.GetNumElements();
+
+    lock->Lock(MUTEX_CONTEXT);
+    /*
+     * Only the current owner of the remote object can change its properties. Other senders on
+     * the same object path are ignored.
+     */
+    if (components && components->cacheProperties && !components->cacheOwner.empty() && (components->cacheOwner == message->GetSender())) {
+        ++components->cacheGeneration;
+        Components::CachedInterface& cached = components->propertyCache[ifaceName];
+        for (size_t i = 0; i < numChanged; ++i) {
+            const char* name = changed[i].v_dictEntry.key->v_string.str;
+            if (ifc && IsCacheable(ifc, name)) {
+                cached.values[name] = *changed[i].v_dictEntry.val;
+            } else {
+                cached.values.erase(name);
+                cached.complete = false;
+            }
+        }
+        for (size_t i = 0; i < numInvalidated; ++i) {
+            cached.values.erase(invalidated[i].v_string.str);
+            cached.complete = false;
+        }
+    }
+    lock->Unlock(MUTEX_CONTEXT);
+}
+
+void ProxyBusObject::CacheOwnerChangedHandler(const InterfaceDescription::Member* member, const char* srcPath, Message& message)
+{
+    size_t numArgs;
+    const MsgArg* args;
+    message->GetArgs(numArgs, args);
+    if ((numArgs < 3) || (args[0].typeId != ALLJOYN_STRING) || (args[2].typeId != ALLJOYN_STRING)) {
+        return;
+    }
+    if (serviceName != args[0].v_string.str) {
+        return;
+    }
+    /*
+     * The values came from the old owner. For a unique name the new owner is empty.
+     */
+    lock->Lock(MUTEX_CONTEXT);
+    if (components) {
+        components->ClearPropertyCache();
+        components->cacheOwner = args[2].v_string.str;
+    }
+    lock->Unlock(MUTEX_CONTEXT);
+}
+
+void ProxyBusObject::CacheSessionLostHandler(const InterfaceDescription::Member* member, const char* srcPath, Message& message)
+{
+    size_t numArgs;
+    const MsgArg* args;
+    message->GetArgs(numArgs, args);
+    if ((numArgs < 1) || (args[0].typeId != ALLJOYN_UINT32) || (sessionId == 0) || (sessionId != args[0].v_uint32)) {
+        return;
+    }
+    /*
+     * PropertiesChanged signals are no longer received on the session.
+     */
+    lock->Lock(MUTEX_CONTEXT);
+    if (components && components->cacheProperties) {
+        components->ClearPropertyCache();
+    }
+    lock->Unlock(MUTEX_CONTEXT);
+}
+
 QStatus ProxyBusObject::GetAllProperties(const char* iface, MsgArg& value, uint32_t timeout) const
 {
     QStatus status;
@@ -99,6 +370,35 @@ QStatus ProxyBusObject::GetAllProperties(const char* iface, MsgArg& value, uint3
     if (!valueIface) {
         status = ER_BUS_OBJECT_NO_SUCH_INTERFACE;
     } else {
+        uint32_t generation = 0;
+        bool cacheable = false;
+        lock->Lock(MUTEX_CONTEXT);
+        if (components->cacheProperties) {
+            cacheable = true;
+            generation = components->cacheGeneration;
+        }
+        if (cacheable && IsFullyCacheable(valueIface)) {
+            map<qcc::String, Components::CachedInterface>::const_iterator cached = components->propertyCache.find(iface);
+            if ((cached != components->propertyCache.end()) && cached->second.complete) {
+                /*
+                 * Build the a{sv} reply from the cached variants
+                 */
+                const map<qcc::String, MsgArg>& values = cached->second.values;
+                vector<MsgArg> entries(values.size());
+                size_t i = 0;
+                for (map<qcc::String, MsgArg>::const_iterator it = values.begin(); it != values.end(); ++it) {
+                    entries[i++].Set("{sv}", it->first.c_str(), it->second.v_variant.val);
+                }
+                value.Set("a{sv}", entries.size(), entries.empty() ? NULL : &entries[0]);
+                value.Stabilize();
+                ++components->cacheStats.hits;
+                lock->Unlock(MUTEX_CONTEXT);
+                return ER_OK;
+            }
+            ++components->cacheStats.misses;
+        }
+        lock->Unlock(MUTEX_CONTEXT);
+
         uint8_t flags = 0;
         /*
          * If the object or the property interface is secure method call must be encrypted.
@@ -116,6 +416,25 @@ QStatus ProxyBusObject::GetAllProperties(const char* iface, MsgArg& value, uint3
             if (ER_OK == status) {
                 value = *(reply->GetArg(0));
             }
+            if ((ER_OK == status) && cacheable && (value.typeId == ALLJOYN_ARRAY)) {
+                lock->Lock(MUTEX_CONTEXT);
+                /*
+                 * Don't fill the cache if properties changed while the call was in progress.
+                 */
+                if (components->cacheProperties && (generation == components->cacheGeneration)) {
+                    Components::CachedInterface& cached = components->propertyCache[iface];
+                    const MsgArg* entries = value.v_array.GetElements();
+                    size_t numEntries = value.v_array.GetNumElements();
+                    for (size_t i = 0; i < numEntries; ++i) {
+                        const char* name = entries[i].v_dictEntry.key->v_string.str;
+                        if (IsCacheable(valueIface, name)) {
+                            cached.values[name] = *entries[i].v_dictEntry.val;
+                        }
+                    }
+                    cached.complete = IsFullyCacheable(valueIface);
+                }
+                lock->Unlock(MUTEX_CONTEXT);
+            }
         }
     }
     return status;
@@ -190,6 +509,26 @@ QStatus ProxyBusObject::GetProperty(const char* iface, const char* property, Msg
     if (!valueIface) {
         status = ER_BUS_OBJECT_NO_SUCH_INTERFACE;
     } else {
+        uint32_t generation = 0;
+        bool cacheable = false;
+        lock->Lock(MUTEX_CONTEXT);
+        if (components->cacheProperties && IsCacheable(valueIface, property)) {
+            cacheable = true;
+            generation = components->cacheGeneration;
+            map<qcc::String, Components::CachedInterface>::const_iterator cached = components->propertyCache.find(iface);
+            if (cached != components->propertyCache.end()) {
+                map<qcc::String, MsgArg>::const_iterator it = cached->second.values.find(property);
+                if (it != cached->second.values.end()) {
+                    value = it->second;
+                    ++components->cacheStats.hits;
+                    lock->Unlock(MUTEX_CONTEXT);
+                    return ER_OK;
+                }
+            }
+            ++components->cacheStats.misses;
+        }
+        lock->Unlock(MUTEX_CONTEXT);
+
         uint8_t flags = 0;
         /*
          * If the object or the property interface is secure method call must be encrypted.
@@ -209,6 +548,16 @@ QStatus ProxyBusObject::GetProperty(const char* iface, const char* property, Msg
             if (ER_OK == status) {
                 value = *(reply->GetArg(0));
             }
+            if ((ER_OK == status) && cacheable) {
+                lock->Lock(MUTEX_CONTEXT);
+                /*
+                 * Don't cache the value if properties changed while the call was in progress.
+                 */
+                if (components->cacheProperties && (generation == components->cacheGeneration)) {
+                    components->propertyCache[iface].values[property] = value;
+                }
+                lock->Unlock(MUTEX_CONTEXT);
+            }
         }
     }
     return status;
@@ -305,6 +654,21 @@ QStatus ProxyBusObject::SetProperty(const char* iface, const char* property, Msg
                                 timeout,
                                 flags);
         }
+        if (ER_OK == status) {
+            /*
+             * Drop the cached value rather than waiting for the PropertiesChanged signal.
+             */
+            lock->Lock(MUTEX_CONTEXT);
+            if (components->cacheProperties) {
+                ++components->cacheGeneration;
+                map<qcc::String, Components::CachedInterface>::iterator cached = components->propertyCache.find(iface);
+                if (cached != components->propertyCache.end()) {
+                    cached->second.values.erase(property);
+                    cached->second.complete = false;
+                }
+            }
+            lock->Unlock(MUTEX_CONTEXT);
+        }
     }
     return status;
 }
@@ -737,15 +1101,166 @@ QStatus ProxyBusObject::MethodCallAsync(const char* ifaceName,
 }
 
 /**
- * Internal context structure used between synchronous method_call and method_return
+ * Internal context shared by the method calls of a batch
  */
-class SyncReplyContext {
-  public:
-    SyncReplyContext(BusAttachment& bus) : replyMsg(bus) { }
-    Message replyMsg;
-    Event event;
+struct BatchContext {
+
+    /** Reply context for one method call in the batch */
+    struct Slot {
+        BatchContext* batch;
+        size_t index;
+    };
+
+    BatchContext(ProxyBusObject* obj, ProxyBusObject::MethodCallBatchAsyncCB* callback, void* context, size_t numCalls) :
+        obj(obj), callback(callback), context(context), slots(numCalls), outstanding(static_cast<int32_t>(numCalls) + 1)
+    {
+        for (size_t i = 0; i < numCalls; ++i) {
+            slots[i].batch = this;
+            slots[i].index = i;
+        }
+    }
+
+    ProxyBusObject* obj;
+    ProxyBusObject::MethodCallBatchAsyncCB* callback;
+    void* context;
+    vector<Message> calls;       /**< The method calls */
+    vector<Message> replies;     /**< The replies in the same order as the method calls */
+    vector<Slot> slots;          /**< Reply contexts, one per method call */
+    volatile int32_t outstanding; /**< Replies not yet received plus one held while the batch is being sent */
 };
 
+/*
+ * Account for one reply and complete the batch if it was the last one.
+ */
+static void ReleaseBatch(BatchContext* batch)
+{
+    if (DecrementAndFetch(&batch->outstanding) == 0) {
+        QStatus status = ER_OK;
+        for (size_t i = 0; i < batch->replies.size(); ++i) {
+            if (batch->replies[i]->GetType() != MESSAGE_METHOD_RET) {
+                status = ER_BUS_REPLY_IS_ERROR_MESSAGE;
+                break;
+            }
+        }
+        batch->callback->MethodCallBatchCB(status, batch->obj, &batch->replies[0], batch->replies.size(), batch->context);
+        delete batch;
+    }
+}
+
+/*
+ * Complete a method call in the batch that was not sent with an error reply.
+ */
+static void FailBatchCall(BatchContext* batch, BusAttachment& bus, size_t index, QStatus status)
+{
+    Message reply(bus);
+    reply->ErrorMsg(status, 0);
+    batch->replies[index] = reply;
+    ReleaseBatch(batch);
+}
+
+QStatus ProxyBusObject::MethodCallBatchAsync(const BatchedCall* calls,
+                                             size_t numCalls,
+                                             MethodCallBatchAsyncCB* callback,
+                                             void* context,
+                                             uint32_t timeout,
+                                             uint8_t flags)
+{
+    if (!calls || (numCalls == 0)) {
+        return ER_BAD_ARG_1;
+    }
+    if (!callback) {
+        return ER_BAD_ARG_3;
+    }
+    LocalEndpoint localEndpoint = bus->GetInternal().GetLocalEndpoint();
+    if (!localEndpoint->IsValid()) {
+        return ER_BUS_ENDPOINT_CLOSING;
+    }
+    /*
+     * Marshal all the method calls before sending any so a bad method call fails the whole batch.
+     */
+    QStatus status = ER_OK;
+    BatchContext* batch = new BatchContext(this, callback, context, numCalls);
+    batch->calls.reserve(numCalls);
+    batch->replies.reserve(numCalls);
+    for (size_t i = 0; (status == ER_OK) && (i < numCalls); ++i) {
+        const InterfaceDescription::Member* method = calls[i].method;
+        if (!method) {
+            status = ER_BAD_ARG_1;
+            break;
+        }
+        if (!ImplementsInterface(method->iface->GetName())) {
+            status = ER_BUS_OBJECT_NO_SUCH_INTERFACE;
+            QCC_LogError(status, ("Object %s does not implement %s", path.c_str(), method->iface->GetName()));
+            break;
+        }
+        uint8_t callFlags = flags & ~ALLJOYN_FLAG_NO_REPLY_EXPECTED;
+        if (SecurityApplies(this, method->iface)) {
+            callFlags |= ALLJOYN_FLAG_ENCRYPTED;
+        }
+        if ((callFlags & ALLJOYN_FLAG_ENCRYPTED) && !bus->IsPeerSecurityEnabled()) {
+            status = ER_BUS_SECURITY_NOT_ENABLED;
+            break;
+        }
+        batch->calls.push_back(Message(*bus));
+        batch->replies.push_back(Message(*bus));
+        status = batch->calls[i]->CallMsg(method->signature, serviceName, sessionId, path, method->iface->GetName(), method->name, calls[i].args, calls[i].numArgs, callFlags);
+    }
+    if (status != ER_OK) {
+        delete batch;
+        return status;
+    }
+    /*
+     * Register all the reply handlers first so the method calls can be sent back to back. The
+     * extra reference on the batch keeps it from completing until all the calls have been sent.
+     */
+    vector<bool> registered(numCalls, false);
+    size_t numRegistered = 0;
+    for (size_t i = 0; i < numCalls; ++i) {
+        QStatus regStatus = localEndpoint->RegisterReplyHandler(this,
+                                                                static_cast<MessageReceiver::ReplyHandler>(&ProxyBusObject::BatchReplyHandler),
+                                                                *calls[i].method,
+                                                                batch->calls[i],
+                                                                &batch->slots[i],
+                                                                timeout);
+        if (regStatus == ER_OK) {
+            registered[i] = true;
+            ++numRegistered;
+        } else {
+            status = regStatus;
+        }
+    }
+    if (numRegistered == 0) {
+        delete batch;
+        return status;
+    }
+    for (size_t i = 0; i < numCalls; ++i) {
+        QStatus sendStatus;
+        if (!registered[i]) {
+            sendStatus = status;
+        } else if (b2bEp->IsValid()) {
+            sendStatus = b2bEp->PushMessage(batch->calls[i]);
+        } else {
+            BusEndpoint busEndpoint = BusEndpoint::cast(localEndpoint);
+            sendStatus = bus->GetInternal().GetRouter().PushMessage(batch->calls[i], busEndpoint);
+        }
+        /*
+         * If the reply handler cannot be unregistered it has already been called.
+         */
+        if ((sendStatus != ER_OK) && (!registered[i] || localEndpoint->UnregisterReplyHandler(batch->calls[i]))) {
+            FailBatchCall(batch, *bus, i, sendStatus);
+        }
+    }
+    ReleaseBatch(batch);
+    return ER_OK;
+}
+
+void ProxyBusObject::BatchReplyHandler(Message& message, void* context)
+{
+    BatchContext::Slot* slot = reinterpret_cast<BatchContext::Slot*>(context);
+    BatchContext* batch = slot->batch;
+    batch->replies[slot->index] = message;
+    ReleaseBatch(batch);
+}
 
 QStatus ProxyBusObject::MethodCall(const InterfaceDescription::Member& method,
                                    const MsgArg* args,
@@ -801,17 +1316,19 @@ QStatus ProxyBusObject::MethodCall(const InterfaceDescription::Member& method,
             status = bus->GetInternal().GetRouter().PushMessage(msg, busEndpoint);
         }
     } else {
-        ManagedObj<SyncReplyContext> ctxt(*bus);
         /*
          * Synchronous calls are really asynchronous calls that block waiting for a builtin
-         * reply handler to be called.
+         * reply handler to be called. The context is shared with the reply handler and each
+         * releases its reference when done with it.
          */
-        ManagedObj<SyncReplyContext>* heapCtx = new ManagedObj<SyncReplyContext>(ctxt);
+        BusAttachment::Internal& busInternal = bus->GetInternal();
+        Thread* thisThread = Thread::GetThread();
+        BusAttachment::Internal::SyncReplyContext* ctxt = busInternal.AcquireSyncReplyContext(thisThread);
         status = localEndpoint->RegisterReplyHandler(const_cast<MessageReceiver*>(static_cast<const MessageReceiver* const>(this)),
                                                      static_cast<MessageReceiver::ReplyHandler>(&ProxyBusObject::SyncReplyHandler),
                                                      method,
                                                      msg,
-                                                     heapCtx,
+                                                     ctxt,
                                                      timeout);
         if (status == ER_OK) {
             if (b2bEp->IsValid()) {
@@ -821,12 +1338,11 @@ QStatus ProxyBusObject::MethodCall(const InterfaceDescription::Member& method,
                 status = bus->GetInternal().GetRouter().PushMessage(msg, busEndpoint);
             }
         } else {
-            delete heapCtx;
-            heapCtx = NULL;
+            busInternal.ReleaseSyncReplyContext(ctxt);
+            busInternal.ReleaseSyncReplyContext(ctxt);
             goto MethodCallExit;
         }
 
-        Thread* thisThread = Thread::GetThread();
         if (status == ER_OK) {
             lock->Lock(MUTEX_CONTEXT);
             if (!isExiting) {
@@ -854,16 +1370,19 @@ QStatus ProxyBusObject::MethodCall(const InterfaceDescription::Member& method,
             replyMsg = ctxt->replyMsg;
         } else if ((status == ER_ALERTED_THREAD) && (SYNC_METHOD_ALERTCODE_ABORT == thisThread->GetAlertCode())) {
             /*
-             * We can't touch anything in this case since the external thread that was waiting
-             * can't know whether this object still exists.
+             * We can't touch this object in this case since the external thread that was waiting
+             * can't know whether this object still exists. The context belongs to the bus
+             * attachment so it is still safe to release it. DestructComponents released the
+             * reference held by the reply handler it unregistered.
              */
             status = ER_BUS_METHOD_CALL_ABORTED;
         } else if (localEndpoint->UnregisterReplyHandler(msg)) {
             /*
-             * The handler was deregistered so we need to delete the context here.
+             * The handler was deregistered so we need to release its reference here.
              */
-            delete heapCtx;
+            busInternal.ReleaseSyncReplyContext(ctxt);
         }
+        busInternal.ReleaseSyncReplyContext(ctxt);
     }
 
 MethodCallExit:
@@ -906,17 +1425,17 @@ QStatus ProxyBusObject::MethodCall(const char* ifaceName,
 
 void ProxyBusObject::SyncReplyHandler(Message& msg, void* context)
 {
-    ManagedObj<SyncReplyContext>* ctx = reinterpret_cast<ManagedObj<SyncReplyContext>*> (context);
+    BusAttachment::Internal::SyncReplyContext* ctx = reinterpret_cast<BusAttachment::Internal::SyncReplyContext*> (context);
 
     /* Set the reply message */
-    (*ctx)->replyMsg = msg;
+    ctx->replyMsg = msg;
 
     /* Wake up sync method_call thread */
-    QStatus status = (*ctx)->event.SetEvent();
+    QStatus status = ctx->event.SetEvent();
     if (ER_OK != status) {
         QCC_LogError(status, ("SetEvent failed"));
     }
-    delete ctx;
+    bus->GetInternal().ReleaseSyncReplyContext(ctx);
 }
 
 QStatus ProxyBusObject::SecureConnection(bool forceAuth)
@@ -1069,7 +1588,25 @@ void ProxyBusObject::DestructComponents()
         }
 
         if (bus) {
+            /*
+             * The reply handlers of aborted synchronous method calls will never be called so the
+             * references they hold on the sync reply contexts are released here.
+             */
+            vector<void*> contexts;
+            bus->GetInternal().GetLocalEndpoint()->UnregisterReplyHandlers(this, static_cast<MessageReceiver::ReplyHandler>(&ProxyBusObject::SyncReplyHandler), contexts);
+            for (vector<void*>::iterator cit = contexts.begin(); cit != contexts.end(); ++cit) {
+                bus->GetInternal().ReleaseSyncReplyContext(reinterpret_cast<BusAttachment::Internal::SyncReplyContext*>(*cit));
+            }
             bus->UnregisterAllHandlers(this);
+            if (components->cacheProperties && bus->IsConnected()) {
+                /*
+                 * Don't wait for the reply, the destructor must not block on the daemon.
+                 */
+                Message reply(*bus);
+                qcc::String rule = PropertiesChangedRule(path);
+                MsgArg arg("s", rule.c_str());
+                bus->GetDBusProxyObj().MethodCall(org::freedesktop::DBus::InterfaceName, "RemoveMatch", &arg, 1, reply, DefaultCallTimeout, ALLJOYN_FLAG_NO_REPLY_EXPECTED);
+            }
         }
 
         /* Wait for any waiting threads to exit this object's members */
@@ -1123,6 +1660,7 @@ ProxyBusObject::ProxyBusObject(const ProxyBusObject& other) :
     isSecure(other.isSecure)
 {
     *components = *other.components;
+    components->ResetPropertyCache();
 }
 
 ProxyBusObject& ProxyBusObject::operator=(const ProxyBusObject& other)
@@ -1132,6 +1670,7 @@ ProxyBusObject& ProxyBusObject::operator=(const ProxyBusObject& other)
         if (other.components) {
             components = new Components();
             *components = *other.components;
+            components->ResetPropertyCache();
             if (!lock) {
                 lock = new Mutex();
             }
@@ -20,6 +20,10 @@
 #include <qcc/platform.h>
 
 #include <assert.h>
+#include <string.h>
+#include <algorithm>
+#include <set>
+#include <vector>
 
 #include <qcc/Debug.h>
 #include <qcc/String.h>
@@ -52,6 +56,150 @@ namespace ajn {
 
 #define ENDPOINT_IS_DEAD_ALERTCODE  1
 
+/*
+ * Number of slots in the transmit ring. This must be a power of two so slot indices stay
+ * consistent when the 32 bit enqueue counter wraps.
+ */
+static const uint32_t MAX_TX_QUEUE_SIZE = 32;
+
+/* Longest time a sender blocked on a full transmit queue waits before checking again */
+static const uint32_t MAX_TX_WAIT_MS = 20 * 1000;
+
+/* Size of the receive read-ahead buffer. Larger reads go straight into the message buffer */
+static const size_t RX_BUF_SIZE = 16 * 1024;
+
+/*
+ * Maximum number of header compression rules a link can define in band
+ */
+static const size_t MAX_LINK_COMPRESSION_RULES = 256;
+
+/*
+ * RxSource reads ahead from the endpoint stream so that a single read from the socket can be
+ * parsed into as many messages as it contains. Bytes following the last complete message are
+ * kept for the next message. With read-ahead disabled, reads pass straight through to the
+ * stream once any buffered bytes have been consumed.
+ */
+class RxSource : public qcc::Source {
+  public:
+
+    RxSource(Source* source) : source(source), readAhead(false), drained(false), buf(NULL), pos(NULL), eod(NULL) { }
+
+    ~RxSource() { delete [] buf; }
+
+    /* Set the underlying source */
+    void SetSource(Source* source) { this->source = source; }
+
+    /* Enable or disable reading ahead */
+    void SetReadAhead(bool enable) { readAhead = enable; }
+
+    QStatus PullBytes(void* outBuf, size_t reqBytes, size_t& actualBytes, uint32_t timeout = Event::WAIT_FOREVER)
+    {
+        if (pos == eod) {
+            if (!readAhead || (reqBytes >= RX_BUF_SIZE)) {
+                return source->PullBytes(outBuf, reqBytes, actualBytes, timeout);
+            }
+            /*
+             * A short read means the socket was empty. Read callbacks are level triggered so
+             * a non-blocking read can report that there is nothing to read without asking.
+             */
+            if (drained && (timeout == 0)) {
+                drained = false;
+                actualBytes = 0;
+                return ER_TIMEOUT;
+            }
+            if (!buf) {
+                buf = new uint8_t[RX_BUF_SIZE];
+            }
+            size_t got = 0;
+            QStatus status = source->PullBytes(buf, RX_BUF_SIZE, got, timeout);
+            if (status != ER_OK) {
+                actualBytes = 0;
+                return status;
+            }
+            drained = (got < RX_BUF_SIZE);
+            pos = buf;
+            eod = buf + got;
+        }
+        actualBytes = (std::min)(reqBytes, static_cast<size_t>(eod - pos));
+        memcpy(outBuf, pos, actualBytes);
+        pos += actualBytes;
+        return ER_OK;
+    }
+
+    /*
+     * Read-ahead is disabled on connections that pass handles because handles arrive with the
+     * bytes they were sent with. Any bytes that were read ahead before that are consumed first
+     * and carry no handles.
+     */
+    QStatus PullBytesAndFds(void* outBuf, size_t reqBytes, size_t& actualBytes, SocketFd* fdList, size_t& numFds, uint32_t timeout = Event::WAIT_FOREVER)
+    {
+        if (pos == eod) {
+            return source->PullBytesAndFds(outBuf, reqBytes, actualBytes, fdList, numFds, timeout);
+        }
+        numFds = 0;
+        actualBytes = (std::min)(reqBytes, static_cast<size_t>(eod - pos));
+        memcpy(outBuf, pos, actualBytes);
+        pos += actualBytes;
+        return ER_OK;
+    }
+
+    /*
+     * Lines are only read during the authentication handshake. They are read a buffer at a
+     * time rather than a byte at a time and any bytes following the line are kept for the
+     * next read. A non-blocking read that finds no newline appends what it has read to
+     * outStr and returns ER_TIMEOUT so the caller can resume the line later.
+     */
+    QStatus GetLine(qcc::String& outStr, uint32_t timeout = Event::WAIT_FOREVER)
+    {
+        while (true) {
+            if (pos == eod) {
+                if (!buf) {
+                    buf = new uint8_t[RX_BUF_SIZE];
+                }
+                size_t got = 0;
+                QStatus status = source->PullBytes(buf, RX_BUF_SIZE, got, timeout);
+                if (status != ER_OK) {
+                    return status;
+                }
+                if (got == 0) {
+                    return ER_FAIL;
+                }
+                pos = buf;
+                eod = buf + got;
+            }
+            uint8_t* nl = static_cast<uint8_t*>(memchr(pos, '\n', eod - pos));
+            uint8_t* end = nl ? nl : eod;
+            for (uint8_t* p = pos; p < end; ++p) {
+                if (*p != '\r') {
+                    outStr.push_back(static_cast<char>(*p));
+                }
+            }
+            if (nl) {
+                pos = nl + 1;
+                return ER_OK;
+            }
+            pos = eod;
+            if (timeout == 0) {
+                return ER_TIMEOUT;
+            }
+        }
+    }
+
+    Event& GetSourceEvent() { return source->GetSourceEvent(); }
+
+  private:
+
+    RxSource(const RxSource& other);
+    RxSource& operator=(const RxSource& other);
+
+    Source* source;    /**< The endpoint stream */
+    bool readAhead;    /**< True if reading ahead is enabled */
+    bool drained;      /**< True if the last read from the stream did not fill the buffer */
+    uint8_t* buf;      /**< Read-ahead buffer */
+    uint8_t* pos;      /**< Next unconsumed byte in buf */
+    uint8_t* eod;      /**< End of data in buf */
+};
+
 class _RemoteEndpoint::Internal {
     friend class _RemoteEndpoint;
   public:
@@ -59,7 +207,19 @@ class _RemoteEndpoint::Internal {
     Internal(BusAttachment& bus, bool incoming, const qcc::String& connectSpec, Stream* stream, const char* threadName, bool isSocket) :
         bus(bus),
         stream(stream),
-        txQueue(),
+        rxSource(stream),
+        linkCompressionRules(MAX_LINK_COMPRESSION_RULES),
+        txQueue(MAX_TX_QUEUE_SIZE, Message(bus)),
+        emptySlot(txQueue[0]),
+        txTail(0),
+        txHead(0),
+        txCount(0),
+        txPending(0),
+        txWaiters(0),
+        txDrops(0),
+        txShared(0),
+        txCopies(0),
+        vectoredWrites(true),
         txWaitQueue(),
         lock(),
         exitCount(0),
@@ -82,20 +242,87 @@ class _RemoteEndpoint::Internal {
         hasRxSessionMsg(false),
         getNextMsg(true),
         currentWriteMsg(bus),
+        writeShared(false),
+        writeOffset(0),
         stopping(false),
-        sessionId(0)
+        sessionId(0),
+        pendingAuth(NULL),
+        ioDispatch(&bus.GetInternal().GetIODispatch())
     {
+        for (uint32_t i = 0; i < MAX_TX_QUEUE_SIZE; ++i) {
+            txReady[i] = 0;
+        }
     }
 
     ~Internal() {
     }
 
+    /*
+     * Reserve a slot in the transmit ring. Returns false if the queue is full.
+     */
+    bool ReserveTxSlot() {
+        if (IncrementAndFetch(&txCount) > static_cast<int32_t>(MAX_TX_QUEUE_SIZE)) {
+            DecrementAndFetch(&txCount);
+            return false;
+        }
+        return true;
+    }
+
+    /*
+     * Fill a previously reserved slot. Returns true if the queue was empty in which case the
+     * caller is responsible for enabling the write callback.
+     */
+    bool PublishTx(Message& msg) {
+        uint32_t slot = static_cast<uint32_t>(IncrementAndFetch(&txTail) - 1) & (MAX_TX_QUEUE_SIZE - 1);
+        txQueue[slot] = msg;
+        IncrementAndFetch(&txReady[slot]);
+        return IncrementAndFetch(&txPending) == 1;
+    }
+
+    /*
+     * Release the slot at the head of the ring. Only called by the consumer (WriteCallback).
+     */
+    void ReleaseTxSlot() {
+        uint32_t slot = txHead++ & (MAX_TX_QUEUE_SIZE - 1);
+        txQueue[slot] = emptySlot;
+        DecrementAndFetch(&txReady[slot]);
+        DecrementAndFetch(&txCount);
+        /* Wake the longest waiting sender if there is one */
+        if (txWaiters > 0) {
+            lock.Lock(MUTEX_CONTEXT);
+            if (!txWaitQueue.empty()) {
+                Thread* wakeMe = txWaitQueue.back();
+                txWaitQueue.pop_back();
+                DecrementAndFetch(&txWaiters);
+                QStatus status = wakeMe->Alert();
+                if (ER_OK != status) {
+                    QCC_LogError(status, ("Failed to alert thread blocked on full tx queue"));
+                }
+            }
+            lock.Unlock(MUTEX_CONTEXT);
+        }
+    }
+
     BusAttachment& bus;                      /**< Message bus associated with this endpoint */
     qcc::Stream* stream;                     /**< Stream for this endpoint or NULL if uninitialized */
-
-    std::deque<Message> txQueue;             /**< Transmit message queue */
+    RxSource rxSource;                       /**< Source that messages are read from */
+    _CompressionRules linkCompressionRules;  /**< Header compression rules defined in band by messages received on this link */
+    std::set<uint32_t> definedTokens;        /**< Compression tokens whose header fields have been sent in full on this link */
+
+    std::vector<Message> txQueue;            /**< Transmit ring filled by any number of senders and drained by WriteCallback */
+    Message emptySlot;                       /**< Placeholder message stored in free txQueue slots */
+    volatile int32_t txReady[MAX_TX_QUEUE_SIZE]; /**< Non-zero when the corresponding txQueue slot holds a message */
+    volatile int32_t txTail;                 /**< Enqueue counter (atomically incremented) */
+    uint32_t txHead;                         /**< Dequeue counter (only accessed by WriteCallback) */
+    volatile int32_t txCount;                /**< Number of reserved txQueue slots, bounded by MAX_TX_QUEUE_SIZE */
+    volatile int32_t txPending;              /**< Number of queued messages not yet taken by WriteCallback */
+    volatile int32_t txWaiters;              /**< Number of threads on txWaitQueue */
+    volatile int32_t txDrops;                /**< Number of messages dropped because their TTL expired before transmission */
+    volatile int32_t txShared;               /**< Number of messages transmitted from a shared buffer */
+    volatile int32_t txCopies;               /**< Number of messages copied before transmission */
+    bool vectoredWrites;                     /**< False if the endpoint does not implement PushBytesVectored */
     std::deque<qcc::Thread*> txWaitQueue;    /**< Threads waiting for txQueue to become not-full */
-    qcc::Mutex lock;                         /**< Mutex that protects the txQueue and timeout values */
+    qcc::Mutex lock;                         /**< Mutex that protects the txWaitQueue and timeout values */
     int32_t exitCount;                       /**< Number of sub-threads (rx and tx) that have exited (atomically incremented) */
 
     EndpointListener* listener;              /**< Listener for thread exit and untrusted client start and exit notifications. */
@@ -125,9 +352,13 @@ class _RemoteEndpoint::Internal {
     bool validateSender;                     /**< If true, the sender field on incomming messages will be overwritten with actual endpoint name */
     bool hasRxSessionMsg;                    /**< true iff this endpoint has previously processed a non-control message */
     bool getNextMsg;                         /**< If true, read the next message from the txQueue */
-    Message currentWriteMsg;                 /**< The message currently being read for this endpoint */
+    Message currentWriteMsg;                 /**< The message currently being written to this endpoint */
+    bool writeShared;                        /**< True if currentWriteMsg shares its buffer with other endpoints */
+    size_t writeOffset;                      /**< Number of bytes of a shared currentWriteMsg already written */
     bool stopping;                           /**< Is this EP stopping? */
     uint32_t sessionId;                      /**< SessionId for BusToBus endpoint. (not used for non-B2B endpoints) */
+    EndpointAuth* pendingAuth;               /**< Handshake driven by ContinueEstablish() */
+    IODispatch* ioDispatch;                  /**< The iodispatch shard the stream is registered with */
 };
 
 
@@ -136,6 +367,7 @@ void _RemoteEndpoint::SetStream(qcc::Stream* s)
 
     if (internal) {
         internal->stream = s;
+        internal->rxSource.SetSource(s);
     }
 }
 
@@ -168,6 +400,15 @@ const qcc::GUID128& _RemoteEndpoint::GetRemoteGUID() const
     }
 }
 
+qcc::Source& _RemoteEndpoint::GetSource()
+{
+    if (internal) {
+        return internal->rxSource;
+    } else {
+        return GetStream();
+    }
+}
+
 qcc::Stream& _RemoteEndpoint::GetStream()
 {
     if (internal) {
@@ -196,6 +437,33 @@ bool _RemoteEndpoint::IsIncomingConnection() const
     }
 }
 
+_CompressionRules* _RemoteEndpoint::GetLinkCompressionRules()
+{
+    return internal ? &internal->linkCompressionRules : NULL;
+}
+
+bool _RemoteEndpoint::DefineCompressionToken(const _Message& msg)
+{
+    uint32_t token = msg.GetCompressionToken();
+    if (!internal || !token || !(msg.msgHeader.flags & ALLJOYN_FLAG_COMPRESSED)) {
+        return false;
+    }
+    if ((msg.msgHeader.flags & ALLJOYN_FLAG_ENCRYPTED) && !msg.encrypt) {
+        return false;
+    }
+    bool define = false;
+    internal->lock.Lock(MUTEX_CONTEXT);
+    /*
+     * Once the limit is reached the peer asks for the expansions of any new tokens instead.
+     */
+    if ((internal->definedTokens.size() < MAX_LINK_COMPRESSION_RULES) && (internal->definedTokens.count(token) == 0)) {
+        internal->definedTokens.insert(token);
+        define = true;
+    }
+    internal->lock.Unlock(MUTEX_CONTEXT);
+    return define;
+}
+
 _RemoteEndpoint::Features&  _RemoteEndpoint::GetFeatures()
 {
     if (internal) {
@@ -228,17 +496,66 @@ QStatus _RemoteEndpoint::Establish(const qcc::String& authMechanisms, qcc::Strin
 
         status = auth.Establish(authMechanisms, authUsed, redirection, listener);
         if (status == ER_OK) {
-            internal->uniqueName = auth.GetUniqueName();
-            internal->remoteName = auth.GetRemoteName();
-            internal->remoteGUID = auth.GetRemoteGUID();
-            internal->features.protocolVersion = auth.GetRemoteProtocolVersion();
-            internal->features.trusted = (authUsed != "ANONYMOUS");
+            Established(auth, authUsed);
+        }
+    }
+    return status;
+}
 
+QStatus _RemoteEndpoint::StartEstablish(const qcc::String& authMechanisms, AuthListener* listener)
+{
+    if (!internal) {
+        return ER_BUS_NO_ENDPOINT;
+    }
+    if (internal->pendingAuth) {
+        return ER_BUS_ESTABLISH_FAILED;
+    }
+    RemoteEndpoint rep = RemoteEndpoint::wrap(this);
+    internal->pendingAuth = new EndpointAuth(internal->bus, rep, internal->incoming);
+    QStatus status = internal->pendingAuth->Begin(authMechanisms, listener);
+    if (status != ER_OK) {
+        AbortEstablish();
+    }
+    return status;
+}
+
+QStatus _RemoteEndpoint::ContinueEstablish(qcc::String& authUsed, qcc::String& redirection)
+{
+    if (!internal) {
+        return ER_BUS_NO_ENDPOINT;
+    }
+    if (!internal->pendingAuth) {
+        return ER_BUS_ESTABLISH_FAILED;
+    }
+    QStatus status = internal->pendingAuth->Continue(authUsed, redirection);
+    if (status != ER_WOULDBLOCK) {
+        if (status == ER_OK) {
+            Established(*internal->pendingAuth, authUsed);
         }
+        /* The pending auth holds a reference to this endpoint so it must not outlive the handshake */
+        AbortEstablish();
     }
     return status;
 }
 
+void _RemoteEndpoint::AbortEstablish()
+{
+    if (internal) {
+        EndpointAuth* auth = internal->pendingAuth;
+        internal->pendingAuth = NULL;
+        delete auth;
+    }
+}
+
+void _RemoteEndpoint::Established(const EndpointAuth& auth, const qcc::String& authUsed)
+{
+    internal->uniqueName = auth.GetUniqueName();
+    internal->remoteName = auth.GetRemoteName();
+    internal->remoteGUID = auth.GetRemoteGUID();
+    internal->features.protocolVersion = auth.GetRemoteProtocolVersion();
+    internal->features.trusted = (authUsed != "ANONYMOUS");
+}
+
 QStatus _RemoteEndpoint::SetLinkTimeout(uint32_t& idleTimeout)
 {
     if (internal) {
@@ -290,7 +607,7 @@ QStatus _RemoteEndpoint::SetLinkTimeout(uint32_t idleTimeout, uint32_t probeTime
         internal->idleTimeout = idleTimeout;
         internal->probeTimeout = probeTimeout;
         internal->maxIdleProbes = maxIdleProbes;
-        IODispatch& iodispatch = internal->bus.GetInternal().GetIODispatch();
+        IODispatch& iodispatch = *internal->ioDispatch;
         uint32_t timeout = (internal->idleTimeoutCount == 0) ? internal->idleTimeout : internal->probeTimeout;
 
         QStatus status = iodispatch.EnableTimeoutCallback(internal->stream, timeout);
@@ -311,7 +628,10 @@ QStatus _RemoteEndpoint::Start()
     QStatus status;
     internal->started = true;
     Router& router = internal->bus.GetInternal().GetRouter();
-    IODispatch& iodispatch = internal->bus.GetInternal().GetIODispatch();
+
+    /* The endpoint stays on this iodispatch shard until it is stopped so its callbacks are ordered */
+    internal->ioDispatch = &internal->bus.GetInternal().AssignIODispatch();
+    IODispatch& iodispatch = *internal->ioDispatch;
 
     if (internal->features.isBusToBus) {
         endpointType = ENDPOINT_TYPE_BUS2BUS;
@@ -319,6 +639,9 @@ QStatus _RemoteEndpoint::Start()
     /* Set the send timeout for this endpoint */
     internal->stream->SetSendTimeout(0);
 
+    /* Handles must be read together with the bytes that carry them so they disable read-ahead */
+    internal->rxSource.SetReadAhead(!internal->features.handlePassing && !internal->armRxPause);
+
     /* Endpoint needs to be wrapped before we can use it */
     RemoteEndpoint me = RemoteEndpoint::wrap(this);
 
@@ -364,7 +687,7 @@ QStatus _RemoteEndpoint::Stop(void)
      * its ultimate demise.
      */
     if (internal->started) {
-        ret = internal->bus.GetInternal().GetIODispatch().StopStream(internal->stream);
+        ret = internal->ioDispatch->StopStream(internal->stream);
 
     }
     internal->stopping = true;
@@ -386,18 +709,14 @@ QStatus _RemoteEndpoint::StopAfterTxEmpty(uint32_t maxWaitMs)
     }
 
     /* Wait for txqueue to empty before triggering stop */
-    internal->lock.Lock(MUTEX_CONTEXT);
     while (true) {
-        if (internal->txQueue.empty() || (maxWaitMs && (qcc::GetTimestamp() > (startTime + maxWaitMs)))) {
+        if ((internal->txCount == 0) || (maxWaitMs && (qcc::GetTimestamp() > (startTime + maxWaitMs)))) {
             status = Stop();
             break;
         } else {
-            internal->lock.Unlock(MUTEX_CONTEXT);
             qcc::Sleep(5);
-            internal->lock.Lock(MUTEX_CONTEXT);
         }
     }
-    internal->lock.Unlock(MUTEX_CONTEXT);
     return status;
 }
 
@@ -405,6 +724,8 @@ QStatus _RemoteEndpoint::PauseAfterRxReply()
 {
 
     if (internal) {
+        /* Don't read beyond the reply since the stream may be handed over after it */
+        internal->rxSource.SetReadAhead(false);
         internal->armRxPause = true;
         return ER_OK;
     } else {
@@ -437,6 +758,7 @@ void _RemoteEndpoint::ThreadExit(Thread* thread)
     if (it != internal->txWaitQueue.end()) {
         (*it)->RemoveAuxListener(this);
         internal->txWaitQueue.erase(it);
+        DecrementAndFetch(&internal->txWaiters);
     }
     internal->lock.Unlock(MUTEX_CONTEXT);
 
@@ -617,7 +939,7 @@ QStatus _RemoteEndpoint::ReadCallback(qcc::Source& source, bool isTimedOut)
                 /* Check pause condition. Block until stopped */
                 if (internal->armRxPause && internal->started && (msg->GetType() == MESSAGE_METHOD_RET)) {
                     status = ER_BUS_ENDPOINT_CLOSING;
-                    internal->bus.GetInternal().GetIODispatch().DisableReadCallback(internal->stream);
+                    internal->ioDispatch->DisableReadCallback(internal->stream);
                     return ER_OK;
                 }
                 if (status == ER_OK) {
@@ -627,7 +949,7 @@ QStatus _RemoteEndpoint::ReadCallback(qcc::Source& source, bool isTimedOut)
         }
         if (status == ER_TIMEOUT) {
             internal->lock.Lock(MUTEX_CONTEXT);
-            internal->bus.GetInternal().GetIODispatch().EnableReadCallback(internal->stream, internal->idleTimeout);
+            internal->ioDispatch->EnableReadCallback(internal->stream, internal->idleTimeout);
             internal->lock.Unlock(MUTEX_CONTEXT);
         } else {
 
@@ -640,7 +962,7 @@ QStatus _RemoteEndpoint::ReadCallback(qcc::Source& source, bool isTimedOut)
             }
             Invalidate();
             internal->stopping = true;
-            internal->bus.GetInternal().GetIODispatch().StopStream(internal->stream);
+            internal->ioDispatch->StopStream(internal->stream);
         }
     } else {
         /* This is a timeout alarm, try to send a probe message if maximum idle
@@ -655,7 +977,7 @@ QStatus _RemoteEndpoint::ReadCallback(qcc::Source& source, bool isTimedOut)
             QCC_DbgPrintf(("%s: Sent ProbeReq (%s)\n", GetUniqueName().c_str(), QCC_StatusText(status)));
             internal->lock.Lock(MUTEX_CONTEXT);
             uint32_t timeout = (internal->idleTimeoutCount == 0) ? internal->idleTimeout : internal->probeTimeout;
-            internal->bus.GetInternal().GetIODispatch().EnableReadCallback(internal->stream, timeout);
+            internal->ioDispatch->EnableReadCallback(internal->stream, timeout);
             internal->lock.Unlock(MUTEX_CONTEXT);
         } else {
             QCC_DbgPrintf(("%s: Maximum number of idle probe (%d) attempts reached", GetUniqueName().c_str(), internal->maxIdleProbes));
@@ -668,7 +990,7 @@ QStatus _RemoteEndpoint::ReadCallback(qcc::Source& source, bool isTimedOut)
             status = ER_BUS_ENDPOINT_CLOSING;
             Invalidate();
             internal->stopping = true;
-            internal->bus.GetInternal().GetIODispatch().StopStream(internal->stream);
+            internal->ioDispatch->StopStream(internal->stream);
         }
     }
     return status;
@@ -689,31 +1011,71 @@ QStatus _RemoteEndpoint::WriteCallback(qcc::Sink& sink, bool isTimedOut) {
     QStatus status = ER_OK;
     while (status == ER_OK) {
         if (internal->getNextMsg) {
-            internal->lock.Lock(MUTEX_CONTEXT);
-            if (!internal->txQueue.empty()) {
-                /* Make a deep copy of the message since there is state information inside the message.
-                 * Each copy of the message could be in different write state.
-                 */
-                internal->currentWriteMsg = Message(internal->txQueue.back(), true);
-
-                /* Alert next thread on wait queue */
-                if (0 < internal->txWaitQueue.size()) {
-                    Thread* wakeMe = internal->txWaitQueue.back();
-                    internal->txWaitQueue.pop_back();
-                    status = wakeMe->Alert();
-                    if (ER_OK != status) {
-                        QCC_LogError(status, ("Failed to alert thread blocked on full tx queue"));
-                    }
+            uint32_t slot = internal->txHead & (MAX_TX_QUEUE_SIZE - 1);
+            if (internal->txReady[slot]) {
+                /* Taking the message is a full barrier so the slot contents are visible */
+                DecrementAndFetch(&internal->txPending);
+                Message& msg = internal->txQueue[slot];
+                /* Expired messages are dropped here rather than searched for by senders */
+                if (msg->IsExpired()) {
+                    QCC_DbgPrintf(("Dropping expired message (serial=%u) to %s", msg->GetCallSerial(), GetUniqueName().c_str()));
+                    IncrementAndFetch(&internal->txDrops);
+                    internal->ReleaseTxSlot();
+                    continue;
+                }
+                if (IsShareable(*msg)) {
+                    /*
+                     * The write state is kept here rather than in the message so the same buffer
+                     * can be written to any number of endpoints without being copied.
+                     */
+                    internal->currentWriteMsg = msg;
+                    internal->writeShared = true;
+                    internal->writeOffset = 0;
+                    IncrementAndFetch(&internal->txShared);
+                } else {
+                    /* Make a deep copy of the message since there is state information inside the message.
+                     * Each copy of the message could be in different write state.
+                     */
+                    internal->currentWriteMsg = Message(msg, true);
+                    internal->writeShared = false;
+                    IncrementAndFetch(&internal->txCopies);
                 }
                 internal->getNextMsg = false;
-                internal->lock.Unlock(MUTEX_CONTEXT);
+            } else if (internal->txPending > 0) {
+                /*
+                 * A sender has reserved the head slot but not filled it yet. Other messages
+                 * are queued behind it so come back as soon as possible.
+                 */
+                internal->ioDispatch->EnableWriteCallbackNow(internal->stream);
+                return ER_OK;
             } else {
-
-                internal->bus.GetInternal().GetIODispatch().DisableWriteCallback(internal->stream);
-                internal->lock.Unlock(MUTEX_CONTEXT);
+                internal->ioDispatch->DisableWriteCallback(internal->stream);
+                /*
+                 * A sender that found the queue empty enables the write callback after queuing
+                 * its message so check again in case that happened before the disable.
+                 */
+                if (internal->txPending > 0) {
+                    continue;
+                }
                 return ER_OK;
             }
         }
+        if (internal->writeShared) {
+            /* Coalesce the current message and any messages queued behind it into one write */
+            if (internal->vectoredWrites) {
+                status = WriteBatch();
+                if (status != ER_NOT_IMPLEMENTED) {
+                    continue;
+                }
+                internal->vectoredWrites = false;
+            }
+            status = WriteShared();
+            if (status == ER_OK) {
+                internal->ReleaseTxSlot();
+                internal->getNextMsg = true;
+            }
+            continue;
+        }
         /* Deliver message */
         RemoteEndpoint rep = RemoteEndpoint::wrap(this);
         status = internal->currentWriteMsg->DeliverNonBlocking(rep);
@@ -729,17 +1091,15 @@ QStatus _RemoteEndpoint::WriteCallback(qcc::Sink& sink, bool isTimedOut) {
         if (status == ER_OK) {
             /* Message has been successfully delivered. i.e. PushBytes is complete
              */
-            internal->lock.Lock(MUTEX_CONTEXT);
-            internal->txQueue.pop_back();
+            internal->ReleaseTxSlot();
             internal->getNextMsg = true;
-            internal->lock.Unlock(MUTEX_CONTEXT);
         }
     }
 
     if (status == ER_TIMEOUT) {
         /* Timed-out in the middle of a message write. */
         internal->lock.Lock(MUTEX_CONTEXT);
-        internal->bus.GetInternal().GetIODispatch().EnableWriteCallback(internal->stream);
+        internal->ioDispatch->EnableWriteCallback(internal->stream);
         internal->lock.Unlock(MUTEX_CONTEXT);
     } else if (status != ER_OK) {
         /* On an unexpected disconnect save the status that cause the thread exit */
@@ -752,7 +1112,112 @@ QStatus _RemoteEndpoint::WriteCallback(qcc::Sink& sink, bool isTimedOut) {
 
         Invalidate();
         internal->stopping = true;
-        internal->bus.GetInternal().GetIODispatch().StopStream(internal->stream);
+        internal->ioDispatch->StopStream(internal->stream);
+    }
+    return status;
+}
+
+bool _RemoteEndpoint::IsShareable(const _Message& msg)
+{
+    return !msg.handles && !msg.encrypt && !(msg.msgHeader.flags & ALLJOYN_FLAG_ENCRYPTED);
+}
+
+QStatus _RemoteEndpoint::WriteShared()
+{
+    const _Message& msg = *(internal->currentWriteMsg);
+    const uint8_t* buf = reinterpret_cast<const uint8_t*>(msg.msgBuf);
+    size_t len = msg.bufEOD - buf;
+    if (len == 0) {
+        QStatus status = ER_BUS_EMPTY_MESSAGE;
+        QCC_LogError(status, ("Message is empty"));
+        return status;
+    }
+    Sink& sink = GetSink();
+    QStatus status = ER_OK;
+    while ((status == ER_OK) && (internal->writeOffset < len)) {
+        size_t pushed = 0;
+        if (internal->writeOffset == 0) {
+            uint32_t ttl = (msg.msgHeader.flags & ALLJOYN_FLAG_SESSIONLESS) ? (msg.ttl * 1000) : msg.ttl;
+            status = sink.PushBytes(buf, len, pushed, ttl);
+        } else {
+            status = sink.PushBytes(buf + internal->writeOffset, len - internal->writeOffset, pushed);
+        }
+        if (status == ER_OK) {
+            internal->writeOffset += pushed;
+        }
+    }
+    return status;
+}
+
+QStatus _RemoteEndpoint::WriteBatch()
+{
+    const _Message& curMsg = *(internal->currentWriteMsg);
+    const uint8_t* curBuf = reinterpret_cast<const uint8_t*>(curMsg.msgBuf);
+    if (curMsg.bufEOD == curBuf) {
+        QStatus status = ER_BUS_EMPTY_MESSAGE;
+        QCC_LogError(status, ("Message is empty"));
+        return status;
+    }
+    TxBuffer bufs[MAX_TX_QUEUE_SIZE];
+    bufs[0].buf = curBuf + internal->writeOffset;
+    bufs[0].len = (curMsg.bufEOD - curBuf) - internal->writeOffset;
+    size_t numBufs = 1;
+    /*
+     * Messages queued behind the current one are written straight from the queued message
+     * since nothing in them needs to be modified. Stop at the first message that needs
+     * special handling, it will be delivered on its own when it reaches the head of the queue.
+     */
+    while (numBufs < MAX_TX_QUEUE_SIZE) {
+        uint32_t slot = (internal->txHead + numBufs) & (MAX_TX_QUEUE_SIZE - 1);
+        if (!internal->txReady[slot]) {
+            break;
+        }
+        DecrementAndFetch(&internal->txPending);
+        const _Message& msg = *(internal->txQueue[slot]);
+        const uint8_t* buf = reinterpret_cast<const uint8_t*>(msg.msgBuf);
+        if (!IsShareable(msg) || (msg.bufEOD == buf) || msg.IsExpired()) {
+            IncrementAndFetch(&internal->txPending);
+            break;
+        }
+        bufs[numBufs].buf = buf;
+        bufs[numBufs].len = msg.bufEOD - buf;
+        ++numBufs;
+    }
+
+    size_t pushed = 0;
+    QStatus status = PushBytesVectored(bufs, numBufs, pushed);
+    if (status != ER_OK) {
+        pushed = 0;
+    }
+    QCC_DbgPrintf(("Wrote %u bytes of %u messages to %s", static_cast<uint32_t>(pushed), static_cast<uint32_t>(numBufs), GetUniqueName().c_str()));
+
+    /* Release the messages that were completely written */
+    if (pushed >= bufs[0].len) {
+        pushed -= bufs[0].len;
+        internal->ReleaseTxSlot();
+        internal->getNextMsg = true;
+    } else {
+        internal->writeOffset += pushed;
+        pushed = 0;
+    }
+    for (size_t i = 1; i < numBufs; ++i) {
+        if (pushed >= bufs[i].len) {
+            pushed -= bufs[i].len;
+            IncrementAndFetch(&internal->txShared);
+            internal->ReleaseTxSlot();
+        } else if (pushed > 0) {
+            /* A partially written message becomes the current message */
+            uint32_t slot = internal->txHead & (MAX_TX_QUEUE_SIZE - 1);
+            internal->currentWriteMsg = internal->txQueue[slot];
+            internal->writeShared = true;
+            internal->writeOffset = pushed;
+            internal->getNextMsg = false;
+            IncrementAndFetch(&internal->txShared);
+            pushed = 0;
+        } else {
+            /* Not written, it will be taken from the queue again */
+            IncrementAndFetch(&internal->txPending);
+        }
     }
     return status;
 }
@@ -760,7 +1225,6 @@ QStatus _RemoteEndpoint::WriteCallback(qcc::Sink& sink, bool isTimedOut) {
 QStatus _RemoteEndpoint::PushMessage(Message& msg)
 {
     QCC_DbgTrace(("RemoteEndpoint::PushMessage %s (serial=%d)", GetUniqueName().c_str(), msg->GetCallSerial()));
-    static const size_t MAX_TX_QUEUE_SIZE = 30;
 
     QStatus status = ER_OK;
 
@@ -779,79 +1243,82 @@ QStatus _RemoteEndpoint::PushMessage(Message& msg)
     if (internal->stopping) {
         return ER_BUS_ENDPOINT_CLOSING;
     }
-    internal->lock.Lock(MUTEX_CONTEXT);
-    size_t count = internal->txQueue.size();
-    bool wasEmpty = (count == 0);
-    if (MAX_TX_QUEUE_SIZE > count) {
-        internal->txQueue.push_front(msg);
-    } else {
-        while (true) {
-            /* Remove a queue entry whose TTLs is expired if possible */
-            deque<Message>::iterator it = internal->txQueue.begin();
-            uint32_t maxWait = 20 * 1000;
-            while (it != internal->txQueue.end()) {
-                uint32_t expMs;
-                if ((*it)->IsExpired(&expMs)) {
-                    internal->txQueue.erase(it);
-                    break;
-                } else {
-                    ++it;
-                }
-                maxWait = (std::min)(maxWait, expMs);
-            }
-            if (internal->txQueue.size() < MAX_TX_QUEUE_SIZE) {
-                /* Check queue wasn't drained while we were waiting */
-                if (internal->txQueue.size() == 0) {
-                    wasEmpty = true;
-                }
-                internal->txQueue.push_front(msg);
-                status = ER_OK;
-                break;
-            } else {
-                /* This thread will have to wait for room in the queue */
-                Thread* thread = Thread::GetThread();
-                assert(thread);
-
-                thread->AddAuxListener(this);
-                internal->txWaitQueue.push_front(thread);
-                internal->lock.Unlock(MUTEX_CONTEXT);
-                status = Event::Wait(Event::neverSet, maxWait);
-                internal->lock.Lock(MUTEX_CONTEXT);
-
-                /* Reset alert status */
-                if (ER_ALERTED_THREAD == status) {
-                    if (thread->GetAlertCode() == ENDPOINT_IS_DEAD_ALERTCODE) {
-                        status = ER_BUS_ENDPOINT_CLOSING;
-                    }
-                    thread->GetStopEvent().ResetEvent();
-                }
-                /* Remove thread from wait queue. */
-                thread->RemoveAuxListener(this);
-                deque<Thread*>::iterator eit = find(internal->txWaitQueue.begin(), internal->txWaitQueue.end(), thread);
-                if (eit != internal->txWaitQueue.end()) {
-                    internal->txWaitQueue.erase(eit);
-                }
+    /*
+     * The first time a compression token is sent on this link the header goes out in full with
+     * the token so the peer learns the expansion from the message instead of asking for it. The
+     * message may be sent on other links so the header is expanded in a copy.
+     */
+    if (DefineCompressionToken(*msg)) {
+        Message defineMsg(msg, true);
+        status = defineMsg->UncompressHeader();
+        if (status == ER_OK) {
+            return PushMessage(defineMsg);
+        }
+        QCC_LogError(status, ("Failed to define compression token %u", msg->GetCompressionToken()));
+        status = ER_OK;
+    }
+    bool reserved = internal->ReserveTxSlot();
+    while (!reserved) {
+        /* Don't wait for room for a message that has already expired */
+        uint32_t maxWait;
+        if (msg->IsExpired(&maxWait)) {
+            QCC_DbgPrintf(("Dropping expired message (serial=%u) to %s", msg->GetCallSerial(), GetUniqueName().c_str()));
+            IncrementAndFetch(&internal->txDrops);
+            return ER_OK;
+        }
+        maxWait = (std::min)(maxWait, MAX_TX_WAIT_MS);
 
-                if ((ER_OK != status) && (ER_ALERTED_THREAD != status) && (ER_TIMEOUT != status)) {
-                    break;
-                }
+        /* This thread will have to wait for room in the queue */
+        Thread* thread = Thread::GetThread();
+        assert(thread);
+
+        internal->lock.Lock(MUTEX_CONTEXT);
+        thread->AddAuxListener(this);
+        internal->txWaitQueue.push_front(thread);
+        IncrementAndFetch(&internal->txWaiters);
+        /* The queue may have drained before WriteCallback could see this thread waiting */
+        reserved = internal->ReserveTxSlot();
+        if (!reserved) {
+            internal->lock.Unlock(MUTEX_CONTEXT);
+            status = Event::Wait(Event::neverSet, maxWait);
+            internal->lock.Lock(MUTEX_CONTEXT);
 
+            /* Reset alert status */
+            if (ER_ALERTED_THREAD == status) {
+                if (thread->GetAlertCode() == ENDPOINT_IS_DEAD_ALERTCODE) {
+                    status = ER_BUS_ENDPOINT_CLOSING;
+                }
+                thread->GetStopEvent().ResetEvent();
             }
         }
-    }
+        /* Remove thread from wait queue. */
+        thread->RemoveAuxListener(this);
+        deque<Thread*>::iterator eit = find(internal->txWaitQueue.begin(), internal->txWaitQueue.end(), thread);
+        if (eit != internal->txWaitQueue.end()) {
+            internal->txWaitQueue.erase(eit);
+            DecrementAndFetch(&internal->txWaiters);
+        }
+        internal->lock.Unlock(MUTEX_CONTEXT);
 
+        if ((ER_OK != status) && (ER_ALERTED_THREAD != status) && (ER_TIMEOUT != status)) {
+            return status;
+        }
+        status = ER_OK;
+        if (!reserved) {
+            reserved = internal->ReserveTxSlot();
+        }
+    }
 
-    if (wasEmpty) {
-        internal->bus.GetInternal().GetIODispatch().EnableWriteCallbackNow(internal->stream);
+    if (internal->PublishTx(msg)) {
+        internal->ioDispatch->EnableWriteCallbackNow(internal->stream);
     }
-    internal->lock.Unlock(MUTEX_CONTEXT);
 #ifndef NDEBUG
 #undef QCC_MODULE
 #define QCC_MODULE "TXSTATS"
     static uint32_t lastTime = 0;
     uint32_t now = GetTimestamp();
     if ((now - lastTime) > 1000) {
-        QCC_DbgPrintf(("Tx queue size (%s) = %d", GetUniqueName().c_str(), count));
+        QCC_DbgPrintf(("Tx queue size (%s) = %d, dropped = %d, shared = %d, copied = %d", GetUniqueName().c_str(), internal->txCount, internal->txDrops, internal->txShared, internal->txCopies));
         lastTime = now;
     }
 #undef QCC_MODULE
@@ -860,6 +1327,42 @@ QStatus _RemoteEndpoint::PushMessage(Message& msg)
     return status;
 }
 
+size_t _RemoteEndpoint::GetTxQueueDepth() const
+{
+    if (internal) {
+        return (std::min)(static_cast<uint32_t>(internal->txCount), MAX_TX_QUEUE_SIZE);
+    } else {
+        return 0;
+    }
+}
+
+uint32_t _RemoteEndpoint::GetTxDropCount() const
+{
+    if (internal) {
+        return static_cast<uint32_t>(internal->txDrops);
+    } else {
+        return 0;
+    }
+}
+
+uint32_t _RemoteEndpoint::GetTxSharedCount() const
+{
+    if (internal) {
+        return static_cast<uint32_t>(internal->txShared);
+    } else {
+        return 0;
+    }
+}
+
+uint32_t _RemoteEndpoint::GetTxCopyCount() const
+{
+    if (internal) {
+        return static_cast<uint32_t>(internal->txCopies);
+    } else {
+        return 0;
+    }
+}
+
 void _RemoteEndpoint::IncrementRef()
 {
     int refs = IncrementAndFetch(&internal->refCount);
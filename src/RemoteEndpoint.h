@@ -40,6 +40,8 @@
 namespace ajn {
 
 class _RemoteEndpoint;
+class _CompressionRules;
+class EndpointAuth;
 
 /**
  * Managed object type that wraps a remote endpoint
@@ -270,6 +272,41 @@ class _RemoteEndpoint : public _BusEndpoint, public qcc::ThreadListener, public
      */
     QStatus Establish(const qcc::String& authMechanisms, qcc::String& authUsed, qcc::String& redirection, AuthListener* listener = NULL);
 
+    /**
+     * Start establishing an incoming connection without blocking. The caller drives the handshake
+     * by calling ContinueEstablish() each time the endpoint source has data to read.
+     *
+     * @param authMechanisms  The authentication mechanism(s) to accept.
+     * @param listener        Optional authentication listener
+     *
+     * @return
+     *      - ER_OK if the handshake was started.
+     *      - An error status otherwise
+     */
+    QStatus StartEstablish(const qcc::String& authMechanisms, AuthListener* listener = NULL);
+
+    /**
+     * Advance a handshake started by StartEstablish() as far as the data already received allows.
+     * The handshake is over when any status other than ER_WOULDBLOCK is returned.
+     *
+     * @param authUsed        [OUT]    Returns the name of the authentication method
+     *                                 that was used to establish the connection.
+     * @param redirection     [OUT}    Returns a redirection address for the endpoint. This value
+     *                                 is only meaninful if the return status is ER_BUS_ENDPOINT_REDIRECT.
+     *
+     * @return
+     *      - ER_OK if the connection has been established.
+     *      - ER_WOULDBLOCK if the handshake is waiting for data from the remote side.
+     *      = ER_BUS_ENDPOINT_REDIRECT if the endpoint is being redirected.
+     *      - An error status otherwise
+     */
+    QStatus ContinueEstablish(qcc::String& authUsed, qcc::String& redirection);
+
+    /**
+     * Abandon a handshake started by StartEstablish() that has not finished.
+     */
+    void AbortEstablish();
+
     /**
      * Get the GUID of the remote side of a bus-to-bus endpoint.
      *
@@ -300,11 +337,12 @@ class _RemoteEndpoint : public _BusEndpoint, public qcc::ThreadListener, public
 
     bool IsTrusted() { return GetFeatures().trusted; }
     /**
-     * Get the data source for this endpoint
+     * Get the data source for this endpoint. Once the endpoint has been started this source
+     * reads ahead from the stream so several messages can be parsed from a single read.
      *
      * @return  The data source for this endpoint.
      */
-    qcc::Source& GetSource() { return GetStream(); }
+    qcc::Source& GetSource();
 
     /**
      * Get the data sink for this endpoint
@@ -343,6 +381,26 @@ class _RemoteEndpoint : public _BusEndpoint, public qcc::ThreadListener, public
      */
     const Features& GetFeatures() const;
 
+    /**
+     * Get the header compression rules that were defined in band by messages received on this
+     * endpoint. These are only used to expand messages received on this endpoint.
+     *
+     * @return   The compression rules for this link or NULL if the endpoint is not initialized.
+     */
+    _CompressionRules* GetLinkCompressionRules();
+
+    /**
+     * Check if a message with a compressed header must be sent with its header in full because
+     * its compression token has not been sent on this link yet. The token is recorded as sent.
+     * Only messages that were compressed by this bus attachment and that are not yet encrypted
+     * can be sent in full.
+     *
+     * @param msg   The message that is about to be sent on this link.
+     *
+     * @return  true if the message should be sent with its header in full.
+     */
+    bool DefineCompressionToken(const _Message& msg);
+
     /**
      * Increment the reference count for this remote endpoint.
      * RemoteEndpoints are stopped when the number of references reaches zero.
@@ -380,6 +438,38 @@ class _RemoteEndpoint : public _BusEndpoint, public qcc::ThreadListener, public
      */
     bool IsSessionRouteSetUp();
 
+    /**
+     * Get the number of messages currently queued for transmission on this endpoint.
+     *
+     * @return  The transmit queue depth.
+     */
+    size_t GetTxQueueDepth() const;
+
+    /**
+     * Get the number of messages that were discarded without being transmitted because their
+     * time-to-live expired while they were queued or waiting for room in the queue.
+     *
+     * @return  The number of dropped messages.
+     */
+    uint32_t GetTxDropCount() const;
+
+    /**
+     * Get the number of messages that were written straight from the buffer they were received
+     * or marshaled into. These buffers are shared with every other endpoint the message is
+     * routed to.
+     *
+     * @return  The number of messages transmitted without copying.
+     */
+    uint32_t GetTxSharedCount() const;
+
+    /**
+     * Get the number of messages that had to be copied before they could be transmitted
+     * because transmitting them modifies the message (encryption or handle passing).
+     *
+     * @return  The number of messages copied for transmission.
+     */
+    uint32_t GetTxCopyCount() const;
+
     /**
      * Get the IP address of the remote end.
      * @param ipAddr [OUT] The IP address of the remote end.
@@ -389,6 +479,30 @@ class _RemoteEndpoint : public _BusEndpoint, public qcc::ThreadListener, public
 
   protected:
 
+    /**
+     * A buffer to be written by PushBytesVectored.
+     */
+    struct TxBuffer {
+        const uint8_t* buf;   /**< Start of the data */
+        size_t len;           /**< Number of bytes */
+    };
+
+    /**
+     * Write several buffers to the stream with a single operation. Endpoints whose stream
+     * supports gather writes override this so that WriteCallback can send all the messages
+     * that are waiting in the transmit queue at once. Writes must not block.
+     *
+     * @param bufs      Buffers to write in order.
+     * @param numBufs   Number of buffers.
+     * @param pushed    [OUT] Number of bytes written. This may be less than the total length.
+     * @return
+     *      - ER_OK if some bytes were written.
+     *      - ER_TIMEOUT if the write would block.
+     *      - ER_NOT_IMPLEMENTED if the endpoint does not support gather writes.
+     *      - An error status otherwise
+     */
+    virtual QStatus PushBytesVectored(const TxBuffer* bufs, size_t numBufs, size_t& pushed) { return ER_NOT_IMPLEMENTED; }
+
     /**
      * Set link timeout params (with knowledge of the underlying transport characteristics)
      *
@@ -404,6 +518,11 @@ class _RemoteEndpoint : public _BusEndpoint, public qcc::ThreadListener, public
     class Internal;
     Internal* internal; /* All the internal state for a remote endpoint */
 
+    /**
+     * Record the results of a successful authentication.
+     */
+    void Established(const EndpointAuth& auth, const qcc::String& authUsed);
+
     /**
      * Copy constructor is undefined.
      */
@@ -461,6 +580,39 @@ class _RemoteEndpoint : public _BusEndpoint, public qcc::ThreadListener, public
      */
     QStatus WriteCallback(qcc::Sink& sink, bool isTimedOut);
 
+    /**
+     * Write the current message together with the messages queued behind it using
+     * PushBytesVectored. Called from WriteCallback.
+     *
+     * @return
+     *      - ER_OK if some bytes were written.
+     *      - ER_TIMEOUT if the write would block.
+     *      - ER_NOT_IMPLEMENTED if the endpoint does not support gather writes.
+     *      - An error status otherwise
+     */
+    QStatus WriteBatch();
+
+    /**
+     * Write the remainder of a current message that shares its buffer with the sender.
+     * Called from WriteCallback.
+     *
+     * @return
+     *      - ER_OK if the message was completely written.
+     *      - ER_TIMEOUT if the write would block.
+     *      - An error status otherwise
+     */
+    QStatus WriteShared();
+
+    /**
+     * Determine if a message can be transmitted from its own buffer. Transmitting a message that
+     * must be encrypted, carries handles or is decrypted in place when it is unmarshaled
+     * requires a private copy.
+     *
+     * @param msg   Message to examine.
+     * @return  true if the message buffer can be shared.
+     */
+    static bool IsShareable(const _Message& msg);
+
     /**
      * Internal callback used to indicate that the Stream for this endpoint has been removed
      * from the IODispatch.
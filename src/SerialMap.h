@@ -0,0 +1,216 @@
+#ifndef _ALLJOYN_SERIALMAP_H
+#define _ALLJOYN_SERIALMAP_H
+/**
+ * @file
+ *
+ * This file defines an open addressed hash table keyed by message serial number.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#ifndef __cplusplus
+#error Only include SerialMap.h in C++ code.
+#endif
+
+#include <qcc/platform.h>
+
+#include <vector>
+
+namespace ajn {
+
+/**
+ * Maps message serial numbers to values stored in place in an open addressed table with linear
+ * probing. Serial numbers are allocated sequentially so the low bits of the serial number are used
+ * as the hash. Inserting and removing values does not allocate memory unless the table has to
+ * grow. The table is not thread safe.
+ *
+ * Pointers returned by Find() and At() are invalidated by Insert().
+ */
+template <typename T>
+class SerialMap {
+  public:
+
+    /**
+     * Constructor
+     *
+     * @param capacity  Initial number of slots, must be a power of 2.
+     */
+    SerialMap(size_t capacity = 64) : slots(capacity), used(0), deleted(0) { }
+
+    /**
+     * Find the value for a serial number.
+     *
+     * @param serial  The serial number.
+     *
+     * @return  The value or NULL if there is no value for the serial number.
+     */
+    T* Find(uint32_t serial)
+    {
+        size_t index = Probe(serial);
+        return (index == NOT_FOUND) ? NULL : &slots[index].value;
+    }
+
+    /**
+     * Insert or replace the value for a serial number.
+     *
+     * @param serial  The serial number.
+     * @param value   The value to store.
+     */
+    void Insert(uint32_t serial, const T& value)
+    {
+        size_t index = Probe(serial);
+        if (index == NOT_FOUND) {
+            if (((used + deleted + 1) * 4) > (slots.size() * 3)) {
+                /* Grow if the table is at least half full otherwise just clear out the deleted slots */
+                Rehash(((used + 1) * 2 > slots.size()) ? slots.size() * 2 : slots.size());
+            }
+            const size_t mask = slots.size() - 1;
+            index = serial & mask;
+            while (slots[index].state == USED) {
+                index = (index + 1) & mask;
+            }
+            if (slots[index].state == DELETED) {
+                --deleted;
+            }
+            slots[index].state = USED;
+            slots[index].serial = serial;
+            ++used;
+        }
+        slots[index].value = value;
+    }
+
+    /**
+     * Remove the value for a serial number.
+     *
+     * @param serial  The serial number.
+     * @param value   [OUT] If not NULL returns a copy of the value that was removed.
+     *
+     * @return  true if there was a value for the serial number.
+     */
+    bool Remove(uint32_t serial, T* value = NULL)
+    {
+        size_t index = Probe(serial);
+        if (index == NOT_FOUND) {
+            return false;
+        }
+        if (value) {
+            *value = slots[index].value;
+        }
+        slots[index].state = DELETED;
+        slots[index].value = T();
+        --used;
+        ++deleted;
+        return true;
+    }
+
+    /**
+     * Remove all values.
+     */
+    void Clear()
+    {
+        for (size_t i = 0; i < slots.size(); ++i) {
+            slots[i] = Slot();
+        }
+        used = 0;
+        deleted = 0;
+    }
+
+    /**
+     * Get the number of values in the table.
+     */
+    size_t Size() const { return used; }
+
+    /**
+     * Get the number of slots in the table. Use with At() to visit every value.
+     */
+    size_t Capacity() const { return slots.size(); }
+
+    /**
+     * Get the value in a slot. Values can be removed while visiting the slots.
+     *
+     * @param index   The slot index, less than Capacity().
+     * @param serial  [OUT] Returns the serial number of the value.
+     *
+     * @return  The value or NULL if the slot is not in use.
+     */
+    T* At(size_t index, uint32_t& serial)
+    {
+        if (slots[index].state != USED) {
+            return NULL;
+        }
+        serial = slots[index].serial;
+        return &slots[index].value;
+    }
+
+  private:
+
+    static const size_t NOT_FOUND = static_cast<size_t>(-1);
+
+    enum SlotState {
+        EMPTY,     /**< Slot has never been used */
+        USED,      /**< Slot holds a value */
+        DELETED    /**< Slot held a value that was removed */
+    };
+
+    struct Slot {
+        Slot() : state(EMPTY), serial(0), value() { }
+        SlotState state;
+        uint32_t serial;
+        T value;
+    };
+
+    size_t Probe(uint32_t serial) const
+    {
+        const size_t mask = slots.size() - 1;
+        size_t index = serial & mask;
+        for (size_t n = 0; n < slots.size(); ++n) {
+            if (slots[index].state == EMPTY) {
+                break;
+            }
+            if ((slots[index].state == USED) && (slots[index].serial == serial)) {
+                return index;
+            }
+            index = (index + 1) & mask;
+        }
+        return NOT_FOUND;
+    }
+
+    void Rehash(size_t capacity)
+    {
+        std::vector<Slot> old(capacity);
+        old.swap(slots);
+        const size_t mask = slots.size() - 1;
+        for (size_t i = 0; i < old.size(); ++i) {
+            if (old[i].state == USED) {
+                size_t index = old[i].serial & mask;
+                while (slots[index].state == USED) {
+                    index = (index + 1) & mask;
+                }
+                slots[index] = old[i];
+            }
+        }
+        deleted = 0;
+    }
+
+    std::vector<Slot> slots;   /**< The table */
+    size_t used;               /**< Number of slots holding a value */
+    size_t deleted;            /**< Number of slots that held a value that was removed */
+};
+
+}
+
+#endif
@@ -36,6 +36,40 @@ using namespace std;
 
 namespace ajn {
 
+SignalTable::Snapshot SignalTable::GetSnapshot()
+{
+    snapshotLock.Lock(MUTEX_CONTEXT);
+    Snapshot snap = hashTable;
+    snapshotLock.Unlock(MUTEX_CONTEXT);
+    return snap;
+}
+
+SignalTable::Snapshot SignalTable::BeginUpdate(bool& inPlace)
+{
+    snapshotLock.Lock(MUTEX_CONTEXT);
+    /*
+     * Readers take a reference while holding snapshotLock so nobody can start using the
+     * current snapshot while it is being changed.
+     */
+    inPlace = (hashTable.GetRefCount() == 1);
+    if (inPlace) {
+        return hashTable;
+    }
+    snapshotLock.Unlock(MUTEX_CONTEXT);
+    Snapshot snap;
+    *snap = *hashTable;
+    return snap;
+}
+
+void SignalTable::EndUpdate(Snapshot& snap, bool inPlace)
+{
+    if (!inPlace) {
+        snapshotLock.Lock(MUTEX_CONTEXT);
+        hashTable = snap;
+    }
+    snapshotLock.Unlock(MUTEX_CONTEXT);
+}
+
 void SignalTable::Add(MessageReceiver* receiver,
                       MessageReceiver::SignalHandler handler,
                       const InterfaceDescription::Member* member,
@@ -48,7 +82,10 @@ void SignalTable::Add(MessageReceiver* receiver,
     Entry entry(handler, receiver, member);
     Key key(sourcePath, member->iface->GetName(), member->name);
     lock.Lock(MUTEX_CONTEXT);
-    hashTable.insert(pair<const Key, Entry>(key, entry));
+    bool inPlace;
+    Snapshot snap = BeginUpdate(inPlace);
+    snap->insert(pair<const Key, Entry>(key, entry));
+    EndUpdate(snap, inPlace);
     lock.Unlock(MUTEX_CONTEXT);
 }
 
@@ -62,42 +99,47 @@ void SignalTable::Remove(MessageReceiver* receiver,
     pair<iterator, iterator> range;
 
     lock.Lock(MUTEX_CONTEXT);
-    range = hashTable.equal_range(key);
+    bool inPlace;
+    Snapshot snap = BeginUpdate(inPlace);
+    range = snap->equal_range(key);
     iter = range.first;
     while (iter != range.second) {
         if ((iter->second.object == receiver) && (iter->second.handler == handler)) {
-            hashTable.erase(iter);
+            snap->erase(iter);
             break;
         } else {
             ++iter;
         }
     }
+    EndUpdate(snap, inPlace);
     lock.Unlock(MUTEX_CONTEXT);
 }
 
 void SignalTable::RemoveAll(MessageReceiver* receiver)
 {
-    bool removed;
     lock.Lock(MUTEX_CONTEXT);
-    do {
-        removed = false;
-        for (iterator iter = hashTable.begin(); iter != hashTable.end(); ++iter) {
-            if (iter->second.object == receiver) {
-                hashTable.erase(iter);
-                removed = true;
-                break;
-            }
+    bool inPlace;
+    Snapshot snap = BeginUpdate(inPlace);
+    iterator iter = snap->begin();
+    while (iter != snap->end()) {
+        if (iter->second.object == receiver) {
+            snap->erase(iter++);
+        } else {
+            ++iter;
         }
-    } while (removed);
+    }
+    EndUpdate(snap, inPlace);
     lock.Unlock(MUTEX_CONTEXT);
 }
 
-pair<SignalTable::const_iterator, SignalTable::const_iterator> SignalTable::Find(const char* sourcePath,
+pair<SignalTable::const_iterator, SignalTable::const_iterator> SignalTable::Find(Snapshot& snapshot,
+                                                                                 const char* sourcePath,
                                                                                  const char* iface,
                                                                                  const char* signalName)
 {
     Key key(sourcePath, iface, signalName);
-    return hashTable.equal_range(key);
+    const HashTable& table = *snapshot;
+    return table.equal_range(key);
 }
 
 }
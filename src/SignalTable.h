@@ -33,6 +33,7 @@
 #include <qcc/String.h>
 #include <qcc/StringMapKey.h>
 #include <qcc/Mutex.h>
+#include <qcc/ManagedObj.h>
 
 #include <alljoyn/InterfaceDescription.h>
 #include <alljoyn/MessageReceiver.h>
@@ -45,6 +46,10 @@ namespace ajn {
 
 /**
  * %SignalTable is a multimap that maps interface/signalname and/or source path to SignalHandler instances.
+ *
+ * A multimap snapshot is never modified while a reader holds it. Changes are made to a copy that then
+ * replaces the current multimap so signal dispatch only needs a reference to the current snapshot.
+ * When no reader holds the current snapshot it is changed in place instead.
  */
 class SignalTable {
 
@@ -124,15 +129,26 @@ class SignalTable {
         }
     };
 
+    /**
+     * Type definition for the signal hash table
+     */
+    typedef std::unordered_multimap<Key, Entry, Hash, Equal> HashTable;
+
     /**
      * Table iterator
      */
-    typedef std::unordered_multimap<Key, Entry, Hash, Equal>::iterator iterator;
+    typedef HashTable::iterator iterator;
 
     /**
      * Const table iterator
      */
-    typedef std::unordered_multimap<Key, Entry, Hash, Equal>::const_iterator const_iterator;
+    typedef HashTable::const_iterator const_iterator;
+
+    /**
+     * Snapshots are replaced rather than modified so a reader only needs a reference to the
+     * current one.
+     */
+    typedef qcc::ManagedObj<HashTable> Snapshot;
 
     /**
      * Add an entry to the signal hash table.
@@ -167,34 +183,55 @@ class SignalTable {
      */
     void RemoveAll(MessageReceiver* receiver);
 
+    /**
+     * Get a reference to the current snapshot of the signal table.
+     *
+     * @return  The current snapshot. It is never modified.
+     */
+    Snapshot GetSnapshot();
+
     /**
      * Find Entries based on set of criteria.
-     * Signal table lock should be held until iterators are no longer in use.
+     * The snapshot must be held until iterators are no longer in use.
      *
+     * @param snapshot     Snapshot returned by GetSnapshot().
      * @param sourcePath   The object path of the signal sender.
-     * @param iface    The interface.
+     * @param iface        The interface.
      * @param signalName   The signal name.
      *
      * @return   Iterator range of entries with matching criteria.
      */
-    std::pair<const_iterator, const_iterator> Find(const char* sourcePath, const char* iface, const char* signalName);
+    static std::pair<const_iterator, const_iterator> Find(Snapshot& snapshot, const char* sourcePath, const char* iface, const char* signalName);
+
+  private:
 
     /**
-     * Get the lock that protects the signal table.
+     * Get the snapshot to change. Must be called with the lock held.
+     *
+     * If the table holds the only reference to the current snapshot no reader can be using it,
+     * so it is returned to be changed in place and snapshotLock is held until EndUpdate().
+     * Otherwise a copy is returned.
+     *
+     * @param inPlace  [OUT] true if the current snapshot is returned.
+     *
+     * @return  The snapshot to change.
      */
-    void Lock(void) { lock.Lock(MUTEX_CONTEXT); }
+    Snapshot BeginUpdate(bool& inPlace);
 
     /**
-     * Release the lock that protects the signal table.
+     * Finish a change started with BeginUpdate(). A copy is published as the current snapshot.
+     * Must be called with the lock held.
+     *
+     * @param snap     The snapshot returned by BeginUpdate().
+     * @param inPlace  The value returned by BeginUpdate().
      */
-    void Unlock(void) { lock.Unlock(MUTEX_CONTEXT); }
-
-  private:
+    void EndUpdate(Snapshot& snap, bool inPlace);
 
-    qcc::Mutex lock; /**< Lock protecting the signal table */
+    qcc::Mutex lock;          /**< Mutex to serialize changes to the signal table */
+    qcc::Mutex snapshotLock;  /**< Mutex that is only held while taking or replacing a reference to the current snapshot */
 
-    /**  The hash table */
-    std::unordered_multimap<Key, Entry, Hash, Equal> hashTable;
+    /**  The current hash table */
+    Snapshot hashTable;
 };
 
 }
@@ -0,0 +1,322 @@
+/**
+ * @file
+ *
+ * This file implements the signature compiler and the signature program cache.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <string.h>
+
+#include <list>
+
+#include <qcc/atomic.h>
+#include <qcc/Debug.h>
+#include <qcc/Mutex.h>
+#include <qcc/STLContainer.h>
+
+#include "SignatureProgram.h"
+#include "SignatureUtils.h"
+
+#define QCC_MODULE "ALLJOYN"
+
+using namespace qcc;
+using namespace std;
+
+namespace ajn {
+
+const size_t SignatureProgramCache::MAX_PROGRAMS;
+
+/*
+ * Returns true for the basic types that are unmarshaled as scalar arrays.
+ */
+static inline bool IsScalarType(char typeId)
+{
+    switch (typeId) {
+    case ALLJOYN_BYTE:
+    case ALLJOYN_BOOLEAN:
+    case ALLJOYN_INT16:
+    case ALLJOYN_UINT16:
+    case ALLJOYN_INT32:
+    case ALLJOYN_UINT32:
+    case ALLJOYN_INT64:
+    case ALLJOYN_UINT64:
+    case ALLJOYN_DOUBLE:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+static inline uint32_t HashSignature(const char* sig)
+{
+    /* FNV-1a */
+    uint32_t hash = 2166136261U;
+    while (*sig) {
+        hash = (hash ^ static_cast<uint8_t>(*sig++)) * 16777619U;
+    }
+    return hash;
+}
+
+QStatus _SignatureProgram::Compile(const char* sig)
+{
+    signature.clear();
+    ops.clear();
+    elemSigs.clear();
+    numArgs = 0;
+    hash = 0;
+
+    if (!sig || !SignatureUtils::IsValidSignature(sig)) {
+        return ER_BUS_BAD_SIGNATURE;
+    }
+    signature = sig;
+    hash = HashSignature(sig);
+    const char* sigPtr = signature.c_str();
+    while (*sigPtr) {
+        QStatus status = CompileType(sigPtr);
+        if (status != ER_OK) {
+            return status;
+        }
+        ++numArgs;
+    }
+    return ER_OK;
+}
+
+/*
+ * Compile one complete type. The signature has already been validated.
+ */
+QStatus _SignatureProgram::CompileType(const char*& sigPtr)
+{
+    QStatus status = ER_OK;
+    const char* start = sigPtr;
+    size_t index = ops.size();
+    ops.push_back(Op());
+    ops[index].code = OP_VALUE;
+    ops[index].numMembers = 0;
+    ops[index].sigOffset = static_cast<uint16_t>(start - signature.c_str());
+    ops[index].elemSig = 0;
+
+    switch (*sigPtr++) {
+    case ALLJOYN_ARRAY:
+        if (IsScalarType(*sigPtr)) {
+            ops[index].code = OP_SCALAR_ARRAY;
+            ++sigPtr;
+        } else {
+            const char* elemStart = sigPtr;
+            ops[index].code = OP_ARRAY;
+            status = CompileType(sigPtr);
+            if (status == ER_OK) {
+                ops[index].elemSig = static_cast<uint16_t>(elemSigs.size());
+                elemSigs.push_back(qcc::String(elemStart, sigPtr - elemStart));
+            }
+        }
+        break;
+
+    case ALLJOYN_STRUCT_OPEN:
+        ops[index].code = OP_STRUCT;
+        while ((status == ER_OK) && (*sigPtr != ALLJOYN_STRUCT_CLOSE)) {
+            status = CompileType(sigPtr);
+            ++ops[index].numMembers;
+        }
+        ++sigPtr;
+        break;
+
+    case ALLJOYN_DICT_ENTRY_OPEN:
+        ops[index].code = OP_DICT_ENTRY;
+        status = CompileType(sigPtr);
+        if (status == ER_OK) {
+            status = CompileType(sigPtr);
+        }
+        ++sigPtr;
+        break;
+
+    case ALLJOYN_STRUCT_CLOSE:
+    case ALLJOYN_DICT_ENTRY_CLOSE:
+    case ALLJOYN_INVALID:
+        status = ER_BUS_BAD_SIGNATURE;
+        break;
+
+    default:
+        break;
+    }
+    ops[index].next = static_cast<uint16_t>(ops.size());
+    return status;
+}
+
+bool _SignatureProgram::Matches(const MsgArg& arg, size_t index) const
+{
+    const Op& op = ops[index];
+    const char* sig = GetTypeSig(op);
+
+    switch (op.code) {
+    case OP_VALUE:
+        return arg.typeId == static_cast<AllJoynTypeId>(sig[0]);
+
+    case OP_SCALAR_ARRAY:
+        if (arg.typeId == ALLJOYN_ARRAY) {
+            const char* elemSig = arg.v_array.GetElemSig();
+            return elemSig && (elemSig[0] == sig[1]) && (elemSig[1] == 0);
+        }
+        return arg.typeId == static_cast<AllJoynTypeId>((sig[1] << 8) | ALLJOYN_ARRAY);
+
+    case OP_ARRAY:
+        if (arg.typeId != ALLJOYN_ARRAY) {
+            return false;
+        }
+        return arg.v_array.GetElemSig() && (strcmp(arg.v_array.GetElemSig(), GetElemSig(op)) == 0);
+
+    case OP_STRUCT:
+        if ((arg.typeId != ALLJOYN_STRUCT) || (arg.v_struct.numMembers != op.numMembers) || (op.numMembers && !arg.v_struct.members)) {
+            return false;
+        }
+        ++index;
+        for (size_t i = 0; i < op.numMembers; ++i) {
+            if (!Matches(arg.v_struct.members[i], index)) {
+                return false;
+            }
+            index = ops[index].next;
+        }
+        return true;
+
+    case OP_DICT_ENTRY:
+        if ((arg.typeId != ALLJOYN_DICT_ENTRY) || !arg.v_dictEntry.key || !arg.v_dictEntry.val) {
+            return false;
+        }
+        return Matches(*arg.v_dictEntry.key, index + 1) && Matches(*arg.v_dictEntry.val, ops[index + 1].next);
+
+    default:
+        return false;
+    }
+}
+
+/*
+ * The cache is a small LRU. The map is keyed by the signature string held by each program so a
+ * lookup does not need to copy the signature. The lock is only held to find a program and move
+ * it to the front of the LRU list, signatures are compiled outside the lock.
+ */
+struct SigHash {
+    size_t operator()(const char* sig) const { return HashSignature(sig); }
+};
+
+struct SigEq {
+    bool operator()(const char* sig1, const char* sig2) const { return strcmp(sig1, sig2) == 0; }
+};
+
+typedef std::list<const _SignatureProgram*> ProgramList;
+typedef std::unordered_map<const char*, ProgramList::iterator, SigHash, SigEq> ProgramMap;
+
+static qcc::Mutex cacheLock;      /* Protects lru and programs */
+static ProgramList lru;           /* Cached programs, most recently used first */
+static ProgramMap programs;       /* Cached programs by signature */
+static bool enabled = true;
+static uint32_t evicted = 0;
+
+/*
+ * Find a cached program and mark it most recently used. Must be called with cacheLock held.
+ */
+static const _SignatureProgram* FindProgram(const char* sig)
+{
+    ProgramMap::iterator it = programs.find(sig);
+    if (it == programs.end()) {
+        return NULL;
+    }
+    const _SignatureProgram* program = *it->second;
+    lru.splice(lru.begin(), lru, it->second);
+    return program;
+}
+
+const _SignatureProgram* SignatureProgramCache::Get(const char* sig)
+{
+    if (!sig) {
+        return NULL;
+    }
+    cacheLock.Lock(MUTEX_CONTEXT);
+    const _SignatureProgram* program = FindProgram(sig);
+    if (program) {
+        IncrementAndFetch(&program->refs);
+    }
+    cacheLock.Unlock(MUTEX_CONTEXT);
+    if (program) {
+        return program;
+    }
+
+    /* Compile outside the lock so lookups of other signatures are not held up */
+    _SignatureProgram* compiled = new _SignatureProgram();
+    QStatus status = compiled->Compile(sig);
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Failed to compile signature \"%s\"", sig));
+        delete compiled;
+        return NULL;
+    }
+
+    cacheLock.Lock(MUTEX_CONTEXT);
+    /* Another thread may have compiled the same signature in the meantime */
+    program = FindProgram(sig);
+    if (program) {
+        IncrementAndFetch(&program->refs);
+    } else {
+        if (programs.size() >= MAX_PROGRAMS) {
+            const _SignatureProgram* oldest = lru.back();
+            programs.erase(oldest->GetSignature().c_str());
+            lru.pop_back();
+            ++evicted;
+            QCC_DbgPrintf(("Evicted signature \"%s\"", oldest->GetSignature().c_str()));
+            Release(oldest);
+        }
+        /* One reference for the cache and one for the caller */
+        compiled->refs = 2;
+        lru.push_front(compiled);
+        programs[compiled->GetSignature().c_str()] = lru.begin();
+        program = compiled;
+        compiled = NULL;
+        QCC_DbgPrintf(("Compiled signature \"%s\"", sig));
+    }
+    cacheLock.Unlock(MUTEX_CONTEXT);
+
+    delete compiled;
+    return program;
+}
+
+void SignatureProgramCache::Release(const _SignatureProgram* program)
+{
+    if (program && (DecrementAndFetch(&program->refs) == 0)) {
+        delete program;
+    }
+}
+
+void SignatureProgramCache::Enable(bool enable)
+{
+    enabled = enable;
+}
+
+bool SignatureProgramCache::IsEnabled()
+{
+    return enabled;
+}
+
+void SignatureProgramCache::GetStats(uint32_t& numPrograms, uint32_t& numEvicted)
+{
+    cacheLock.Lock(MUTEX_CONTEXT);
+    numPrograms = static_cast<uint32_t>(programs.size());
+    numEvicted = evicted;
+    cacheLock.Unlock(MUTEX_CONTEXT);
+}
+
+}
@@ -0,0 +1,204 @@
+#ifndef _ALLJOYN_SIGNATUREPROGRAM_H
+#define _ALLJOYN_SIGNATUREPROGRAM_H
+/**
+ * @file
+ *
+ * This file defines signature programs, signatures compiled into a flat list of operations,
+ * and the cache that holds the programs for recently used signatures.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#ifndef __cplusplus
+#error Only include SignatureProgram.h in C++ code.
+#endif
+
+#include <qcc/platform.h>
+
+#include <vector>
+
+#include <qcc/String.h>
+
+#include <alljoyn/MsgArg.h>
+#include <alljoyn/Status.h>
+
+namespace ajn {
+
+/**
+ * A signature program is a signature that has been validated and broken down into one
+ * operation per complete type. Containers are followed by the operations for their members so
+ * the structure of the signature never has to be parsed again while marshaling or unmarshaling.
+ */
+class _SignatureProgram {
+  public:
+
+    /**
+     * Operation codes
+     */
+    typedef enum {
+        OP_VALUE,         ///< A basic type, variant or handle
+        OP_SCALAR_ARRAY,  ///< An array of a fixed size basic type
+        OP_ARRAY,         ///< An array of any other element type, followed by the element operation
+        OP_STRUCT,        ///< A struct, followed by the member operations
+        OP_DICT_ENTRY     ///< A dictionary entry, followed by the key and value operations
+    } OpCode;
+
+    /**
+     * One operation.
+     */
+    struct Op {
+        uint8_t code;          ///< The OpCode
+        uint8_t numMembers;    ///< Number of operations for struct members
+        uint16_t next;         ///< Index of the operation following this one and its members
+        uint16_t sigOffset;    ///< Offset of the complete type in the signature
+        uint16_t elemSig;      ///< For OP_ARRAY the index of the element signature
+    };
+
+    /**
+     * Default constructor creates an empty program.
+     */
+    _SignatureProgram() : numArgs(0), hash(0), refs(0) { }
+
+    /**
+     * Compile a signature.
+     *
+     * @param sig   The signature to compile.
+     *
+     * @return
+     *      - #ER_OK if the signature was compiled.
+     *      - #ER_BUS_BAD_SIGNATURE if the signature is not valid.
+     */
+    QStatus Compile(const char* sig);
+
+    /**
+     * Check that a MsgArg has the type given by an operation.
+     *
+     * @param arg    The arg to check.
+     * @param index  Index of the operation.
+     *
+     * @return true if the arg has the type.
+     */
+    bool Matches(const MsgArg& arg, size_t index = 0) const;
+
+    /**
+     * Get the compiled signature.
+     */
+    const qcc::String& GetSignature() const { return signature; }
+
+    /**
+     * Get the hash of the compiled signature.
+     */
+    uint32_t GetHash() const { return hash; }
+
+    /**
+     * Get the number of complete types (top level arguments) in the signature.
+     */
+    size_t GetNumArgs() const { return numArgs; }
+
+    /**
+     * Get an operation.
+     *
+     * @param index  Index of the operation.
+     */
+    const Op& GetOp(size_t index) const { return ops[index]; }
+
+    /**
+     * Get the signature of the complete type for an operation. The returned signature is not
+     * terminated at the end of the complete type.
+     *
+     * @param op   The operation.
+     */
+    const char* GetTypeSig(const Op& op) const { return signature.c_str() + op.sigOffset; }
+
+    /**
+     * Get the NUL terminated element signature for an OP_ARRAY operation.
+     *
+     * @param op   The operation.
+     */
+    const char* GetElemSig(const Op& op) const { return elemSigs[op.elemSig].c_str(); }
+
+  private:
+
+    friend class SignatureProgramCache;
+
+    QStatus CompileType(const char*& sigPtr);
+
+    qcc::String signature;               ///< The compiled signature
+    std::vector<Op> ops;                 ///< The operations
+    std::vector<qcc::String> elemSigs;   ///< Element signatures for OP_ARRAY operations
+    size_t numArgs;                      ///< Number of top level complete types
+    uint32_t hash;                       ///< Hash of the signature
+    mutable volatile int32_t refs;       ///< References held by the cache and its callers
+};
+
+/**
+ * Process-wide cache of compiled programs. Each signature is compiled once and its program is
+ * kept until it is the least recently used program in a full cache. Programs are reference
+ * counted so a program that is evicted while it is in use stays valid until it is released.
+ */
+class SignatureProgramCache {
+  public:
+
+    /**
+     * Maximum number of programs kept in the cache.
+     */
+    static const size_t MAX_PROGRAMS = 256;
+
+    /**
+     * Get the program for a signature, compiling the signature if it is not in the cache. If
+     * the cache is full the least recently used program is evicted to make room for it.
+     *
+     * @param sig   The signature.
+     *
+     * @return  The program or NULL if the signature is not valid. The caller should fall back to
+     *          interpreting the signature if NULL is returned and must call Release() on a
+     *          program it has finished with.
+     */
+    static const _SignatureProgram* Get(const char* sig);
+
+    /**
+     * Release a program returned by Get().
+     *
+     * @param program   The program to release, may be NULL.
+     */
+    static void Release(const _SignatureProgram* program);
+
+    /**
+     * Enable or disable the use of signature programs for unmarshaling and for checking array
+     * elements while marshaling. Used for benchmarking against the signature interpreter.
+     *
+     * @param enable   True to use signature programs.
+     */
+    static void Enable(bool enable);
+
+    /**
+     * Check if signature programs are in use.
+     */
+    static bool IsEnabled();
+
+    /**
+     * Get cache statistics.
+     *
+     * @param numPrograms  [OUT] Number of programs in the cache.
+     * @param numEvicted   [OUT] Number of programs that have been evicted from the cache.
+     */
+    static void GetStats(uint32_t& numPrograms, uint32_t& numEvicted);
+};
+
+}
+
+#endif
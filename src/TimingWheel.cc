@@ -0,0 +1,138 @@
+/**
+ * @file
+ *
+ * Hashed timing wheel implementation.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <assert.h>
+
+#include "TimingWheel.h"
+
+using namespace std;
+
+namespace ajn {
+
+TimingWheel::TimingWheel(uint32_t tickMs, size_t numSlots) :
+    tickMs(tickMs),
+    mask(numSlots - 1),
+    curTick(0),
+    count(0),
+    slots(numSlots)
+{
+    assert(tickMs > 0);
+    assert((numSlots > 0) && ((numSlots & mask) == 0));
+}
+
+void TimingWheel::Add(uint32_t key, uint64_t deadline)
+{
+    uint64_t tick = deadline / tickMs;
+    /*
+     * Deadlines in the past or in the current tick go in the next slot to be processed.
+     */
+    if (tick <= curTick) {
+        tick = curTick + 1;
+    }
+    Entry entry;
+    entry.key = key;
+    entry.deadline = deadline;
+    slots[tick & mask].push_back(entry);
+    ++count;
+}
+
+bool TimingWheel::Remove(uint32_t key, uint64_t deadline)
+{
+    /*
+     * Entries are always in the slot Add() would pick for them now. An entry that has gone
+     * around again is put back in the same slot and one in the current tick was moved to the
+     * next slot to be processed.
+     */
+    uint64_t tick = deadline / tickMs;
+    if (tick <= curTick) {
+        tick = curTick + 1;
+    }
+    vector<Entry>& slot = slots[tick & mask];
+    for (vector<Entry>::iterator it = slot.begin(); it != slot.end(); ++it) {
+        if ((it->key == key) && (it->deadline == deadline)) {
+            *it = slot.back();
+            slot.pop_back();
+            --count;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TimingWheel::NextDeadline(uint64_t& deadline) const
+{
+    bool found = false;
+    if (count == 0) {
+        return found;
+    }
+    for (uint64_t tick = curTick + 1; tick <= curTick + slots.size(); ++tick) {
+        const vector<Entry>& slot = slots[tick & mask];
+        for (vector<Entry>::const_iterator it = slot.begin(); it != slot.end(); ++it) {
+            if (!found || (it->deadline < deadline)) {
+                deadline = it->deadline;
+                found = true;
+            }
+        }
+        /*
+         * Slots further on only hold deadlines in later ticks or later turns of the wheel.
+         */
+        if (found && ((deadline / tickMs) <= tick)) {
+            break;
+        }
+    }
+    return found;
+}
+
+void TimingWheel::Advance(uint64_t now, vector<Entry>& due)
+{
+    uint64_t nowTick = now / tickMs;
+    if (nowTick <= curTick) {
+        return;
+    }
+    /*
+     * If more than one turn of the wheel has passed each slot only needs to be processed once.
+     */
+    uint64_t tick = curTick + 1;
+    if ((nowTick - curTick) > slots.size()) {
+        tick = nowTick - slots.size() + 1;
+    }
+    curTick = nowTick;
+    for (; tick <= nowTick; ++tick) {
+        /*
+         * Swap the slot out so entries that go around again are not seen twice in this pass.
+         */
+        scratch.swap(slots[tick & mask]);
+        count -= scratch.size();
+        for (vector<Entry>::const_iterator it = scratch.begin(); it != scratch.end(); ++it) {
+            if (it->deadline <= now) {
+                due.push_back(*it);
+            } else {
+                Add(it->key, it->deadline);
+            }
+        }
+        scratch.clear();
+    }
+}
+
+}
@@ -0,0 +1,125 @@
+#ifndef _ALLJOYN_TIMINGWHEEL_H
+#define _ALLJOYN_TIMINGWHEEL_H
+/**
+ * @file
+ *
+ * This file defines a hashed timing wheel for tracking large numbers of timeouts.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#ifndef __cplusplus
+#error Only include TimingWheel.h in C++ code.
+#endif
+
+#include <qcc/platform.h>
+
+#include <vector>
+
+namespace ajn {
+
+/**
+ * A hashed timing wheel. Timeouts are kept in slots by the tick they expire in so adding a
+ * timeout is constant time. Deadlines further out than one turn of the wheel go around again.
+ *
+ * The owner of the wheel keeps the authoritative state for each key and ignores due entries
+ * that no longer match it. The wheel is not thread safe.
+ */
+class TimingWheel {
+  public:
+
+    /**
+     * A timeout in the wheel.
+     */
+    struct Entry {
+        uint32_t key;        /**< Key supplied by the owner of the wheel */
+        uint64_t deadline;   /**< Timestamp in milliseconds when the timeout expires */
+    };
+
+    /**
+     * Constructor
+     *
+     * @param tickMs     Resolution of the wheel in milliseconds.
+     * @param numSlots   Number of slots in the wheel, must be a power of 2.
+     */
+    TimingWheel(uint32_t tickMs, size_t numSlots);
+
+    /**
+     * Add a timeout.
+     *
+     * @param key       Key that will be returned when the timeout expires.
+     * @param deadline  Timestamp in milliseconds when the timeout expires.
+     */
+    void Add(uint32_t key, uint64_t deadline);
+
+    /**
+     * Remove a timeout.
+     *
+     * @param key       Key the timeout was added with.
+     * @param deadline  Deadline the timeout was added with.
+     *
+     * @return  true if the timeout was removed, false if it has already expired.
+     */
+    bool Remove(uint32_t key, uint64_t deadline);
+
+    /**
+     * Get the earliest deadline in the wheel.
+     *
+     * @param deadline  [OUT] The earliest deadline.
+     *
+     * @return  true if the wheel has a timeout, false if it is empty.
+     */
+    bool NextDeadline(uint64_t& deadline) const;
+
+    /**
+     * Advance the wheel to the current time and collect the timeouts that have expired.
+     *
+     * @param now   The current timestamp in milliseconds.
+     * @param due   [OUT] The expired timeouts are appended to this vector.
+     */
+    void Advance(uint64_t now, std::vector<Entry>& due);
+
+    /**
+     * Get the number of timeouts in the wheel.
+     *
+     * @return  The number of timeouts including ones the owner no longer cares about.
+     */
+    size_t Size() const { return count; }
+
+  private:
+
+    /**
+     * Assignment operator is private.
+     */
+    TimingWheel& operator=(const TimingWheel& other);
+
+    /**
+     * Copy constructor is private.
+     */
+    TimingWheel(const TimingWheel& other);
+
+    const uint32_t tickMs;                   /**< Resolution of the wheel */
+    const size_t mask;                       /**< Mask for mapping a tick to a slot */
+    uint64_t curTick;                        /**< All slots up to and including this tick have been processed */
+    size_t count;                            /**< Number of entries in the wheel */
+    std::vector<std::vector<Entry> > slots;  /**< The slots of the wheel */
+    std::vector<Entry> scratch;              /**< Slot being processed by Advance() */
+};
+
+}
+
+#endif
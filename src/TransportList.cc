@@ -32,8 +32,8 @@ using namespace qcc;
 
 namespace ajn {
 
-TransportList::TransportList(BusAttachment& bus, TransportFactoryContainer& factories, IODispatch* m_ioDispatch, uint32_t concurrency)
-    : bus(bus), localTransport(new LocalTransport(bus, concurrency)), m_factories(factories), isStarted(false), isInitialized(false), m_ioDispatch(m_ioDispatch)
+TransportList::TransportList(BusAttachment& bus, TransportFactoryContainer& factories, std::vector<IODispatch*>& ioDispatchers, uint32_t concurrency)
+    : bus(bus), localTransport(new LocalTransport(bus, concurrency)), m_factories(factories), isStarted(false), isInitialized(false), m_ioDispatchers(ioDispatchers)
 {
 }
 
@@ -174,10 +174,12 @@ QStatus TransportList::Start(const String& transportSpecs)
         }
     }
 
-    /* Start the iodispatch */
-    QStatus s = m_ioDispatch->Start();
-    if (ER_OK == status) {
-        status = s;
+    /* Start the iodispatch shards */
+    for (size_t i = 0; i < m_ioDispatchers.size(); ++i) {
+        QStatus s = m_ioDispatchers[i]->Start();
+        if (ER_OK == status) {
+            status = s;
+        }
     }
     isStarted = (ER_OK == status);
     return status;
@@ -194,10 +196,12 @@ QStatus TransportList::Stop()
             status = s;
         }
     }
-    /* Stop the iodispatch */
-    QStatus s = m_ioDispatch->Stop();
-    if (ER_OK == status) {
-        status = s;
+    /* Stop the iodispatch shards */
+    for (size_t i = 0; i < m_ioDispatchers.size(); ++i) {
+        QStatus s = m_ioDispatchers[i]->Stop();
+        if (ER_OK == status) {
+            status = s;
+        }
     }
 
     return status;
@@ -213,10 +217,12 @@ QStatus TransportList::Join()
             status = s;
         }
     }
-    /* Join the iodispatch */
-    QStatus s = m_ioDispatch->Join();
-    if (ER_OK == status) {
-        status = s;
+    /* Join the iodispatch shards */
+    for (size_t i = 0; i < m_ioDispatchers.size(); ++i) {
+        QStatus s = m_ioDispatchers[i]->Join();
+        if (ER_OK == status) {
+            status = s;
+        }
     }
     return status;
 }
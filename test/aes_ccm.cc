@@ -28,11 +28,14 @@
 #include <qcc/String.h>
 #include <qcc/StringUtil.h>
 #include <qcc/Util.h>
+#include <qcc/time.h>
 
 #include <alljoyn/version.h>
 
 #include <alljoyn/Status.h>
 
+#include <CryptoAESNI.h>
+
 using namespace qcc;
 using namespace std;
 using namespace ajn;
@@ -322,6 +325,46 @@ static TEST_CASE testVector[] = {
 };
 
 
+/*
+ * Encrypts messages of msgLen bytes with a 5 byte nonce and a header as additional data, which is
+ * how message bodies are encrypted, and returns the throughput in MB/s on a single core.
+ */
+static uint32_t Throughput(bool aesni, size_t msgLen)
+{
+    static const size_t hdrLen = 48;
+    static const size_t totalBytes = 16 * 1024 * 1024;
+    uint8_t keyData[16];
+    uint8_t nonceData[5];
+    uint8_t* buf = new uint8_t[hdrLen + msgLen + 16];
+
+    for (size_t i = 0; i < sizeof(keyData); ++i) {
+        keyData[i] = (uint8_t)i;
+    }
+    memset(nonceData, 0x5A, sizeof(nonceData));
+    memset(buf, 0xA5, hdrLen + msgLen + 16);
+    KeyBlob key(keyData, sizeof(keyData), KeyBlob::AES);
+    KeyBlob nonce(nonceData, sizeof(nonceData), KeyBlob::GENERIC);
+
+    size_t iterations = totalBytes / msgLen;
+    uint64_t start = GetTimestamp64();
+    for (size_t i = 0; i < iterations; ++i) {
+        size_t len = msgLen;
+        /* A cipher is created for every message just as Crypto::Encrypt() does */
+        if (aesni) {
+            Crypto_AES_NI aes(key);
+            aes.Encrypt_CCM(buf + hdrLen, buf + hdrLen, len, nonce, buf, hdrLen, 8);
+        } else {
+            Crypto_AES aes(key, Crypto_AES::CCM);
+            aes.Encrypt_CCM(buf + hdrLen, buf + hdrLen, len, nonce, buf, hdrLen, 8);
+        }
+    }
+    uint64_t elapsed = GetTimestamp64() - start;
+    delete [] buf;
+    if (elapsed == 0) {
+        elapsed = 1;
+    }
+    return static_cast<uint32_t>((static_cast<uint64_t>(iterations * msgLen) * 1000) / (elapsed * 1024 * 1024));
+}
 
 int main(int argc, char** argv)
 {
@@ -387,6 +430,65 @@ int main(int argc, char** argv)
         printf("Crypto_PseudorandomFunctionCCM test PASSED\n");
     }
 
+    /*
+     * Run the same test vectors through the AES-NI implementation if this processor has it.
+     */
+    if (Crypto_AES_NI::IsAvailable(KeyBlob((const uint8_t*)"0123456789ABCDEF", 16, KeyBlob::AES))) {
+        for (size_t i = 0; i < ArraySize(testVector); i++) {
+            uint8_t key[16];
+            uint8_t msg[64];
+
+            size_t keyLen = HexStringToBytes(testVector[i].key, key, sizeof(key), ' ');
+            KeyBlob nonce(HexStringToByteString(testVector[i].nonce, ' '), KeyBlob::GENERIC);
+            size_t len = HexStringToBytes(testVector[i].input, msg, sizeof(msg), ' ');
+            size_t hdrLen = testVector[i].hdrLen;
+
+            KeyBlob kb(key, keyLen, KeyBlob::AES);
+            Crypto_AES_NI aes(kb);
+
+            len -= hdrLen;
+            status = aes.Encrypt_CCM(msg + hdrLen, msg + hdrLen, len, nonce, msg, hdrLen, testVector[i].authLen);
+            if (status != ER_OK) {
+                printf("AES-NI encryption error %s for test #%d\n", QCC_StatusText(status), static_cast<int>(i + 1));
+                goto ErrorExit;
+            }
+            String output = BytesToHexString(msg, hdrLen + len, false, ' ');
+            if (output != testVector[i].output) {
+                printf("AES-NI encrypt verification failure for test #%d\n%s\n", static_cast<int>(i + 1), output.c_str());
+                goto ErrorExit;
+            }
+            status = aes.Decrypt_CCM(msg + hdrLen, msg + hdrLen, len, nonce, msg, hdrLen, testVector[i].authLen);
+            if (status != ER_OK) {
+                printf("AES-NI authentication failure %s for test #%d\n", QCC_StatusText(status), static_cast<int>(i + 1));
+                goto ErrorExit;
+            }
+            String input = BytesToHexString(msg, hdrLen + len, false, ' ');
+            if (input != testVector[i].input) {
+                printf("AES-NI decrypt verification failure for test #%d\n", static_cast<int>(i + 1));
+                goto ErrorExit;
+            }
+        }
+        printf("AES-NI CCM unit test PASSED\n");
+    } else {
+        printf("AES-NI CCM is not available on this processor\n");
+    }
+
+    {
+        static const size_t msgLens[] = { 64, 256, 1024, 4096, 16384 };
+        bool aesni = Crypto_AES_NI::IsAvailable(KeyBlob((const uint8_t*)"0123456789ABCDEF", 16, KeyBlob::AES));
+
+        printf("\nAES-CCM encryption throughput (MB/s on one core)\n");
+        printf("  message bytes   portable   AES-NI\n");
+        for (size_t i = 0; i < ArraySize(msgLens); ++i) {
+            uint32_t portable = Throughput(false, msgLens[i]);
+            if (aesni) {
+                printf("  %13u   %8u   %6u\n", static_cast<uint32_t>(msgLens[i]), portable, Throughput(true, msgLens[i]));
+            } else {
+                printf("  %13u   %8u        -\n", static_cast<uint32_t>(msgLens[i]), portable);
+            }
+        }
+    }
+
     return 0;
 
 ErrorExit:
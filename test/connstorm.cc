@@ -0,0 +1,256 @@
+/**
+ * @file
+ *
+ * Connection storm benchmark for the daemon TCP transport. Opens a large number of TCP
+ * connections to a daemon at once, as happens when many devices reconnect after a network
+ * outage, and then completes the authentication handshake on each of them. Reports how many
+ * handshakes succeeded and how long they took.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#include <qcc/Debug.h>
+#include <qcc/IPAddress.h>
+#include <qcc/Socket.h>
+#include <qcc/SocketStream.h>
+#include <qcc/String.h>
+#include <qcc/StringUtil.h>
+#include <qcc/Thread.h>
+#include <qcc/Util.h>
+#include <qcc/time.h>
+
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/version.h>
+
+#include <alljoyn/Status.h>
+
+#include <RemoteEndpoint.h>
+
+#define QCC_MODULE "ALLJOYN"
+
+using namespace std;
+using namespace qcc;
+using namespace ajn;
+
+static BusAttachment* gBus;
+
+/*
+ * One connection of the storm
+ */
+struct Connection {
+    Connection() : sock(-1), stream(NULL), status(ER_OK), handshakeMs(0), completeMs(0) { }
+
+    SocketFd sock;
+    SocketStream* stream;
+    RemoteEndpoint ep;
+    QStatus status;
+    uint32_t handshakeMs;   /* Time taken by the handshake itself */
+    uint32_t completeMs;    /* Time from the start of the storm until the handshake completed */
+};
+
+/*
+ * Completes the handshakes for every n'th connection.
+ */
+class HandshakeThread : public Thread {
+  public:
+    HandshakeThread(vector<Connection>& conns, const qcc::String& spec, uint64_t stormStart, size_t first, size_t step) :
+        Thread("handshake"), conns(conns), spec(spec), stormStart(stormStart), first(first), step(step) { }
+
+  private:
+    ThreadReturn STDCALL Run(void* arg)
+    {
+        for (size_t i = first; i < conns.size(); i += step) {
+            Connection& conn = conns[i];
+            if (conn.status != ER_OK) {
+                continue;
+            }
+            uint64_t start = GetTimestamp64();
+            conn.stream = new SocketStream(conn.sock);
+            conn.ep = RemoteEndpoint(*gBus, false, spec, conn.stream, "storm");
+            conn.ep->GetFeatures().isBusToBus = true;
+            conn.ep->GetFeatures().allowRemote = true;
+            conn.ep->GetFeatures().handlePassing = false;
+            qcc::String authName;
+            qcc::String redirection;
+            conn.status = conn.ep->Establish("ANONYMOUS", authName, redirection);
+            uint64_t now = GetTimestamp64();
+            conn.handshakeMs = static_cast<uint32_t>(now - start);
+            conn.completeMs = static_cast<uint32_t>(now - stormStart);
+        }
+        return 0;
+    }
+
+    vector<Connection>& conns;
+    qcc::String spec;
+    uint64_t stormStart;
+    size_t first;
+    size_t step;
+};
+
+static uint32_t Percentile(const vector<uint32_t>& sorted, uint32_t pct)
+{
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t index = (sorted.size() - 1) * pct / 100;
+    return sorted[index];
+}
+
+static void usage(void)
+{
+    printf("Usage: connstorm [-h] [-a <addr>] [-p <port>] [-n <connections>] [-t <threads>]\n\n");
+    printf("Options:\n");
+    printf("   -h                    = Print this help message\n");
+    printf("   -a <addr>             = IPv4 address of the daemon, default is 127.0.0.1\n");
+    printf("   -p <port>             = TCP port of the daemon, default is 9955\n");
+    printf("   -n <connections>      = Number of connections in the storm, default is 1000\n");
+    printf("   -t <threads>          = Number of threads completing handshakes, default is 16\n");
+    printf("\n");
+    printf("The daemon limits limit@max_incomplete_connections and limit@max_completed_connections\n");
+    printf("must allow the number of connections in the storm.\n");
+}
+
+int main(int argc, char** argv)
+{
+    qcc::String addr = "127.0.0.1";
+    uint16_t port = 9955;
+    uint32_t numConns = 1000;
+    uint32_t numThreads = 16;
+
+    for (int i = 1; i < argc; ++i) {
+        if (0 == strcmp("-h", argv[i])) {
+            usage();
+            exit(0);
+        } else if ((0 == strcmp("-a", argv[i])) || (0 == strcmp("-p", argv[i])) ||
+                   (0 == strcmp("-n", argv[i])) || (0 == strcmp("-t", argv[i]))) {
+            if ((i + 1) == argc) {
+                printf("option %s requires a parameter\n", argv[i]);
+                usage();
+                exit(1);
+            }
+            const char* opt = argv[i++];
+            if (0 == strcmp("-a", opt)) {
+                addr = argv[i];
+            } else if (0 == strcmp("-p", opt)) {
+                port = static_cast<uint16_t>(StringToU32(argv[i], 10, port));
+            } else if (0 == strcmp("-n", opt)) {
+                numConns = StringToU32(argv[i], 10, numConns);
+            } else {
+                numThreads = StringToU32(argv[i], 10, numThreads);
+            }
+        } else {
+            usage();
+            exit(1);
+        }
+    }
+    if ((numConns == 0) || (numThreads == 0)) {
+        usage();
+        exit(1);
+    }
+
+    gBus = new BusAttachment("connstorm");
+    QStatus status = gBus->Start();
+    if (status != ER_OK) {
+        printf("Failed to start bus attachment: %s\n", QCC_StatusText(status));
+        exit(1);
+    }
+
+    IPAddress ipAddr(addr);
+    qcc::String spec = "tcp:addr=" + addr + ",port=" + U32ToString(port);
+    vector<Connection> conns(numConns);
+
+    /*
+     * Open all of the connections before any handshake is completed so the daemon has every one
+     * of them in the authenticating state at the same time.
+     */
+    uint64_t stormStart = GetTimestamp64();
+    uint32_t connected = 0;
+    for (uint32_t i = 0; i < numConns; ++i) {
+        Connection& conn = conns[i];
+        conn.status = qcc::Socket(QCC_AF_INET, QCC_SOCK_STREAM, conn.sock);
+        if (conn.status == ER_OK) {
+            conn.status = qcc::Connect(conn.sock, ipAddr, port);
+        }
+        if (conn.status == ER_OK) {
+            uint8_t nul = 0;
+            size_t sent;
+            conn.status = qcc::Send(conn.sock, &nul, 1, sent);
+        }
+        if (conn.status == ER_OK) {
+            ++connected;
+        }
+    }
+    uint32_t connectMs = static_cast<uint32_t>(GetTimestamp64() - stormStart);
+    printf("Opened %u of %u connections in %u ms\n", connected, numConns, connectMs);
+
+    vector<HandshakeThread*> threads;
+    for (uint32_t i = 0; i < numThreads; ++i) {
+        threads.push_back(new HandshakeThread(conns, spec, stormStart, i, numThreads));
+        threads.back()->Start();
+    }
+    for (uint32_t i = 0; i < numThreads; ++i) {
+        threads[i]->Join();
+        delete threads[i];
+    }
+    uint32_t stormMs = static_cast<uint32_t>(GetTimestamp64() - stormStart);
+
+    vector<uint32_t> handshakeMs;
+    vector<uint32_t> completeMs;
+    uint32_t failed = 0;
+    for (uint32_t i = 0; i < numConns; ++i) {
+        if (conns[i].status == ER_OK) {
+            handshakeMs.push_back(conns[i].handshakeMs);
+            completeMs.push_back(conns[i].completeMs);
+        } else {
+            ++failed;
+        }
+    }
+    sort(handshakeMs.begin(), handshakeMs.end());
+    sort(completeMs.begin(), completeMs.end());
+
+    uint32_t established = static_cast<uint32_t>(handshakeMs.size());
+    printf("Established %u connections, %u failed, in %u ms", established, failed, stormMs);
+    if (stormMs) {
+        printf(" (%u handshakes/sec)", static_cast<uint32_t>((static_cast<uint64_t>(established) * 1000) / stormMs));
+    }
+    printf("\n");
+    printf("Handshake ms:  p50 %u  p90 %u  p99 %u  max %u\n",
+           Percentile(handshakeMs, 50), Percentile(handshakeMs, 90), Percentile(handshakeMs, 99), Percentile(handshakeMs, 100));
+    printf("Completion ms: p50 %u  p90 %u  p99 %u  max %u\n",
+           Percentile(completeMs, 50), Percentile(completeMs, 90), Percentile(completeMs, 99), Percentile(completeMs, 100));
+
+    for (uint32_t i = 0; i < numConns; ++i) {
+        Connection& conn = conns[i];
+        conn.ep = RemoteEndpoint();
+        if (conn.stream) {
+            delete conn.stream;
+        } else if (conn.sock != -1) {
+            qcc::Close(conn.sock);
+        }
+    }
+
+    delete gBus;
+    return (failed == 0) ? 0 : 1;
+}
@@ -31,6 +31,7 @@
 #include <qcc/String.h>
 #include <qcc/StringUtil.h>
 #include <qcc/ManagedObj.h>
+#include <qcc/time.h>
 
 #include <alljoyn/BusAttachment.h>
 #include <alljoyn/Message.h>
@@ -41,6 +42,7 @@
 /* Private files included for unit testing */
 #include <PeerState.h>
 #include <SignatureUtils.h>
+#include <SignatureProgram.h>
 #include <RemoteEndpoint.h>
 
 #define QCC_MODULE "ALLJOYN"
@@ -1030,19 +1032,94 @@ QStatus TestMsgUnpack()
 
 }
 
+/*
+ * Marshal and unmarshal a message numIterations times and return the elapsed time in milliseconds.
+ */
+static QStatus MarshalUnmarshalLoop(const MsgArg* args, size_t numArgs, uint32_t numIterations, uint64_t& elapsed)
+{
+    QStatus status = ER_OK;
+    TestPipe stream;
+    TestPipe* pStream = &stream;
+    RemoteEndpoint ep(*gBus, falsiness, String::Empty, pStream);
+
+    uint64_t start = GetTimestamp64();
+    for (uint32_t n = 0; (status == ER_OK) && (n < numIterations); ++n) {
+        MyMessage msg;
+        status = msg->MethodCall("desti.nation", "/foo/bar", "foo.bar", "test", args, numArgs);
+        if (status == ER_OK) {
+            status = msg->Deliver(ep);
+        }
+        if (status == ER_OK) {
+            status = msg->Read(ep, ":88.88");
+        }
+        if (status == ER_OK) {
+            status = msg->Unmarshal(ep, ":88.88");
+        }
+        if (status == ER_OK) {
+            status = msg->UnmarshalBody();
+        }
+    }
+    elapsed = GetTimestamp64() - start;
+    return status;
+}
+
+/*
+ * Compare the signature interpreter with compiled signature programs for the signatures
+ * that make up most of the traffic.
+ */
+static QStatus SignatureBenchmark(uint32_t numIterations)
+{
+    QStatus status = ER_OK;
+    static const char* keys[] = { "one", "two", "three", "four", "five", "six", "seven", "eight" };
+    MsgArg dict[ArraySize(keys)];
+    for (size_t k = 0; k < ArraySize(keys); ++k) {
+        dict[k].Set("{sv}", keys[k], new MsgArg("u", static_cast<uint32_t>(k)));
+        dict[k].SetOwnershipFlags(MsgArg::OwnsArgs, true);
+    }
+    MsgArg args[5];
+    args[0].Set("s", s);
+    args[1].Set("u", u);
+    args[2].Set("ay", ArraySize(ay), ay);
+    args[3].Set("a{sv}", ArraySize(dict), dict);
+    args[4].Set("(ii)", i, i);
+
+    quiet = true;
+    printf("%8s %16s %16s\n", "sig", "interpreted(ms)", "compiled(ms)");
+    for (size_t a = 0; (status == ER_OK) && (a < ArraySize(args)); ++a) {
+        uint64_t interpreted;
+        uint64_t compiled;
+        SignatureProgramCache::Enable(false);
+        status = MarshalUnmarshalLoop(&args[a], 1, numIterations, interpreted);
+        SignatureProgramCache::Enable(true);
+        if (status == ER_OK) {
+            status = MarshalUnmarshalLoop(&args[a], 1, numIterations, compiled);
+        }
+        if (status == ER_OK) {
+            printf("%8s %16u %16u\n", MsgArg::Signature(&args[a], 1).c_str(), static_cast<uint32_t>(interpreted), static_cast<uint32_t>(compiled));
+        }
+    }
+    uint32_t numPrograms;
+    uint32_t numEvicted;
+    SignatureProgramCache::GetStats(numPrograms, numEvicted);
+    printf("Signature program cache holds %u programs, %u programs were evicted\n", numPrograms, numEvicted);
+    return status;
+}
+
 
 static void usage(void)
 {
-    printf("Usage: marshal [-f] [-q]\n");
+    printf("Usage: marshal [-f] [-q] [-b] [-p <iterations>]\n");
     printf("Options:\n");
     printf("   -f         = fuzzing\n");
     printf("   -q         = Quiet\n");
     printf("   -b         = Suppress big array test (which takes a long time)\n");
+    printf("   -p <n>     = Benchmark compiled signatures against the signature interpreter with n messages per signature\n");
 }
 
 int main(int argc, char** argv)
 {
     bool fuzz = false;
+    uint32_t benchmark = 0;
     QStatus status = ER_OK;
 
     printf("AllJoyn Library version: %s\n", ajn::GetVersion());
@@ -1056,6 +1133,13 @@ int main(int argc, char** argv)
             nobig = true;
         } else if (0 == strcmp("-q", argv[i])) {
             quiet = true;
+        } else if (0 == strcmp("-p", argv[i])) {
+            ++i;
+            if (i == argc) {
+                usage();
+                exit(1);
+            }
+            benchmark = StringToU32(argv[i], 10, 10000);
         } else {
             usage();
             exit(1);
@@ -1265,6 +1349,13 @@ int main(int argc, char** argv)
         printf("\nFAILED\n");
     }
 
+    if ((status == ER_OK) && benchmark) {
+        status = SignatureBenchmark(benchmark);
+        if (status != ER_OK) {
+            printf("\nBENCHMARK FAILED %s\n", QCC_StatusText(status));
+        }
+    }
+
     if (fuzz) {
         int count = 0;
         fuzzing = true;
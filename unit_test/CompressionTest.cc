@@ -34,6 +34,7 @@
 #include <alljoyn/Status.h>
 
 /* Private files included for unit testing */
+#include <CompressionRules.h>
 #include <RemoteEndpoint.h>
 
 #include <gtest/gtest.h>
@@ -196,3 +197,150 @@ TEST(CompressionTest, Compression) {
         ASSERT_EQ(sig, msg2.GetMemberName()) << "FAILD 6." << 1;
     }
 }
+
+TEST(CompressionTest, InBandDefinition) {
+    QStatus status;
+    BusAttachment sendBus("compressionSender");
+    BusAttachment recvBus("compressionReceiver");
+    MyMessage msg(sendBus);
+    Pipe stream;
+    Pipe* pStream = &stream;
+    static const bool falsiness = false;
+    RemoteEndpoint sendEp(sendBus, falsiness, String::Empty, pStream);
+    RemoteEndpoint recvEp(recvBus, falsiness, String::Empty, pStream);
+
+    sendBus.Start();
+    recvBus.Start();
+
+    /* The first message for a token on a link defines the expansion so is sent uncompressed */
+    status = msg.Signal(":1.99", "/foo/bar", "foo.bar", "define", 0, 4321);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    uint32_t tok1 = msg.GetCompressionToken();
+    ASSERT_NE(0U, tok1);
+    status = msg.Deliver(sendEp);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    ASSERT_EQ(0, msg.GetFlags() & ALLJOYN_FLAG_COMPRESSED);
+    ASSERT_EQ(tok1, msg.GetCompressionToken());
+
+    /* Later messages with the same header fields are compressed */
+    status = msg.Signal(":1.99", "/foo/bar", "foo.bar", "define", 0, 4321);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    ASSERT_EQ(tok1, msg.GetCompressionToken());
+    status = msg.Deliver(sendEp);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    ASSERT_NE(0, msg.GetFlags() & ALLJOYN_FLAG_COMPRESSED);
+
+    /* The receiver has its own compression rules but can expand both messages */
+    for (int i = 0; i < 2; ++i) {
+        MyMessage msg2(recvBus);
+        status = msg2.Read(recvEp, ":88.88");
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+        status = msg2.Unmarshal(recvEp, ":88.88");
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+        ASSERT_EQ(4321U, msg2.GetSessionId()) << "FAILED " << i;
+        ASSERT_STREQ("define", msg2.GetMemberName()) << "FAILED " << i;
+        ASSERT_STREQ("/foo/bar", msg2.GetObjectPath()) << "FAILED " << i;
+    }
+}
+
+TEST(CompressionTest, InBandDefinitionIsPerLink) {
+    QStatus status;
+    BusAttachment sendBus("compressionSender");
+    BusAttachment recvBus("compressionReceiver");
+    MyMessage msg(sendBus);
+    Pipe stream1;
+    Pipe* pStream1 = &stream1;
+    Pipe stream2;
+    Pipe* pStream2 = &stream2;
+    static const bool falsiness = false;
+    RemoteEndpoint sendEp1(sendBus, falsiness, String::Empty, pStream1);
+    RemoteEndpoint recvEp1(recvBus, falsiness, String::Empty, pStream1);
+    RemoteEndpoint sendEp2(sendBus, falsiness, String::Empty, pStream2);
+    RemoteEndpoint recvEp2(recvBus, falsiness, String::Empty, pStream2);
+    RemoteEndpoint otherEp(recvBus, falsiness, String::Empty, pStream1);
+
+    sendBus.Start();
+    recvBus.Start();
+
+    /* Each link gets the definition the first time the token is sent on it */
+    status = msg.Signal(":1.99", "/foo/bar", "foo.bar", "perlink", 0, 1234);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = msg.Deliver(sendEp1);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    ASSERT_EQ(0, msg.GetFlags() & ALLJOYN_FLAG_COMPRESSED);
+
+    status = msg.Signal(":1.99", "/foo/bar", "foo.bar", "perlink", 0, 1234);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = msg.Deliver(sendEp2);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    ASSERT_EQ(0, msg.GetFlags() & ALLJOYN_FLAG_COMPRESSED);
+
+    status = msg.Signal(":1.99", "/foo/bar", "foo.bar", "perlink", 0, 1234);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = msg.Deliver(sendEp2);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    ASSERT_NE(0, msg.GetFlags() & ALLJOYN_FLAG_COMPRESSED);
+
+    MyMessage msg1(recvBus);
+    status = msg1.Read(recvEp1, ":88.88");
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = msg1.Unmarshal(recvEp1, ":88.88");
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    for (int i = 0; i < 2; ++i) {
+        MyMessage msg2(recvBus);
+        status = msg2.Read(recvEp2, ":88.88");
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+        status = msg2.Unmarshal(recvEp2, ":88.88");
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+        ASSERT_STREQ("perlink", msg2.GetMemberName()) << "FAILED " << i;
+    }
+
+    /* A definition received on one link is not used to expand messages received on another */
+    for (int i = 0; i < 2; ++i) {
+        status = msg.Signal(":1.99", "/foo/bar", "foo.bar", "isolated", 0, 1234);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+        status = msg.Deliver(sendEp1);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    }
+    MyMessage msg3(recvBus);
+    status = msg3.Read(recvEp1, ":88.88");
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = msg3.Unmarshal(recvEp1, ":88.88");
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    MyMessage msg4(recvBus);
+    status = msg4.Read(otherEp, ":88.88");
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = msg4.Unmarshal(otherEp, ":88.88");
+    ASSERT_EQ(ER_BUS_CANNOT_EXPAND_MESSAGE, status) << "  Actual Status: " << QCC_StatusText(status);
+}
+
+TEST(CompressionTest, LearnedExpansionsAreBounded) {
+    _CompressionRules rules(2);
+    HeaderFields fields[4];
+    for (size_t i = 0; i < ArraySize(fields); ++i) {
+        qcc::String member = "member" + qcc::U32ToString(i);
+        fields[i].field[ALLJOYN_HDR_FIELD_INTERFACE].Set("s", "foo.bar");
+        fields[i].field[ALLJOYN_HDR_FIELD_MEMBER].Set("s", member.c_str());
+        fields[i].field[ALLJOYN_HDR_FIELD_MEMBER].Stabilize();
+    }
+
+    /* A rule allocated locally is never removed */
+    uint32_t localToken = rules.GetToken(fields[0]);
+
+    /* Only the two most recently learned expansions are kept */
+    rules.AddExpansion(fields[1], 101);
+    rules.AddExpansion(fields[2], 102);
+    rules.AddExpansion(fields[3], 103);
+
+    HeaderFields expansion;
+    EXPECT_FALSE(rules.GetExpansion(101, expansion));
+    EXPECT_TRUE(rules.GetExpansion(102, expansion));
+    EXPECT_STREQ("member2", expansion.field[ALLJOYN_HDR_FIELD_MEMBER].v_string.str);
+    HeaderFields expansion3;
+    EXPECT_TRUE(rules.GetExpansion(103, expansion3));
+    HeaderFields local;
+    EXPECT_TRUE(rules.GetExpansion(localToken, local));
+    EXPECT_STREQ("member0", local.field[ALLJOYN_HDR_FIELD_MEMBER].v_string.str);
+    EXPECT_EQ(localToken, rules.GetToken(fields[0]));
+}
@@ -25,6 +25,8 @@
 
 #include <qcc/platform.h>
 
+#include <string.h>
+
 #include <qcc/Crypto.h>
 #include <qcc/Debug.h>
 #include <qcc/FileStream.h>
@@ -229,3 +231,111 @@ TEST(KeyStoreTest, keystore_store_load_merge) {
     DeleteFile("keystore_test");
 }
 
+
+/*
+ * Read a key store file written by the default key store listener and return its size and version
+ */
+static size_t ReadKeyStoreFile(const char* application, uint16_t& version)
+{
+    FileSource source(GetHomeDir() + "/.alljoyn_keystore/" + application);
+    uint8_t buf[1024];
+    size_t total = 0;
+    size_t pulled;
+    version = 0;
+    while (source.PullBytes(buf, sizeof(buf), pulled) == ER_OK) {
+        if ((total == 0) && (pulled >= sizeof(version))) {
+            memcpy(&version, buf, sizeof(version));
+        }
+        total += pulled;
+    }
+    return total;
+}
+
+TEST(KeyStoreTest, keystore_journal_append_compact) {
+    qcc::GUID128 guid1;
+    qcc::GUID128 guid2;
+    qcc::GUID128 guid3;
+    QStatus status = ER_OK;
+    KeyBlob key;
+
+    /*
+     * Start from an empty key store that is not shared so changes are appended to the journal
+     */
+    {
+        KeyStore keyStore("keystore_journal_test");
+        keyStore.Init(NULL, false);
+        keyStore.Clear();
+
+        key.Rand(Crypto_AES::AES128_SIZE, KeyBlob::AES);
+        keyStore.AddKey(guid1, key);
+        status = keyStore.Store();
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to store keystore";
+
+        key.Rand(Crypto_AES::AES128_SIZE, KeyBlob::AES);
+        keyStore.AddKey(guid2, key);
+        key.Rand(620, KeyBlob::GENERIC);
+        keyStore.AddKey(guid3, key);
+        status = keyStore.Store();
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to append to keystore";
+
+        /* Deleting a key appends a record straight away */
+        status = keyStore.DelKey(guid2);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to delete guid2";
+    }
+
+    /*
+     * Load the snapshot and replay the journal
+     */
+    {
+        KeyStore keyStore("keystore_journal_test");
+        keyStore.Init(NULL, false);
+
+        status = keyStore.GetKey(guid1, key);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to load guid1";
+
+        status = keyStore.GetKey(guid2, key);
+        ASSERT_EQ(ER_BUS_KEY_UNAVAILABLE, status) << "  Actual Status: " << QCC_StatusText(status) << " guid2 was not deleted";
+
+        status = keyStore.GetKey(guid3, key);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to load guid3";
+        ASSERT_EQ(static_cast<size_t>(620), key.GetSize()) << "guid3 key was not replayed correctly";
+
+        /*
+         * Append enough records to force the journal to be compacted. Appending a record only
+         * ever grows the file so the file shrinks when the journal is compacted into a snapshot.
+         */
+        uint16_t version;
+        size_t size = ReadKeyStoreFile("keystore_journal_test", version);
+        EXPECT_EQ(0x0104, version);
+        size_t compactions = 0;
+        for (size_t i = 0; i < 200; ++i) {
+            key.Rand(Crypto_AES::AES128_SIZE, KeyBlob::AES);
+            keyStore.AddKey(guid1, key);
+            status = keyStore.Store();
+            ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to store keystore";
+            size_t newSize = ReadKeyStoreFile("keystore_journal_test", version);
+            if (newSize < size) {
+                ++compactions;
+            }
+            size = newSize;
+        }
+        EXPECT_LT(0U, compactions) << "Journal was never compacted";
+        EXPECT_EQ(0x0104, version);
+    }
+
+    /*
+     * Load the compacted key store
+     */
+    {
+        KeyStore keyStore("keystore_journal_test");
+        keyStore.Init(NULL, false);
+
+        status = keyStore.GetKey(guid1, key);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to load guid1";
+
+        status = keyStore.GetKey(guid3, key);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to load guid3";
+
+        keyStore.Clear();
+    }
+}
@@ -20,6 +20,8 @@
 
 #include <qcc/Util.h>
 #include <qcc/Pipe.h>
+#include <qcc/Socket.h>
+#include <qcc/SocketStream.h>
 #include <qcc/String.h>
 #include <qcc/StringUtil.h>
 
@@ -297,6 +299,65 @@ TEST(MarshalTest, TestMsgUnpack) {
     delete bus;
 }
 
+#if !defined(QCC_OS_GROUP_WINDOWS)
+/*
+ * Pass a handle between two endpoints connected by a UNIX socket pair. Every read on an endpoint
+ * that passes handles goes through PullBytesAndFds.
+ */
+TEST(MarshalTest, HandlePassingOverUnixSocket) {
+    QStatus status = ER_OK;
+
+    BusAttachment* bus = new BusAttachment("HandlePassingOverUnixSocket", false);
+    bus->Start();
+
+    qcc::SocketFd socks[2];
+    status = qcc::SocketPair(socks);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    SocketStream txStream(socks[0]);
+    SocketStream rxStream(socks[1]);
+    SocketStream* pTxStream = &txStream;
+    SocketStream* pRxStream = &rxStream;
+    static const bool falsiness = false;
+    RemoteEndpoint txEp(*bus, falsiness, String::Empty, pTxStream);
+    RemoteEndpoint rxEp(*bus, falsiness, String::Empty, pRxStream);
+    txEp->GetFeatures().handlePassing = true;
+    rxEp->GetFeatures().handlePassing = true;
+
+    qcc::SocketFd handle;
+    status = qcc::Socket(QCC_AF_INET, QCC_SOCK_STREAM, handle);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    MyMessage txMsg(*bus);
+    MsgArg arg("h", handle);
+    status = txMsg.MethodCall("a.b.c", "/foo/bar", "foo.bar", "test", &arg, 1);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    status = txMsg.Deliver(txEp);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    MyMessage rxMsg(*bus);
+    status = rxMsg.Read(rxEp, ":88.88");
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    status = rxMsg.Unmarshal(rxEp, ":88.88");
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    status = rxMsg.UnmarshalBody();
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    qcc::SocketFd received = qcc::INVALID_SOCKET_FD;
+    status = rxMsg.GetArgs("h", &received);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    /* The received handle is a duplicate of the one that was sent */
+    EXPECT_NE(qcc::INVALID_SOCKET_FD, received);
+    EXPECT_NE(handle, received);
+
+    qcc::Close(handle);
+    delete bus;
+}
+#endif
+
 /*--------------------------FUZZING TEST CODE---------------------------------*/
 static bool fuzzing = false;
 static bool nobig = false;
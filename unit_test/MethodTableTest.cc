@@ -0,0 +1,155 @@
+/**
+ * @file
+ *
+ * This file tests replacing and removing method table entries while method calls are using them
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+#include <qcc/Thread.h>
+#include <qcc/Util.h>
+
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/BusObject.h>
+#include <alljoyn/InterfaceDescription.h>
+
+/* Private files included for unit testing */
+#include <MethodTable.h>
+
+#include <gtest/gtest.h>
+
+using namespace qcc;
+using namespace ajn;
+
+static const char* INTERFACE_NAME = "org.alljoyn.test.MethodTableTest";
+static const char* OBJECT_PATH = "/org/alljoyn/test/MethodTableTest";
+
+class MethodTableTestObject : public BusObject {
+  public:
+    MethodTableTestObject() : BusObject(OBJECT_PATH) { }
+
+    void First(const InterfaceDescription::Member* member, Message& msg) { }
+
+    void Second(const InterfaceDescription::Member* member, Message& msg) { }
+};
+
+/* Replaces or removes the test object's entries from another thread */
+class MethodTableUpdater : public Thread {
+  public:
+    MethodTableUpdater(MethodTable& table, MethodTableTestObject& obj, const InterfaceDescription::Member* member) :
+        Thread("MethodTableUpdater"), table(table), obj(obj), member(member), done(false) { }
+
+    qcc::ThreadReturn STDCALL Run(void* arg) {
+        if (member) {
+            table.Add(&obj, static_cast<MessageReceiver::MethodHandler>(&MethodTableTestObject::Second), member);
+        } else {
+            table.RemoveAll(&obj);
+        }
+        done = true;
+        return (qcc::ThreadReturn)0;
+    }
+
+    MethodTable& table;
+    MethodTableTestObject& obj;
+    const InterfaceDescription::Member* member;
+    volatile bool done;
+};
+
+class MethodTableTest : public testing::Test {
+  public:
+    MethodTableTest() : bus("MethodTableTest", false), member(NULL) { }
+
+    virtual void SetUp() {
+        InterfaceDescription* testIntf = NULL;
+        QStatus status = bus.CreateInterface(INTERFACE_NAME, testIntf);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+        status = testIntf->AddMethod("ping", "s", "s", "in,out");
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+        testIntf->Activate();
+        member = testIntf->GetMember("ping");
+        ASSERT_TRUE(member != NULL);
+    }
+
+    BusAttachment bus;
+    const InterfaceDescription::Member* member;
+    MethodTable table;
+    MethodTableTestObject obj;
+};
+
+TEST_F(MethodTableTest, ReplaceWhileInUse) {
+    table.Add(&obj, static_cast<MessageReceiver::MethodHandler>(&MethodTableTestObject::First), member);
+
+    /* A method call is using the entry */
+    MethodTable::SafeEntry* inUse = new MethodTable::SafeEntry();
+    ASSERT_TRUE(table.Find(OBJECT_PATH, INTERFACE_NAME, "ping", *inUse));
+    ASSERT_TRUE(inUse->entry->handler == static_cast<MessageReceiver::MethodHandler>(&MethodTableTestObject::First));
+
+    MethodTableUpdater updater(table, obj, member);
+    ASSERT_EQ(ER_OK, updater.Start());
+
+    /* New method calls find the replacement while the old entry is still in use */
+    bool replaced = false;
+    for (size_t i = 0; (i < 200) && !replaced; ++i) {
+        MethodTable::SafeEntry safeEntry;
+        replaced = table.Find(OBJECT_PATH, INTERFACE_NAME, "ping", safeEntry) &&
+                   (safeEntry.entry->handler == static_cast<MessageReceiver::MethodHandler>(&MethodTableTestObject::Second));
+        qcc::Sleep(5);
+    }
+    EXPECT_TRUE(replaced);
+    MethodTable::SafeEntry noIface;
+    EXPECT_TRUE(table.Find(OBJECT_PATH, "", "ping", noIface));
+    EXPECT_TRUE(noIface.entry->handler == static_cast<MessageReceiver::MethodHandler>(&MethodTableTestObject::Second));
+
+    /* Add() does not return until the old entry is no longer in use */
+    qcc::Sleep(50);
+    EXPECT_FALSE(updater.done);
+    EXPECT_TRUE(inUse->entry->handler == static_cast<MessageReceiver::MethodHandler>(&MethodTableTestObject::First));
+    delete inUse;
+    updater.Join();
+    EXPECT_TRUE(updater.done);
+}
+
+TEST_F(MethodTableTest, RemoveWhileInUse) {
+    table.Add(&obj, static_cast<MessageReceiver::MethodHandler>(&MethodTableTestObject::First), member);
+
+    MethodTable::SafeEntry* inUse = new MethodTable::SafeEntry();
+    ASSERT_TRUE(table.Find(OBJECT_PATH, INTERFACE_NAME, "ping", *inUse));
+
+    MethodTableUpdater updater(table, obj, NULL);
+    ASSERT_EQ(ER_OK, updater.Start());
+
+    /* New method calls no longer find the entry */
+    bool removed = false;
+    for (size_t i = 0; (i < 200) && !removed; ++i) {
+        MethodTable::SafeEntry safeEntry;
+        removed = !table.Find(OBJECT_PATH, INTERFACE_NAME, "ping", safeEntry);
+        qcc::Sleep(5);
+    }
+    EXPECT_TRUE(removed);
+
+    /* RemoveAll() does not return until the entry is no longer in use */
+    qcc::Sleep(50);
+    EXPECT_FALSE(updater.done);
+    EXPECT_TRUE(inUse->entry->object == &obj);
+    delete inUse;
+    updater.Join();
+    EXPECT_TRUE(updater.done);
+
+    MethodTable::SafeEntry safeEntry;
+    EXPECT_FALSE(table.Find(OBJECT_PATH, "", "ping", safeEntry));
+}
@@ -0,0 +1,70 @@
+/**
+ * @file
+ *
+ * This file tests interning and releasing names in the NameAtomTable
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+/* Private files included for unit testing */
+#include <NameAtoms.h>
+
+#include <gtest/gtest.h>
+
+using namespace ajn;
+
+TEST(NameAtomsTest, InternAndRelease) {
+    const char* name = "org.alljoyn.test.NameAtomsTest";
+
+    EXPECT_EQ(NameAtomTable::UNKNOWN_ATOM, NameAtomTable::Find(name));
+    EXPECT_EQ(NameAtomTable::NIL_ATOM, NameAtomTable::Intern(""));
+
+    uint32_t generation = NameAtomTable::Generation();
+    NameAtom atom = NameAtomTable::Intern(name);
+    EXPECT_NE(generation, NameAtomTable::Generation());
+    EXPECT_EQ(atom, NameAtomTable::Intern(name));
+    EXPECT_EQ(atom, NameAtomTable::Find(name));
+
+    /* The name stays in the table until the last reference is released */
+    NameAtomTable::Release(name);
+    EXPECT_EQ(atom, NameAtomTable::Find(name));
+    NameAtomTable::Release(name);
+    EXPECT_EQ(NameAtomTable::UNKNOWN_ATOM, NameAtomTable::Find(name));
+
+    /* Atoms are not reused */
+    NameAtom again = NameAtomTable::Intern(name);
+    EXPECT_NE(atom, again);
+    NameAtomTable::Release(name);
+}
+
+TEST(NameAtomsTest, ResolveHeaderFields) {
+    NameAtom iface = NameAtomTable::Intern("org.alljoyn.test.NameAtomsTest");
+    NameAtom member = NameAtomTable::Intern("Ping");
+
+    uint32_t generation;
+    MessageNameAtoms atoms(":1.1", "org.alljoyn.test.NameAtomsTest", "Ping", NULL, generation);
+    EXPECT_EQ(NameAtomTable::Generation(), generation);
+    EXPECT_EQ(NameAtomTable::UNKNOWN_ATOM, atoms.sender);
+    EXPECT_EQ(iface, atoms.iface);
+    EXPECT_EQ(member, atoms.member);
+    EXPECT_EQ(NameAtomTable::NIL_ATOM, atoms.destination);
+
+    NameAtomTable::Release("org.alljoyn.test.NameAtomsTest");
+    NameAtomTable::Release("Ping");
+}
@@ -25,6 +25,9 @@
 #include <qcc/Thread.h>
 #include <qcc/Util.h>
 
+#include "BusInternal.h"
+#include "AllJoynPeerObj.h"
+
 using namespace ajn;
 using namespace qcc;
 
@@ -3002,3 +3005,124 @@ TEST_F(ObjectSecurityTest, Test33) {
     EXPECT_EQ(Intf2->GetSecurityPolicy(), AJ_IFC_SECURITY_INHERIT);
     EXPECT_FALSE(clientProxyObject.IsSecure());
 }
+
+class OwnerChangedListener : public BusListener {
+  public:
+    OwnerChangedListener(const char* name) : name(name), newOwner() { }
+
+    void NameOwnerChanged(const char* busName, const char* previousOwner, const char* newOwner)
+    {
+        if (newOwner && (name == busName)) {
+            this->newOwner = newOwner;
+        }
+    }
+
+    qcc::String name;
+    qcc::String newOwner;
+};
+
+/*
+ *  Service owns a well-known name and implements a secure interface.
+ *  Client authenticates to the service through the well-known name.
+ *  Service reconnects to the bus so it gets a new unique name and takes the well-known name again.
+ *  expected that the client resumes the session in one round trip instead of authenticating again.
+ */
+TEST_F(ObjectSecurityTest, ResumeAfterReconnect) {
+
+    QStatus status = ER_OK;
+    const char* wellKnownName = "org.alljoyn.alljoyn_test.ResumeAfterReconnect";
+
+    InterfaceDescription* Intf1 = NULL;
+    status = servicebus.CreateInterface(interface1, Intf1, AJ_IFC_SECURITY_REQUIRED);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = Intf1->AddMethod("my_ping", "s", "s", "inStr,outStr", 0);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    Intf1->Activate();
+    InterfaceDescription* Intf2 = NULL;
+    status = servicebus.CreateInterface(interface2, Intf2, AJ_IFC_SECURITY_REQUIRED);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = Intf2->AddProperty("integer_property", "i", PROP_ACCESS_RW);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    Intf2->Activate();
+
+    SvcTestObject serviceObject(object_path, servicebus);
+    status = servicebus.RegisterBusObject(serviceObject, false);
+    //Wait for a maximum of 3 sec for object to be registered
+    for (int i = 0; i < 300; ++i) {
+        qcc::Sleep(10);
+        if (serviceObject.objectRegistered) {
+            break;
+        }
+    }
+    ASSERT_TRUE(serviceObject.objectRegistered);
+    status = servicebus.RequestName(wellKnownName, DBUS_NAME_FLAG_DO_NOT_QUEUE);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    InterfaceDescription* clienttestIntf = NULL;
+    status = clientbus.CreateInterface(interface1, clienttestIntf, AJ_IFC_SECURITY_REQUIRED);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = clienttestIntf->AddMethod("my_ping", "s", "s", "inStr,outStr", 0);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    clienttestIntf->Activate();
+
+    OwnerChangedListener ownerListener(wellKnownName);
+    clientbus.RegisterBusListener(ownerListener);
+
+    AllJoynPeerObj* peerObj = clientbus.GetInternal().GetLocalEndpoint()->GetPeerObj();
+    AllJoynPeerObj::AuthStats stats;
+
+    {
+        ProxyBusObject clientProxyObject(clientbus, wellKnownName, object_path, 0, false);
+        status = clientProxyObject.AddInterface(interface1);
+        EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+        Message reply(clientbus);
+        const InterfaceDescription::Member* pingMethod = clientProxyObject.GetInterface(interface1)->GetMember("my_ping");
+        MsgArg pingArgs("s", "Ping String");
+        status = clientProxyObject.MethodCall(*pingMethod, &pingArgs, 1, reply, 5000);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+        EXPECT_STREQ("Ping String", reply->GetArg(0)->v_string.str);
+        EXPECT_TRUE(serviceObject.msgEncrypted);
+    }
+    peerObj->GetAuthStats(stats);
+    EXPECT_EQ(1U, stats.conversations);
+    EXPECT_EQ(0U, stats.resumeHits);
+
+    /* Reconnect the service so it comes back under a new unique name */
+    qcc::String oldUniqueName = servicebus.GetUniqueName();
+    status = servicebus.Disconnect(ajn::getConnectArg().c_str());
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = servicebus.Connect(ajn::getConnectArg().c_str());
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    EXPECT_NE(oldUniqueName, servicebus.GetUniqueName());
+    status = servicebus.RequestName(wellKnownName, DBUS_NAME_FLAG_DO_NOT_QUEUE);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    //Wait for a maximum of 3 sec for the client to see the new owner
+    for (int i = 0; i < 300; ++i) {
+        if (ownerListener.newOwner == servicebus.GetUniqueName()) {
+            break;
+        }
+        qcc::Sleep(10);
+    }
+    ASSERT_EQ(servicebus.GetUniqueName(), ownerListener.newOwner);
+
+    serviceObject.msgEncrypted = false;
+    {
+        ProxyBusObject clientProxyObject(clientbus, wellKnownName, object_path, 0, false);
+        status = clientProxyObject.AddInterface(interface1);
+        EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+        Message reply(clientbus);
+        const InterfaceDescription::Member* pingMethod = clientProxyObject.GetInterface(interface1)->GetMember("my_ping");
+        MsgArg pingArgs("s", "Ping String");
+        status = clientProxyObject.MethodCall(*pingMethod, &pingArgs, 1, reply, 5000);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+        EXPECT_STREQ("Ping String", reply->GetArg(0)->v_string.str);
+        EXPECT_TRUE(serviceObject.msgEncrypted);
+    }
+    peerObj->GetAuthStats(stats);
+    EXPECT_EQ(1U, stats.conversations);
+    EXPECT_EQ(1U, stats.resumeAttempts);
+    EXPECT_EQ(1U, stats.resumeHits);
+    EXPECT_EQ(0U, stats.failures);
+
+    clientbus.UnregisterBusListener(ownerListener);
+}
@@ -25,6 +25,14 @@
 #include "ajTestCommon.h"
 
 #include <qcc/time.h>
+#include <qcc/Thread.h>
+
+#include <algorithm>
+#include <vector>
+
+/* Private files included for unit testing */
+#include "BusInternal.h"
+
 /* Header files included for Google Test Framework */
 #include <gtest/gtest.h>
 
@@ -761,3 +769,98 @@ TEST_F(PerfTest, ClientTest_BasicDiscovery) {
     ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
     ASSERT_STREQ("Hello World", replyc->GetArg(0)->v_string.str);
 }
+
+/* Times synchronous my_ping round trips so the call path can be compared before and after a change */
+TEST_F(PerfTest, MethodCallTest_RoundTripLatency) {
+    const size_t numCalls = 2000;
+    ClientSetup testclient(ajn::getConnectArg().c_str());
+
+    BusAttachment* client_msgBus = testclient.getClientMsgBus();
+
+    /* No session required since client and service on same daemon */
+    ProxyBusObject remoteObj(*client_msgBus, "org.alljoyn.test_services", "/org/alljoyn/test_services", 0);
+    QStatus status = remoteObj.IntrospectRemoteObject();
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    Message replyc(*client_msgBus);
+    MsgArg pingStr("s", "Hello World");
+    std::vector<uint64_t> latency;
+    latency.reserve(numCalls);
+    uint64_t total = 0;
+    for (size_t i = 0; i < numCalls; ++i) {
+        uint64_t start = GetTimestamp64();
+        status = remoteObj.MethodCall("org.alljoyn.test_services.Interface", "my_ping", &pingStr, 1, replyc, 5000);
+        uint64_t elapsed = GetTimestamp64() - start;
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+        latency.push_back(elapsed);
+        total += elapsed;
+    }
+    ASSERT_STREQ("Hello World", replyc->GetArg(0)->v_string.str);
+
+    std::sort(latency.begin(), latency.end());
+    printf("my_ping: %u calls, mean %.3f ms, p99 %u ms\n", static_cast<unsigned int>(numCalls),
+           static_cast<double>(total) / numCalls, static_cast<unsigned int>(latency[(numCalls * 99) / 100]));
+}
+
+/* Makes synchronous my_ping calls on a proxy object shared with other threads */
+class PingThread : public Thread {
+  public:
+    PingThread(BusAttachment& bus, ProxyBusObject& remoteObj, uint32_t id, size_t numCalls) :
+        Thread("PingThread"), bus(bus), remoteObj(remoteObj), id(id), numCalls(numCalls), failures(0) { }
+
+    qcc::ThreadReturn STDCALL Run(void* arg) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "Ping from %u", id);
+        Message replyc(bus);
+        MsgArg pingStr("s", buf);
+        for (size_t i = 0; i < numCalls; ++i) {
+            QStatus status = remoteObj.MethodCall("org.alljoyn.test_services.Interface", "my_ping", &pingStr, 1, replyc, 5000);
+            /* The reply must be the one for this thread's call */
+            if ((status != ER_OK) || (strcmp(buf, replyc->GetArg(0)->v_string.str) != 0)) {
+                ++failures;
+            }
+        }
+        return (qcc::ThreadReturn)0;
+    }
+
+    BusAttachment& bus;
+    ProxyBusObject& remoteObj;
+    uint32_t id;
+    size_t numCalls;
+    size_t failures;
+};
+
+TEST_F(PerfTest, MethodCallTest_ConcurrentSyncCalls) {
+    const size_t numThreads = 4;
+    const size_t numCalls = 500;
+    ClientSetup testclient(ajn::getConnectArg().c_str());
+
+    BusAttachment* client_msgBus = testclient.getClientMsgBus();
+
+    /* No session required since client and service on same daemon */
+    ProxyBusObject remoteObj(*client_msgBus, "org.alljoyn.test_services", "/org/alljoyn/test_services", 0);
+    QStatus status = remoteObj.IntrospectRemoteObject();
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    std::vector<PingThread*> threads;
+    for (size_t i = 0; i < numThreads; ++i) {
+        threads.push_back(new PingThread(*client_msgBus, remoteObj, static_cast<uint32_t>(i), numCalls));
+    }
+    for (size_t i = 0; i < numThreads; ++i) {
+        status = threads[i]->Start();
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    }
+    for (size_t i = 0; i < numThreads; ++i) {
+        threads[i]->Join();
+        EXPECT_EQ(0U, threads[i]->failures);
+        delete threads[i];
+    }
+
+    /*
+     * The synchronous calls reused pooled contexts instead of allocating one per call.
+     */
+    const size_t maxContexts = BusAttachment::Internal::NUM_SYNC_REPLY_SLOTS;
+    size_t numContexts = client_msgBus->GetInternal().GetNumSyncReplyContexts();
+    EXPECT_LT(0U, numContexts);
+    EXPECT_GE(maxContexts, numContexts);
+}
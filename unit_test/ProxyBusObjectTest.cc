@@ -21,8 +21,12 @@
 #include <alljoyn/ProxyBusObject.h>
 #include <alljoyn/InterfaceDescription.h>
 #include <alljoyn/DBusStd.h>
+#include <qcc/Event.h>
+#include <qcc/StringUtil.h>
 #include <qcc/Thread.h>
 
+#include <vector>
+
 using namespace ajn;
 using namespace qcc;
 
@@ -464,3 +468,301 @@ TEST_F(ProxyBusObjectTest, AddPropertyInterfaceError) {
     status = proxyObj.AddInterface(*testIntf);
     EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
 }
+
+class PropertyCacheTestBusObject : public BusObject {
+  public:
+    PropertyCacheTestBusObject(const char* path) :
+        BusObject(path), counter(0), gets(0)
+    {
+    }
+
+    QStatus Get(const char* ifcName, const char* propName, MsgArg& val)
+    {
+        ++gets;
+        if (strcmp(propName, "counter") == 0) {
+            return val.Set("u", counter);
+        }
+        return ER_BUS_NO_SUCH_PROPERTY;
+    }
+
+    void Change(uint32_t value)
+    {
+        counter = value;
+        MsgArg val("u", counter);
+        EmitPropChanged(INTERFACE_NAME, "counter", val, 0);
+    }
+
+    uint32_t counter;
+    uint32_t gets;
+};
+
+static QStatus CreatePropertyCacheInterface(BusAttachment& bus)
+{
+    InterfaceDescription* testIntf = NULL;
+    QStatus status = bus.CreateInterface(INTERFACE_NAME, testIntf, false);
+    if (status == ER_OK) {
+        status = testIntf->AddProperty("counter", "u", PROP_ACCESS_READ);
+    }
+    if (status == ER_OK) {
+        status = testIntf->AddPropertyAnnotation("counter", ::ajn::org::freedesktop::DBus::AnnotateEmitsChanged, "true");
+    }
+    if (status == ER_OK) {
+        testIntf->Activate();
+    }
+    return status;
+}
+
+TEST_F(ProxyBusObjectTest, PropertyCache) {
+    status = CreatePropertyCacheInterface(servicebus);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = CreatePropertyCacheInterface(bus);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    PropertyCacheTestBusObject testObj(OBJECT_PATH);
+    status = testObj.AddInterface(*servicebus.GetInterface(INTERFACE_NAME));
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    status = servicebus.Start();
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = servicebus.Connect(ajn::getConnectArg().c_str());
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = servicebus.RegisterBusObject(testObj);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    ProxyBusObject proxy(bus, servicebus.GetUniqueName().c_str(), OBJECT_PATH, 0);
+    status = proxy.AddInterface(*bus.GetInterface(INTERFACE_NAME));
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = proxy.EnablePropertyCaching();
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    /* The first read goes to the remote object, the second is served from the cache */
+    MsgArg val;
+    uint32_t counter = 0;
+    status = proxy.GetProperty(INTERFACE_NAME, "counter", val);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = proxy.GetProperty(INTERFACE_NAME, "counter", val);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    EXPECT_EQ(ER_OK, val.Get("u", &counter));
+    EXPECT_EQ(0U, counter);
+    EXPECT_EQ(1U, testObj.gets);
+
+    ProxyBusObject::PropertyCacheStats stats;
+    proxy.GetPropertyCacheStats(stats);
+    EXPECT_EQ(1U, stats.hits);
+    EXPECT_EQ(1U, stats.misses);
+
+    /* PropertiesChanged updates the cached value without another Get */
+    testObj.Change(42);
+    for (size_t i = 0; i < 200; ++i) {
+        status = proxy.GetProperty(INTERFACE_NAME, "counter", val);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+        val.Get("u", &counter);
+        if (counter == 42) {
+            break;
+        }
+        qcc::Sleep(5);
+    }
+    EXPECT_EQ(42U, counter);
+    EXPECT_EQ(1U, testObj.gets);
+
+    /* GetAll fills the cache for the whole interface so the next GetAll is local */
+    MsgArg all;
+    status = proxy.GetAllProperties(INTERFACE_NAME, all);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    uint32_t gets = testObj.gets;
+    status = proxy.GetAllProperties(INTERFACE_NAME, all);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    EXPECT_EQ(gets, testObj.gets);
+    MsgArg* entries;
+    size_t numEntries;
+    ASSERT_EQ(ER_OK, all.Get("a{sv}", &numEntries, &entries));
+    ASSERT_EQ(1U, numEntries);
+    EXPECT_STREQ("counter", entries[0].v_dictEntry.key->v_string.str);
+
+    servicebus.UnregisterBusObject(testObj);
+}
+
+class BatchTestBusObject : public BusObject {
+  public:
+    BatchTestBusObject(const char* path) : BusObject(path) { }
+
+    void SetUp(const InterfaceDescription& intf)
+    {
+        QStatus status = AddInterface(intf);
+        EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+        const MethodEntry methodEntries[] = {
+            { intf.GetMember("ping"), static_cast<MessageReceiver::MethodHandler>(&BatchTestBusObject::Ping) }
+        };
+        status = AddMethodHandlers(methodEntries, sizeof(methodEntries) / sizeof(methodEntries[0]));
+        EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    }
+
+    void Ping(const InterfaceDescription::Member* member, Message& msg)
+    {
+        MsgArg arg("s", msg->GetArg(0)->v_string.str);
+        QStatus status = MethodReply(msg, &arg, 1);
+        EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    }
+};
+
+class BatchTestCallback : public ProxyBusObject::MethodCallBatchAsyncCB {
+  public:
+    BatchTestCallback() : status(ER_FAIL) { }
+
+    void MethodCallBatchCB(QStatus status, ProxyBusObject* obj, const Message* replies, size_t numReplies, void* context)
+    {
+        this->status = status;
+        for (size_t i = 0; i < numReplies; ++i) {
+            const MsgArg* arg = replies[i]->GetArg(0);
+            values.push_back((arg && (arg->typeId == ALLJOYN_STRING)) ? arg->v_string.str : "");
+        }
+        done.SetEvent();
+    }
+
+    QStatus status;
+    std::vector<qcc::String> values;
+    Event done;
+};
+
+TEST_F(ProxyBusObjectTest, MethodCallBatchAsync) {
+    InterfaceDescription* testIntf = NULL;
+    status = servicebus.CreateInterface(INTERFACE_NAME, testIntf, false);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = testIntf->AddMember(MESSAGE_METHOD_CALL, "ping", "s", "s", "in,out", 0);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    testIntf->Activate();
+
+    BatchTestBusObject testObj(OBJECT_PATH);
+    testObj.SetUp(*testIntf);
+
+    status = servicebus.Start();
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = servicebus.Connect(ajn::getConnectArg().c_str());
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = servicebus.RegisterBusObject(testObj);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    ProxyBusObject proxy(bus, servicebus.GetUniqueName().c_str(), OBJECT_PATH, 0);
+    status = proxy.IntrospectRemoteObject();
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    const InterfaceDescription::Member* ping = proxy.GetInterface(INTERFACE_NAME)->GetMember("ping");
+    ASSERT_TRUE(ping != NULL);
+
+    const size_t numCalls = 100;
+    std::vector<qcc::String> strs(numCalls);
+    std::vector<MsgArg> args(numCalls);
+    std::vector<ProxyBusObject::BatchedCall> calls(numCalls);
+    for (size_t i = 0; i < numCalls; ++i) {
+        strs[i] = "ping " + qcc::U32ToString(static_cast<uint32_t>(i));
+        args[i].Set("s", strs[i].c_str());
+        calls[i].method = ping;
+        calls[i].args = &args[i];
+        calls[i].numArgs = 1;
+    }
+
+    BatchTestCallback callback;
+    status = proxy.MethodCallBatchAsync(&calls[0], numCalls, &callback);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = Event::Wait(callback.done, 10000);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    EXPECT_EQ(ER_OK, callback.status) << "  Actual Status: " << QCC_StatusText(callback.status);
+    ASSERT_EQ(numCalls, callback.values.size());
+    for (size_t i = 0; i < numCalls; ++i) {
+        EXPECT_STREQ(strs[i].c_str(), callback.values[i].c_str());
+    }
+
+    /* An empty batch is rejected and the callback is not called */
+    status = proxy.MethodCallBatchAsync(NULL, 0, &callback);
+    EXPECT_EQ(ER_BAD_ARG_1, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    servicebus.UnregisterBusObject(testObj);
+}
+
+TEST_F(ProxyBusObjectTest, PropertyCacheFollowsOwner) {
+    BusAttachment otherbus("ProxyBusObjectTestother", false);
+    status = CreatePropertyCacheInterface(servicebus);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = CreatePropertyCacheInterface(otherbus);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = CreatePropertyCacheInterface(bus);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    /* The service owns the well-known name, another peer has an object on the same path */
+    PropertyCacheTestBusObject testObj(OBJECT_PATH);
+    status = testObj.AddInterface(*servicebus.GetInterface(INTERFACE_NAME));
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    PropertyCacheTestBusObject otherObj(OBJECT_PATH);
+    status = otherObj.AddInterface(*otherbus.GetInterface(INTERFACE_NAME));
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    status = servicebus.Start();
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = servicebus.Connect(ajn::getConnectArg().c_str());
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = servicebus.RegisterBusObject(testObj);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = servicebus.RequestName(OBJECT_NAME, DBUS_NAME_FLAG_DO_NOT_QUEUE);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    status = otherbus.Start();
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = otherbus.Connect(ajn::getConnectArg().c_str());
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = otherbus.RegisterBusObject(otherObj);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    ProxyBusObject proxy(bus, OBJECT_NAME, OBJECT_PATH, 0);
+    status = proxy.AddInterface(*bus.GetInterface(INTERFACE_NAME));
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = proxy.EnablePropertyCaching();
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    MsgArg val;
+    uint32_t counter = 0;
+    status = proxy.GetProperty(INTERFACE_NAME, "counter", val);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    EXPECT_EQ(1U, testObj.gets);
+
+    /* PropertiesChanged from a peer that does not own the name is ignored */
+    otherObj.Change(99);
+    qcc::Sleep(200);
+    status = proxy.GetProperty(INTERFACE_NAME, "counter", val);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    EXPECT_EQ(ER_OK, val.Get("u", &counter));
+    EXPECT_EQ(0U, counter);
+    EXPECT_EQ(1U, testObj.gets);
+
+    /* PropertiesChanged from the owner is applied */
+    testObj.Change(42);
+    for (size_t i = 0; i < 200; ++i) {
+        status = proxy.GetProperty(INTERFACE_NAME, "counter", val);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+        val.Get("u", &counter);
+        if (counter == 42) {
+            break;
+        }
+        qcc::Sleep(5);
+    }
+    EXPECT_EQ(42U, counter);
+    EXPECT_EQ(1U, testObj.gets);
+
+    /* A change of owner drops the cache so the next read goes to the remote object */
+    status = servicebus.ReleaseName(OBJECT_NAME);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = servicebus.RequestName(OBJECT_NAME, DBUS_NAME_FLAG_DO_NOT_QUEUE);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    for (size_t i = 0; i < 200; ++i) {
+        proxy.GetProperty(INTERFACE_NAME, "counter", val);
+        if (testObj.gets > 1) {
+            break;
+        }
+        qcc::Sleep(5);
+    }
+    EXPECT_EQ(2U, testObj.gets);
+
+    otherbus.UnregisterBusObject(otherObj);
+    otherbus.Stop();
+    otherbus.Join();
+    servicebus.UnregisterBusObject(testObj);
+}
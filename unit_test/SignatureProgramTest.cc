@@ -0,0 +1,96 @@
+/**
+ * @file
+ *
+ * This file tests the signature program cache.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+#include <qcc/String.h>
+
+/* Private files included for unit testing */
+#include <SignatureProgram.h>
+
+#include <gtest/gtest.h>
+
+using namespace qcc;
+using namespace ajn;
+
+/* Generates distinct struct signatures such as "(ybnqy)" */
+static qcc::String StructSignature(size_t n)
+{
+    qcc::String sig = "(";
+    for (size_t i = 0; i < 5; ++i) {
+        sig += "ybnq"[n % 4];
+        n /= 4;
+    }
+    sig += ")";
+    return sig;
+}
+
+TEST(SignatureProgramTest, CompileOnce) {
+    const _SignatureProgram* program = SignatureProgramCache::Get("a{sv}i");
+    ASSERT_TRUE(program != NULL);
+    EXPECT_STREQ("a{sv}i", program->GetSignature().c_str());
+    EXPECT_EQ(2U, program->GetNumArgs());
+
+    const _SignatureProgram* again = SignatureProgramCache::Get("a{sv}i");
+    EXPECT_EQ(program, again);
+    SignatureProgramCache::Release(again);
+    SignatureProgramCache::Release(program);
+
+    EXPECT_TRUE(SignatureProgramCache::Get("a{sv") == NULL);
+}
+
+TEST(SignatureProgramTest, EvictLeastRecentlyUsed) {
+    const size_t maxPrograms = SignatureProgramCache::MAX_PROGRAMS;
+    uint32_t numPrograms;
+    uint32_t evictedBefore;
+    SignatureProgramCache::GetStats(numPrograms, evictedBefore);
+
+    /* Held while it is evicted */
+    qcc::String heldSig = StructSignature(0);
+    const _SignatureProgram* held = SignatureProgramCache::Get(heldSig.c_str());
+    ASSERT_TRUE(held != NULL);
+
+    /* Used between every new signature so it is never the least recently used */
+    const _SignatureProgram* hot = SignatureProgramCache::Get(StructSignature(1).c_str());
+    ASSERT_TRUE(hot != NULL);
+
+    for (size_t i = 2; i < (2 * maxPrograms); ++i) {
+        SignatureProgramCache::Release(SignatureProgramCache::Get(StructSignature(i).c_str()));
+        const _SignatureProgram* program = SignatureProgramCache::Get(StructSignature(1).c_str());
+        EXPECT_EQ(hot, program);
+        SignatureProgramCache::Release(program);
+    }
+
+    uint32_t evictedAfter;
+    SignatureProgramCache::GetStats(numPrograms, evictedAfter);
+    EXPECT_EQ(static_cast<uint32_t>(maxPrograms), numPrograms);
+    EXPECT_LT(evictedBefore, evictedAfter);
+
+    /* The evicted program is still usable and a new lookup compiles the signature again */
+    EXPECT_STREQ(heldSig.c_str(), held->GetSignature().c_str());
+    const _SignatureProgram* recompiled = SignatureProgramCache::Get(heldSig.c_str());
+    ASSERT_TRUE(recompiled != NULL);
+    EXPECT_NE(held, recompiled);
+
+    SignatureProgramCache::Release(recompiled);
+    SignatureProgramCache::Release(held);
+    SignatureProgramCache::Release(hot);
+}
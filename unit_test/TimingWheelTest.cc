@@ -0,0 +1,157 @@
+/**
+ * @file
+ *
+ * This file tests the timing wheel and serial number table used for method call replies
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <vector>
+
+/* Private files included for unit testing */
+#include <SerialMap.h>
+#include <TimingWheel.h>
+
+#include <gtest/gtest.h>
+
+using namespace std;
+using namespace ajn;
+
+TEST(TimingWheelTest, SerialMap) {
+    SerialMap<uint32_t> map;
+
+    for (uint32_t serial = 1; serial <= 1000; ++serial) {
+        map.Insert(serial, serial * 2);
+    }
+    ASSERT_EQ(1000U, map.Size());
+
+    for (uint32_t serial = 1; serial <= 1000; serial += 2) {
+        uint32_t value = 0;
+        ASSERT_TRUE(map.Remove(serial, &value));
+        ASSERT_EQ(serial * 2, value);
+    }
+    ASSERT_EQ(500U, map.Size());
+    ASSERT_FALSE(map.Remove(1));
+
+    for (uint32_t serial = 1; serial <= 1000; ++serial) {
+        uint32_t* value = map.Find(serial);
+        if (serial & 1) {
+            ASSERT_TRUE(value == NULL);
+        } else {
+            ASSERT_TRUE(value != NULL);
+            ASSERT_EQ(serial * 2, *value);
+        }
+    }
+
+    /* Insert and remove many serial numbers, the deleted slots must be reused */
+    for (uint32_t serial = 2000; serial < 100000; ++serial) {
+        map.Insert(serial, 0);
+        map.Remove(serial);
+    }
+    ASSERT_EQ(500U, map.Size());
+    ASSERT_GE(4096U, map.Capacity());
+
+    size_t count = 0;
+    for (size_t i = 0; i < map.Capacity(); ++i) {
+        uint32_t serial;
+        if (map.At(i, serial)) {
+            ASSERT_EQ(0U, serial & 1);
+            ++count;
+        }
+    }
+    ASSERT_EQ(500U, count);
+}
+
+TEST(TimingWheelTest, Expiry) {
+    TimingWheel wheel(10, 64);
+    vector<TimingWheel::Entry> due;
+    uint64_t now = 1000000;
+
+    /* The first advance processes every slot */
+    wheel.Advance(now, due);
+    ASSERT_TRUE(due.empty());
+
+    wheel.Add(1, now + 5);
+    wheel.Add(2, now + 25);
+    wheel.Add(3, now + 5000);   /* Several turns of the wheel */
+    wheel.Add(4, now - 10);     /* Already expired */
+    ASSERT_EQ(4U, wheel.Size());
+
+    wheel.Advance(now + 10, due);
+    ASSERT_EQ(2U, due.size());
+    ASSERT_TRUE(((due[0].key == 1) && (due[1].key == 4)) || ((due[0].key == 4) && (due[1].key == 1)));
+
+    due.clear();
+    wheel.Advance(now + 30, due);
+    ASSERT_EQ(1U, due.size());
+    ASSERT_EQ(2U, due[0].key);
+
+    due.clear();
+    wheel.Advance(now + 4999, due);
+    ASSERT_TRUE(due.empty());
+    ASSERT_EQ(1U, wheel.Size());
+
+    due.clear();
+    wheel.Advance(now + 5010, due);
+    ASSERT_EQ(1U, due.size());
+    ASSERT_EQ(3U, due[0].key);
+    ASSERT_EQ(now + 5000, due[0].deadline);
+    ASSERT_EQ(0U, wheel.Size());
+}
+
+TEST(TimingWheelTest, RemoveAndNextDeadline) {
+    TimingWheel wheel(10, 64);
+    vector<TimingWheel::Entry> due;
+    uint64_t now = 1000000;
+    uint64_t deadline = 0;
+
+    wheel.Advance(now, due);
+    ASSERT_FALSE(wheel.NextDeadline(deadline));
+
+    wheel.Add(1, now + 5000);   /* Several turns of the wheel */
+    ASSERT_TRUE(wheel.NextDeadline(deadline));
+    ASSERT_EQ(now + 5000, deadline);
+
+    wheel.Add(2, now + 25);
+    wheel.Add(3, now + 1280);   /* Same slot as key 2 one turn later */
+    ASSERT_TRUE(wheel.NextDeadline(deadline));
+    ASSERT_EQ(now + 25, deadline);
+
+    /* Removing the earliest timeout moves the next deadline */
+    ASSERT_TRUE(wheel.Remove(2, now + 25));
+    ASSERT_FALSE(wheel.Remove(2, now + 25));
+    ASSERT_EQ(2U, wheel.Size());
+    ASSERT_TRUE(wheel.NextDeadline(deadline));
+    ASSERT_EQ(now + 1280, deadline);
+
+    /* A timeout that has gone around again can still be removed */
+    wheel.Advance(now + 1290, due);
+    ASSERT_EQ(1U, due.size());
+    ASSERT_EQ(3U, due[0].key);
+    ASSERT_TRUE(wheel.Remove(1, now + 5000));
+    ASSERT_EQ(0U, wheel.Size());
+    ASSERT_FALSE(wheel.NextDeadline(deadline));
+
+    /* A removed timeout is not reported when it would have expired */
+    wheel.Add(4, now + 1300);
+    ASSERT_TRUE(wheel.Remove(4, now + 1300));
+    due.clear();
+    wheel.Advance(now + 1400, due);
+    ASSERT_TRUE(due.empty());
+}